@@ -0,0 +1,273 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: aimGuide.cpp
+//
+// Desc: 조준 중 큐볼 경로 예측 구현.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "aimGuide.h"
+#include "physicsParams.h"
+#include "tableField.h"
+#include "tableLayout.h"
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+    const int AIM_MAX_SEGMENTS = 256;   // 한 경로에서 진행하는 구간 수의 상한
+    const int EVENT_SEARCH_STEPS = 24;  // 사건 시각을 찾는 이분 탐색 횟수
+
+    // 점이 다 차면 마지막 점을 바꾼다 (경로의 끝은 항상 맞게 남는다).
+    void addPoint(AimPath& path, float x, float z)
+    {
+        if (path.count >= AIM_PATH_MAX_POINTS)
+            path.count = AIM_PATH_MAX_POINTS - 1;
+        path.x[path.count] = x;
+        path.z[path.count] = z;
+        path.count++;
+    }
+
+    void clearPath(AimPath& path)
+    {
+        path.count = 0;
+        path.pocketed = false;
+    }
+}
+
+void CAimGuide::setTable(const BallState* balls, int count, uint64_t stateHash)
+{
+    if (m_valid && m_stateHash == stateHash)
+        return;
+
+    m_stateHash = stateHash;
+    m_cueX = balls[CUE_BALL].x;
+    m_cueZ = balls[CUE_BALL].z;
+
+    m_numObstacles = 0;
+    for (int i = 0; i < count; i++) {
+        if (i == CUE_BALL || !balls[i].active) continue;
+        m_obstacleIndex[m_numObstacles] = i;
+        m_obstacleX[m_numObstacles] = balls[i].x;
+        m_obstacleZ[m_numObstacles] = balls[i].z;
+        m_numObstacles++;
+    }
+
+    const TableLayout& table = activeTable();
+    m_minX = (float)(table.minX + M_RADIUS);
+    m_maxX = (float)(table.maxX - M_RADIUS);
+    m_minZ = (float)(table.minZ + M_RADIUS);
+    m_maxZ = (float)(table.maxZ - M_RADIUS);
+    m_numPockets = table.numPockets;
+    for (int p = 0; p < m_numPockets; p++)
+        m_pockets[p] = table.pockets[p];
+
+    // 공 배치가 바뀌었으므로 이전 예측은 쓸 수 없다.
+    m_aim = m_power = -1.0f;
+    m_valid = true;
+}
+
+CAimGuide::EventType CAimGuide::nextEvent(float px, float pz, float dx, float dz, float maxT,
+    bool checkBalls, float* t, int* obstacle) const
+{
+    EventType type = EVENT_STOP;
+    float best = maxT;
+    int which = -1;
+
+    // 쿠션: which 0은 x축(좌우), 1은 z축(상하) 쿠션
+    if (dx != 0.0f) {
+        float tx = ((dx > 0 ? m_maxX : m_minX) - px) / dx;
+        if (tx < 0) tx = 0;
+        if (tx < best) { best = tx; type = EVENT_CUSHION; which = 0; }
+    }
+    if (dz != 0.0f) {
+        float tz = ((dz > 0 ? m_maxZ : m_minZ) - pz) / dz;
+        if (tz < 0) tz = 0;
+        if (tz < best) { best = tz; type = EVENT_CUSHION; which = 1; }
+    }
+
+    // 포켓: 공 중심이 포켓 원 안으로 들어오는 순간
+    for (int p = 0; p < m_numPockets; p++) {
+        const PocketCircle& pocket = m_pockets[p];
+        float fx = px - pocket.x;
+        float fz = pz - pocket.z;
+        float b = fx * dx + fz * dz;
+        float c = fx * fx + fz * fz - pocket.radius * pocket.radius;
+        float tp;
+        if (c <= 0) {
+            tp = 0;
+        }
+        else {
+            if (b >= 0) continue;
+            float disc = b * b - c;
+            if (disc < 0) continue;
+            tp = -b - sqrtf(disc);
+        }
+        if (tp <= best) { best = tp; type = EVENT_POCKET; which = p; }
+    }
+
+    // 공: 두 중심 사이 거리가 지름이 되는 순간
+    if (checkBalls) {
+        const float diameter = (float)(M_RADIUS * 2);
+        for (int k = 0; k < m_numObstacles; k++) {
+            float fx = px - m_obstacleX[k];
+            float fz = pz - m_obstacleZ[k];
+            float b = fx * dx + fz * dz;
+            if (b >= 0) continue;   // 멀어지는 방향
+            float c = fx * fx + fz * fz - diameter * diameter;
+            float tb;
+            if (c <= 0) {
+                tb = 0;
+            }
+            else {
+                float disc = b * b - c;
+                if (disc < 0) continue;
+                tb = -b - sqrtf(disc);
+            }
+            if (tb < best) { best = tb; type = EVENT_BALL; which = k; }
+        }
+    }
+
+    *t = best;
+    *obstacle = which;
+    return type;
+}
+
+void CAimGuide::trace(AimPath& path, BallState& ball, int maxEvents, bool checkBalls, int* hitObstacle) const
+{
+    clearPath(path);
+    addPoint(path, ball.x, ball.z);
+    *hitObstacle = -1;
+
+    int cushions = 0;
+    float slideStep = 0.0f;     // 지금 미끄러짐 단계의 토막 시간 (0: 아직 정하지 않음)
+    for (int segment = 0; segment < AIM_MAX_SEGMENTS && isBallMoving(ball); segment++) {
+        // 구름 단계는 멈출 때까지 직선이고, 미끄러짐 단계는 곡선이므로 토막으로 나눈다.
+        float dt = phaseTime(ball);
+        if (ballPhase(ball) == PHASE_SLIDING) {
+            if (slideStep <= 0.0f)
+                slideStep = dt / AIM_SLIDE_SEGMENTS;
+            if (dt > slideStep * 1.5f)
+                dt = slideStep;
+        }
+        else {
+            slideStep = 0.0f;
+        }
+
+        BallState end = ball;
+        advanceBall(end, dt);
+        const float2 start = ballPosition(ball);
+        const float2 chord = ballPosition(end) - start;
+        float distance = length(chord);
+        if (distance <= 1e-6f) {
+            ball = end;
+            continue;
+        }
+        const float2 dir = chord / distance;
+
+        float t;
+        int which;
+        EventType type = nextEvent(start.x, start.y, dir.x, dir.y, distance, checkBalls, &t, &which);
+        if (type == EVENT_STOP) {
+            ball = end;
+            addPoint(path, ball.x, ball.z);
+            continue;
+        }
+
+        // 토막 위 거리 t에 닿는 시각을 찾아 그 순간의 속도와 회전으로 맞춘다.
+        float lo = 0.0f, hi = dt;
+        for (int k = 0; k < EVENT_SEARCH_STEPS; k++) {
+            float mid = 0.5f * (lo + hi);
+            BallState probe = ball;
+            advanceBall(probe, mid);
+            if (dot(ballPosition(probe) - start, dir) < t) lo = mid;
+            else hi = mid;
+        }
+        advanceBall(ball, hi);
+        setBallPosition(ball, start + dir * t);
+        addPoint(path, ball.x, ball.z);
+
+        if (type == EVENT_POCKET) {
+            path.pocketed = true;
+            break;
+        }
+        if (type == EVENT_BALL) {
+            *hitObstacle = which;
+            break;
+        }
+
+        // 쿠션: 물리 코어와 같은 impulse (반발, 쿠션 마찰과 옆 회전). which 0은 x축(좌우) 쿠션.
+        // 경로는 쿠션에서 반지름만큼 안쪽이므로 밀어내기는 되돌린다.
+        if (++cushions > maxEvents)
+            break;
+        FieldSample sample;
+        sample.distance = 0.0f;
+        sample.nx = which == 0 ? (dir.x > 0 ? -1.0f : 1.0f) : 0.0f;
+        sample.nz = which == 1 ? (dir.y > 0 ? -1.0f : 1.0f) : 0.0f;
+        sample.pocket = 1.0f;
+        const float2 at = ballPosition(ball);
+        bounceOffCushion(sample, ball);
+        setBallPosition(ball, at);
+        slideStep = 0.0f;
+    }
+}
+
+const AimPrediction& CAimGuide::predict(float aim, float power, float tipSide, float tipHeight)
+{
+    if (aim == m_aim && power == m_power && tipSide == m_tipSide && tipHeight == m_tipHeight)
+        return m_prediction;
+    m_aim = aim;
+    m_power = power;
+    m_tipSide = tipSide;
+    m_tipHeight = tipHeight;
+
+    AimPrediction& pred = m_prediction;
+    clearPath(pred.cue);
+    clearPath(pred.cueAfter);
+    clearPath(pred.object);
+    pred.hitBall = -1;
+    if (!m_valid)
+        return pred;
+
+    BallState cue;
+    memset(&cue, 0, sizeof(cue));
+    cue.x = m_cueX;
+    cue.y = (float)M_RADIUS;
+    cue.z = m_cueZ;
+    cue.active = true;
+    strikeCueBall(cue, aim, power, tipSide, tipHeight);
+
+    int obstacle;
+    trace(pred.cue, cue, AIM_CUE_MAX_EVENTS, true, &obstacle);
+    if (obstacle < 0)
+        return pred;
+
+    pred.hitBall = m_obstacleIndex[obstacle];
+    pred.ghostX = cue.x;
+    pred.ghostZ = cue.z;
+
+    // contact solver와 같이 중심선 방향 속도의 (1 + e) / 2가 목적구로 넘어가고,
+    // 큐볼에는 나머지 속도와 회전이 남는다 (공끼리는 마찰이 없다).
+    BallState object;
+    memset(&object, 0, sizeof(object));
+    object.x = m_obstacleX[obstacle];
+    object.y = (float)M_RADIUS;
+    object.z = m_obstacleZ[obstacle];
+    object.active = true;
+    float2 normal = ballPosition(object) - ballPosition(cue);
+    float gap = length(normal);
+    if (gap <= 0.0f)
+        return pred;
+    normal = normal / gap;
+    float vn = dot(ballVelocity(cue), normal);
+    if (vn <= 0.0f)
+        return pred;
+    const float2 transfer = normal * (vn * 0.5f * (1.0f + activePhysics().ballRestitution));
+    setBallVelocity(object, transfer);
+    setBallVelocity(cue, ballVelocity(cue) - transfer);
+
+    int unused;
+    trace(pred.object, object, AIM_AFTER_MAX_EVENTS, false, &unused);
+    trace(pred.cueAfter, cue, AIM_AFTER_MAX_EVENTS, false, &unused);
+    return pred;
+}
@@ -0,0 +1,87 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: aimGuide.h
+//
+// Desc: 조준 중 큐볼 경로 예측.
+//       큐 팁 위치까지 strikeCueBall로 친 큐볼을 물리 코어의 운동 단계(미끄러짐 -> 구름)와
+//       쿠션 impulse(bounceOffCushion)로 따라간다. 미끄러지는 구간은 곡선이므로 몇 토막으로
+//       나누어 잇는다. 첫 공 충돌에서는 contact solver와 같이 반발 계수만큼 중심선 방향 속도를
+//       넘기고 큐볼의 회전은 남긴다 (당김, 밀어치기). 그 뒤의 큐볼/목적구는 쿠션 몇 번만 따라간다.
+//       정지한 공과 쿠션/포켓 정보는 테이블 hash가 바뀔 때만 다시 만든다.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __aimGuideH__
+#define __aimGuideH__
+
+#include "billiardPhysics.h"
+#include <stdint.h>
+
+const int AIM_PATH_MAX_POINTS = 48;  // 시작점 + 사건과 미끄러짐 토막의 끝점
+const int AIM_SLIDE_SEGMENTS = 6;    // 미끄러짐 단계 하나를 나누는 토막 수
+const int AIM_CUE_MAX_EVENTS = 4;    // 첫 공 충돌 전까지 따라가는 쿠션 반사 수
+const int AIM_AFTER_MAX_EVENTS = 2;  // 충돌 후 경로에서 따라가는 쿠션 반사 수
+
+struct AimPath {
+    int   count;
+    float x[AIM_PATH_MAX_POINTS];
+    float z[AIM_PATH_MAX_POINTS];
+    bool  pocketed;     // 경로 끝에서 포켓에 들어감
+};
+
+struct AimPrediction {
+    AimPath cue;        // 큐볼: 출발 ~ 첫 공 충돌(또는 정지)
+    AimPath cueAfter;   // 큐볼: 첫 공 충돌 이후
+    AimPath object;     // 맞은 공
+    int     hitBall;    // 첫 충돌 공, 없으면 -1
+    float   ghostX, ghostZ; // 첫 충돌 순간의 큐볼 중심
+};
+
+class CAimGuide {
+public:
+    CAimGuide(void) : m_valid(false), m_stateHash(0), m_numObstacles(0), m_numPockets(0), m_aim(-1.0f), m_power(-1.0f),
+        m_tipSide(0.0f), m_tipHeight(0.0f)
+    {
+        m_prediction.cue.count = m_prediction.cueAfter.count = m_prediction.object.count = 0;
+        m_prediction.hitBall = -1;
+    }
+
+    // 테이블이 바뀐 경우에만 정적인 장애물 정보를 다시 만든다.
+    // 쿠션과 포켓은 activeTable()에서 가져오므로 테이블을 바꾸면 invalidate 해야 한다.
+    void setTable(const BallState* balls, int count, uint64_t stateHash);
+    void invalidate(void) { m_valid = false; }
+
+    // 큐볼을 aim(라디안) 방향, power 속력, 큐 팁 위치 (tipSide, tipHeight)로 쳤을 때의 경로
+    const AimPrediction& predict(float aim, float power, float tipSide = 0.0f, float tipHeight = 0.0f);
+    const AimPrediction& last(void) const { return m_prediction; }
+
+private:
+    // 한 직선 구간에서 가장 먼저 일어나는 사건
+    enum EventType { EVENT_STOP, EVENT_CUSHION, EVENT_POCKET, EVENT_BALL };
+
+    EventType nextEvent(float px, float pz, float dx, float dz, float maxT,
+        bool checkBalls, float* t, int* obstacle) const;
+    // ball을 멈추거나 포켓, 공에 닿을 때까지 (쿠션은 maxEvents번까지) 진행한다.
+    // ball은 끝난 순간의 상태가 된다.
+    void trace(AimPath& path, BallState& ball, int maxEvents, bool checkBalls, int* hitObstacle) const;
+
+    bool     m_valid;
+    uint64_t m_stateHash;
+    float    m_cueX, m_cueZ;
+
+    // 큐볼을 제외한 활성 공 (SoA)
+    int      m_numObstacles;
+    int      m_obstacleIndex[NUM_BALLS];
+    float    m_obstacleX[NUM_BALLS];
+    float    m_obstacleZ[NUM_BALLS];
+
+    // 공 중심이 움직일 수 있는 범위 (쿠션에서 반지름만큼 안쪽)와 포켓
+    float    m_minX, m_maxX, m_minZ, m_maxZ;
+    int          m_numPockets;
+    PocketCircle m_pockets[NUM_POCKETS];
+
+    float         m_aim, m_power, m_tipSide, m_tipHeight;
+    AimPrediction m_prediction;
+};
+
+#endif // __aimGuideH__
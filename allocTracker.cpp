@@ -0,0 +1,75 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: allocTracker.cpp
+//
+// Desc: heap 할당 계수 hook 구현.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "allocTracker.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+    std::atomic<unsigned long long> g_allocCount(0);
+    std::atomic<unsigned long long> g_allocBytes(0);
+    AllocFailureHandler g_failureHandler = NULL;
+}
+
+#ifdef ALLOC_TRACKING
+
+namespace
+{
+    void* trackedAlloc(size_t bytes)
+    {
+        g_allocCount.fetch_add(1, std::memory_order_relaxed);
+        g_allocBytes.fetch_add(bytes, std::memory_order_relaxed);
+        void* p = malloc(bytes == 0 ? 1 : bytes);
+        if (p == NULL)
+            throw std::bad_alloc();
+        return p;
+    }
+}
+
+void* operator new(size_t bytes) { return trackedAlloc(bytes); }
+void* operator new[](size_t bytes) { return trackedAlloc(bytes); }
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+
+#endif // ALLOC_TRACKING
+
+AllocStats allocTotals(void)
+{
+    AllocStats s;
+    s.count = g_allocCount.load(std::memory_order_relaxed);
+    s.bytes = g_allocBytes.load(std::memory_order_relaxed);
+    return s;
+}
+
+bool allocTrackingEnabled(void)
+{
+#ifdef ALLOC_TRACKING
+    return true;
+#else
+    return false;
+#endif
+}
+
+void setAllocFailureHandler(AllocFailureHandler handler)
+{
+    g_failureHandler = handler;
+}
+
+bool CAllocWatch::expectNone(const char* where) const
+{
+    AllocStats d = delta();
+    if (d.count == 0)
+        return true;
+    if (g_failureHandler != NULL)
+        g_failureHandler(where, d);
+    return false;
+}
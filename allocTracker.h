@@ -0,0 +1,55 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: allocTracker.h
+//
+// Desc: heap 할당 횟수와 byte 수를 세는 debug hook.
+//       ALLOC_TRACKING을 정의하고 빌드하면 allocTracker.cpp가 전역 operator new/delete를
+//       바꾸어 모든 thread의 할당을 센다. 정의하지 않으면 값은 항상 0이다.
+//
+//       CAllocWatch로 frame이나 샷 하나 동안의 할당량을 재고, expectNone()으로
+//       안정 상태에서 할당이 없어야 하는 구간을 검사한다. 할당이 있으면 등록된
+//       handler를 부르고 false를 돌려준다. tools/allocCheck은 warm-up 뒤의 frame과 샷을
+//       이것으로 검사해 할당이 있으면 실패한다.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __allocTrackerH__
+#define __allocTrackerH__
+
+struct AllocStats {
+    unsigned long long count;   // 할당 횟수
+    unsigned long long bytes;   // 요청한 byte 수
+};
+
+// 프로그램 시작부터 지금까지의 합계
+AllocStats allocTotals(void);
+bool allocTrackingEnabled(void);
+
+// expectNone()이 실패할 때 부른다. NULL이면 아무것도 하지 않는다.
+typedef void (*AllocFailureHandler)(const char* where, const AllocStats& delta);
+void setAllocFailureHandler(AllocFailureHandler handler);
+
+class CAllocWatch {
+public:
+    CAllocWatch(void) { begin(); }
+
+    void begin(void) { m_start = allocTotals(); }
+
+    // begin() 이후의 할당량
+    AllocStats delta(void) const
+    {
+        AllocStats now = allocTotals();
+        AllocStats d;
+        d.count = now.count - m_start.count;
+        d.bytes = now.bytes - m_start.bytes;
+        return d;
+    }
+
+    // begin() 이후 할당이 없었으면 true
+    bool expectNone(const char* where) const;
+
+private:
+    AllocStats m_start;
+};
+
+#endif // __allocTrackerH__
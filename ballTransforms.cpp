@@ -0,0 +1,73 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: ballTransforms.cpp
+//
+// Desc: 공의 방향과 world 행렬 일괄 생성 구현.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "ballTransforms.h"
+#include <cstring>
+
+CBallTransforms::CBallTransforms(void)
+    : m_worldValid(false)
+{
+    for (int i = 0; i < MAX_BALL_TRANSFORMS; i++) {
+        m_position[i] = make_float3(0.0f, 0.0f, 0.0f);
+        resetOrientation(i);
+    }
+    m_lastWorld = float4x4Identity();
+}
+
+void CBallTransforms::resetOrientation(int slot)
+{
+    m_orientation[slot] = quatIdentity();
+    m_sinceNormalize[slot] = 0;
+    m_dirty[slot] = true;
+}
+
+void CBallTransforms::rotateLocal(int slot, quat rotation)
+{
+    m_orientation[slot] = normalize(m_orientation[slot] * rotation);
+    m_sinceNormalize[slot] = 0;
+    m_dirty[slot] = true;
+}
+
+void CBallTransforms::roll(int slot, float3 omega, float t)
+{
+    if (lengthSq(omega) == 0.0f || t == 0.0f)
+        return;
+
+    m_orientation[slot] = integrateRotation(m_orientation[slot], omega, t);
+    if (++m_sinceNormalize[slot] >= ORIENTATION_NORMALIZE_INTERVAL) {
+        m_orientation[slot] = normalize(m_orientation[slot]);
+        m_sinceNormalize[slot] = 0;
+    }
+    m_dirty[slot] = true;
+}
+
+void CBallTransforms::setPosition(int slot, float3 position)
+{
+    const float3& old = m_position[slot];
+    if (old.x == position.x && old.y == position.y && old.z == position.z)
+        return;
+    m_position[slot] = position;
+    m_dirty[slot] = true;
+}
+
+void CBallTransforms::update(const float4x4& world)
+{
+    bool worldChanged = !m_worldValid || memcmp(&world, &m_lastWorld, sizeof(world)) != 0;
+    m_lastWorld = world;
+    m_worldValid = true;
+
+    for (int i = 0; i < MAX_BALL_TRANSFORMS; i++) {
+        if (!m_dirty[i] && !worldChanged)
+            continue;
+        if (m_dirty[i]) {
+            m_local[i] = float4x4RotationTranslation(m_orientation[i], m_position[i]);
+            m_dirty[i] = false;
+        }
+        m_world[i] = m_local[i] * world;
+    }
+}
@@ -0,0 +1,58 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: ballTransforms.h
+//
+// Desc: 공의 방향(quaternion)과 그리기용 world 행렬을 slot 순서의 연속 배열로 관리한다.
+//       방향은 각속도를 적분할 때마다 정규화하지 않고 ORIENTATION_NORMALIZE_INTERVAL 번에
+//       한 번 정규화한다. 위치나 방향이 바뀐 slot만 dirty로 표시해 두었다가, update()가
+//       frame마다 한 번 dirty slot의 local 행렬(R * T)을 다시 만들고 world 행렬을 곱해
+//       m_world에 쓴다. world 행렬이 바뀐 frame에는 모든 slot을 다시 곱한다.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __ballTransformsH__
+#define __ballTransformsH__
+
+#include "billiardPhysics.h"
+
+// 물리 공 NUM_BALLS개와 조준용 공 하나
+const int MAX_BALL_TRANSFORMS = NUM_BALLS + 1;
+// 이 횟수만큼 회전을 쌓으면 quaternion을 다시 정규화한다.
+const int ORIENTATION_NORMALIZE_INTERVAL = 32;
+
+class CBallTransforms {
+public:
+    CBallTransforms(void);
+
+    // 방향을 처음 상태로 되돌린다.
+    void resetOrientation(int slot);
+
+    // 공 자신의 축 기준으로 돌린다 (지금까지의 회전보다 먼저 적용).
+    void rotateLocal(int slot, quat rotation);
+
+    // world 축 기준 각속도 omega로 t 동안 굴린다.
+    void roll(int slot, float3 omega, float t);
+
+    // 공의 중심을 알린다. 바뀌었을 때만 dirty가 된다.
+    void setPosition(int slot, float3 position);
+
+    // 바뀐 slot의 행렬을 다시 만든다. 그리기 전에 frame마다 한 번 부른다.
+    void update(const float4x4& world);
+
+    const float4x4* matrices(void) const { return m_world; }
+    const float4x4& matrix(int slot) const { return m_world[slot]; }
+    quat orientation(int slot) const { return m_orientation[slot]; }
+
+private:
+    quat     m_orientation[MAX_BALL_TRANSFORMS];
+    float3   m_position[MAX_BALL_TRANSFORMS];
+    float4x4 m_local[MAX_BALL_TRANSFORMS];  // R * T
+    float4x4 m_world[MAX_BALL_TRANSFORMS];  // R * T * world
+    bool     m_dirty[MAX_BALL_TRANSFORMS];
+    int      m_sinceNormalize[MAX_BALL_TRANSFORMS];
+
+    float4x4 m_lastWorld;
+    bool     m_worldValid;
+};
+
+#endif // __ballTransformsH__
@@ -0,0 +1,308 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: billiardEnv.cpp
+//
+// Desc: 샷 정책 학습용 C ABI 환경 구현.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "billiardEnv.h"
+#include "billiardPhysics.h"
+#include "contactSolver.h"
+#include "ruleEngine.h"
+#include "tableLayout.h"
+#include "threadPool.h"
+#include <cstring>
+#include <new>
+
+static_assert(BENV_NUM_BALLS == NUM_BALLS, "observation layout must match the physics core");
+
+namespace
+{
+    const float REWARD_BALL = 1.0f;
+    const float REWARD_FOUL = -1.0f;
+    const float REWARD_WIN = 10.0f;
+    // 이 step 수 안에 멈추지 않으면 남은 움직임을 버린다.
+    const int   MAX_SHOT_STEPS = 4096;
+    // 환경 몇 개를 한 번에 넘길지 (샷 길이가 제각각이므로 작게 나눈다)
+    const int   ENV_GRAIN = 4;
+
+    // splitmix64: seed를 퍼뜨리고 섞기에 쓴다.
+    uint64_t nextRandom(uint64_t& state)
+    {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    unsigned activeMask(const BallState* balls)
+    {
+        unsigned mask = 0;
+        for (int i = 0; i < NUM_BALLS; i++) {
+            if (balls[i].active) mask |= 1u << i;
+        }
+        return mask;
+    }
+
+    void sendEvent(CRuleEngine& rules, PhysicsEventType type, int a = -1, int b = -1)
+    {
+        PhysicsEvent event;
+        event.type = type;
+        event.a = a;
+        event.b = b;
+        event.speed = 0.0f;
+        rules.onEvent(event);
+    }
+}
+
+struct EnvSlot {
+    BallState   balls[NUM_BALLS];
+    CRuleEngine rules;
+    uint64_t    random;
+    int         shots;      // 이번 게임에서 친 샷 수
+};
+
+struct BilliardEnv {
+    EnvSlot*     slots;
+    int          count;
+    CThreadPool* pool;
+};
+
+namespace
+{
+    // 게임의 Setup과 같은 배치: 큐볼은 cue 자리, 고정된 공은 그 자리, 나머지는 섞는다.
+    void newGame(EnvSlot& slot)
+    {
+        const TableLayout& table = activeTable();
+        int available[TABLE_MAX_RACK];
+        int numAvailable = 0;
+        for (int pos = 0; pos < table.rackCount; pos++) {
+            if (table.rackBall[pos] == 0) available[numAvailable++] = pos;
+        }
+        for (int i = numAvailable - 1; i > 0; i--) {
+            int j = (int)(nextRandom(slot.random) % (uint64_t)(i + 1));
+            int t = available[i];
+            available[i] = available[j];
+            available[j] = t;
+        }
+
+        for (int i = 0; i < NUM_BALLS; i++) {
+            BallState& ball = slot.balls[i];
+            memset(&ball, 0, sizeof(ball));
+            ball.y = (float)M_RADIUS;
+            if (i > table.rackCount) {
+                pocketBall(ball);
+                continue;
+            }
+
+            int posIndex = -1;
+            for (int pos = 0; pos < table.rackCount; pos++) {
+                if (table.rackBall[pos] == i) posIndex = pos;
+            }
+            if (i == CUE_BALL) {
+                ball.x = table.cueX;
+                ball.z = table.cueZ;
+            }
+            else {
+                if (posIndex < 0 && numAvailable > 0)
+                    posIndex = available[--numAvailable];
+                if (posIndex < 0) {
+                    pocketBall(ball);
+                    continue;
+                }
+                ball.x = table.rackX[posIndex];
+                ball.z = table.rackZ[posIndex];
+            }
+            ball.active = true;
+        }
+
+        slot.rules.reset(slot.balls, NUM_BALLS);
+        slot.shots = 0;
+    }
+
+    // 큐볼을 친 뒤 멈출 때까지 진행하며 규칙에 사건을 넘긴다.
+    void runShot(EnvSlot& slot, CContactSolver& solver)
+    {
+        sendEvent(slot.rules, EVENT_SHOT_STARTED);
+        solver.reset();
+
+        bool moving = true;
+        for (int step = 0; moving && step < MAX_SHOT_STEPS; step++) {
+            StepEvents events;
+            stepTable(slot.balls, NUM_BALLS, SIM_FIXED_STEP, &events, &solver);
+
+            // StepEvents는 쿠션에 맞은 수만 세므로 어느 공인지는 알 수 없다 (규칙은 수만 쓴다).
+            for (int c = 0; c < events.cushionHits; c++)
+                sendEvent(slot.rules, EVENT_CUSHION_HIT);
+            if (events.firstContact >= 0)
+                sendEvent(slot.rules, EVENT_FIRST_CONTACT, CUE_BALL, events.firstContact);
+            for (int i = 0; i < NUM_BALLS; i++) {
+                if (events.pocketed & (1u << i))
+                    sendEvent(slot.rules, EVENT_POCKETED, i);
+            }
+
+            // 더 이상 충돌이 없으면 남은 구간은 닫힌 해로 한 번에 끝낸다.
+            moving = !fastForwardToRest(slot.balls, NUM_BALLS);
+        }
+        if (moving) {
+            for (int i = 0; i < NUM_BALLS; i++) {
+                BallState& ball = slot.balls[i];
+                ball.vx = ball.vz = 0.0f;
+                ball.wx = ball.wy = ball.wz = 0.0f;
+            }
+        }
+        sendEvent(slot.rules, EVENT_ALL_STOPPED);
+    }
+
+    float playShot(EnvSlot& slot, const BilliardEnvAction& action, CContactSolver& solver, bool* done)
+    {
+        if (slot.rules.selectingGroup())
+            slot.rules.selectGroup(action.group != 0);
+
+        const RuleState before = slot.rules.rules();
+        if (before.free_shot) {
+            const TableLayout& table = activeTable();
+            const float r = (float)M_RADIUS;
+            BallState& cue = slot.balls[CUE_BALL];
+            memset(&cue, 0, sizeof(cue));
+            cue.x = action.placeX < table.minX + r ? table.minX + r : action.placeX > table.maxX - r ? table.maxX - r : action.placeX;
+            cue.z = action.placeZ < table.minZ + r ? table.minZ + r : action.placeZ > table.maxZ - r ? table.maxZ - r : action.placeZ;
+            cue.y = r;
+            cue.active = true;
+            slot.rules.placeCueBall();
+        }
+
+        unsigned activeBefore = activeMask(slot.balls);
+        strikeCueBall(slot.balls[CUE_BALL], action.aim, action.power, action.tipSide, action.tipHeight);
+        runShot(slot, solver);
+        slot.shots++;
+
+        // 자기 그룹(정해지지 않았으면 8번을 뺀 아무 공)을 넣은 수
+        unsigned potted = activeBefore & ~activeMask(slot.balls);
+        int own = 0;
+        for (int i = 1; i < NUM_BALLS; i++) {
+            if (!(potted & (1u << i)) || i == EIGHT_BALL) continue;
+            if (before.open || (before.group ? isSolidBall(i) : isStripeBall(i)))
+                own++;
+        }
+
+        float reward = own * REWARD_BALL;
+        if (slot.rules.lastShotFoul())
+            reward += REWARD_FOUL;
+
+        int winner = slot.rules.winner();
+        if (winner != 0)
+            reward += (winner == 1) == before.turn ? REWARD_WIN : -REWARD_WIN;
+
+        *done = winner != 0 || slot.shots >= BENV_MAX_SHOTS;
+        if (*done)
+            newGame(slot);
+        return reward;
+    }
+
+    struct StepBody {
+        BilliardEnv*             env;
+        const BilliardEnvAction* actions;
+        float*                   rewards;
+        uint8_t*                 dones;
+
+        void operator()(int begin, int end) const
+        {
+            // solver는 이 구간에서만 쓰므로 stack에 둔다.
+            CContactSolver solver;
+            for (int i = begin; i < end; i++) {
+                bool done;
+                float reward = playShot(env->slots[i], actions[i], solver, &done);
+                if (rewards != NULL) rewards[i] = reward;
+                if (dones != NULL) dones[i] = done ? 1 : 0;
+            }
+        }
+    };
+}
+
+BilliardEnv* benv_create(int numEnvs, int numThreads)
+{
+    if (numEnvs <= 0)
+        return NULL;
+
+    BilliardEnv* env = new (std::nothrow) BilliardEnv;
+    if (env == NULL)
+        return NULL;
+    env->count = numEnvs;
+    env->slots = new (std::nothrow) EnvSlot[numEnvs];
+    // 부른 thread도 함께 일하므로 worker는 하나 적게 둔다. thread 하나면 pool이 없다.
+    env->pool = NULL;
+    if (numThreads != 1)
+        env->pool = new (std::nothrow) CThreadPool(numThreads > 1 ? numThreads - 1 : 0);
+    if (env->slots == NULL || (numThreads != 1 && env->pool == NULL)) {
+        benv_destroy(env);
+        return NULL;
+    }
+    benv_reset(env, 0);
+    return env;
+}
+
+void benv_destroy(BilliardEnv* env)
+{
+    if (env == NULL)
+        return;
+    delete env->pool;
+    delete[] env->slots;
+    delete env;
+}
+
+int benv_num_envs(const BilliardEnv* env)
+{
+    return env != NULL ? env->count : 0;
+}
+
+void benv_reset(BilliardEnv* env, uint64_t seed)
+{
+    if (env == NULL)
+        return;
+    uint64_t spread = seed;
+    for (int i = 0; i < env->count; i++) {
+        env->slots[i].random = nextRandom(spread);
+        newGame(env->slots[i]);
+    }
+}
+
+void benv_step(BilliardEnv* env, const BilliardEnvAction* actions, float* rewards, uint8_t* dones)
+{
+    if (env == NULL || actions == NULL)
+        return;
+    StepBody body = { env, actions, rewards, dones };
+    if (env->pool != NULL)
+        env->pool->parallelFor(env->count, ENV_GRAIN, body);
+    else
+        body(0, env->count);
+}
+
+void benv_observe(const BilliardEnv* env, float* positions, uint8_t* active, int32_t* rules)
+{
+    if (env == NULL)
+        return;
+    for (int i = 0; i < env->count; i++) {
+        const EnvSlot& slot = env->slots[i];
+        if (positions != NULL) {
+            float* out = positions + i * NUM_BALLS * 2;
+            for (int b = 0; b < NUM_BALLS; b++) {
+                out[b * 2] = slot.balls[b].x;
+                out[b * 2 + 1] = slot.balls[b].z;
+            }
+        }
+        if (active != NULL) {
+            for (int b = 0; b < NUM_BALLS; b++)
+                active[i * NUM_BALLS + b] = slot.balls[b].active ? 1 : 0;
+        }
+        if (rules != NULL) {
+            const RuleState& state = slot.rules.rules();
+            int32_t* out = rules + i * BENV_RULE_FIELDS;
+            out[BENV_RULE_TURN] = state.turn;
+            out[BENV_RULE_GROUP] = state.group;
+            out[BENV_RULE_OPEN] = state.open;
+            out[BENV_RULE_FREE_SHOT] = state.free_shot;
+        }
+    }
+}
@@ -0,0 +1,84 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: billiardEnv.h
+//
+// Desc: 샷 정책 학습용 C ABI 환경. 창 없이 물리 코어와 규칙만으로 여러 게임을 돌린다.
+//
+//       benv_create(n, threads)로 n개의 환경을 만들고, benv_step에 환경마다 행동 하나를
+//       주면 모든 환경이 그 샷을 공이 멈출 때까지 동시에 진행한다 (한 step = 샷 하나).
+//       benv_observe는 호출한 쪽의 연속된 buffer에 바로 쓴다.
+//       메모리는 benv_create에서 모두 잡으므로 reset, step, observe는 heap을 쓰지 않는다.
+//
+//       행동: 그룹을 골라야 하면 group으로 고르고, free shot이면 (placeX, placeZ)에
+//       큐볼을 놓은 뒤 (aim, power, tipSide, tipHeight)로 친다.
+//       보상(친 사람 기준): 자기 그룹 공 하나에 +1, 파울 -1, 이기면 +10, 지면 -10.
+//       게임이 끝나거나 BENV_MAX_SHOTS를 넘으면 done이 1이 되고 그 환경은 새 게임으로
+//       바뀐다 (돌려받는 관측은 새 게임의 것).
+//
+//       공유 library로 만들 때는 물리 코어 파일과 함께 빌드한다. 예)
+//         g++ -O2 -shared -fPIC -o libbilliardenv.so billiardEnv.cpp billiardPhysics.cpp
+//             contactSolver.cpp detMath.cpp islandStepper.cpp ruleEngine.cpp tableField.cpp
+//             tableConfig.cpp tableLayout.cpp threadPool.cpp eventBus.cpp physicsParams.cpp
+//       Windows DLL은 BILLIARD_ENV_EXPORTS를 정의해 빌드한다.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __billiardEnvH__
+#define __billiardEnvH__
+
+#include <stdint.h>
+
+#if defined(_WIN32) && defined(BILLIARD_ENV_EXPORTS)
+#define BENV_API __declspec(dllexport)
+#else
+#define BENV_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BENV_NUM_BALLS 16
+#define BENV_MAX_SHOTS 256      /* 한 게임의 샷 수 상한 */
+
+/* benv_observe의 rules buffer에서 환경 하나가 쓰는 칸 */
+enum BilliardEnvRuleField {
+    BENV_RULE_TURN,         /* 1: player 1 차례 */
+    BENV_RULE_GROUP,        /* 1: 차례인 사람의 그룹이 solid */
+    BENV_RULE_OPEN,         /* 1: 그룹이 아직 정해지지 않음 */
+    BENV_RULE_FREE_SHOT,    /* 1: 큐볼을 놓고 친다 */
+    BENV_RULE_FIELDS
+};
+
+typedef struct BilliardEnvAction {
+    float   aim;            /* 라디안 */
+    float   power;          /* 큐볼 초기 속력 */
+    float   tipSide;        /* 큐 팁 위치 (반지름 비율) */
+    float   tipHeight;
+    float   placeX;         /* free shot일 때 큐볼 자리 */
+    float   placeZ;
+    int32_t group;          /* 그룹을 골라야 할 때 1: solid, 0: stripe */
+} BilliardEnvAction;
+
+typedef struct BilliardEnv BilliardEnv;
+
+/* numThreads가 0이면 hardware thread 수를 쓴다. 실패하면 NULL. */
+BENV_API BilliardEnv* benv_create(int numEnvs, int numThreads);
+BENV_API void benv_destroy(BilliardEnv* env);
+BENV_API int  benv_num_envs(const BilliardEnv* env);
+
+/* 모든 환경을 새 게임으로. 같은 seed면 같은 rack이 된다. */
+BENV_API void benv_reset(BilliardEnv* env, uint64_t seed);
+
+/* actions[numEnvs]. rewards[numEnvs], dones[numEnvs]는 NULL이어도 된다. */
+BENV_API void benv_step(BilliardEnv* env, const BilliardEnvAction* actions, float* rewards, uint8_t* dones);
+
+/* positions[numEnvs * BENV_NUM_BALLS * 2] (x, z), active[numEnvs * BENV_NUM_BALLS],
+   rules[numEnvs * BENV_RULE_FIELDS]. 필요 없는 buffer는 NULL. */
+BENV_API void benv_observe(const BilliardEnv* env, float* positions, uint8_t* active, int32_t* rules);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __billiardEnvH__ */
@@ -0,0 +1,509 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: billiardPhysics.cpp
+//
+// Desc: D3D에 의존하지 않는 당구 물리 코어 구현.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "billiardPhysics.h"
+#include "tableLayout.h"
+#include "tableConfig.h"
+#include "islandStepper.h"
+#include "detMath.h"
+#include <cmath>
+#include <cstring>
+
+// -----------------------------------------------------------------------------
+// 물리 함수
+// -----------------------------------------------------------------------------
+
+void integrateBall(BallState& ball, float timeDiff)
+{
+    if (!ball.active) return;
+
+    advanceBall(ball, timeDiff);
+}
+
+bool bounceOffCushion(const FieldSample& sample, BallState& ball)
+{
+    const float radius = (float)M_RADIUS;
+    if (sample.distance >= radius)
+        return false;
+
+    // 쿠션 안으로 파고든 만큼 법선 방향으로 밀어낸다.
+    const float2 normal = make_float2(sample.nx, sample.nz);
+    setBallPosition(ball, ballPosition(ball) + normal * (radius - sample.distance));
+
+    // 쿠션에서 멀어지는 중인 공은 이미 반사된 것이므로 다시 뒤집지 않는다.
+    float2 v = ballVelocity(ball);
+    float vn = dot(v, normal);
+    if (vn >= 0.0f)
+        return false;
+
+    // 반사 벡터 계산 (법선 impulse는 (1 + 반발 계수) * -vn)
+    const PhysicsParams& params = activePhysics();
+    const float normalImpulse = (1.0f + params.cushionRestitution) * -vn;
+    v += normal * normalImpulse;
+
+    // 쿠션 접점은 공의 적도에 있으므로 접선 방향 미끄러짐은 vt + R * wy 이다.
+    // 마찰 impulse는 법선 impulse에 비례하고, 미끄러짐을 없애는 양(2/7)을 넘지 않는다.
+    // 접선 속도가 dv 변할 때 R * wy는 5/2 * dv 변한다.
+    const float2 tangent = perp(normal);
+    float slip = dot(v, tangent) + radius * ball.wy;
+    float limit = params.cushionFriction * normalImpulse;
+    float dv = -slip * 2.0f / 7.0f;
+    if (dv > limit) dv = limit;
+    else if (dv < -limit) dv = -limit;
+    setBallVelocity(ball, v + tangent * dv);
+    ball.wy += 2.5f * dv / radius;
+    return true;
+}
+
+void pocketBall(BallState& ball)
+{
+    ball.active = false;
+    ball.x = ball.y = ball.z = -999.0f; // 물리적으로 접근 불가능한 위치
+    ball.vx = ball.vz = 0;
+    ball.wx = ball.wy = ball.wz = 0;
+}
+
+bool isBallMoving(const BallState& ball)
+{
+    return ball.active && ballPhase(ball) >= PHASE_ROLLING;
+}
+
+// -----------------------------------------------------------------------------
+// 회전 모델
+// -----------------------------------------------------------------------------
+
+namespace
+{
+    // 바닥 접점의 미끄러짐 속도
+    float2 slipVelocity(const BallState& ball)
+    {
+        const float radius = (float)M_RADIUS;
+        return make_float2(ball.vx + radius * ball.wz, ball.vz - radius * ball.wx);
+    }
+
+    // 미끄러짐 단계의 닫힌 해. 마찰 방향 dir는 단계 동안 바뀌지 않는다.
+    void slide(BallState& ball, float2 dir, float t)
+    {
+        const float f = activePhysics().slideFriction;
+        const float2 v = ballVelocity(ball);
+        setBallPosition(ball, ballPosition(ball) + (v * t - dir * (0.5f * f * t * t)) * activePhysics().timeScale);
+        setBallVelocity(ball, v - dir * (f * t));
+        ball.wx += 2.5f * f * dir.y * t / (float)M_RADIUS;
+        ball.wz -= 2.5f * f * dir.x * t / (float)M_RADIUS;
+    }
+
+    // 구름 단계의 닫힌 해. 각속도는 속도를 따라간다.
+    void rollBall(BallState& ball, float t)
+    {
+        const float2 v = ballVelocity(ball);
+        float speed = length(v);
+        if (speed > 0.0f) {
+            const float2 dir = v / speed;
+            setBallPosition(ball, ballPosition(ball) + dir * distanceAfterTime(speed, t));
+            setBallVelocity(ball, dir * speedAfterTime(speed, t));
+        }
+        ball.wx = ball.vz / (float)M_RADIUS;
+        ball.wz = -ball.vx / (float)M_RADIUS;
+    }
+
+    void decaySpin(BallState& ball, float t)
+    {
+        float drop = activePhysics().spinFriction * t / (float)M_RADIUS;
+        if (ball.wy > drop) ball.wy -= drop;
+        else if (ball.wy < -drop) ball.wy += drop;
+        else ball.wy = 0.0f;
+    }
+}
+
+BallPhase ballPhase(const BallState& ball)
+{
+    if (length(slipVelocity(ball)) > SLIP_EPSILON)
+        return PHASE_SLIDING;
+    if (ball.vx != 0 || ball.vz != 0)
+        return PHASE_ROLLING;
+    if (ball.wy != 0)
+        return PHASE_SPINNING;
+    return PHASE_STOPPED;
+}
+
+float phaseTime(const BallState& ball)
+{
+    switch (ballPhase(ball)) {
+    case PHASE_SLIDING:
+        return length(slipVelocity(ball)) * 2.0f / (7.0f * activePhysics().slideFriction);
+    case PHASE_ROLLING:
+        return stopTime(length(ballVelocity(ball)));
+    case PHASE_SPINNING:
+        return fabsf(ball.wy) * (float)M_RADIUS / activePhysics().spinFriction;
+    default:
+        return 0.0f;
+    }
+}
+
+// 큐 팁이 중심에서 (side, height) * R 만큼 떨어진 곳을 수평으로 치면
+//     v = J / m,  w = (5 / 2) * (v / R) * (side * (s x d) + height * (y x d))
+// 이고 s x d = -y, y x d = (dz, 0, -dx) 이다. (s: 오른쪽, y: 위, d: 조준 방향)
+void strikeCueBall(BallState& cue, float aim, float power, float tipSide, float tipHeight)
+{
+    float offset = sqrtf(tipSide * tipSide + tipHeight * tipHeight);
+    if (offset > MAX_TIP_OFFSET) {
+        tipSide *= MAX_TIP_OFFSET / offset;
+        tipHeight *= MAX_TIP_OFFSET / offset;
+    }
+
+    float2 dir;
+    physSinCos(aim, &dir.y, &dir.x);
+    float k = 2.5f * power / (float)M_RADIUS;
+    setBallVelocity(cue, dir * power);
+    cue.wx = k * tipHeight * dir.y;
+    cue.wy = -k * tipSide;
+    cue.wz = -k * tipHeight * dir.x;
+}
+
+// -----------------------------------------------------------------------------
+// 감속 모델의 닫힌 해
+//
+// D = rollDecay, k = rollResistance / D 라 두면 속력은
+//     v(t) = (v0 + k) * exp(-D * t) - k
+// 이고, 정지 시간은 v(T) = 0 에서
+//     T = ln(1 + v0 / k) / D
+// 이동 거리는 위치가 timeScale * v 로 움직이므로
+//     d(t) = timeScale * ((v0 + k) * (1 - exp(-D * t)) / D - k * t)
+// -----------------------------------------------------------------------------
+
+namespace
+{
+    // k
+    double resistSpeed(const PhysicsParams& params)
+    {
+        return (double)params.rollResistance / params.rollDecay;
+    }
+}
+
+float stopTime(float speed)
+{
+    if (speed <= 0.0f)
+        return 0.0f;
+    const PhysicsParams& params = activePhysics();
+    return (float)(physLog1p(speed / resistSpeed(params)) / params.rollDecay);
+}
+
+float speedAfterTime(float speed, float t)
+{
+    if (t >= stopTime(speed))
+        return 0.0f;
+    const PhysicsParams& params = activePhysics();
+    const double k = resistSpeed(params);
+    return (float)((speed + k) * physExp(-(double)params.rollDecay * t) - k);
+}
+
+float distanceAfterTime(float speed, float t)
+{
+    if (speed <= 0.0f)
+        return 0.0f;
+    const PhysicsParams& params = activePhysics();
+    const double k = resistSpeed(params);
+    double T = stopTime(speed);
+    double tt = t < T ? t : T;
+    return (float)(params.timeScale * ((speed + k) * -physExpm1(-(double)params.rollDecay * tt) / params.rollDecay
+        - k * tt));
+}
+
+float stopDistance(float speed)
+{
+    if (speed <= 0.0f)
+        return 0.0f;
+    const PhysicsParams& params = activePhysics();
+    const double k = resistSpeed(params);
+    return (float)(params.timeScale / params.rollDecay * (speed - k * physLog1p(speed / k)));
+}
+
+// 속력을 거리의 함수로 쓰면
+//     d(v) = timeScale / D * ((v0 - v) - k * ln((v0 + k) / (v + k)))
+// 이고 v에 대해 닫힌 꼴로 풀리지 않으므로 Newton 반복으로 푼다. (단조 감소, 2~3회면 수렴)
+float speedAfterDistance(float speed, float distance)
+{
+    if (distance <= 0.0f)
+        return speed;
+    if (distance >= stopDistance(speed))
+        return 0.0f;
+
+    const PhysicsParams& params = activePhysics();
+    const double k = resistSpeed(params);
+    double target = distance * params.rollDecay / params.timeScale;
+    double v = speed - target;
+    if (v < 0) v = 0;
+    for (int i = 0; i < 8; i++) {
+        double f = (speed - v) - k * physLog((speed + k) / (v + k)) - target;
+        double df = -v / (v + k);
+        if (df == 0.0) break;
+        double next = v - f / df;
+        if (next < 0) next = 0;
+        if (next > speed) next = speed;
+        if (fabs(next - v) < 1e-7) { v = next; break; }
+        v = next;
+    }
+    return (float)v;
+}
+
+// 같은 식을 v0에 대해 푼다. f(v0)는 증가하는 볼록 함수이므로 아래에서 시작한 Newton은
+// 한 번 넘어간 뒤 위에서 단조롭게 수렴한다.
+float speedForDistance(float distance, float arriveSpeed)
+{
+    if (arriveSpeed < 0.0f)
+        arriveSpeed = 0.0f;
+    if (distance <= 0.0f)
+        return arriveSpeed;
+
+    const PhysicsParams& params = activePhysics();
+    const double k = resistSpeed(params);
+    double target = distance * params.rollDecay / params.timeScale;
+    double v = arriveSpeed + target;
+    for (int i = 0; i < 8; i++) {
+        double f = (v - arriveSpeed) - k * physLog((v + k) / (arriveSpeed + k)) - target;
+        double df = v / (v + k);
+        if (df == 0.0) break;
+        double next = v - f / df;
+        if (next < arriveSpeed) next = arriveSpeed;
+        if (fabs(next - v) < 1e-7) { v = next; break; }
+        v = next;
+    }
+    return (float)v;
+}
+
+void advanceBall(BallState& ball, float t)
+{
+    if (t <= 0.0f)
+        return;
+    decaySpin(ball, t);
+
+    // 미끄러짐 단계: 끝나는 시점까지 진행한 뒤 남은 시간은 구름 단계로 넘긴다.
+    const float2 u = slipVelocity(ball);
+    float slip = length(u);
+    if (slip > SLIP_EPSILON) {
+        float slideEnd = slip * 2.0f / (7.0f * activePhysics().slideFriction);
+        if (t < slideEnd) {
+            slide(ball, u / slip, t);
+            return;
+        }
+        slide(ball, u / slip, slideEnd);
+        t -= slideEnd;
+    }
+
+    rollBall(ball, t);
+}
+
+namespace
+{
+    // 선분 p0-p1 과 q0-q1 사이 최단 거리의 제곱
+    float segmentDistanceSq(float2 p0, float2 p1, float2 q0, float2 q1)
+    {
+        const float2 u = p1 - p0;
+        const float2 v = q1 - q0;
+        const float2 w = p0 - q0;
+        float a = dot(u, u);
+        float b = dot(u, v);
+        float c = dot(v, v);
+        float d = dot(u, w);
+        float e = dot(v, w);
+
+        float s = 0.0f, t = 0.0f;
+        if (a <= 1e-12f && c <= 1e-12f) {
+            s = t = 0.0f;
+        }
+        else if (a <= 1e-12f) {
+            t = e / c;
+        }
+        else if (c <= 1e-12f) {
+            s = -d / a;
+        }
+        else {
+            float denom = a * c - b * b;
+            s = denom > 1e-12f ? (b * e - c * d) / denom : 0.0f;
+            s = s < 0 ? 0 : (s > 1 ? 1 : s);
+            t = (b * s + e) / c;
+            if (t < 0) { t = 0; s = -d / a; }
+            else if (t > 1) { t = 1; s = (b - d) / a; }
+        }
+        s = s < 0 ? 0 : (s > 1 ? 1 : s);
+        t = t < 0 ? 0 : (t > 1 ? 1 : t);
+
+        return lengthSq(w + u * s - v * t);
+    }
+
+    bool fastForwardOn(const RuntimeTable& table, BallState* balls)
+    {
+        const int count = table.balls;
+        float2 stop[NUM_BALLS];
+        bool moving[NUM_BALLS];
+        bool any = false;
+
+        const float minX = table.minX + table.radius, maxX = table.maxX - table.radius;
+        const float minZ = table.minZ + table.radius, maxZ = table.maxZ - table.radius;
+
+        for (int i = 0; i < count; i++) {
+            const BallState& ball = balls[i];
+            moving[i] = isBallMoving(ball);
+            stop[i] = ballPosition(ball);
+            if (!moving[i]) continue;
+            any = true;
+
+            if (ballPhase(ball) == PHASE_SLIDING)
+                return false;
+
+            const float2 v = ballVelocity(ball);
+            float speed = length(v);
+            // 접촉 충격량이 남긴 아주 작은 속도는 length가 0으로 떨어질 수 있다.
+            if (speed > 0.0f)
+                stop[i] += v * (stopDistance(speed) / speed);
+
+            // 쿠션에 닿기 전에 멈춰야 하고, 남은 경로가 포켓을 지나면 안 된다.
+            bool blocked = (stop[i].x <= minX) | (stop[i].x >= maxX) | (stop[i].y <= minZ) | (stop[i].y >= maxZ);
+            for (int p = 0; p < table.pockets; p++) {
+                const PocketCircle& pocket = table.pocket(p);
+                const float2 center = make_float2(pocket.x, pocket.z);
+                float r = pocket.radius;
+                blocked |= segmentDistanceSq(ballPosition(ball), stop[i], center, center) <= r * r;
+            }
+            if (blocked)
+                return false;
+        }
+        if (!any)
+            return true;
+
+        // 움직이는 공의 경로가 다른 공(의 경로)과 지름 이내로 가까워지면 충돌 가능성이 있다.
+        // 시간을 무시한 경로끼리의 거리이므로 보수적인 판정이다.
+        const float diameter = table.radius * 2;
+        for (int i = 0; i < count; i++) {
+            if (!moving[i]) continue;
+            for (int j = 0; j < count; j++) {
+                if (j == i || !balls[j].active) continue;
+                if (moving[j] && j < i) continue; // 움직이는 공끼리는 한 번만
+                float distSq = segmentDistanceSq(ballPosition(balls[i]), stop[i], ballPosition(balls[j]), stop[j]);
+                if (distSq < diameter * diameter)
+                    return false;
+            }
+        }
+
+        for (int i = 0; i < count; i++) {
+            if (!moving[i]) continue;
+            setBallPosition(balls[i], stop[i]);
+            balls[i].vx = balls[i].vz = 0;
+            balls[i].wx = balls[i].wz = 0;
+        }
+        return true;
+    }
+}
+
+bool fastForwardToRest(BallState* balls, int count)
+{
+    return fastForwardOn(RuntimeTable(activeTable(), count), balls);
+}
+
+void stepTable(BallState* balls, int count, float timeDiff, StepEvents* events, CContactSolver* solver)
+{
+    StepEvents local;
+    if (events == NULL)
+        events = &local;
+    memset(events, 0, sizeof(*events));
+    events->firstContact = -1;
+
+    // 공끼리의 접촉은 island마다 한꺼번에 푼다. solver가 없으면 warm start 없이 이 step만 푼다.
+    // (solver는 작업 공간이 커서 필요할 때만 만든다)
+    if (solver == NULL) {
+        CContactSolver oneStep;
+        stepTable(balls, count, timeDiff, events, &oneStep);
+        return;
+    }
+
+    BallIslands islands;
+    buildIslands(balls, count, timeDiff, islands);
+    solver->forgetSeparated(islands.islandOf);
+
+    for (int k = 0; k < islands.numIslands; k++) {
+        StepEvents island;
+        int begin = islands.start[k];
+        stepIsland(balls, islands.members + begin, islands.start[k + 1] - begin, timeDiff,
+            island, *solver, solver->workspace(), solver->pool(), NULL);
+        mergeStepEvents(*events, island);
+    }
+}
+
+ShotOutcome simulateShot(const TableState& start, float aim, float power,
+    float tipSide, float tipHeight, int maxSteps)
+{
+    ShotOutcome outcome;
+    memset(&outcome, 0, sizeof(outcome));
+    outcome.firstContact = -1;
+
+    BallState* balls = outcome.finalBalls;
+    memcpy(balls, start.balls, sizeof(start.balls));
+    CContactSolver solver;
+    strikeCueBall(balls[CUE_BALL], aim, power, tipSide, tipHeight);
+
+    bool moving = true;
+    while (moving && outcome.steps < maxSteps) {
+        StepEvents events;
+        stepTable(balls, NUM_BALLS, SIM_FIXED_STEP, &events, &solver);
+        outcome.steps++;
+        outcome.pocketed |= events.pocketed;
+        outcome.cushionHits += events.cushionHits;
+        if (outcome.firstContact < 0)
+            outcome.firstContact = events.firstContact;
+
+        // 더 이상 충돌이 없으면 남은 구간은 닫힌 해로 한 번에 끝낸다.
+        moving = !fastForwardToRest(balls, NUM_BALLS);
+    }
+
+    bool solidIn = false, stripeIn = false;
+    for (int i = 0; i < NUM_BALLS; i++) {
+        if (!(outcome.pocketed & (1u << i))) continue;
+        solidIn = solidIn || isSolidBall(i);
+        stripeIn = stripeIn || isStripeBall(i);
+    }
+    outcome.scratch = (outcome.pocketed & (1u << CUE_BALL)) != 0;
+    outcome.foul = isFoul(start.rules.break_shot, solidIn, stripeIn, outcome.scratch, outcome.cushionHits) ||
+        !isLegalFirstContact(start.rules, outcome.firstContact);
+    return outcome;
+}
+
+// -----------------------------------------------------------------------------
+// 규칙
+// -----------------------------------------------------------------------------
+
+// shot의 foul 여부를 판단함. break_shot와 cusion count를 사용함.
+bool isFoul(bool breakShot, bool solidIn, bool stripeIn, bool whiteIn, int cushionCount)
+{
+    if (breakShot) {
+        if (!solidIn && !stripeIn) {
+            if (cushionCount < 4) {
+                return true;
+            }
+        }
+    }
+    if (whiteIn) {
+        return true;
+    }
+    return false;
+}
+
+bool isLegalFirstContact(const RuleState& rules, int firstContact)
+{
+    // 아무 공도 맞히지 못함
+    if (firstContact < 0 || firstContact >= NUM_BALLS)
+        return false;
+    if (rules.break_shot)
+        return true;
+    if (rules.open)
+        return firstContact != EIGHT_BALL;
+
+    bool groupCleared = rules.group ? rules.solid_num == 0 : rules.stripe_num == 0;
+    if (firstContact == EIGHT_BALL)
+        return groupCleared;
+    return rules.group ? isSolidBall(firstContact) : isStripeBall(firstContact);
+}
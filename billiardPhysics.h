@@ -0,0 +1,181 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: billiardPhysics.h
+//
+// Desc: D3D에 의존하지 않는 당구 물리 코어.
+//       공/테이블 상태와 한 프레임 진행(공 이동, 포켓, 쿠션, 공끼리의 충돌)을
+//       제공하여 게임 화면과 샷 분석(what-if 시뮬레이션)이 같은 모델을 사용한다.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __billiardPhysicsH__
+#define __billiardPhysicsH__
+
+#include "simdMath.h"
+#include "physicsParams.h"
+
+#define M_RADIUS 0.21   // ball radius
+
+const int NUM_BALLS = 16;
+const int NUM_WALLS = 4;
+const int NUM_POCKETS = 6;      // 테이블 하나가 가질 수 있는 최대 포켓 수
+
+const int CUE_BALL = 0;
+const int EIGHT_BALL = 8;
+
+// 감속 모델: dv/dt = -rollDecay * v - rollResistance * (v / |v|)
+// 속도에 비례하는 감쇠(예전 ballUpdate의 (1 - DECREASE_RATE) * 400)에
+// 일정한 구름 저항을 더해 공이 유한한 시간에 정확히 멈추도록 한다.
+// 위치, 속도, 정지 시간 모두 닫힌 식으로 계산되어 step 크기와 무관하다.
+// 계수와 위치 배율(timeScale)은 activePhysics()에서 읽는다 (physicsParams.h).
+//
+// 게임 루프 한 프레임(약 16ms * 0.0007)에 해당하는 고정 시뮬레이션 간격
+const float SIM_FIXED_STEP = 0.0112f;
+
+// 회전 모델: 공은 미끄러짐(sliding) -> 구름(rolling) -> 제자리 회전(spinning) -> 정지 순으로
+// 단계를 지나며, 단계마다 닫힌 해가 있어 단계 경계까지 한 번에 진행할 수 있다.
+// 각속도는 R * w가 속도와 같은 단위가 되도록 둔다 (구름: wx = vz / R, wz = -vx / R).
+//
+// 미끄러짐: 바닥 접점의 미끄러짐 속도 u = (vx + R * wz, vz - R * wx)의 반대 방향으로
+//          일정한 마찰이 걸리고, u는 7/2 * slideFriction 의 비율로 줄어든다.
+// 제자리 회전(세로축 english)은 다른 단계와 관계없이 R * wy가 spinFriction의 비율로 줄어든다.
+
+// 이보다 작은 미끄러짐 속도는 구름으로 본다.
+const float SLIP_EPSILON = 1e-4f;
+// 큐 팁이 공 중심에서 벗어날 수 있는 최대 거리 (반지름 비율, 넘으면 miscue)
+const float MAX_TIP_OFFSET = 0.5f;
+
+// -----------------------------------------------------------------------------
+// 상태 정의
+// -----------------------------------------------------------------------------
+
+struct BallState {
+    float x, y, z;      // 공의 중심
+    float vx, vz;       // x-z 평면 속도
+    float wx, wy, wz;   // 각속도 (R * w가 속도와 같은 단위)
+    bool  active;       // false: 포켓에 들어감
+};
+
+// 테이블 평면(x, z)의 위치와 속도, 각속도를 벡터로 읽고 쓴다.
+inline float2 ballPosition(const BallState& ball) { return make_float2(ball.x, ball.z); }
+inline float2 ballVelocity(const BallState& ball) { return make_float2(ball.vx, ball.vz); }
+inline float3 ballSpin(const BallState& ball) { return make_float3(ball.wx, ball.wy, ball.wz); }
+inline void setBallPosition(BallState& ball, float2 p) { ball.x = p.x; ball.z = p.y; }
+inline void setBallVelocity(BallState& ball, float2 v) { ball.vx = v.x; ball.vz = v.y; }
+
+enum BallPhase { PHASE_STOPPED, PHASE_SPINNING, PHASE_ROLLING, PHASE_SLIDING };
+
+// 쿠션 박스 (중심, x방향 폭, z방향 깊이). 화면에 그리는 레일 모양이며
+// 충돌 판정은 tableLayout의 쿠션 nose / jaw 다각형으로 한다.
+struct WallBox {
+    float x, z;
+    float width, depth;
+};
+
+struct PocketCircle {
+    float x, z;
+    float radius;
+};
+
+// 규칙 진행에 필요한 값들 (virtualLego.cpp의 전역 변수와 같은 의미)
+struct RuleState {
+    bool turn;          // true: player 1, false: player 2
+    bool group;         // true: solid, false: stripe
+    bool open;          // true: 그룹이 아직 배정되지 않음
+    bool break_shot;
+    bool free_shot;
+    int  solid_num, stripe_num;
+};
+
+struct TableState {
+    BallState balls[NUM_BALLS];
+    RuleState rules;
+};
+
+// 한 번의 step 동안 일어난 일
+struct StepEvents {
+    unsigned int pocketed;  // 들어간 공의 bit mask (1 << index)
+    int cushionHits;
+    int firstContact;       // 큐볼이 처음 맞힌 공, 없으면 -1
+    int contacts;           // 공끼리 닿은 쌍의 수
+    int solverIterations;   // 접촉 solver의 반복 횟수 (substep 합)
+    int substeps;           // 가장 잘게 나눈 island의 substep 수
+    int movingBalls;        // step이 끝난 뒤 아직 움직이는(회전 포함) 공의 수
+};
+
+// 샷 하나를 끝까지 시뮬레이션한 결과
+struct ShotOutcome {
+    unsigned int pocketed;
+    int  cushionHits;
+    int  firstContact;
+    bool scratch;           // 큐볼이 들어감 (white_in)
+    bool foul;
+    int  steps;
+    BallState finalBalls[NUM_BALLS];
+};
+
+// -----------------------------------------------------------------------------
+// 공 분류
+// -----------------------------------------------------------------------------
+
+inline bool isSolidBall(int index) { return 0 < index && index < EIGHT_BALL; }
+inline bool isStripeBall(int index) { return EIGHT_BALL < index && index < NUM_BALLS; }
+
+// -----------------------------------------------------------------------------
+// 물리 함수
+// -----------------------------------------------------------------------------
+
+struct FieldSample;
+class CContactSolver;
+
+void integrateBall(BallState& ball, float timeDiff);
+bool bounceOffCushion(const FieldSample& sample, BallState& ball);
+void pocketBall(BallState& ball);
+bool isBallMoving(const BallState& ball);
+
+// 현재 운동 단계와 그 단계가 끝날 때까지 남은 시간 (정지 상태는 0)
+BallPhase ballPhase(const BallState& ball);
+float phaseTime(const BallState& ball);
+
+// aim(라디안) 방향, power 속력으로 큐볼을 친다. tipSide(오른쪽 +)와 tipHeight(위쪽 +)는
+// 반지름에 대한 큐 팁 위치이며 MAX_TIP_OFFSET 안으로 줄인다. tipHeight = 0.4 이면 바로 구른다.
+void strikeCueBall(BallState& cue, float aim, float power, float tipSide, float tipHeight);
+
+// 감속 모델의 닫힌 해. speed로 출발한 공의 t 시간 뒤 속력/이동 거리,
+// 정지 시간/거리, distance만큼 굴러간 뒤의 속력, distance만큼 굴러간 뒤 arriveSpeed가
+// 남는 출발 속력
+float speedAfterTime(float speed, float t);
+float distanceAfterTime(float speed, float t);
+float stopTime(float speed);
+float stopDistance(float speed);
+float speedAfterDistance(float speed, float distance);
+float speedForDistance(float distance, float arriveSpeed);
+
+// 충돌 없이 t 시간 진행한 위치, 속도, 각속도. 미끄러짐이 끝나는 시점에서 구름의 해로
+// 이어 붙이므로 t의 크기와 관계없이 같은 결과가 된다. (공이 멈추면 속도는 정확히 0)
+void advanceBall(BallState& ball, float t);
+
+// 남은 충돌(공, 쿠션, 포켓)이 없으면 모든 공을 멈출 위치로 바로 옮기고 true
+// (미끄러지는 공은 경로가 곡선이므로 구름 단계가 될 때까지 기다린다)
+bool fastForwardToRest(BallState* balls, int count);
+
+// 모든 공을 timeDiff 만큼 진행한다. events는 NULL일 수 있다.
+// solver를 주면 공끼리의 접촉이 이전 step의 impulse에서 시작한다 (warm start).
+void stepTable(BallState* balls, int count, float timeDiff, StepEvents* events,
+    CContactSolver* solver = 0);
+
+// aim(라디안)과 power(흰 공 초기 속도), 큐 팁 위치로 샷을 친 뒤 모든 공이 멈출 때까지 진행
+ShotOutcome simulateShot(const TableState& start, float aim, float power,
+    float tipSide = 0.0f, float tipHeight = 0.0f, int maxSteps = 20000);
+
+// -----------------------------------------------------------------------------
+// 규칙
+// -----------------------------------------------------------------------------
+
+bool isFoul(bool breakShot, bool solidIn, bool stripeIn, bool whiteIn, int cushionCount);
+
+// 큐볼이 처음 맞힌 공(없으면 -1)이 rules에서 허용되는지 여부.
+// 그룹이 정해졌으면 자기 그룹의 공이어야 하고, 자기 그룹을 다 넣었을 때만 8번 공이 허용된다.
+bool isLegalFirstContact(const RuleState& rules, int firstContact);
+
+#endif // __billiardPhysicsH__
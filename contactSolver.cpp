@@ -0,0 +1,228 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: contactSolver.cpp
+//
+// Desc: 공끼리의 동시 접촉 impulse solver 구현.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "contactSolver.h"
+#include "threadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+CContactSolver::CContactSolver(void)
+    : m_pool(NULL), m_parallelMin(SOLVER_PARALLEL_MIN_CONTACTS)
+{
+    m_work.numContacts = 0;
+    m_work.numColors = 0;
+    reset();
+}
+
+void CContactSolver::reset(void)
+{
+    memset(m_lastImpulse, 0, sizeof(m_lastImpulse));
+}
+
+void CContactSolver::forgetSeparated(const int* islandOf)
+{
+    for (int a = 0; a < NUM_BALLS; a++) {
+        for (int b = a + 1; b < NUM_BALLS; b++) {
+            if (islandOf[a] != islandOf[b] || islandOf[a] < 0)
+                m_lastImpulse[a][b] = 0.0f;
+        }
+    }
+}
+
+void CContactSolver::findContacts(const BallState* balls, const int* members, int numMembers,
+    ContactWorkspace& work)
+{
+    const float diameter = (float)(M_RADIUS * 2);
+    const float restitution = activePhysics().ballRestitution;
+    work.numContacts = 0;
+
+    for (int m = 0; m < numMembers; m++) {
+        int i = members[m];
+        if (!balls[i].active) continue;
+        for (int n = m + 1; n < numMembers; n++) {
+            int j = members[n];
+            if (!balls[j].active) continue;
+
+            const float2 pi = ballPosition(balls[i]);
+            const float2 pj = ballPosition(balls[j]);
+            float distSq = lengthSq(pi - pj);
+            if (distSq > diameter * diameter || distSq <= 0.0f) continue;
+
+            float distance = sqrtf(distSq);
+            BallContact& c = work.contacts[work.numContacts++];
+            c.a = i < j ? i : j;
+            c.b = i < j ? j : i;
+            c.normal = (ballPosition(balls[c.a]) - ballPosition(balls[c.b])) / distance;
+
+            // 충돌 직전의 접근 속도로 목표 분리 속도를 정한다.
+            float vn = dot(ballVelocity(balls[c.a]) - ballVelocity(balls[c.b]), c.normal);
+            c.target = vn < -RESTITUTION_SLOP ? -restitution * vn : 0.0f;
+            c.impulse = m_lastImpulse[c.a][c.b] * SOLVER_WARM_START;
+            c.delta = 0.0f;
+            c.mid = (pi + pj) * 0.5f;
+        }
+    }
+
+    // 공 번호가 아니라 접촉 위치 순서로 정렬해 두면 공 번호를 바꾸어도 같은 순서로 풀린다.
+    std::sort(work.contacts, work.contacts + work.numContacts, [](const BallContact& l, const BallContact& r) {
+        return l.mid.x != r.mid.x ? l.mid.x < r.mid.x : l.mid.y < r.mid.y;
+    });
+}
+
+void CContactSolver::colorContacts(ContactWorkspace& work)
+{
+    // 공 하나에 닿은 접촉은 서로 다른 색이 되도록 가장 작은 빈 색을 고른다.
+    unsigned used[NUM_BALLS];
+    memset(used, 0, sizeof(used));
+    int color[MAX_CONTACTS];
+    int colorCount[MAX_CONTACTS + 1];
+    memset(colorCount, 0, sizeof(colorCount));
+
+    work.numColors = 0;
+    for (int k = 0; k < work.numContacts; k++) {
+        const BallContact& c = work.contacts[k];
+        unsigned taken = used[c.a] | used[c.b];
+        int col = 0;
+        while (taken & (1u << col)) col++;
+        used[c.a] |= 1u << col;
+        used[c.b] |= 1u << col;
+        color[k] = col;
+        colorCount[col]++;
+        if (col + 1 > work.numColors) work.numColors = col + 1;
+    }
+
+    work.colorStart[0] = 0;
+    for (int col = 0; col < work.numColors; col++)
+        work.colorStart[col + 1] = work.colorStart[col] + colorCount[col];
+
+    int fill[MAX_CONTACTS];
+    memcpy(fill, work.colorStart, sizeof(int) * work.numColors);
+    for (int k = 0; k < work.numContacts; k++)
+        work.order[fill[color[k]]++] = k;
+}
+
+void CContactSolver::solveRange(BallState* balls, ContactWorkspace& work, int begin, int end)
+{
+    for (int i = begin; i < end; i++) {
+        BallContact& c = work.contacts[work.order[i]];
+        BallState& a = balls[c.a];
+        BallState& b = balls[c.b];
+
+        // 질량이 같으므로 유효 질량은 1/2
+        const float2 va = ballVelocity(a);
+        const float2 vb = ballVelocity(b);
+        float vn = dot(va - vb, c.normal);
+        float next = c.impulse + (c.target - vn) * 0.5f;
+        if (next < 0.0f) next = 0.0f;   // 접촉은 밀기만 한다
+        float delta = next - c.impulse;
+        c.impulse = next;
+        c.delta = fabsf(delta);
+
+        setBallVelocity(a, va + c.normal * delta);
+        setBallVelocity(b, vb - c.normal * delta);
+    }
+}
+
+void CContactSolver::projectPositions(BallState* balls, const ContactWorkspace& work)
+{
+    const float diameter = (float)(M_RADIUS * 2);
+    for (int pass = 0; pass < SOLVER_POSITION_PASSES; pass++) {
+        bool moved = false;
+        for (int i = 0; i < work.numContacts; i++) {
+            const BallContact& c = work.contacts[work.order[i]];
+            BallState& a = balls[c.a];
+            BallState& b = balls[c.b];
+
+            const float2 d = ballPosition(a) - ballPosition(b);
+            float distance = length(d);
+            if (distance >= diameter || distance <= 0.0f) continue;
+
+            // 겹친 만큼 두 공을 반씩 밀어낸다.
+            const float2 push = d * ((diameter - distance) * 0.5f / distance);
+            setBallPosition(a, ballPosition(a) + push);
+            setBallPosition(b, ballPosition(b) - push);
+            moved = true;
+        }
+        if (!moved) break;
+    }
+}
+
+SolverStats CContactSolver::solve(BallState* balls, int count)
+{
+    int members[NUM_BALLS];
+    for (int i = 0; i < count; i++)
+        members[i] = i;
+    return solve(balls, members, count, m_work, m_pool);
+}
+
+SolverStats CContactSolver::solve(BallState* balls, const int* members, int numMembers,
+    ContactWorkspace& work, CThreadPool* pool)
+{
+    SolverStats stats;
+    stats.contacts = 0;
+    stats.colors = 0;
+    stats.iterations = 0;
+    stats.cueContact = -1;
+
+    findContacts(balls, members, numMembers, work);
+
+    // 이 공들 사이의 warm start만 지운다. 다른 island의 값은 그쪽 thread가 쓴다.
+    for (int m = 0; m < numMembers; m++) {
+        for (int n = 0; n < numMembers; n++)
+            m_lastImpulse[members[m]][members[n]] = 0.0f;
+    }
+    if (work.numContacts == 0)
+        return stats;
+
+    colorContacts(work);
+
+    // warm start: 이전 step의 impulse를 먼저 적용한다.
+    for (int k = 0; k < work.numContacts; k++) {
+        const BallContact& c = work.contacts[k];
+        if (c.impulse == 0.0f) continue;
+        setBallVelocity(balls[c.a], ballVelocity(balls[c.a]) + c.normal * c.impulse);
+        setBallVelocity(balls[c.b], ballVelocity(balls[c.b]) - c.normal * c.impulse);
+    }
+
+    for (int iteration = 0; iteration < SOLVER_MAX_ITERATIONS; iteration++) {
+        for (int col = 0; col < work.numColors; col++) {
+            int begin = work.colorStart[col];
+            int size = work.colorStart[col + 1] - begin;
+            if (pool != NULL && size >= m_parallelMin) {
+                int grain = size / pool->size() + 1;
+                pool->parallelFor(size, grain, [this, balls, &work, begin](int from, int to) {
+                    solveRange(balls, work, begin + from, begin + to);
+                });
+            }
+            else {
+                solveRange(balls, work, begin, begin + size);
+            }
+        }
+        stats.iterations++;
+
+        float largest = 0.0f;
+        for (int k = 0; k < work.numContacts; k++) {
+            if (work.contacts[k].delta > largest) largest = work.contacts[k].delta;
+        }
+        if (largest < SOLVER_TOLERANCE)
+            break;
+    }
+
+    projectPositions(balls, work);
+
+    for (int k = 0; k < work.numContacts; k++) {
+        const BallContact& c = work.contacts[k];
+        m_lastImpulse[c.a][c.b] = c.impulse;
+        if (c.a == CUE_BALL && (stats.cueContact < 0 || c.b < stats.cueContact))
+            stats.cueContact = c.b;
+    }
+    stats.contacts = work.numContacts;
+    stats.colors = work.numColors;
+    return stats;
+}
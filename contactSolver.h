@@ -0,0 +1,104 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: contactSolver.h
+//
+// Desc: 공끼리 동시에 닿은 접촉들을 한꺼번에 푸는 반복 impulse solver.
+//       접촉마다 누적 impulse(>= 0)를 두고, 목표 분리 속도(-반발 계수 * 접근 속도)를
+//       만족할 때까지 모든 접촉을 번갈아 고친다. 한 번의 반복에서 impulse 변화가
+//       SOLVER_TOLERANCE 아래로 내려가면 멈춘다.
+//
+//       접촉은 위치 순서로 정렬한 뒤 공을 공유하지 않도록 색을 나눈다(graph coloring).
+//       같은 색 안의 접촉은 서로 독립이므로 큰 색은 여러 thread에서 나누어 풀 수 있고,
+//       결과는 공 번호나 thread 수와 관계없이 같다. 이전 step에서 계속 닿아 있는 쌍은
+//       그때의 impulse에서 시작한다.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __contactSolverH__
+#define __contactSolverH__
+
+#include "billiardPhysics.h"
+
+class CThreadPool;
+
+// 반발 계수는 activePhysics().ballRestitution
+// 이보다 느리게 다가오는 접촉은 튕기지 않고 겹치지 않게만 한다.
+const float RESTITUTION_SLOP = 0.01f;
+const int   SOLVER_MAX_ITERATIONS = 16;
+const float SOLVER_TOLERANCE = 1e-4f;
+const int   SOLVER_POSITION_PASSES = 4;
+// 이전 step의 impulse 중 다시 쓰는 비율
+const float SOLVER_WARM_START = 0.8f;
+// 한 색의 접촉이 이보다 많을 때만 thread pool로 나눈다.
+const int   SOLVER_PARALLEL_MIN_CONTACTS = 64;
+
+const int MAX_CONTACTS = NUM_BALLS * (NUM_BALLS - 1) / 2;
+
+struct SolverStats {
+    int contacts;
+    int colors;
+    int iterations;     // 속도 반복 횟수 (접촉이 없으면 0)
+    int cueContact;     // 큐볼과 닿은 공 중 가장 번호가 작은 공, 없으면 -1
+};
+
+struct BallContact {
+    int   a, b;         // a < b
+    float2 normal;      // b에서 a를 향하는 단위 법선
+    float target;       // 목표 상대 법선 속도
+    float impulse;      // 누적 impulse
+    float delta;        // 이번 반복의 impulse 변화
+    float2 mid;         // 접촉점 (푸는 순서를 정하는 데 쓴다)
+};
+
+// 한 번의 solve에 쓰는 작업 공간. 서로 다른 island를 동시에 풀 때는 각자 하나씩 쓴다.
+struct ContactWorkspace {
+    BallContact contacts[MAX_CONTACTS];
+    int numContacts;
+    int order[MAX_CONTACTS];            // 색 순서로 정렬된 접촉 번호
+    int colorStart[MAX_CONTACTS + 1];   // 색 c의 접촉은 order[colorStart[c] .. colorStart[c + 1])
+    int numColors;
+};
+
+class CContactSolver {
+public:
+    CContactSolver(void);
+
+    // pool이 있으면 큰 색은 pool에서 나누어 푼다. NULL이면 한 thread로 푼다.
+    void setParallel(CThreadPool* pool, int minContacts = SOLVER_PARALLEL_MIN_CONTACTS)
+    {
+        m_pool = pool;
+        m_parallelMin = minContacts;
+    }
+
+    // 이전 step의 impulse를 버린다 (새 샷, 배치 변경).
+    void reset(void);
+
+    // 서로 다른 island(islandOf 값이 다름)에 속한 쌍의 impulse를 버린다.
+    // 이번 step에 닿지 않을 쌍이 다음에 닿을 때 오래된 값으로 시작하지 않게 한다.
+    void forgetSeparated(const int* islandOf);
+
+    // 모든 공의 접촉을 푼다.
+    SolverStats solve(BallState* balls, int count);
+
+    // members에 속한 공끼리의 접촉만 푼다. members가 서로 겹치지 않으면 workspace를
+    // 따로 주어 여러 thread에서 동시에 불러도 된다 (그때 pool은 NULL로 준다).
+    SolverStats solve(BallState* balls, const int* members, int numMembers,
+        ContactWorkspace& work, CThreadPool* pool);
+
+    ContactWorkspace& workspace(void) { return m_work; }
+    CThreadPool* pool(void) const { return m_pool; }
+
+private:
+    void findContacts(const BallState* balls, const int* members, int numMembers, ContactWorkspace& work);
+    void colorContacts(ContactWorkspace& work);
+    void solveRange(BallState* balls, ContactWorkspace& work, int begin, int end);
+    void projectPositions(BallState* balls, const ContactWorkspace& work);
+
+    ContactWorkspace m_work;
+    float   m_lastImpulse[NUM_BALLS][NUM_BALLS]; // warm start, [a][b] (a < b)
+
+    CThreadPool* m_pool;
+    int          m_parallelMin;
+};
+
+#endif // __contactSolverH__
@@ -11,6 +11,7 @@
 //////////////////////////////////////////////////////////////////////////////////////////////////
 
 #include "d3dUtility.h"
+#include "simClock.h"
 
 bool d3d::InitD3D(
 	HINSTANCE hInstance,
@@ -144,12 +145,14 @@ bool d3d::InitD3D(
 	return true;
 }
 
-int d3d::EnterMsgLoop( bool (*ptr_display)(float timeDelta) )
+int d3d::EnterMsgLoop( bool (*ptr_display)(float timeDelta), double clockRate )
 {
 	MSG msg;
 	::ZeroMemory(&msg, sizeof(MSG));
 
-	static double lastTime = (double)timeGetTime(); 
+	// timeGetTime은 1ms 단위이고 15.6ms씩 뛰므로 고해상도 단조 시계로 잰다.
+	CMonotonicClock clock;
+	double lastTime = clock.seconds();
 
 	while(msg.message != WM_QUIT)
 	{
@@ -160,8 +163,8 @@ int d3d::EnterMsgLoop( bool (*ptr_display)(float timeDelta) )
 		}
 		else
         {	
-			double currTime  = (double)timeGetTime();
-			double timeDelta = (currTime - lastTime)*0.0007;
+			double currTime  = clock.seconds();
+			double timeDelta = (currTime - lastTime)*clockRate;
 			ptr_display((float)timeDelta); // 이 부분에서 지속적으로 반복하여 Display 함수를 실행
 
 			lastTime = currTime;
@@ -36,7 +36,8 @@ namespace d3d
 		IDirect3DDevice9** device);// [out]The created device.
 
 	int EnterMsgLoop( 
-		bool (*ptr_display)(float timeDelta));
+		bool (*ptr_display)(float timeDelta),
+		double clockRate = 0.7);  // 실제 1초에 넘길 timeDelta 합
 
 	LRESULT CALLBACK WndProc(
 		HWND hwnd,
@@ -0,0 +1,154 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: detMath.cpp
+//
+// Desc: bit 재현 가능한 초월 함수 구현.
+//       범위를 줄인 뒤 Taylor 급수를 고정된 항 수만큼 Horner 꼴로 더한다.
+//       오차는 double 기준 몇 ulp이며 물리 코어에서 쓰는 범위에서는 CRT와
+//       1e-15 정도 차이가 난다.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "detMath.h"
+
+#ifdef _MSC_VER
+#pragma fp_contract(off)
+#endif
+
+namespace
+{
+    // ln 2와 pi / 2를 상위(곱해도 오차 없는 자릿수)와 하위로 나눈 값 (Cody-Waite)
+    const double LN2_HI = 6.93147180369123816490e-01;
+    const double LN2_LO = 1.90821492927058770002e-10;
+    const double INV_LN2 = 1.44269504088896338700e+00;
+    const double PIO2_HI = 1.57079632673412561417e+00;
+    const double PIO2_LO = 6.07710050650619224932e-11;
+    const double TWO_OVER_PI = 6.36619772367581382433e-01;
+
+    double roundHalfUp(double x)
+    {
+        return floor(x + 0.5);
+    }
+
+    // |r| <= ln2 / 2 에서 exp(r) - 1
+    double expm1Reduced(double r)
+    {
+        // r + r^2/2! + ... + r^14/14!
+        double p = 1.0 / 87178291200.0;
+        p = p * r + 1.0 / 6227020800.0;
+        p = p * r + 1.0 / 479001600.0;
+        p = p * r + 1.0 / 39916800.0;
+        p = p * r + 1.0 / 3628800.0;
+        p = p * r + 1.0 / 362880.0;
+        p = p * r + 1.0 / 40320.0;
+        p = p * r + 1.0 / 5040.0;
+        p = p * r + 1.0 / 720.0;
+        p = p * r + 1.0 / 120.0;
+        p = p * r + 1.0 / 24.0;
+        p = p * r + 1.0 / 6.0;
+        p = p * r + 0.5;
+        return r + r * r * p;
+    }
+
+    // |x| <= pi / 4 에서 sin, cos
+    double sinReduced(double x)
+    {
+        double x2 = x * x;
+        double p = -1.0 / 1307674368000.0;
+        p = p * x2 + 1.0 / 6227020800.0;
+        p = p * x2 - 1.0 / 39916800.0;
+        p = p * x2 + 1.0 / 362880.0;
+        p = p * x2 - 1.0 / 5040.0;
+        p = p * x2 + 1.0 / 120.0;
+        p = p * x2 - 1.0 / 6.0;
+        return x + x * x2 * p;
+    }
+
+    double cosReduced(double x)
+    {
+        double x2 = x * x;
+        double p = 1.0 / 20922789888000.0;
+        p = p * x2 - 1.0 / 87178291200.0;
+        p = p * x2 + 1.0 / 479001600.0;
+        p = p * x2 - 1.0 / 3628800.0;
+        p = p * x2 + 1.0 / 40320.0;
+        p = p * x2 - 1.0 / 720.0;
+        p = p * x2 + 1.0 / 24.0;
+        return 1.0 - 0.5 * x2 + x2 * x2 * p;
+    }
+}
+
+double detExp(double x)
+{
+    if (x > 709.0) return HUGE_VAL;
+    if (x < -745.0) return 0.0;
+
+    // x = k ln2 + r
+    double k = roundHalfUp(x * INV_LN2);
+    double r = (x - k * LN2_HI) - k * LN2_LO;
+    return ldexp(1.0 + expm1Reduced(r), (int)k);
+}
+
+double detExpm1(double x)
+{
+    // 0 근처에서는 1을 빼며 생기는 자릿수 손실을 피한다.
+    if (x > -0.34 && x < 0.34)
+        return expm1Reduced(x);
+    return detExp(x) - 1.0;
+}
+
+double detLog(double x)
+{
+    if (x <= 0.0) return x == 0.0 ? -HUGE_VAL : (x - x) / 0.0;
+
+    // x = m 2^e,  sqrt(1/2) <= m < sqrt(2)
+    int e;
+    double m = frexp(x, &e);
+    if (m < 0.70710678118654752440) {
+        m *= 2.0;
+        e--;
+    }
+
+    // log m = 2 atanh(s),  s = (m - 1) / (m + 1),  |s| <= 0.172
+    double s = (m - 1.0) / (m + 1.0);
+    double s2 = s * s;
+    double p = 1.0 / 23.0;
+    p = p * s2 + 1.0 / 21.0;
+    p = p * s2 + 1.0 / 19.0;
+    p = p * s2 + 1.0 / 17.0;
+    p = p * s2 + 1.0 / 15.0;
+    p = p * s2 + 1.0 / 13.0;
+    p = p * s2 + 1.0 / 11.0;
+    p = p * s2 + 1.0 / 9.0;
+    p = p * s2 + 1.0 / 7.0;
+    p = p * s2 + 1.0 / 5.0;
+    p = p * s2 + 1.0 / 3.0;
+    double logM = 2.0 * s + 2.0 * s * s2 * p;
+    return (e * LN2_HI + logM) + e * LN2_LO;
+}
+
+double detLog1p(double x)
+{
+    // u = 1 + x 에서 잃은 자릿수를 x / (u - 1)로 되돌린다 (Kahan).
+    double u = 1.0 + x;
+    if (u == 1.0)
+        return x;
+    return detLog(u) * (x / (u - 1.0));
+}
+
+void detSinCos(double angle, double* s, double* c)
+{
+    // angle = k pi/2 + r,  |r| <= pi / 4
+    double k = roundHalfUp(angle * TWO_OVER_PI);
+    double r = (angle - k * PIO2_HI) - k * PIO2_LO;
+    double sr = sinReduced(r);
+    double cr = cosReduced(r);
+
+    int quadrant = (int)(k - 4.0 * floor(k * 0.25));
+    switch (quadrant) {
+    case 0: *s = sr;  *c = cr;  break;
+    case 1: *s = cr;  *c = -sr; break;
+    case 2: *s = -sr; *c = -cr; break;
+    default: *s = -cr; *c = sr; break;
+    }
+}
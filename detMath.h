@@ -0,0 +1,60 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: detMath.h
+//
+// Desc: 어느 compiler, CRT에서나 같은 bit를 내는 초월 함수.
+//       exp, log, sin, cos를 +, -, *, /, floor, frexp, ldexp만으로 계산한다.
+//       이 연산들은 IEEE 754에서 결과가 정해져 있으므로, FMA 합치기 없이 SSE2로
+//       빌드한 x86-64(또는 x86 /arch:SSE2) 프로그램끼리는 결과가 같다.
+//
+//       DETERMINISTIC_PHYSICS를 정의하고 빌드하면 물리 코어는 phys*() 함수를 통해
+//       이 구현을 쓰고, 정의하지 않으면 CRT 함수를 그대로 쓴다.
+//       GCC/Clang에서는 -ffp-contract=off를 함께 주어야 한다 (MSVC는 아래 pragma).
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __detMathH__
+#define __detMathH__
+
+#include <math.h>
+
+double detExp(double x);
+double detExpm1(double x);
+double detLog(double x);
+double detLog1p(double x);
+// 라디안 각의 sin, cos을 한 번에 구한다.
+void   detSinCos(double angle, double* s, double* c);
+
+#ifdef DETERMINISTIC_PHYSICS
+
+#ifdef _MSC_VER
+#pragma fp_contract(off)
+#endif
+
+inline double physExp(double x) { return detExp(x); }
+inline double physExpm1(double x) { return detExpm1(x); }
+inline double physLog(double x) { return detLog(x); }
+inline double physLog1p(double x) { return detLog1p(x); }
+inline void physSinCos(float angle, float* s, float* c)
+{
+    double sd, cd;
+    detSinCos(angle, &sd, &cd);
+    *s = (float)sd;
+    *c = (float)cd;
+}
+
+#else
+
+inline double physExp(double x) { return exp(x); }
+inline double physExpm1(double x) { return expm1(x); }
+inline double physLog(double x) { return log(x); }
+inline double physLog1p(double x) { return log1p(x); }
+inline void physSinCos(float angle, float* s, float* c)
+{
+    *s = sinf(angle);
+    *c = cosf(angle);
+}
+
+#endif // DETERMINISTIC_PHYSICS
+
+#endif // __detMathH__
@@ -0,0 +1,113 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: eventBus.cpp
+//
+// Desc: 물리 사건 event bus 구현 (bounded MPMC ring buffer).
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "eventBus.h"
+#include <cstddef>
+
+CEventBus::CEventBus(void)
+    : m_enqueuePos(0), m_dequeuePos(0), m_dropped(0), m_numListeners(0)
+{
+    for (int i = 0; i < EVENT_BUS_CAPACITY; i++)
+        m_cells[i].sequence.store((unsigned)i, std::memory_order_relaxed);
+    for (int i = 0; i < MAX_EVENT_LISTENERS; i++)
+        m_listeners[i] = NULL;
+}
+
+bool CEventBus::subscribe(CEventListener* listener)
+{
+    if (listener == NULL || m_numListeners >= MAX_EVENT_LISTENERS)
+        return false;
+    m_listeners[m_numListeners++] = listener;
+    return true;
+}
+
+void CEventBus::unsubscribe(CEventListener* listener)
+{
+    for (int i = 0; i < m_numListeners; i++) {
+        if (m_listeners[i] != listener) continue;
+        for (int j = i + 1; j < m_numListeners; j++)
+            m_listeners[j - 1] = m_listeners[j];
+        m_listeners[--m_numListeners] = NULL;
+        return;
+    }
+}
+
+bool CEventBus::publish(PhysicsEventType type, int a, int b, float speed)
+{
+    const unsigned mask = EVENT_BUS_CAPACITY - 1;
+    unsigned pos = m_enqueuePos.load(std::memory_order_relaxed);
+    Cell* cell;
+    for (;;) {
+        cell = &m_cells[pos & mask];
+        unsigned sequence = cell->sequence.load(std::memory_order_acquire);
+        int diff = (int)(sequence - pos);
+        if (diff == 0) {
+            if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                break;
+        }
+        else if (diff < 0) {
+            // 한 바퀴 전의 사건을 아직 읽지 않았다.
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        else {
+            pos = m_enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    cell->event.type = type;
+    cell->event.a = a;
+    cell->event.b = b;
+    cell->event.speed = speed;
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+bool CEventBus::pop(PhysicsEvent& event)
+{
+    const unsigned mask = EVENT_BUS_CAPACITY - 1;
+    unsigned pos = m_dequeuePos.load(std::memory_order_relaxed);
+    Cell* cell;
+    for (;;) {
+        cell = &m_cells[pos & mask];
+        unsigned sequence = cell->sequence.load(std::memory_order_acquire);
+        int diff = (int)(sequence - (pos + 1));
+        if (diff == 0) {
+            if (m_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                break;
+        }
+        else if (diff < 0) {
+            return false;   // 비었음
+        }
+        else {
+            pos = m_dequeuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    event = cell->event;
+    cell->sequence.store(pos + mask + 1, std::memory_order_release);
+    return true;
+}
+
+int CEventBus::dispatch(void)
+{
+    int count = 0;
+    PhysicsEvent event;
+    while (pop(event)) {
+        for (int i = 0; i < m_numListeners; i++)
+            m_listeners[i]->onEvent(event);
+        count++;
+    }
+    return count;
+}
+
+void CEventBus::clear(void)
+{
+    PhysicsEvent event;
+    while (pop(event)) {}
+}
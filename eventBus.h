@@ -0,0 +1,82 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: eventBus.h
+//
+// Desc: 물리 코어가 내는 사건(공끼리 충돌, 쿠션, 포켓, 첫 접촉, 샷 시작/정지)을
+//       규칙, telemetry, 소리 쪽으로 전달하는 event bus.
+//       publish는 lock을 쓰지 않는 고정 크기 ring buffer에 넣으므로 island를 진행하는
+//       여러 thread에서 동시에 불러도 되고, dispatch는 게임 thread에서 쌓인 사건을
+//       들어온 순서대로 등록된 listener들에게 넘긴다.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __eventBusH__
+#define __eventBusH__
+
+#include <atomic>
+
+enum PhysicsEventType {
+    EVENT_SHOT_STARTED,     // 멈춰 있던 공이 움직이기 시작함
+    EVENT_BALL_CONTACT,     // a, b가 speed로 부딪힘
+    EVENT_CUSHION_HIT,      // a가 speed로 쿠션에 맞음
+    EVENT_POCKETED,         // a가 포켓에 들어감
+    EVENT_FIRST_CONTACT,    // 이번 샷에서 큐볼(a)이 처음 맞힌 공 b
+    EVENT_ALL_STOPPED       // 모든 공이 멈춤
+};
+
+struct PhysicsEvent {
+    PhysicsEventType type;
+    int   a, b;             // 공 번호, 없으면 -1
+    float speed;            // 충돌 순간의 법선 방향 속력
+};
+
+class CEventListener {
+public:
+    virtual ~CEventListener(void) {}
+    virtual void onEvent(const PhysicsEvent& event) = 0;
+};
+
+// 2의 거듭제곱이어야 한다.
+const int EVENT_BUS_CAPACITY = 1024;
+const int MAX_EVENT_LISTENERS = 8;
+
+class CEventBus {
+public:
+    CEventBus(void);
+
+    // 게임 thread에서만 부른다. 등록 순서대로 사건을 받는다.
+    bool subscribe(CEventListener* listener);
+    void unsubscribe(CEventListener* listener);
+
+    // 어느 thread에서나 부를 수 있다. buffer가 가득 차면 버리고 false.
+    bool publish(PhysicsEventType type, int a = -1, int b = -1, float speed = 0.0f);
+
+    // 쌓인 사건을 모두 listener들에게 넘기고 넘긴 수를 돌려준다.
+    int dispatch(void);
+
+    // 아직 넘기지 않은 사건을 버린다.
+    void clear(void);
+
+    // buffer가 가득 차 버린 사건 수
+    unsigned dropped(void) const { return m_dropped.load(); }
+
+private:
+    bool pop(PhysicsEvent& event);
+
+    // 칸마다 sequence를 두어 쓰는 쪽과 읽는 쪽이 CAS 한 번으로 칸을 차지한다.
+    struct Cell {
+        std::atomic<unsigned> sequence;
+        PhysicsEvent event;
+    };
+
+    Cell m_cells[EVENT_BUS_CAPACITY];
+    std::atomic<unsigned> m_enqueuePos;
+    char m_pad[64];                     // 쓰는 쪽과 읽는 쪽이 cache line을 나누지 않게
+    std::atomic<unsigned> m_dequeuePos;
+    std::atomic<unsigned> m_dropped;
+
+    CEventListener* m_listeners[MAX_EVENT_LISTENERS];
+    int m_numListeners;
+};
+
+#endif // __eventBusH__
@@ -0,0 +1,374 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: islandStepper.cpp
+//
+// Desc: 접촉 island 분할과 island 단위 진행 구현.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "islandStepper.h"
+#include "tableField.h"
+#include "tableLayout.h"
+#include "tableConfig.h"
+#include "threadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+    int findRoot(int* parent, int i)
+    {
+        while (parent[i] != i) {
+            parent[i] = parent[parent[i]];
+            i = parent[i];
+        }
+        return i;
+    }
+
+    // 공이 움직일 수 있는 속력의 상한 (위치 단위/시간).
+    // 미끄러지는 동안 속도는 지금 속도와 회전이 만드는 속도 사이에 있으므로 둘의 합으로 잡는다.
+    float reachSpeed(const BallState& ball)
+    {
+        float spin = length(make_float2(ball.wx, ball.wz));
+        return (length(ballVelocity(ball)) + spin) * activePhysics().timeScale;
+    }
+
+    // timeDiff 동안 공이 움직일 수 있는 거리의 상한
+    float sweptDistance(const BallState& ball, float timeDiff)
+    {
+        return reachSpeed(ball) * timeDiff + ISLAND_MARGIN;
+    }
+
+    // t 만큼 진행한 뒤 쿠션과 포켓을 table field 조회 한 번으로 판정한다.
+    // 경계에서 충분히 떨어진 공은 field를 읽지 않는다.
+    void moveBall(const RuntimeTable& table, BallState* balls, int i, float t, const CTableField& field,
+        StepEvents& events, CEventBus* bus)
+    {
+        BallState& ball = balls[i];
+        integrateBall(ball, t);
+        if (isClearOfBoundary(table, ball.x, ball.z, 0.0f))
+            return;
+
+        FieldSample sample = field.sample(ball.x, ball.z);
+        if (sample.pocket <= 0.0f) {
+            pocketBall(ball);
+            events.pocketed |= 1u << i;
+            if (bus != NULL) bus->publish(EVENT_POCKETED, i);
+            return;
+        }
+
+        float approach = -dot(ballVelocity(ball), make_float2(sample.nx, sample.nz));
+        if (bounceOffCushion(sample, ball)) {
+            events.cushionHits++;
+            if (bus != NULL) bus->publish(EVENT_CUSHION_HIT, i, -1, approach);
+        }
+    }
+
+    // 가장 가까운 장애물(쿠션, 포켓, 같은 island의 공)까지 남은 거리.
+    // substepCount는 SUBSTEP_TRAVEL보다 먼 거리를 구분하지 않으므로 경계가 그보다 멀면 field를 읽지 않는다.
+    float clearance(const RuntimeTable& table, const BallState* balls, const int* members, int numMembers, int m,
+        const CTableField& field)
+    {
+        const float radius = table.radius;
+        const BallState& ball = balls[members[m]];
+        float gap = SUBSTEP_TRAVEL;
+        if (!isClearOfBoundary(table, ball.x, ball.z, SUBSTEP_TRAVEL)) {
+            FieldSample sample = field.sample(ball.x, ball.z);
+            gap = sample.distance - radius;
+            if (sample.pocket < gap) gap = sample.pocket;
+        }
+
+        for (int n = 0; n < numMembers; n++) {
+            const BallState& other = balls[members[n]];
+            if (n == m || !other.active) continue;
+            float between = length(ballPosition(ball) - ballPosition(other)) - 2 * radius;
+            if (between < gap) gap = between;
+        }
+        return gap;
+    }
+
+    // 한 substep에 SUBSTEP_TRAVEL과 장애물까지 거리 중 작은 쪽보다 멀리 가지 않도록
+    // timeDiff를 나눌 횟수. 2의 거듭제곱으로 올려 느린 공의 경계가 빠른 공의 경계와 겹치게 한다.
+    int substepCount(float travel, float gap)
+    {
+        float allowed = gap < SUBSTEP_TRAVEL ? gap : SUBSTEP_TRAVEL;
+        if (allowed < SUBSTEP_MIN_TRAVEL) allowed = SUBSTEP_MIN_TRAVEL;
+
+        int count = 1;
+        while (count < MAX_SUBSTEPS && travel > allowed * count)
+            count *= 2;
+        return count;
+    }
+
+    void buildIslandsOn(const RuntimeTable& table, const BallState* balls, float timeDiff, BallIslands& islands)
+    {
+        const int count = table.balls;
+        const float diameter = table.radius * 2;
+        int parent[NUM_BALLS];
+        float reach[NUM_BALLS];
+
+        for (int i = 0; i < count; i++) {
+            parent[i] = i;
+            reach[i] = balls[i].active ? sweptDistance(balls[i], timeDiff) : 0.0f;
+        }
+
+        for (int i = 0; i < count; i++) {
+            if (!balls[i].active) continue;
+            for (int j = i + 1; j < count; j++) {
+                if (!balls[j].active) continue;
+
+                float limit = diameter + reach[i] + reach[j];
+                if (lengthSq(ballPosition(balls[i]) - ballPosition(balls[j])) > limit * limit) continue;
+
+                int ri = findRoot(parent, i);
+                int rj = findRoot(parent, j);
+                if (ri != rj)
+                    parent[ri > rj ? ri : rj] = ri < rj ? ri : rj;
+            }
+        }
+
+        // 뿌리가 가장 작은 번호이므로 번호 순서로 훑으면 island도 그 순서로 생긴다.
+        int rootIsland[NUM_BALLS];
+        int size[NUM_BALLS];
+        islands.numIslands = 0;
+        islands.numMoving = 0;
+        for (int i = 0; i < count; i++) {
+            islands.islandOf[i] = -1;
+            if (!balls[i].active) continue;
+            if (ballPhase(balls[i]) != PHASE_STOPPED)
+                islands.numMoving++;
+            int root = findRoot(parent, i);
+            if (root == i) {
+                rootIsland[i] = islands.numIslands;
+                size[islands.numIslands++] = 0;
+            }
+            islands.islandOf[i] = rootIsland[root];
+            size[rootIsland[root]]++;
+        }
+
+        islands.start[0] = 0;
+        for (int k = 0; k < islands.numIslands; k++)
+            islands.start[k + 1] = islands.start[k] + size[k];
+
+        int fill[NUM_BALLS];
+        memcpy(fill, islands.start, sizeof(int) * islands.numIslands);
+        for (int i = 0; i < count; i++) {
+            if (islands.islandOf[i] >= 0)
+                islands.members[fill[islands.islandOf[i]]++] = i;
+        }
+    }
+
+    void stepIslandOn(const RuntimeTable& table, BallState* balls, const int* members, int numMembers, float timeDiff,
+        StepEvents& events, CContactSolver& solver, ContactWorkspace& work, CThreadPool* pool,
+        CEventBus* bus)
+    {
+        memset(&events, 0, sizeof(events));
+        events.firstContact = -1;
+        events.substeps = 1;
+
+        const CTableField& field = activeTableField();
+
+        // 혼자 있는 정지한 공은 포켓 위에 놓였는지만 본다 (free shot 배치).
+        if (numMembers == 1 && ballPhase(balls[members[0]]) == PHASE_STOPPED) {
+            moveBall(table, balls, members[0], 0.0f, field, events, bus);
+            return;
+        }
+
+        // 공마다 필요한 substep 수. 가장 잦은 공의 간격을 한 tick으로 두고 진행한다.
+        int rate[NUM_BALLS];
+        float speed[NUM_BALLS];
+        float localTime[NUM_BALLS];     // 공마다 이미 진행한 시간
+        int ticks = 1;
+        for (int m = 0; m < numMembers; m++) {
+            speed[m] = reachSpeed(balls[members[m]]);
+            localTime[m] = 0.0f;
+            rate[m] = speed[m] > 0.0f
+                ? substepCount(speed[m] * timeDiff, clearance(table, balls, members, numMembers, m, field))
+                : 1;
+            if (rate[m] > ticks) ticks = rate[m];
+        }
+        events.substeps = ticks;
+
+        const float tick = timeDiff / ticks;
+        int synced[NUM_BALLS];
+        bool isSynced[NUM_BALLS];
+
+        for (int k = 1; k <= ticks; k++) {
+            const float now = k == ticks ? timeDiff : tick * k;
+            int numSynced = 0;
+
+            // 이번 tick이 자기 substep 경계인 공을 진행한다.
+            for (int m = 0; m < numMembers; m++) {
+                isSynced[m] = false;
+                if (!balls[members[m]].active) continue;
+                if (k % (ticks / rate[m]) != 0) continue;
+
+                moveBall(table, balls, members[m], now - localTime[m], field, events, bus);
+                localTime[m] = now;
+                isSynced[m] = true;
+                if (balls[members[m]].active)
+                    synced[numSynced++] = members[m];
+            }
+            if (numMembers == 1)
+                continue;
+
+            // 진행한 공과 닿을 수 있는 느린 공은 지금 시각까지 당겨 와 함께 푼다.
+            // 충돌로 속도가 바뀌므로 남은 step은 가장 잦은 간격으로 진행한다.
+            const int numMoved = numSynced;
+            for (int m = 0; m < numMembers; m++) {
+                const BallState& slow = balls[members[m]];
+                if (isSynced[m] || !slow.active) continue;
+
+                float slowReach = speed[m] * (now - localTime[m]);
+                bool near = false;
+                for (int s = 0; s < numMoved && !near; s++) {
+                    const BallState& fast = balls[synced[s]];
+                    float dx = slow.x - fast.x;
+                    float dz = slow.z - fast.z;
+                    float limit = table.radius * 2 + slowReach + reachSpeed(fast) * tick + ISLAND_MARGIN;
+                    near = dx * dx + dz * dz <= limit * limit;
+                }
+                if (!near) continue;
+
+                moveBall(table, balls, members[m], now - localTime[m], field, events, bus);
+                localTime[m] = now;
+                rate[m] = ticks;
+                speed[m] = reachSpeed(balls[members[m]]);
+                if (balls[members[m]].active)
+                    synced[numSynced++] = members[m];
+            }
+            if (numSynced < 2)
+                continue;
+
+            // 번호 순서로 두어야 solver의 a < b 약속이 지켜진다.
+            std::sort(synced, synced + numSynced);
+            SolverStats stats = solver.solve(balls, synced, numSynced, work, pool);
+            if (events.firstContact < 0)
+                events.firstContact = stats.cueContact;
+            if (stats.contacts > events.contacts)
+                events.contacts = stats.contacts;
+            events.solverIterations += stats.iterations;
+
+            // 다가오던 쌍만 충돌로 알린다 (맞닿아 있기만 한 쌍은 제외).
+            for (int c = 0; c < work.numContacts && bus != NULL; c++) {
+                const BallContact& contact = work.contacts[c];
+                if (contact.target > 0.0f)
+                    bus->publish(EVENT_BALL_CONTACT, contact.a, contact.b, contact.target / activePhysics().ballRestitution);
+            }
+
+            // 충돌한 공은 새 속도로 남은 tick을 진행해야 한다.
+            for (int s = 0; s < numSynced && stats.contacts > 0; s++) {
+                for (int m = 0; m < numMembers; m++) {
+                    if (members[m] != synced[s]) continue;
+                    rate[m] = ticks;
+                    speed[m] = reachSpeed(balls[members[m]]);
+                }
+            }
+        }
+
+        for (int m = 0; m < numMembers; m++) {
+            if (balls[members[m]].active && ballPhase(balls[members[m]]) != PHASE_STOPPED)
+                events.movingBalls++;
+        }
+    }
+}
+
+void buildIslands(const BallState* balls, int count, float timeDiff, BallIslands& islands)
+{
+    buildIslandsOn(RuntimeTable(activeTable(), count), balls, timeDiff, islands);
+}
+
+void stepIsland(BallState* balls, const int* members, int numMembers, float timeDiff,
+    StepEvents& events, CContactSolver& solver, ContactWorkspace& work, CThreadPool* pool,
+    CEventBus* bus)
+{
+    stepIslandOn(RuntimeTable(activeTable(), NUM_BALLS), balls, members, numMembers, timeDiff,
+        events, solver, work, pool, bus);
+}
+
+void mergeStepEvents(StepEvents& total, const StepEvents& island)
+{
+    total.pocketed |= island.pocketed;
+    total.cushionHits += island.cushionHits;
+    if (island.firstContact >= 0)
+        total.firstContact = island.firstContact;  // 큐볼은 한 island에만 있다
+    total.contacts += island.contacts;
+    if (island.solverIterations > total.solverIterations)
+        total.solverIterations = island.solverIterations;
+    if (island.substeps > total.substeps)
+        total.substeps = island.substeps;
+    total.movingBalls += island.movingBalls;
+}
+
+CIslandStepper::CIslandStepper(void)
+    : m_pool(NULL), m_bus(NULL), m_moving(false), m_firstContactSent(false)
+{
+    m_islands.numIslands = 0;
+    m_islands.numMoving = 0;
+}
+
+void CIslandStepper::reset(void)
+{
+    m_solver.reset();
+    m_moving = false;
+    m_firstContactSent = false;
+}
+
+void CIslandStepper::setPool(CThreadPool* pool)
+{
+    m_pool = pool;
+    m_solver.setParallel(pool);
+}
+
+void CIslandStepper::step(BallState* balls, int count, float timeDiff, StepEvents* events)
+{
+    StepEvents local;
+    if (events == NULL)
+        events = &local;
+    memset(events, 0, sizeof(*events));
+    events->firstContact = -1;
+
+    buildIslands(balls, count, timeDiff, m_islands);
+    m_solver.forgetSeparated(m_islands.islandOf);
+
+    // 멈춰 있던 공이 움직이기 시작하면 새 샷이다.
+    if (!m_moving && m_islands.numMoving > 0) {
+        m_moving = true;
+        m_firstContactSent = false;
+        if (m_bus != NULL) m_bus->publish(EVENT_SHOT_STARTED);
+    }
+
+    const int numIslands = m_islands.numIslands;
+    if (m_pool == NULL || numIslands == 1) {
+        // island 하나가 큰 덩어리이면 그 안의 색을 pool로 나눈다.
+        for (int k = 0; k < numIslands; k++) {
+            int begin = m_islands.start[k];
+            stepIsland(balls, m_islands.members + begin, m_islands.start[k + 1] - begin, timeDiff,
+                m_events[k], m_solver, m_work[k], m_pool, m_bus);
+        }
+    }
+    else {
+        m_pool->parallelFor(numIslands, 1, [this, balls, timeDiff](int from, int to) {
+            for (int k = from; k < to; k++) {
+                int begin = m_islands.start[k];
+                stepIsland(balls, m_islands.members + begin, m_islands.start[k + 1] - begin, timeDiff,
+                    m_events[k], m_solver, m_work[k], NULL, m_bus);
+            }
+        });
+    }
+
+    for (int k = 0; k < numIslands; k++)
+        mergeStepEvents(*events, m_events[k]);
+
+    if (m_bus == NULL || !m_moving)
+        return;
+    if (!m_firstContactSent && events->firstContact >= 0) {
+        m_firstContactSent = true;
+        m_bus->publish(EVENT_FIRST_CONTACT, CUE_BALL, events->firstContact);
+    }
+    if (events->movingBalls == 0) {
+        m_moving = false;
+        m_bus->publish(EVENT_ALL_STOPPED);
+    }
+}
@@ -0,0 +1,79 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: islandStepper.h
+//
+// Desc: 한 step 안에서 서로 닿을 수 있는 공끼리 묶은 접촉 island 단위의 진행.
+//       step 동안 공이 움직일 수 있는 거리로 넓힌 원이 겹치는 쌍을 union-find로 묶으면
+//       다른 island의 공과는 이번 step에 닿을 수 없으므로 island마다 따로 진행해도 된다.
+//       공이 하나뿐인 island는 접촉을 찾지 않고 이동, 쿠션, 포켓만 처리한다.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __islandStepperH__
+#define __islandStepperH__
+
+#include "billiardPhysics.h"
+#include "contactSolver.h"
+#include "eventBus.h"
+
+class CThreadPool;
+
+// 이동 거리 추정에 더하는 여유 (위치 보정으로 밀리는 양)
+const float ISLAND_MARGIN = 0.01f;
+
+// 적응형 substep: 공마다 한 substep에 SUBSTEP_TRAVEL과 가장 가까운 장애물까지 거리 중
+// 작은 쪽(SUBSTEP_MIN_TRAVEL 이상)보다 멀리 가지 않도록 step을 2의 거듭제곱으로 나눈다.
+// 느린 공은 자기 경계에서만 진행하고, 빠른 공과 닿을 수 있으면 그 시각으로 당겨 와 함께 푼다.
+const float SUBSTEP_TRAVEL = (float)M_RADIUS * 0.5f;
+const float SUBSTEP_MIN_TRAVEL = (float)M_RADIUS * 0.1f;
+const int   MAX_SUBSTEPS = 32;
+
+struct BallIslands {
+    int numIslands;
+    int start[NUM_BALLS + 1];   // island k의 공은 members[start[k] .. start[k + 1])
+    int members[NUM_BALLS];     // island 안에서는 번호 순서
+    int islandOf[NUM_BALLS];    // 공이 속한 island, 빠진 공은 -1
+    int numMoving;              // 움직이는(회전 포함) 공의 수
+};
+
+// 들어가지 않은 공을 island로 나눈다. island 순서는 가장 작은 공 번호 순서이다.
+void buildIslands(const BallState* balls, int count, float timeDiff, BallIslands& islands);
+
+// island 하나를 timeDiff 만큼 진행한다. events는 이 island의 일만 담는다.
+// 공마다 속력과 장애물까지 거리로 정한 간격으로 나누어 진행한다.
+// bus가 있으면 충돌, 쿠션, 포켓 사건을 바로 publish한다 (여러 thread에서 불려도 된다).
+void stepIsland(BallState* balls, const int* members, int numMembers, float timeDiff,
+    StepEvents& events, CContactSolver& solver, ContactWorkspace& work, CThreadPool* pool,
+    CEventBus* bus);
+
+// island들의 events를 하나로 합친다.
+void mergeStepEvents(StepEvents& total, const StepEvents& island);
+
+// island들을 thread pool에서 나누어 진행하는 stepTable.
+// pool이 없거나 island가 하나뿐이면 호출한 thread에서 진행한다.
+// bus가 있으면 샷 시작, 첫 접촉, 모든 공 정지도 알린다.
+class CIslandStepper {
+public:
+    CIslandStepper(void);
+
+    void setPool(CThreadPool* pool);
+    void setEventBus(CEventBus* bus) { m_bus = bus; }
+    void reset(void);
+
+    void step(BallState* balls, int count, float timeDiff, StepEvents* events);
+
+    // 마지막 step의 island 수
+    int islandCount(void) const { return m_islands.numIslands; }
+
+private:
+    CContactSolver   m_solver;
+    BallIslands      m_islands;
+    ContactWorkspace m_work[NUM_BALLS];     // island마다 하나
+    StepEvents       m_events[NUM_BALLS];
+    CThreadPool*     m_pool;
+    CEventBus*       m_bus;
+    bool             m_moving;              // 지난 step 끝에 움직이는 공이 있었음
+    bool             m_firstContactSent;    // 이번 샷의 첫 접촉을 알렸음
+};
+
+#endif // __islandStepperH__
@@ -0,0 +1,137 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: lockstep.cpp
+//
+// Desc: lockstep 입력 양자화, checksum, desync 검출 구현.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "lockstep.h"
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+    const double TWO_PI = 6.283185307179586476925;
+
+    int32_t quantize(float value, float unit)
+    {
+        return (int32_t)floor((double)value / unit + 0.5);
+    }
+
+    uint64_t hashBytes(uint64_t h, const void* data, size_t size)
+    {
+        const unsigned char* p = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; i++) {
+            h ^= p[i];
+            h *= 0x100000001B3ull;
+        }
+        return h;
+    }
+
+    uint64_t hashFloat(uint64_t h, float value)
+    {
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        return hashBytes(h, &bits, sizeof(bits));
+    }
+}
+
+ShotInput encodeShot(uint32_t step, float aim, float power, float tipSide, float tipHeight)
+{
+    double turns = aim / TWO_PI;
+    turns -= floor(turns);  // [0, 1)
+
+    ShotInput input;
+    input.step = step;
+    input.aim = (int32_t)floor(turns * LOCKSTEP_AIM_STEPS + 0.5) % LOCKSTEP_AIM_STEPS;
+    input.power = quantize(power, LOCKSTEP_POWER_UNIT);
+    input.tipSide = (int16_t)quantize(tipSide, LOCKSTEP_TIP_UNIT);
+    input.tipHeight = (int16_t)quantize(tipHeight, LOCKSTEP_TIP_UNIT);
+    return input;
+}
+
+void decodeShot(const ShotInput& input, float* aim, float* power, float* tipSide, float* tipHeight)
+{
+    // 정수와 2의 거듭제곱 단위의 곱이므로 어느 기계에서나 같은 float가 나온다.
+    *aim = (float)(input.aim * (TWO_PI / LOCKSTEP_AIM_STEPS));
+    *power = input.power * LOCKSTEP_POWER_UNIT;
+    *tipSide = input.tipSide * LOCKSTEP_TIP_UNIT;
+    *tipHeight = input.tipHeight * LOCKSTEP_TIP_UNIT;
+}
+
+void applyShot(BallState& cue, const ShotInput& input)
+{
+    float aim, power, tipSide, tipHeight;
+    decodeShot(input, &aim, &power, &tipSide, &tipHeight);
+    strikeCueBall(cue, aim, power, tipSide, tipHeight);
+}
+
+uint64_t stateChecksum(const BallState* balls, int count)
+{
+    uint64_t h = 0xCBF29CE484222325ull;
+    for (int i = 0; i < count; i++) {
+        const BallState& b = balls[i];
+        unsigned char active = b.active ? 1 : 0;
+        h = hashBytes(h, &active, 1);
+        if (!b.active) continue;
+        h = hashFloat(h, b.x);
+        h = hashFloat(h, b.y);
+        h = hashFloat(h, b.z);
+        h = hashFloat(h, b.vx);
+        h = hashFloat(h, b.vz);
+        h = hashFloat(h, b.wx);
+        h = hashFloat(h, b.wy);
+        h = hashFloat(h, b.wz);
+    }
+    return h;
+}
+
+void CDesyncDetector::reset(void)
+{
+    memset(m_history, 0, sizeof(m_history));
+    m_desynced = false;
+    m_firstDesync = 0;
+}
+
+void CDesyncDetector::record(uint32_t step, uint64_t checksum)
+{
+    Entry& e = m_history[step % CHECKSUM_HISTORY];
+    e.step = step;
+    e.checksum = checksum;
+    e.valid = true;
+}
+
+bool CDesyncDetector::lookup(uint32_t step, uint64_t* checksum) const
+{
+    const Entry& e = m_history[step % CHECKSUM_HISTORY];
+    if (!e.valid || e.step != step)
+        return false;
+    *checksum = e.checksum;
+    return true;
+}
+
+bool CDesyncDetector::check(uint32_t step, uint64_t remote)
+{
+    uint64_t local;
+    if (!lookup(step, &local) || local == remote)
+        return true;
+    if (!m_desynced || step < m_firstDesync) {
+        m_desynced = true;
+        m_firstDesync = step;
+    }
+    return false;
+}
+
+int CFixedStepClock::advance(float timeDelta)
+{
+    m_accumulator += timeDelta;
+    int steps = (int)(m_accumulator / LOCKSTEP_DT);
+    if (steps > LOCKSTEP_MAX_STEPS_PER_FRAME) {
+        steps = LOCKSTEP_MAX_STEPS_PER_FRAME;
+        m_accumulator = 0.0f;
+        return steps;
+    }
+    m_accumulator -= steps * LOCKSTEP_DT;
+    return steps;
+}
@@ -0,0 +1,93 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: lockstep.h
+//
+// Desc: lockstep 진행에 필요한 것들.
+//       - ShotInput: 샷 입력을 정수로 양자화한 값. 두 기계는 이 값만 주고받고,
+//         같은 step에서 applyShot()으로 적용하면 같은 상태에서 출발한다.
+//       - stateChecksum: 공 상태의 bit를 그대로 hash한 값. step마다 비교해 desync를 찾는다.
+//       - CDesyncDetector: 최근 step의 checksum 기록과 상대 값과의 비교.
+//       - CFixedStepClock: frame 시간을 LOCKSTEP_DT 간격의 step 수로 바꾼다.
+//
+//       물리 결과가 기계마다 같으려면 DETERMINISTIC_PHYSICS로 빌드해야 한다 (detMath.h).
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __lockstepH__
+#define __lockstepH__
+
+#include "billiardPhysics.h"
+#include <stdint.h>
+
+const int32_t LOCKSTEP_AIM_STEPS = 1 << 16;    // 한 바퀴
+const float   LOCKSTEP_POWER_UNIT = 1.0f / 1024.0f;
+const float   LOCKSTEP_TIP_UNIT = 1.0f / 256.0f;
+const float   LOCKSTEP_DT = 1.0f / 120.0f;     // step 하나의 시간
+// 한 frame에 따라잡는 step 수의 상한 (멈췄다 돌아온 뒤 한꺼번에 돌지 않게)
+const int     LOCKSTEP_MAX_STEPS_PER_FRAME = 16;
+const int     CHECKSUM_HISTORY = 256;
+
+struct ShotInput {
+    uint32_t step;      // 이 입력을 적용할 step 번호
+    int32_t  aim;       // [0, LOCKSTEP_AIM_STEPS)
+    int32_t  power;     // LOCKSTEP_POWER_UNIT 단위
+    int16_t  tipSide;   // LOCKSTEP_TIP_UNIT 단위
+    int16_t  tipHeight;
+};
+
+ShotInput encodeShot(uint32_t step, float aim, float power, float tipSide, float tipHeight);
+void decodeShot(const ShotInput& input, float* aim, float* power, float* tipSide, float* tipHeight);
+// 큐볼을 input대로 친다.
+void applyShot(BallState& cue, const ShotInput& input);
+
+// 공 상태(위치, 속도, 회전, 활성)의 64-bit FNV-1a hash
+uint64_t stateChecksum(const BallState* balls, int count);
+
+class CDesyncDetector {
+public:
+    CDesyncDetector(void) { reset(); }
+
+    void reset(void);
+    void record(uint32_t step, uint64_t checksum);
+
+    // step의 기록을 찾는다. 아직 없거나 이미 밀려났으면 false.
+    bool lookup(uint32_t step, uint64_t* checksum) const;
+
+    // 상대 기계의 checksum과 비교한다. 다르면 false를 돌려주고 desync로 기록한다.
+    // 비교할 기록이 없으면 true.
+    bool check(uint32_t step, uint64_t remote);
+
+    bool desynced(void) const { return m_desynced; }
+    uint32_t firstDesyncStep(void) const { return m_firstDesync; }
+
+private:
+    struct Entry {
+        uint32_t step;
+        uint64_t checksum;
+        bool     valid;
+    };
+
+    Entry    m_history[CHECKSUM_HISTORY];  // step % CHECKSUM_HISTORY 칸
+    bool     m_desynced;
+    uint32_t m_firstDesync;
+};
+
+class CFixedStepClock {
+public:
+    CFixedStepClock(void) : m_accumulator(0.0f), m_step(0) {}
+
+    void reset(void) { m_accumulator = 0.0f; m_step = 0; }
+
+    // 이번 frame에 진행할 step 수. 남은 시간은 다음 frame으로 넘긴다.
+    int advance(float timeDelta);
+
+    // 다음에 진행할 step 번호
+    uint32_t step(void) const { return m_step; }
+    void finishStep(void) { m_step++; }
+
+private:
+    float    m_accumulator;
+    uint32_t m_step;
+};
+
+#endif // __lockstepH__
@@ -0,0 +1,808 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: netSession.cpp
+//
+// Desc: 네트워크 대전 / 관전 동기화 구현.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "netSession.h"
+#include "islandStepper.h"
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+    enum NetMessage {
+        MSG_HELLO = 1,  // client -> host: 붙고 싶음 / snapshot을 다시 주기 바람
+        MSG_REQUEST,    // client -> host: ack와 확정을 기다리는 입력
+        MSG_UPDATE,     // host -> client: 확정 입력, 거절, checksum
+        MSG_SNAPSHOT    // host -> client: 마지막 입력 직전의 상태
+    };
+
+    // 같은 구조(같은 빌드)의 기계끼리만 주고받으므로 값을 그대로 복사한다.
+    class CPacketWriter {
+    public:
+        CPacketWriter(unsigned char* buffer) : m_buffer(buffer), m_size(0) {}
+
+        void put(const void* data, int size)
+        {
+            if (m_size + size > NET_MAX_PACKET) {
+                m_size = NET_MAX_PACKET + 1;
+                return;
+            }
+            memcpy(m_buffer + m_size, data, size);
+            m_size += size;
+        }
+        template<class T> void put(const T& value) { put(&value, (int)sizeof(T)); }
+
+        bool ok(void) const { return m_size <= NET_MAX_PACKET; }
+        int size(void) const { return m_size; }
+
+    private:
+        unsigned char* m_buffer;
+        int            m_size;
+    };
+
+    class CPacketReader {
+    public:
+        CPacketReader(const unsigned char* data, int size) : m_data(data), m_size(size), m_offset(0) {}
+
+        bool get(void* data, int size)
+        {
+            if (m_offset + size > m_size)
+                return false;
+            memcpy(data, m_data + m_offset, size);
+            m_offset += size;
+            return true;
+        }
+        template<class T> bool get(T& value) { return get(&value, (int)sizeof(T)); }
+
+    private:
+        const unsigned char* m_data;
+        int m_size;
+        int m_offset;
+    };
+
+    // 순번을 뺀 입력 내용이 같은지
+    bool sameInput(const NetInput& a, const NetInput& b)
+    {
+        return a.step == b.step && a.type == b.type && a.player == b.player &&
+            memcmp(&a.shot, &b.shot, sizeof(a.shot)) == 0 &&
+            a.placeX == b.placeX && a.placeZ == b.placeZ;
+    }
+
+    NetInput makeInput(NetInputType type)
+    {
+        NetInput input;
+        memset(&input, 0, sizeof(input));
+        input.type = (uint8_t)type;
+        return input;
+    }
+}
+
+CNetSession::CNetSession(void)
+    : m_transport(NULL), m_role(NET_OFFLINE), m_synced(false), m_hostPeer(-1),
+    m_balls(NULL), m_stepper(NULL), m_bus(NULL), m_rules(NULL),
+    m_step(0), m_nextTurn(1), m_numEntries(0), m_numPeers(0),
+    m_pending(false), m_lastRequest(0), m_ackDirty(false), m_helloWait(0)
+{
+    memset(&m_request, 0, sizeof(m_request));
+    memset(&m_stats, 0, sizeof(m_stats));
+}
+
+void CNetSession::attach(BallState* balls, CIslandStepper* stepper, CEventBus* bus, CRuleEngine* rules)
+{
+    if (m_rules != NULL)
+        m_replayBus.unsubscribe(m_rules);
+    m_balls = balls;
+    m_stepper = stepper;
+    m_bus = bus;
+    m_rules = rules;
+    if (m_rules != NULL)
+        m_replayBus.subscribe(m_rules);
+}
+
+bool CNetSession::host(CNetTransport* transport)
+{
+    if (transport == NULL || m_balls == NULL || m_stepper == NULL)
+        return false;
+
+    m_transport = transport;
+    m_role = NET_HOST;
+    m_synced = true;
+    m_numPeers = 0;
+    m_nextTurn = 1;
+    m_pending = false;
+    memset(&m_stats, 0, sizeof(m_stats));
+    startTimeline(makeInput(NET_INPUT_START));
+    return true;
+}
+
+bool CNetSession::join(CNetTransport* transport, int hostPeer, bool play)
+{
+    if (transport == NULL || hostPeer < 0 || m_balls == NULL || m_stepper == NULL)
+        return false;
+
+    m_transport = transport;
+    m_role = play ? NET_PLAYER : NET_SPECTATOR;
+    m_synced = false;
+    m_hostPeer = hostPeer;
+    m_numPeers = 0;
+    m_pending = false;
+    m_ackDirty = false;
+    m_helloWait = 0;
+    memset(&m_stats, 0, sizeof(m_stats));
+    return true;
+}
+
+void CNetSession::close(void)
+{
+    m_transport = NULL;
+    m_role = NET_OFFLINE;
+    m_synced = false;
+    m_numPeers = 0;
+    m_numEntries = 0;
+    m_pending = false;
+}
+
+// -----------------------------------------------------------------------------
+// timeline
+// -----------------------------------------------------------------------------
+
+void CNetSession::startTimeline(const NetInput& first)
+{
+    Entry& e = m_timeline[0];
+    e.input = first;
+    e.confirmed = true;
+    e.applied = true;
+    memcpy(e.balls, m_balls, sizeof(e.balls));
+    if (m_rules != NULL)
+        e.rules = *m_rules;
+    m_numEntries = 1;
+    m_step = first.step;
+
+    m_stepper->reset();
+    m_replayBus.clear();
+    m_checksums.reset();
+}
+
+int CNetSession::findEntry(uint32_t step) const
+{
+    for (int i = m_numEntries - 1; i >= 0; i--) {
+        if (m_timeline[i].input.step == step)
+            return i;
+        if (m_timeline[i].input.step < step)
+            break;
+    }
+    return -1;
+}
+
+// step 이전(같은 step 포함)에 적용한 마지막 입력. snapshot이 유효한 되돌릴 자리이다.
+// 시작 자리는 적용할 것이 없으므로 늘 유효하다.
+int CNetSession::lastAppliedEntry(uint32_t step) const
+{
+    for (int i = m_numEntries - 1; i >= 0; i--) {
+        const Entry& e = m_timeline[i];
+        if (e.input.step < step || (e.input.step == step && e.applied))
+            return i;
+    }
+    return -1;
+}
+
+int CNetSession::insertEntry(const NetInput& input, bool confirmed)
+{
+    // 가장 오래된 입력은 더 되돌릴 일이 없으므로 버린다.
+    if (m_numEntries == NET_TIMELINE)
+        removeEntry(0);
+
+    int at = m_numEntries;
+    while (at > 0 && m_timeline[at - 1].input.step > input.step) {
+        m_timeline[at] = m_timeline[at - 1];
+        at--;
+    }
+    Entry& e = m_timeline[at];
+    e.input = input;
+    e.confirmed = confirmed;
+    e.applied = false;
+    m_numEntries++;
+    return at;
+}
+
+void CNetSession::removeEntry(int index)
+{
+    for (int i = index + 1; i < m_numEntries; i++)
+        m_timeline[i - 1] = m_timeline[i];
+    m_numEntries--;
+}
+
+bool CNetSession::atRest(void) const
+{
+    for (int i = 0; i < NUM_BALLS; i++) {
+        if (m_balls[i].active && isBallMoving(m_balls[i]))
+            return false;
+    }
+    return m_rules == NULL || !m_rules->shotInProgress();
+}
+
+// 지금 상태에서 input을 적용할 수 있는지. host와 client가 같은 규칙으로 검사한다.
+bool CNetSession::validate(const NetInput& input) const
+{
+    if (input.type == NET_INPUT_START)
+        return true;
+    if (!atRest())
+        return false;
+    if (m_rules == NULL)
+        return input.type != NET_INPUT_GROUP;
+
+    const RuleState& rules = m_rules->rules();
+    if (m_rules->phase() == RULE_GAME_OVER || (input.player == 1) != rules.turn)
+        return false;
+
+    switch (input.type) {
+    case NET_INPUT_SHOT:
+        return !rules.free_shot && !m_rules->selectingGroup();
+    case NET_INPUT_PLACE:
+        return rules.free_shot && !m_rules->selectingGroup();
+    case NET_INPUT_GROUP:
+        return m_rules->selectingGroup();
+    }
+    return false;
+}
+
+void CNetSession::apply(const NetInput& input)
+{
+    // 입력 직전의 snapshot에는 warm start가 없으므로 처음 진행할 때도 지운다.
+    m_stepper->reset();
+
+    switch (input.type) {
+    case NET_INPUT_SHOT:
+        applyShot(m_balls[CUE_BALL], input.shot);
+        break;
+    case NET_INPUT_PLACE:
+    {
+        BallState& cue = m_balls[CUE_BALL];
+        cue.x = input.placeX * NET_PLACE_UNIT;
+        cue.y = (float)M_RADIUS;
+        cue.z = input.placeZ * NET_PLACE_UNIT;
+        cue.vx = cue.vz = 0.0f;
+        cue.wx = cue.wy = cue.wz = 0.0f;
+        cue.active = true;
+        if (m_rules != NULL)
+            m_rules->placeCueBall();
+        break;
+    }
+    case NET_INPUT_GROUP:
+        if (m_rules != NULL)
+            m_rules->selectGroup(input.placeZ != 0);
+        break;
+    }
+}
+
+// 이번 step에 적용할 입력이 있으면 snapshot을 남기고 적용한다.
+// 확정된 입력이 이 상태에 맞지 않으면 false (다른 peer와 어긋났음).
+bool CNetSession::prepareStep(void)
+{
+    int k = findEntry(m_step);
+    if (k < 0 || m_timeline[k].applied)
+        return true;
+
+    Entry& e = m_timeline[k];
+    if (!validate(e.input)) {
+        removeEntry(k);
+        return false;
+    }
+    memcpy(e.balls, m_balls, sizeof(e.balls));
+    if (m_rules != NULL)
+        e.rules = *m_rules;
+    e.applied = true;
+    apply(e.input);
+    return true;
+}
+
+void CNetSession::stepOnce(bool publish)
+{
+    // 다시 진행하는 step의 사건은 규칙만 받는다 (소리, 기록이 두 번 나가지 않게).
+    CEventBus* bus = publish && m_bus != NULL ? m_bus : &m_replayBus;
+    m_stepper->setEventBus(bus);
+    m_stepper->step(m_balls, NUM_BALLS, LOCKSTEP_DT, NULL);
+    m_stepper->setEventBus(m_bus);
+    bus->dispatch();
+
+    m_checksums.record(m_step, stateChecksum(m_balls, NUM_BALLS));
+    m_step++;
+}
+
+void CNetSession::runTo(uint32_t target, uint32_t publishFrom)
+{
+    while (m_step < target) {
+        if (!prepareStep())
+            requestResync();
+        stepOnce(m_step >= publishFrom);
+    }
+}
+
+void CNetSession::resimulate(int index, uint32_t target, uint32_t publishFrom)
+{
+    Entry& e = m_timeline[index];
+    memcpy(m_balls, e.balls, sizeof(e.balls));
+    if (m_rules != NULL)
+        *m_rules = e.rules;
+    for (int i = index; i < m_numEntries; i++)
+        m_timeline[i].applied = m_timeline[i].input.type == NET_INPUT_START;
+    m_replayBus.clear();
+
+    uint32_t from = e.input.step;
+    m_step = from;
+    runTo(target, publishFrom);
+    if (target > from)
+        m_stats.resimulatedSteps += target - from;
+}
+
+void CNetSession::advance(int steps)
+{
+    if (!m_synced)
+        return;
+    for (int s = 0; s < steps; s++) {
+        if (!prepareStep())
+            requestResync();
+        stepOnce(true);
+    }
+}
+
+// -----------------------------------------------------------------------------
+// 입력
+// -----------------------------------------------------------------------------
+
+bool CNetSession::canSubmit(NetInputType type) const
+{
+    if (!m_synced || m_pending || localPlayer() == 0)
+        return false;
+    int k = findEntry(m_step);
+    if (k >= 0 && m_timeline[k].input.type != NET_INPUT_START)
+        return false;   // 이 step에는 이미 입력이 있음
+
+    NetInput probe = makeInput(type);
+    probe.player = (uint8_t)localPlayer();
+    return validate(probe);
+}
+
+bool CNetSession::submit(NetInput& input)
+{
+    if (!canSubmit((NetInputType)input.type))
+        return false;
+
+    input.step = m_step;
+    input.player = (uint8_t)localPlayer();
+    input.turn = m_nextTurn;
+
+    if (m_role == NET_HOST) {
+        // host의 입력은 바로 확정이다.
+        m_log[m_nextTurn % NET_INPUT_LOG] = input;
+        m_nextTurn++;
+        insertEntry(input, true);
+    }
+    else {
+        m_request = input;
+        m_pending = true;
+        insertEntry(input, false);
+        m_stats.predictions++;
+        sendRequest();
+    }
+
+    // 기다리지 않고 지금 상태에 적용한다. 다음 step부터 움직인다.
+    prepareStep();
+    return true;
+}
+
+bool CNetSession::submitShot(float aim, float power, float tipSide, float tipHeight)
+{
+    NetInput input = makeInput(NET_INPUT_SHOT);
+    input.shot = encodeShot(m_step, aim, power, tipSide, tipHeight);
+    return submit(input);
+}
+
+bool CNetSession::submitPlacement(float x, float z)
+{
+    NetInput input = makeInput(NET_INPUT_PLACE);
+    input.placeX = (int32_t)floorf(x / NET_PLACE_UNIT + 0.5f);
+    input.placeZ = (int32_t)floorf(z / NET_PLACE_UNIT + 0.5f);
+    return submit(input);
+}
+
+bool CNetSession::submitGroup(bool solid)
+{
+    NetInput input = makeInput(NET_INPUT_GROUP);
+    input.placeZ = solid ? 1 : 0;
+    return submit(input);
+}
+
+// -----------------------------------------------------------------------------
+// packet
+// -----------------------------------------------------------------------------
+
+bool CNetSession::sendPacket(int peer, const void* data, int size)
+{
+    if (!m_transport->send(peer, data, size))
+        return false;
+    m_stats.packetsSent++;
+    m_stats.bytesSent += size;
+    return true;
+}
+
+void CNetSession::poll(void)
+{
+    if (m_transport == NULL)
+        return;
+
+    unsigned char buffer[NET_MAX_PACKET];
+    int from;
+    int size;
+    while ((size = m_transport->receive(&from, buffer, sizeof(buffer))) > 0) {
+        m_stats.packetsReceived++;
+        m_stats.bytesReceived += size;
+
+        CPacketReader reader(buffer, size);
+        uint8_t type = 0;
+        reader.get(type);
+        if (m_role == NET_HOST) {
+            if (type == MSG_HELLO) {
+                uint8_t play = 0;
+                if (reader.get(play))
+                    onHello(from, play != 0);
+            }
+            else if (type == MSG_REQUEST) {
+                Peer* peer = findPeer(from);
+                uint32_t acked;
+                uint8_t hasInput;
+                NetInput input;
+                if (peer == NULL || !reader.get(acked) || !reader.get(hasInput))
+                    continue;
+                if (acked > peer->acked && acked < m_nextTurn)
+                    peer->acked = acked;
+                if (hasInput && reader.get(input))
+                    onRequest(from, input);
+            }
+        }
+        else if (from == m_hostPeer) {
+            if (type == MSG_SNAPSHOT)
+                onSnapshot(buffer, size);
+            else if (type == MSG_UPDATE && m_synced)
+                onUpdate(buffer, size);
+        }
+    }
+
+    if (m_role == NET_HOST) {
+        for (int i = 0; i < m_numPeers; i++) {
+            Peer& peer = m_peers[i];
+            if (peer.needSnapshot) {
+                sendSnapshot(peer);
+                continue;
+            }
+            // 새 입력과 거절은 바로, 확인이 없으면 조금 뒤에 다시, 아니면 checksum만 가끔
+            uint32_t confirmed = m_nextTurn - 1;
+            uint32_t wait = peer.acked < confirmed ? NET_RESEND_STEPS : NET_HEARTBEAT_STEPS;
+            if (confirmed > peer.sent || peer.rejected >= 0 || m_step - peer.lastSent >= wait)
+                sendUpdate(peer);
+        }
+    }
+    else if (!m_synced) {
+        if (--m_helloWait <= 0) {
+            sendHello();
+            m_helloWait = NET_RESEND_STEPS;
+        }
+    }
+    else if (m_ackDirty || (m_pending && m_step - m_lastRequest >= (uint32_t)NET_RESEND_STEPS)) {
+        sendRequest();
+    }
+}
+
+// -----------------------------------------------------------------------------
+// host
+// -----------------------------------------------------------------------------
+
+CNetSession::Peer* CNetSession::findPeer(int id)
+{
+    for (int i = 0; i < m_numPeers; i++) {
+        if (m_peers[i].id == id)
+            return &m_peers[i];
+    }
+    return NULL;
+}
+
+void CNetSession::onHello(int id, bool play)
+{
+    Peer* peer = findPeer(id);
+    if (peer == NULL) {
+        if (m_numPeers == NET_MAX_PEERS)
+            return;
+        // 치는 사람은 한 명뿐이고 나머지는 관전한다.
+        bool playerTaken = false;
+        for (int i = 0; i < m_numPeers; i++)
+            playerTaken = playerTaken || m_peers[i].player;
+
+        peer = &m_peers[m_numPeers++];
+        peer->id = id;
+        peer->player = play && !playerTaken;
+    }
+    peer->rejected = -1;
+    peer->needSnapshot = true;
+}
+
+void CNetSession::onRequest(int id, const NetInput& request)
+{
+    Peer* peer = findPeer(id);
+    if (peer == NULL || peer->needSnapshot)
+        return;
+
+    // 이미 확정한 요청을 다시 받았으면 확정 입력이 다시 가기를 기다린다.
+    if (request.turn < m_nextTurn && m_nextTurn - request.turn <= (uint32_t)NET_INPUT_LOG &&
+        sameInput(m_log[request.turn % NET_INPUT_LOG], request))
+        return;
+    // 아직 오지 않은 step이면 따라잡은 뒤 다시 온 요청을 처리한다.
+    if (request.step > m_step)
+        return;
+
+    int k = findEntry(request.step);
+    bool taken = k >= 0 && m_timeline[k].input.type != NET_INPUT_START;
+    if (!peer->player || request.player != 2 || request.turn != m_nextTurn ||
+        request.type == NET_INPUT_START || taken) {
+        peer->rejected = (int32_t)request.turn;
+        return;
+    }
+
+    // 요청한 step으로 되돌려 검사한다.
+    uint32_t now = m_step;
+    if (request.step < now) {
+        int restore = lastAppliedEntry(request.step);
+        if (restore < 0) {
+            peer->rejected = (int32_t)request.turn;
+            return;
+        }
+        resimulate(restore, request.step, now);
+        m_stats.resimulatedSteps += now - request.step;
+    }
+
+    uint32_t publishFrom = now;
+    if (validate(request)) {
+        NetInput confirmed = request;
+        m_log[m_nextTurn % NET_INPUT_LOG] = confirmed;
+        m_nextTurn++;
+        insertEntry(confirmed, true);
+        prepareStep();
+        publishFrom = request.step;
+        if (request.step < now)
+            m_stats.rollbacks++;
+    }
+    else {
+        peer->rejected = (int32_t)request.turn;
+    }
+    runTo(now, publishFrom);
+}
+
+void CNetSession::sendUpdate(Peer& peer)
+{
+    unsigned char buffer[NET_MAX_PACKET];
+    CPacketWriter writer(buffer);
+    writer.put((uint8_t)MSG_UPDATE);
+    writer.put(m_step);
+
+    // 가장 최근 step의 checksum (이때까지 확정된 입력 수와 함께)
+    uint64_t checksum = 0;
+    uint8_t hasChecksum = m_step > 0 && m_checksums.lookup(m_step - 1, &checksum) ? 1 : 0;
+    writer.put(hasChecksum);
+    writer.put((uint32_t)(m_step - 1));
+    writer.put(checksum);
+    writer.put((uint32_t)(m_nextTurn - 1));
+    writer.put(peer.rejected);
+
+    // 확인받지 못한 확정 입력
+    uint32_t confirmed = m_nextTurn - 1;
+    if (confirmed - peer.acked > (uint32_t)NET_INPUT_LOG) {
+        peer.needSnapshot = true;
+        return;
+    }
+    uint32_t last = peer.acked + NET_MAX_SEND_INPUTS < confirmed ? peer.acked + NET_MAX_SEND_INPUTS : confirmed;
+    writer.put((uint8_t)(last - peer.acked));
+    for (uint32_t turn = peer.acked + 1; turn <= last; turn++)
+        writer.put(m_log[turn % NET_INPUT_LOG]);
+
+    if (writer.ok() && sendPacket(peer.id, buffer, writer.size())) {
+        if (last > peer.sent)
+            peer.sent = last;
+        peer.rejected = -1;
+        peer.lastSent = m_step;
+    }
+}
+
+void CNetSession::sendSnapshot(Peer& peer)
+{
+    // 마지막 입력 직전의 상태와 그 입력. 받은 쪽이 지금 step까지 진행한다.
+    const Entry& e = m_timeline[m_numEntries - 1];
+    const RuleState rules = m_rules != NULL ? e.rules.rules() : RuleState();
+
+    unsigned char buffer[NET_MAX_PACKET];
+    CPacketWriter writer(buffer);
+    writer.put((uint8_t)MSG_SNAPSHOT);
+    writer.put((uint8_t)(peer.player ? 1 : 0));
+    writer.put(m_step);
+    writer.put(m_nextTurn);
+    writer.put(e.input);
+    writer.put(e.balls, (int)sizeof(e.balls));
+    writer.put((uint8_t)(m_rules != NULL ? 1 : 0));
+    writer.put(rules);
+    writer.put((int32_t)(m_rules != NULL ? e.rules.phase() : RULE_AIMING));
+    writer.put((int32_t)(m_rules != NULL ? e.rules.winner() : 0));
+    writer.put((uint8_t)(m_rules != NULL && e.rules.lastShotFoul() ? 1 : 0));
+
+    if (writer.ok() && sendPacket(peer.id, buffer, writer.size())) {
+        peer.needSnapshot = false;
+        peer.acked = peer.sent = m_nextTurn - 1;
+        peer.rejected = -1;
+        peer.lastSent = m_step;
+    }
+}
+
+// -----------------------------------------------------------------------------
+// client
+// -----------------------------------------------------------------------------
+
+void CNetSession::sendHello(void)
+{
+    unsigned char buffer[8];
+    CPacketWriter writer(buffer);
+    writer.put((uint8_t)MSG_HELLO);
+    writer.put((uint8_t)(m_role == NET_PLAYER ? 1 : 0));
+    sendPacket(m_hostPeer, buffer, writer.size());
+}
+
+void CNetSession::sendRequest(void)
+{
+    unsigned char buffer[NET_MAX_PACKET];
+    CPacketWriter writer(buffer);
+    writer.put((uint8_t)MSG_REQUEST);
+    writer.put((uint32_t)(m_nextTurn - 1));
+    writer.put((uint8_t)(m_pending ? 1 : 0));
+    if (m_pending)
+        writer.put(m_request);
+
+    if (sendPacket(m_hostPeer, buffer, writer.size())) {
+        m_ackDirty = false;
+        m_lastRequest = m_step;
+    }
+}
+
+void CNetSession::requestResync(void)
+{
+    if (m_role == NET_HOST || !m_synced)
+        return;
+    m_synced = false;
+    m_pending = false;
+    m_helloWait = 0;
+    m_stats.resyncs++;
+}
+
+void CNetSession::onUpdate(const unsigned char* data, int size)
+{
+    CPacketReader reader(data, size);
+    uint8_t type, hasChecksum, count;
+    uint32_t hostStep, checksumStep, checksumTurns;
+    uint64_t checksum;
+    int32_t rejected;
+    if (!reader.get(type) || !reader.get(hostStep) || !reader.get(hasChecksum) ||
+        !reader.get(checksumStep) || !reader.get(checksum) || !reader.get(checksumTurns) ||
+        !reader.get(rejected) || !reader.get(count))
+        return;
+
+    for (int i = 0; i < count; i++) {
+        NetInput input;
+        if (!reader.get(input))
+            return;
+        if (input.turn == m_nextTurn)
+            onConfirmed(input);
+        else if (input.turn < m_nextTurn)
+            m_ackDirty = true;  // ack를 잃어버렸음
+    }
+    if (rejected >= 0)
+        onRejected((uint32_t)rejected);
+
+    // 같은 입력까지 확정된 상태끼리만 비교한다.
+    if (hasChecksum && m_synced && !m_pending && checksumTurns == m_nextTurn - 1 &&
+        !m_checksums.check(checksumStep, checksum))
+        requestResync();
+}
+
+void CNetSession::onConfirmed(const NetInput& input)
+{
+    m_nextTurn++;
+    m_ackDirty = true;
+
+    // 예측이 맞았음
+    if (m_pending && sameInput(m_request, input)) {
+        int k = findEntry(input.step);
+        if (k >= 0)
+            m_timeline[k].confirmed = true;
+        m_pending = false;
+        return;
+    }
+
+    // 예측을 지우고 확정 입력을 넣은 뒤, 바뀐 곳부터 지금 step까지 다시 진행한다.
+    uint32_t now = m_step;
+    uint32_t changed = input.step;
+    if (m_pending) {
+        int k = findEntry(m_request.step);
+        if (k >= 0 && !m_timeline[k].confirmed)
+            removeEntry(k);
+        if (m_request.step < changed)
+            changed = m_request.step;
+        m_pending = false;
+        m_stats.rollbacks++;
+    }
+    insertEntry(input, true);
+
+    if (changed < now) {
+        int restore = lastAppliedEntry(changed);
+        if (restore < 0) {
+            requestResync();
+            return;
+        }
+        resimulate(restore, now, changed);
+    }
+}
+
+void CNetSession::onRejected(uint32_t turn)
+{
+    if (!m_pending || m_request.turn != turn)
+        return;
+
+    uint32_t now = m_step;
+    int k = findEntry(m_request.step);
+    m_pending = false;
+    if (k < 0 || m_timeline[k].confirmed)
+        return;
+    removeEntry(k);
+    m_stats.rollbacks++;
+
+    int restore = lastAppliedEntry(m_request.step);
+    if (restore < 0) {
+        requestResync();
+        return;
+    }
+    resimulate(restore, now, m_request.step);
+}
+
+void CNetSession::onSnapshot(const unsigned char* data, int size)
+{
+    CPacketReader reader(data, size);
+    uint8_t type, player, hasRules, lastFoul;
+    uint32_t hostStep, nextTurn;
+    NetInput input;
+    BallState balls[NUM_BALLS];
+    RuleState rules;
+    int32_t phase, winner;
+    if (!reader.get(type) || !reader.get(player) || !reader.get(hostStep) || !reader.get(nextTurn) ||
+        !reader.get(input) || !reader.get(balls, (int)sizeof(balls)) || !reader.get(hasRules) ||
+        !reader.get(rules) || !reader.get(phase) || !reader.get(winner) || !reader.get(lastFoul))
+        return;
+
+    // 자리가 없어 관전자가 되었을 수 있다.
+    if (m_role == NET_PLAYER && !player)
+        m_role = NET_SPECTATOR;
+
+    memcpy(m_balls, balls, sizeof(balls));
+    if (m_rules != NULL && hasRules)
+        m_rules->restore(rules, (RulePhase)phase, winner, lastFoul != 0);
+
+    NetInput start = makeInput(NET_INPUT_START);
+    start.step = input.step;
+    startTimeline(start);
+    if (input.type != NET_INPUT_START)
+        insertEntry(input, true);
+    m_nextTurn = nextTurn;
+    m_pending = false;
+    m_synced = true;
+    m_ackDirty = true;
+
+    // 따라잡는 동안의 사건은 규칙만 받는다.
+    runTo(hostStep, hostStep);
+}
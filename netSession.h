@@ -0,0 +1,201 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: netSession.h
+//
+// Desc: 네트워크 대전 / 관전 동기화.
+//       host process가 공 상태의 기준이며, 주고받는 것은 입력(샷, 큐볼 배치, 그룹 선택)뿐이다.
+//       모든 입력은 공이 멈춘 step에 적용되고 host가 순번(turn)을 매겨 확정한다.
+//
+//       - 치는 사람은 입력을 바로 자기 상태에 적용하고(예측) host에 요청을 보낸다.
+//       - host는 요청을 그 step의 상태로 검사한 뒤 확정해 모든 peer에 보낸다. host가 이미
+//         그 step을 지났으면 직전 입력의 snapshot으로 되돌려 입력을 끼우고 다시 진행한다.
+//       - 확정된 입력이 예측과 다르거나 거절되면 예측 직전의 snapshot으로 되돌리고
+//         확정된 입력으로 현재 step까지 다시 진행한다 (rollback).
+//       - 확인받지 못한 입력은 packet마다 다시 보낸다. packet에는 받은 입력 수(ack)가 있다.
+//       - host는 가끔 (step, checksum)을 보내고, 다르면 peer가 snapshot을 다시 받는다.
+//
+//       snapshot은 입력마다 하나(입력 직전 상태와 규칙)만 두고, 보내는 입력도 아직 확인받지
+//       못한 것뿐이므로 기억하는 양과 대역은 경기 길이와 관계없다.
+//       입력이 확정되는 순서가 같으면 모든 peer가 같은 step에 같은 상태가 되도록
+//       LOCKSTEP_DT 간격으로만 진행한다 (DETERMINISTIC_PHYSICS 빌드에서 기계 사이에도 같음).
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __netSessionH__
+#define __netSessionH__
+
+#include "billiardPhysics.h"
+#include "eventBus.h"
+#include "lockstep.h"
+#include "netTransport.h"
+#include "ruleEngine.h"
+#include <stdint.h>
+
+class CIslandStepper;
+
+enum NetRole {
+    NET_OFFLINE,
+    NET_HOST,       // 기준 상태, player 1
+    NET_PLAYER,     // player 2
+    NET_SPECTATOR   // 보기만 함
+};
+
+enum NetInputType {
+    NET_INPUT_START,    // timeline의 시작 (snapshot만 있고 적용할 것은 없음)
+    NET_INPUT_SHOT,
+    NET_INPUT_PLACE,    // free shot의 큐볼 배치
+    NET_INPUT_GROUP     // 그룹 선택
+};
+
+const float NET_PLACE_UNIT = 1.0f / 4096.0f;
+const int   NET_TIMELINE = 32;          // 되돌릴 수 있는 입력 수
+const int   NET_INPUT_LOG = 64;         // host가 다시 보낼 수 있는 확정 입력 수
+const int   NET_RESEND_STEPS = 12;      // 확인이 없을 때 다시 보내는 간격
+const int   NET_HEARTBEAT_STEPS = 60;   // checksum을 보내는 간격
+const int   NET_MAX_SEND_INPUTS = 8;    // packet 하나에 넣는 입력 수
+
+struct NetInput {
+    uint32_t  turn;     // 확정 순번 (1부터). 요청에서는 요청한 쪽이 기대한 순번
+    uint32_t  step;     // 적용하는 step
+    uint8_t   type;     // NetInputType
+    uint8_t   player;   // 1: host, 2: player
+    uint16_t  reserved;
+    ShotInput shot;     // NET_INPUT_SHOT
+    int32_t   placeX;   // NET_INPUT_PLACE, NET_PLACE_UNIT 단위
+    int32_t   placeZ;   // NET_INPUT_GROUP 에서는 1: solid, 0: stripe
+};
+
+struct NetStats {
+    unsigned bytesSent, bytesReceived;
+    unsigned packetsSent, packetsReceived;
+    unsigned predictions;       // 확정 전에 적용한 입력
+    unsigned rollbacks;         // 되돌린 횟수
+    unsigned resimulatedSteps;  // 되돌린 뒤 다시 진행한 step 수
+    unsigned resyncs;           // checksum이 달라 snapshot을 다시 받은 횟수
+};
+
+class CNetSession {
+public:
+    CNetSession(void);
+
+    // 진행할 공 상태와 stepper, 사건을 받을 bus, 규칙. rules가 있으면 snapshot에 함께 담고
+    // 입력을 규칙으로 검사한다. bus에는 처음 진행하는 step의 사건만 나간다.
+    void attach(BallState* balls, CIslandStepper* stepper, CEventBus* bus, CRuleEngine* rules);
+
+    // host: 지금 상태로 시작하고 peer를 기다린다.
+    bool host(CNetTransport* transport);
+    // hostPeer에 붙는다. host의 snapshot을 받을 때까지는 synced()가 false이다.
+    bool join(CNetTransport* transport, int hostPeer, bool play);
+    void close(void);
+
+    // 받은 packet을 처리하고 보낼 것을 보낸다. frame마다 부른다.
+    void poll(void);
+    // LOCKSTEP_DT로 steps번 진행한다.
+    void advance(int steps);
+
+    // 지금 자기 차례에 낼 수 있는 입력인지
+    bool canSubmit(NetInputType type) const;
+    bool submitShot(float aim, float power, float tipSide, float tipHeight);
+    bool submitPlacement(float x, float z);
+    bool submitGroup(bool solid);
+
+    NetRole role(void) const { return m_role; }
+    bool active(void) const { return m_role != NET_OFFLINE; }
+    bool synced(void) const { return m_synced; }
+    int  localPlayer(void) const { return m_role == NET_HOST ? 1 : m_role == NET_PLAYER ? 2 : 0; }
+    uint32_t step(void) const { return m_step; }
+    uint32_t confirmedTurns(void) const { return m_nextTurn - 1; }
+    int  peerCount(void) const { return m_numPeers; }
+    const NetStats& stats(void) const { return m_stats; }
+    const CDesyncDetector& checksums(void) const { return m_checksums; }
+
+private:
+    CNetSession(const CNetSession&);
+    CNetSession& operator=(const CNetSession&);
+
+    struct Entry {
+        NetInput    input;
+        bool        confirmed;
+        bool        applied;            // 지금 timeline에서 입력을 적용했음 (snapshot이 유효)
+        BallState   balls[NUM_BALLS];   // input.step에서 입력을 적용하기 직전
+        CRuleEngine rules;
+    };
+
+    struct Peer {
+        int      id;            // transport의 peer 번호
+        bool     player;
+        uint32_t acked;         // 이 peer가 받았다고 알린 확정 입력 수
+        uint32_t sent;          // 이 peer에 보낸 확정 입력 수
+        int32_t  rejected;      // 거절을 알릴 순번 (없으면 -1)
+        uint32_t lastSent;      // 마지막으로 보낸 step
+        bool     needSnapshot;
+    };
+
+    // timeline
+    void startTimeline(const NetInput& first);
+    int  findEntry(uint32_t step) const;
+    int  lastAppliedEntry(uint32_t step) const;
+    int  insertEntry(const NetInput& input, bool confirmed);
+    void removeEntry(int index);
+    bool atRest(void) const;
+    bool validate(const NetInput& input) const;
+    void apply(const NetInput& input);
+    bool prepareStep(void);
+    void stepOnce(bool publish);
+    // index의 snapshot으로 되돌리고 target step까지 다시 진행한다.
+    // publishFrom부터는 처음 진행하는 step으로 보고 사건을 bus로 보낸다.
+    void resimulate(int index, uint32_t target, uint32_t publishFrom);
+    void runTo(uint32_t target, uint32_t publishFrom);
+
+    // host
+    void onHello(int id, bool play);
+    void onRequest(int id, const NetInput& request);
+    Peer* findPeer(int id);
+    void sendUpdate(Peer& peer);
+    void sendSnapshot(Peer& peer);
+
+    // client
+    void onUpdate(const unsigned char* data, int size);
+    void onConfirmed(const NetInput& input);
+    void onRejected(uint32_t turn);
+    void onSnapshot(const unsigned char* data, int size);
+    void sendHello(void);
+    void sendRequest(void);
+    void requestResync(void);
+
+    bool submit(NetInput& input);
+    bool sendPacket(int peer, const void* data, int size);
+
+    CNetTransport*  m_transport;
+    NetRole         m_role;
+    bool            m_synced;
+    int             m_hostPeer;
+
+    BallState*      m_balls;
+    CIslandStepper* m_stepper;
+    CEventBus*      m_bus;
+    CEventBus       m_replayBus;    // 다시 진행하는 동안의 사건 (규칙만 받는다)
+    CRuleEngine*    m_rules;
+
+    uint32_t        m_step;         // 다음에 진행할 step
+    uint32_t        m_nextTurn;     // 다음 확정 입력의 순번
+    Entry           m_timeline[NET_TIMELINE];   // step 순서
+    int             m_numEntries;
+    CDesyncDetector m_checksums;
+
+    // host
+    NetInput        m_log[NET_INPUT_LOG];       // turn % NET_INPUT_LOG 칸
+    Peer            m_peers[NET_MAX_PEERS];
+    int             m_numPeers;
+
+    // client
+    bool            m_pending;      // 확정을 기다리는 예측 입력이 있음
+    NetInput        m_request;
+    uint32_t        m_lastRequest;  // 요청을 마지막으로 보낸 step
+    bool            m_ackDirty;     // 새로 받은 확정 입력을 아직 알리지 않았음
+    int             m_helloWait;    // hello를 다시 보낼 때까지 남은 poll 수
+
+    NetStats        m_stats;
+};
+
+#endif // __netSessionH__
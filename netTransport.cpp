@@ -0,0 +1,234 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: netTransport.cpp
+//
+// Desc: UDP, loopback transport 구현.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "netTransport.h"
+#include <cstring>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+typedef int socklen_t;
+#define INVALID_NET_SOCKET ((intptr_t)INVALID_SOCKET)
+#define closeSocket(s) closesocket((SOCKET)(s))
+#else
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#define INVALID_NET_SOCKET ((intptr_t)-1)
+#define closeSocket(s) ::close((int)(s))
+#endif
+
+// -----------------------------------------------------------------------------
+// UDP
+// -----------------------------------------------------------------------------
+
+namespace
+{
+#ifdef _WIN32
+    // WSAStartup은 transport가 처음 열릴 때 한 번만 부른다.
+    bool startSockets(void)
+    {
+        static bool started = false;
+        if (!started) {
+            WSADATA data;
+            started = WSAStartup(MAKEWORD(2, 2), &data) == 0;
+        }
+        return started;
+    }
+#else
+    bool startSockets(void) { return true; }
+#endif
+}
+
+CUdpTransport::CUdpTransport(void)
+    : m_socket(INVALID_NET_SOCKET), m_numPeers(0)
+{
+}
+
+CUdpTransport::~CUdpTransport(void)
+{
+    close();
+}
+
+bool CUdpTransport::open(uint16_t port)
+{
+    close();
+    if (!startSockets())
+        return false;
+
+    intptr_t s = (intptr_t)socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (s == INVALID_NET_SOCKET)
+        return false;
+
+    sockaddr_in local;
+    memset(&local, 0, sizeof(local));
+    local.sin_family = AF_INET;
+    local.sin_addr.s_addr = htonl(INADDR_ANY);
+    local.sin_port = htons(port);
+    if (bind(s, (sockaddr*)&local, sizeof(local)) != 0) {
+        closeSocket(s);
+        return false;
+    }
+
+    // receive()가 막히지 않게 한다.
+#ifdef _WIN32
+    u_long nonBlocking = 1;
+    bool ok = ioctlsocket((SOCKET)s, FIONBIO, &nonBlocking) == 0;
+#else
+    bool ok = fcntl((int)s, F_SETFL, fcntl((int)s, F_GETFL, 0) | O_NONBLOCK) == 0;
+#endif
+    if (!ok) {
+        closeSocket(s);
+        return false;
+    }
+
+    m_socket = s;
+    m_numPeers = 0;
+    return true;
+}
+
+void CUdpTransport::close(void)
+{
+    if (m_socket != INVALID_NET_SOCKET) {
+        closeSocket(m_socket);
+        m_socket = INVALID_NET_SOCKET;
+    }
+}
+
+int CUdpTransport::findPeer(uint32_t address, uint16_t port)
+{
+    for (int i = 0; i < m_numPeers; i++) {
+        if (m_peerAddress[i] == address && m_peerPort[i] == port)
+            return i;
+    }
+    if (m_numPeers == NET_MAX_PEERS)
+        return -1;
+    m_peerAddress[m_numPeers] = address;
+    m_peerPort[m_numPeers] = port;
+    return m_numPeers++;
+}
+
+int CUdpTransport::addPeer(const char* host, uint16_t port)
+{
+    if (!startSockets())
+        return -1;
+
+    addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+    addrinfo* found = NULL;
+    if (getaddrinfo(host, NULL, &hints, &found) != 0 || found == NULL)
+        return -1;
+    uint32_t address = ((sockaddr_in*)found->ai_addr)->sin_addr.s_addr;
+    freeaddrinfo(found);
+    return findPeer(address, htons(port));
+}
+
+bool CUdpTransport::send(int peer, const void* data, int size)
+{
+    if (m_socket == INVALID_NET_SOCKET || peer < 0 || peer >= m_numPeers || size > NET_MAX_PACKET)
+        return false;
+
+    sockaddr_in to;
+    memset(&to, 0, sizeof(to));
+    to.sin_family = AF_INET;
+    to.sin_addr.s_addr = m_peerAddress[peer];
+    to.sin_port = m_peerPort[peer];
+    return sendto(m_socket, (const char*)data, size, 0, (sockaddr*)&to, sizeof(to)) == size;
+}
+
+int CUdpTransport::receive(int* peer, void* buffer, int capacity)
+{
+    if (m_socket == INVALID_NET_SOCKET)
+        return 0;
+
+    for (;;) {
+        sockaddr_in from;
+        socklen_t fromSize = sizeof(from);
+        int size = (int)recvfrom(m_socket, (char*)buffer, capacity, 0, (sockaddr*)&from, &fromSize);
+        if (size <= 0)
+            return 0;   // 받을 것이 없음 (또는 오류)
+
+        int id = findPeer(from.sin_addr.s_addr, from.sin_port);
+        if (id < 0)
+            continue;   // peer 자리가 없으면 버린다
+        *peer = id;
+        return size;
+    }
+}
+
+// -----------------------------------------------------------------------------
+// loopback
+// -----------------------------------------------------------------------------
+
+CLoopbackHub::CLoopbackHub(void)
+    : m_count(0), m_delay(0), m_dropEvery(0), m_posted(0)
+{
+}
+
+void CLoopbackHub::setConditions(int delay, int dropEvery)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_delay = delay;
+    m_dropEvery = dropEvery;
+}
+
+void CLoopbackHub::deliver(void)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    for (int i = 0; i < m_count; i++) {
+        if (m_queue[i].wait > 0)
+            m_queue[i].wait--;
+    }
+}
+
+bool CLoopbackHub::post(int from, int to, const void* data, int size)
+{
+    if (size > NET_MAX_PACKET)
+        return false;
+
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_posted++;
+    if (m_dropEvery > 0 && m_posted % m_dropEvery == 0)
+        return true;    // 보낸 쪽은 손실을 모른다
+    if (m_count == LOOPBACK_QUEUE)
+        return false;
+
+    Packet& p = m_queue[m_count++];
+    p.from = from;
+    p.to = to;
+    p.size = size;
+    p.wait = m_delay;
+    memcpy(p.data, data, size);
+    return true;
+}
+
+int CLoopbackHub::take(int to, int* from, void* buffer, int capacity)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    for (int i = 0; i < m_count; i++) {
+        Packet& p = m_queue[i];
+        if (p.to != to || p.wait > 0)
+            continue;
+
+        int size = p.size < capacity ? p.size : capacity;
+        memcpy(buffer, p.data, size);
+        *from = p.from;
+
+        // 보낸 순서를 지키도록 뒤를 당긴다.
+        for (int j = i + 1; j < m_count; j++)
+            m_queue[j - 1] = m_queue[j];
+        m_count--;
+        return size;
+    }
+    return 0;
+}
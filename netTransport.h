@@ -0,0 +1,115 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: netTransport.h
+//
+// Desc: 네트워크 대전에서 packet을 주고받는 통로.
+//       CNetTransport는 작은 datagram을 peer 번호로 보내고 받는 interface이다.
+//       둘 다 막히지 않으며, 순서가 바뀌거나 packet이 없어질 수 있다고 가정한다.
+//
+//       - CUdpTransport: UDP socket. 처음 packet을 보낸 주소는 새 peer 번호를 받는다.
+//       - CLoopbackHub / CLoopbackTransport: 한 process 안의 endpoint끼리 잇는 대역.
+//         시험에서 지연과 손실을 흉내 낼 수 있다.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __netTransportH__
+#define __netTransportH__
+
+#include <stdint.h>
+#include <mutex>
+
+const int NET_MAX_PACKET = 1024;
+const int NET_MAX_PEERS = 8;
+
+class CNetTransport {
+public:
+    virtual ~CNetTransport(void) {}
+
+    // 보낼 수 없으면 false (packet 크기 초과, 없는 peer 등)
+    virtual bool send(int peer, const void* data, int size) = 0;
+
+    // 받은 packet 하나를 buffer에 채우고 크기를 돌려준다. 없으면 0.
+    virtual int receive(int* peer, void* buffer, int capacity) = 0;
+};
+
+// -----------------------------------------------------------------------------
+// UDP
+// -----------------------------------------------------------------------------
+
+class CUdpTransport : public CNetTransport {
+public:
+    CUdpTransport(void);
+    virtual ~CUdpTransport(void);
+
+    // port에 묶는다. 0이면 아무 port나 쓴다.
+    bool open(uint16_t port);
+    void close(void);
+
+    // 보낼 상대를 등록하고 peer 번호를 돌려준다. 실패하면 -1.
+    int addPeer(const char* host, uint16_t port);
+
+    virtual bool send(int peer, const void* data, int size);
+    virtual int receive(int* peer, void* buffer, int capacity);
+
+private:
+    CUdpTransport(const CUdpTransport&);
+    CUdpTransport& operator=(const CUdpTransport&);
+
+    int findPeer(uint32_t address, uint16_t port);
+
+    intptr_t m_socket;
+    uint32_t m_peerAddress[NET_MAX_PEERS];  // network byte order
+    uint16_t m_peerPort[NET_MAX_PEERS];
+    int      m_numPeers;
+};
+
+// -----------------------------------------------------------------------------
+// 한 process 안의 loopback
+// -----------------------------------------------------------------------------
+
+const int LOOPBACK_QUEUE = 256;
+
+class CLoopbackHub {
+public:
+    CLoopbackHub(void);
+
+    // 보낸 packet이 delay번의 deliver() 뒤에 도착하고, dropEvery번째마다 하나씩 없어진다.
+    // (0이면 지연/손실 없음)
+    void setConditions(int delay, int dropEvery);
+
+    // 지연 중인 packet의 남은 시간을 하나 줄인다. 시험 loop에서 한 번씩 부른다.
+    void deliver(void);
+
+    bool post(int from, int to, const void* data, int size);
+    int take(int to, int* from, void* buffer, int capacity);
+
+private:
+    struct Packet {
+        int  from, to;
+        int  size;
+        int  wait;
+        char data[NET_MAX_PACKET];
+    };
+
+    std::mutex m_lock;
+    Packet     m_queue[LOOPBACK_QUEUE];
+    int        m_count;
+    int        m_delay;
+    int        m_dropEvery;
+    unsigned   m_posted;
+};
+
+// hub의 endpoint 하나. peer 번호는 상대 endpoint 번호이다.
+class CLoopbackTransport : public CNetTransport {
+public:
+    CLoopbackTransport(CLoopbackHub& hub, int endpoint) : m_hub(hub), m_endpoint(endpoint) {}
+
+    virtual bool send(int peer, const void* data, int size) { return m_hub.post(m_endpoint, peer, data, size); }
+    virtual int receive(int* peer, void* buffer, int capacity) { return m_hub.take(m_endpoint, peer, buffer, capacity); }
+
+private:
+    CLoopbackHub& m_hub;
+    int           m_endpoint;
+};
+
+#endif // __netTransportH__
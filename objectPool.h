@@ -0,0 +1,76 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: objectPool.h
+//
+// Desc: 오래 사는 객체를 위한 고정 크기 object pool.
+//       CObjectPool은 capacity개의 칸을 만들 때 한 번에 잡아 두고 free list로 나누어 준다.
+//       빈 칸이 없으면 NULL을 돌려준다 (heap으로 넘어가지 않는다).
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __objectPoolH__
+#define __objectPoolH__
+
+#include <stddef.h>
+#include <new>
+
+template<class T>
+class CObjectPool {
+public:
+    explicit CObjectPool(int capacity)
+        : m_capacity(capacity), m_used(0)
+    {
+        m_storage = static_cast<Slot*>(::operator new(sizeof(Slot) * capacity));
+        m_free = new int[capacity];
+        for (int i = 0; i < capacity; i++)
+            m_free[i] = capacity - 1 - i;
+    }
+
+    ~CObjectPool(void)
+    {
+        // 아직 돌려받지 않은 객체의 소멸자는 부르지 않는다. 쓰는 쪽이 먼저 release한다.
+        ::operator delete(m_storage);
+        delete[] m_free;
+    }
+
+    // 빈 칸이 없으면 NULL
+    T* allocate(void)
+    {
+        if (m_used == m_capacity)
+            return NULL;
+        int index = m_free[m_capacity - 1 - m_used];
+        m_used++;
+        return new (&m_storage[index]) T();
+    }
+
+    void release(T* object)
+    {
+        if (object == NULL)
+            return;
+        object->~T();
+        int index = (int)(reinterpret_cast<Slot*>(object) - m_storage);
+        m_free[m_capacity - m_used] = index;
+        m_used--;
+    }
+
+    int capacity(void) const { return m_capacity; }
+    int used(void) const { return m_used; }
+
+private:
+    CObjectPool(const CObjectPool&);
+    CObjectPool& operator=(const CObjectPool&);
+
+    union Slot {
+        char   bytes[sizeof(T)];
+        double alignDouble;
+        void*  alignPointer;
+        long long alignLong;
+    };
+
+    Slot* m_storage;
+    int*  m_free;       // m_free[0 .. capacity - used) 가 빈 칸 번호
+    int   m_capacity;
+    int   m_used;
+};
+
+#endif // __objectPoolH__
@@ -0,0 +1,173 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: physicsParams.cpp
+//
+// Desc: 물리 계수 파일 읽기/쓰기와 현재 계수 관리.
+//
+// 파일 형식 (한 줄에 하나, '#' 뒤는 주석):
+//     time_scale          <값>
+//     roll_decay          <값>
+//     roll_resistance     <값>
+//     slide_friction      <값>
+//     spin_friction       <값>
+//     cushion_friction    <값>
+//     cushion_restitution <값>
+//     ball_restitution    <값>
+//     clock_rate          <값>
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "physicsParams.h"
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+// 예전 ballUpdate는 프레임마다 속도에 DECREASE_RATE를 곱했다 (dt * 400 프레임 기준).
+// 구름 감속의 속도 비례 부분은 그 감쇠율이다.
+#define DECREASE_RATE 0.9982
+
+namespace
+{
+    const float  ROLL_DECAY = (float)((1 - DECREASE_RATE) * 400);
+    // 예전에 공을 멈춘 것으로 보던 속력 (0.01)에서 감쇠와 저항이 같아지도록 정함
+    const float  STOP_SPEED = 0.01f;
+
+    const PhysicsParams DEFAULT_PARAMS = {
+        3.3f,                       // timeScale
+        ROLL_DECAY,                 // rollDecay
+        ROLL_DECAY * STOP_SPEED,    // rollResistance
+        5.0f,                       // slideFriction: 미끄러짐 속도는 7/2 * 이 비율로 줄어든다
+        1.0f,                       // spinFriction
+        0.2f,                       // cushionFriction: english가 반사각을 바꾸는 정도
+        1.0f,                       // cushionRestitution
+        0.95f,                      // ballRestitution
+        0.7f,                       // clockRate: EnterMsgLoop의 ms * 0.0007
+    };
+
+    const PhysicsParamInfo PARAM_INFO[PHYSICS_PARAM_COUNT] = {
+        { "time_scale",          &PhysicsParams::timeScale,          0.1f,   20.0f },
+        { "roll_decay",          &PhysicsParams::rollDecay,          1e-3f,  10.0f },
+        { "roll_resistance",     &PhysicsParams::rollResistance,     1e-5f,  1.0f },
+        { "slide_friction",      &PhysicsParams::slideFriction,      0.05f,  100.0f },
+        { "spin_friction",       &PhysicsParams::spinFriction,       1e-3f,  100.0f },
+        { "cushion_friction",    &PhysicsParams::cushionFriction,    0.0f,   1.0f },
+        { "cushion_restitution", &PhysicsParams::cushionRestitution, 0.1f,   1.0f },
+        { "ball_restitution",    &PhysicsParams::ballRestitution,    0.1f,   1.0f },
+        { "clock_rate",          &PhysicsParams::clockRate,          0.01f,  10.0f },
+    };
+
+    PhysicsParams s_active = DEFAULT_PARAMS;
+
+    bool readFile(const char* path, std::string* out)
+    {
+        FILE* file = fopen(path, "rb");
+        if (file == NULL)
+            return false;
+        char buffer[4096];
+        size_t n;
+        out->clear();
+        while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0)
+            out->append(buffer, n);
+        fclose(file);
+        return true;
+    }
+}
+
+const PhysicsParamInfo& physicsParamInfo(int index)
+{
+    return PARAM_INFO[index];
+}
+
+const PhysicsParams& defaultPhysicsParams(void)
+{
+    return DEFAULT_PARAMS;
+}
+
+bool parsePhysicsParams(const char* source, PhysicsParams* out, char* error, int errorSize)
+{
+    PhysicsParams params = DEFAULT_PARAMS;
+
+    int lineNumber = 0;
+    const char* p = source;
+    while (*p != '\0') {
+        // 한 줄 복사 (주석과 개행 제거)
+        char line[256];
+        int length = 0;
+        while (*p != '\0' && *p != '\n') {
+            if (length < (int)sizeof(line) - 1) line[length++] = *p;
+            p++;
+        }
+        if (*p == '\n') p++;
+        line[length] = '\0';
+        lineNumber++;
+
+        char* comment = strchr(line, '#');
+        if (comment != NULL) *comment = '\0';
+
+        char key[32];
+        int consumed = 0;
+        if (sscanf(line, "%31s%n", key, &consumed) != 1)
+            continue;
+
+        int index = 0;
+        while (index < PHYSICS_PARAM_COUNT && strcmp(PARAM_INFO[index].key, key) != 0)
+            index++;
+        if (index == PHYSICS_PARAM_COUNT) {
+            snprintf(error, errorSize, "%d: unknown key '%s'", lineNumber, key);
+            return false;
+        }
+
+        const PhysicsParamInfo& info = PARAM_INFO[index];
+        float value;
+        if (sscanf(line + consumed, "%f", &value) != 1) {
+            snprintf(error, errorSize, "%d: wrong number of values", lineNumber);
+            return false;
+        }
+        if (!(value >= info.minValue && value <= info.maxValue)) {
+            snprintf(error, errorSize, "%d: %s must be in [%g, %g]", lineNumber, key, info.minValue, info.maxValue);
+            return false;
+        }
+        params.*info.member = value;
+    }
+
+    *out = params;
+    return true;
+}
+
+bool loadPhysicsParams(const char* path, PhysicsParams* out, char* error, int errorSize)
+{
+    std::string source;
+    if (!readFile(path, &source)) {
+        snprintf(error, errorSize, "%s: cannot open", path);
+        return false;
+    }
+
+    char reason[200];
+    if (!parsePhysicsParams(source.c_str(), out, reason, sizeof(reason))) {
+        snprintf(error, errorSize, "%s: %s", path, reason);
+        return false;
+    }
+    return true;
+}
+
+bool savePhysicsParams(const char* path, const PhysicsParams& params, const char* comment)
+{
+    FILE* file = fopen(path, "w");
+    if (file == NULL)
+        return false;
+    if (comment != NULL)
+        fprintf(file, "# %s\n", comment);
+    for (int i = 0; i < PHYSICS_PARAM_COUNT; i++)
+        fprintf(file, "%-20s %.9g\n", PARAM_INFO[i].key, params.*PARAM_INFO[i].member);
+    return fclose(file) == 0;
+}
+
+void setActivePhysics(const PhysicsParams& params)
+{
+    s_active = params;
+}
+
+const PhysicsParams& activePhysics(void)
+{
+    return s_active;
+}
@@ -0,0 +1,54 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: physicsParams.h
+//
+// Desc: 실측 궤적에 맞춰 조정할 수 있는 물리 계수 (마찰, 반발, 시간 배율).
+//       예전에는 손으로 고른 상수(DECREASE_RATE, TIME_SCALE, ballUpdate의 400,
+//       EnterMsgLoop의 0.0007)였다. 물리 코어는 activePhysics()의 값만 사용하고,
+//       게임은 시작할 때 physics.params가 있으면 읽는다 (tools/physicsFit이 쓴다).
+//
+//       lockstep 대전에서는 양쪽이 같은 파일을 써야 한다 (다르면 checksum이 어긋난다).
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __physicsParamsH__
+#define __physicsParamsH__
+
+struct PhysicsParams {
+    float timeScale;            // 위치가 움직이는 배율 (위치 += timeScale * v * t)
+    float rollDecay;            // 구름 감속 중 속도에 비례하는 부분 (1/s)
+    float rollResistance;       // 구름 감속 중 일정한 부분 (속도/s)
+    float slideFriction;        // 미끄러짐 마찰 (속도/s)
+    float spinFriction;         // 세로축 회전의 감쇠 (R * wy 기준, 속도/s)
+    float cushionFriction;      // 쿠션 접점의 마찰 계수
+    float cushionRestitution;   // 쿠션 반발 계수 (1: 완전 반사)
+    float ballRestitution;      // 공끼리의 반발 계수
+    float clockRate;            // 실제 1초에 진행하는 시뮬레이션 시간 (초)
+};
+
+// 파일의 key와 범위. 조정 도구는 이 표를 따라 계수를 하나씩 다룬다.
+struct PhysicsParamInfo {
+    const char* key;
+    float PhysicsParams::* member;
+    float minValue, maxValue;
+};
+
+const int PHYSICS_PARAM_COUNT = 9;
+const char PHYSICS_PARAMS_FILE[] = "physics.params";
+
+const PhysicsParamInfo& physicsParamInfo(int index);
+
+// 손으로 고른 예전 값
+const PhysicsParams& defaultPhysicsParams(void);
+
+// "key value" 줄들을 읽는다 ('#' 뒤는 주석, 없는 key는 기본값).
+// 실패하면 error에 "줄: 이유"를 남기고 false.
+bool parsePhysicsParams(const char* source, PhysicsParams* out, char* error, int errorSize);
+bool loadPhysicsParams(const char* path, PhysicsParams* out, char* error, int errorSize);
+bool savePhysicsParams(const char* path, const PhysicsParams& params, const char* comment = 0);
+
+// 물리 코어가 사용하는 계수. 시뮬레이션이 진행 중이지 않을 때 바꾼다.
+void setActivePhysics(const PhysicsParams& params);
+const PhysicsParams& activePhysics(void);
+
+#endif // __physicsParamsH__
@@ -0,0 +1,344 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: referencePhysics.cpp
+//
+// Desc: double 기준 stepper 구현.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "referencePhysics.h"
+#include "contactSolver.h"
+#include "tableLayout.h"
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+    const double RADIUS = M_RADIUS;
+    const double SLIP_LIMIT = SLIP_EPSILON;
+
+    ReferenceBall toReference(const BallState& ball)
+    {
+        ReferenceBall r;
+        r.x = ball.x;
+        r.z = ball.z;
+        r.vx = ball.vx;
+        r.vz = ball.vz;
+        r.wx = ball.wx;
+        r.wy = ball.wy;
+        r.wz = ball.wz;
+        r.active = ball.active;
+        return r;
+    }
+
+    BallState toBallState(const ReferenceBall& r)
+    {
+        BallState ball;
+        memset(&ball, 0, sizeof(ball));
+        ball.active = r.active;
+        if (!r.active) {
+            pocketBall(ball);
+            return ball;
+        }
+        ball.x = (float)r.x;
+        ball.y = (float)RADIUS;
+        ball.z = (float)r.z;
+        ball.vx = (float)r.vx;
+        ball.vz = (float)r.vz;
+        ball.wx = (float)r.wx;
+        ball.wy = (float)r.wy;
+        ball.wz = (float)r.wz;
+        return ball;
+    }
+
+    bool isMoving(const ReferenceBall& ball)
+    {
+        if (!ball.active) return false;
+        double ux = ball.vx + RADIUS * ball.wz, uz = ball.vz - RADIUS * ball.wx;
+        return sqrt(ux * ux + uz * uz) > SLIP_LIMIT || ball.vx != 0.0 || ball.vz != 0.0;
+    }
+
+    // -------------------------------------------------------------------------
+    // 운동 (billiardPhysics.cpp의 닫힌 해를 double로)
+    // -------------------------------------------------------------------------
+
+    void slide(ReferenceBall& ball, double dx, double dz, double t)
+    {
+        const double f = activePhysics().slideFriction, scale = activePhysics().timeScale;
+        ball.x += (ball.vx * t - dx * 0.5 * f * t * t) * scale;
+        ball.z += (ball.vz * t - dz * 0.5 * f * t * t) * scale;
+        ball.vx -= dx * f * t;
+        ball.vz -= dz * f * t;
+        ball.wx += 2.5 * f * dz * t / RADIUS;
+        ball.wz -= 2.5 * f * dx * t / RADIUS;
+    }
+
+    void roll(ReferenceBall& ball, double t)
+    {
+        double speed = sqrt(ball.vx * ball.vx + ball.vz * ball.vz);
+        if (speed > 0.0) {
+            const PhysicsParams& params = activePhysics();
+            const double D = params.rollDecay, k = (double)params.rollResistance / params.rollDecay;
+            double stop = log1p(speed / k) / D;
+            double tt = t < stop ? t : stop;
+            double distance = params.timeScale * ((speed + k) * -expm1(-D * tt) / D - k * tt);
+            double next = t < stop ? (speed + k) * exp(-D * t) - k : 0.0;
+            double dx = ball.vx / speed, dz = ball.vz / speed;
+            ball.x += dx * distance;
+            ball.z += dz * distance;
+            ball.vx = dx * next;
+            ball.vz = dz * next;
+        }
+        ball.wx = ball.vz / RADIUS;
+        ball.wz = -ball.vx / RADIUS;
+    }
+
+    void advance(ReferenceBall& ball, double t)
+    {
+        double drop = activePhysics().spinFriction * t / RADIUS;
+        if (ball.wy > drop) ball.wy -= drop;
+        else if (ball.wy < -drop) ball.wy += drop;
+        else ball.wy = 0.0;
+
+        double ux = ball.vx + RADIUS * ball.wz, uz = ball.vz - RADIUS * ball.wx;
+        double slip = sqrt(ux * ux + uz * uz);
+        if (slip > SLIP_LIMIT) {
+            double slideEnd = slip * 2.0 / (7.0 * activePhysics().slideFriction);
+            if (t < slideEnd) {
+                slide(ball, ux / slip, uz / slip, t);
+                return;
+            }
+            slide(ball, ux / slip, uz / slip, slideEnd);
+            t -= slideEnd;
+        }
+        roll(ball, t);
+    }
+
+    // -------------------------------------------------------------------------
+    // 쿠션과 포켓 (쿠션 다각형까지의 정확한 거리)
+    // -------------------------------------------------------------------------
+
+    // 플레이 영역 안쪽이 +인 거리와 안쪽을 향하는 법선
+    double cushionDistance(const TableLayout& table, double px, double pz, double* nx, double* nz)
+    {
+        double best = DBL_MAX, qx = px, qz = pz;
+        bool inside = false;
+        for (int s = 0; s < table.numSegments; s++) {
+            const CushionSegment& seg = table.segments[s];
+            double ax = seg.x0, az = seg.z0, bx = seg.x1, bz = seg.z1;
+            double ex = bx - ax, ez = bz - az;
+            double len = ex * ex + ez * ez;
+            double u = len > 0.0 ? ((px - ax) * ex + (pz - az) * ez) / len : 0.0;
+            u = u < 0.0 ? 0.0 : u > 1.0 ? 1.0 : u;
+            double cx = ax + ex * u, cz = az + ez * u;
+            double d = (px - cx) * (px - cx) + (pz - cz) * (pz - cz);
+            if (d < best) {
+                best = d;
+                qx = cx;
+                qz = cz;
+            }
+            // 짝수-홀수 규칙으로 안쪽인지 센다 (tableField와 같은 판정).
+            if ((az > pz) != (bz > pz)) {
+                double x = ax + (pz - az) * (bx - ax) / (bz - az);
+                if (px < x) inside = !inside;
+            }
+        }
+        double d = sqrt(best);
+        double sign = inside ? 1.0 : -1.0;
+        if (d > 0.0) {
+            *nx = sign * (px - qx) / d;
+            *nz = sign * (pz - qz) / d;
+        }
+        else {
+            *nx = *nz = 0.0;
+        }
+        return sign * d;
+    }
+
+    // bounceOffCushion과 같은 반사와 쿠션 마찰
+    bool bounce(ReferenceBall& ball, double distance, double nx, double nz)
+    {
+        if (distance >= RADIUS)
+            return false;
+        ball.x += nx * (RADIUS - distance);
+        ball.z += nz * (RADIUS - distance);
+
+        double vn = ball.vx * nx + ball.vz * nz;
+        if (vn >= 0.0)
+            return false;
+        double impulse = (1.0 + activePhysics().cushionRestitution) * -vn;
+        double vx = ball.vx + nx * impulse, vz = ball.vz + nz * impulse;
+
+        // perp(normal) = (-nz, nx)
+        double tx = -nz, tz = nx;
+        double slip = vx * tx + vz * tz + RADIUS * ball.wy;
+        double limit = activePhysics().cushionFriction * impulse;
+        double dv = -slip * 2.0 / 7.0;
+        if (dv > limit) dv = limit;
+        else if (dv < -limit) dv = -limit;
+        ball.vx = vx + tx * dv;
+        ball.vz = vz + tz * dv;
+        ball.wy += 2.5 * dv / RADIUS;
+        return true;
+    }
+
+    // -------------------------------------------------------------------------
+    // 공끼리의 접촉: 모든 접촉을 함께 수렴할 때까지
+    // -------------------------------------------------------------------------
+
+    struct Contact {
+        int    a, b;
+        double nx, nz;
+        double target;
+        double impulse;
+    };
+
+    // 큐볼과 닿은 공 중 가장 번호가 작은 공, 없으면 -1
+    int resolveContacts(ReferenceBall* balls)
+    {
+        const double diameter = 2.0 * RADIUS;
+        Contact contacts[NUM_BALLS * (NUM_BALLS - 1) / 2];
+        int numContacts = 0;
+        int cueContact = -1;
+
+        for (int a = 0; a < NUM_BALLS; a++) {
+            if (!balls[a].active) continue;
+            for (int b = a + 1; b < NUM_BALLS; b++) {
+                if (!balls[b].active) continue;
+                double dx = balls[a].x - balls[b].x, dz = balls[a].z - balls[b].z;
+                double distSq = dx * dx + dz * dz;
+                if (distSq > diameter * diameter || distSq <= 0.0) continue;
+                double d = sqrt(distSq);
+                Contact& c = contacts[numContacts++];
+                c.a = a;
+                c.b = b;
+                c.nx = dx / d;
+                c.nz = dz / d;
+                double vn = (balls[a].vx - balls[b].vx) * c.nx + (balls[a].vz - balls[b].vz) * c.nz;
+                c.target = vn < -RESTITUTION_SLOP ? -activePhysics().ballRestitution * vn : 0.0;
+                c.impulse = 0.0;
+                if (a == CUE_BALL && cueContact < 0) cueContact = b;
+            }
+        }
+
+        for (int iteration = 0; iteration < REFERENCE_SOLVER_ITERATIONS && numContacts > 0; iteration++) {
+            double change = 0.0;
+            for (int k = 0; k < numContacts; k++) {
+                Contact& c = contacts[k];
+                ReferenceBall& a = balls[c.a];
+                ReferenceBall& b = balls[c.b];
+                double vn = (a.vx - b.vx) * c.nx + (a.vz - b.vz) * c.nz;
+                double next = c.impulse + (c.target - vn) * 0.5;
+                if (next < 0.0) next = 0.0;
+                double delta = next - c.impulse;
+                c.impulse = next;
+                a.vx += c.nx * delta;
+                a.vz += c.nz * delta;
+                b.vx -= c.nx * delta;
+                b.vz -= c.nz * delta;
+                change = fmax(change, fabs(delta));
+            }
+            if (change < REFERENCE_SOLVER_TOLERANCE)
+                break;
+        }
+
+        // 겹친 만큼 반씩 밀어낸다 (겹침이 남지 않을 때까지).
+        for (int pass = 0; pass < 64; pass++) {
+            bool moved = false;
+            for (int k = 0; k < numContacts; k++) {
+                ReferenceBall& a = balls[contacts[k].a];
+                ReferenceBall& b = balls[contacts[k].b];
+                double dx = a.x - b.x, dz = a.z - b.z;
+                double d = sqrt(dx * dx + dz * dz);
+                if (d >= diameter || d <= 0.0) continue;
+                double push = (diameter - d) * 0.5 / d;
+                a.x += dx * push;
+                a.z += dz * push;
+                b.x -= dx * push;
+                b.z -= dz * push;
+                moved = true;
+            }
+            if (!moved) break;
+        }
+        return cueContact;
+    }
+}
+
+double ballEnergy(const BallState& ball)
+{
+    if (!ball.active)
+        return 0.0;
+    double v2 = (double)ball.vx * ball.vx + (double)ball.vz * ball.vz;
+    double w2 = (double)ball.wx * ball.wx + (double)ball.wy * ball.wy + (double)ball.wz * ball.wz;
+    return 0.5 * v2 + 0.2 * RADIUS * RADIUS * w2;
+}
+
+ShotOutcome referenceShot(const TableState& start, float aim, float power,
+    float tipSide, float tipHeight, double step)
+{
+    ShotOutcome outcome;
+    memset(&outcome, 0, sizeof(outcome));
+    outcome.firstContact = -1;
+
+    // 큐를 치는 순간은 게임과 같은 float 식으로 만든다 (두 경로의 출발점이 같도록).
+    BallState cue = start.balls[CUE_BALL];
+    strikeCueBall(cue, aim, power, tipSide, tipHeight);
+
+    ReferenceBall balls[NUM_BALLS];
+    for (int i = 0; i < NUM_BALLS; i++)
+        balls[i] = toReference(i == CUE_BALL ? cue : start.balls[i]);
+
+    const TableLayout& table = activeTable();
+    double time = 0.0;
+    bool moving = true;
+    while (moving && time < REFERENCE_MAX_TIME) {
+        for (int i = 0; i < NUM_BALLS; i++) {
+            ReferenceBall& ball = balls[i];
+            if (!ball.active) continue;
+            advance(ball, step);
+
+            bool pocketed = false;
+            for (int p = 0; p < table.numPockets && !pocketed; p++) {
+                const PocketCircle& pocket = table.pockets[p];
+                double dx = ball.x - pocket.x, dz = ball.z - pocket.z;
+                pocketed = sqrt(dx * dx + dz * dz) - pocket.radius <= 0.0;
+            }
+            if (pocketed) {
+                ball.active = false;
+                ball.vx = ball.vz = ball.wx = ball.wy = ball.wz = 0.0;
+                outcome.pocketed |= 1u << i;
+                continue;
+            }
+
+            double nx, nz;
+            double distance = cushionDistance(table, ball.x, ball.z, &nx, &nz);
+            if (bounce(ball, distance, nx, nz))
+                outcome.cushionHits++;
+        }
+
+        int contact = resolveContacts(balls);
+        if (outcome.firstContact < 0)
+            outcome.firstContact = contact;
+
+        time += step;
+        moving = false;
+        for (int i = 0; i < NUM_BALLS && !moving; i++)
+            moving = isMoving(balls[i]);
+    }
+    outcome.steps = (int)ceil(time / SIM_FIXED_STEP);
+
+    for (int i = 0; i < NUM_BALLS; i++)
+        outcome.finalBalls[i] = toBallState(balls[i]);
+
+    bool solidIn = false, stripeIn = false;
+    for (int i = 0; i < NUM_BALLS; i++) {
+        if (!(outcome.pocketed & (1u << i))) continue;
+        solidIn = solidIn || isSolidBall(i);
+        stripeIn = stripeIn || isStripeBall(i);
+    }
+    outcome.scratch = (outcome.pocketed & (1u << CUE_BALL)) != 0;
+    outcome.foul = isFoul(start.rules.break_shot, solidIn, stripeIn, outcome.scratch, outcome.cushionHits) ||
+        !isLegalFirstContact(start.rules, outcome.firstContact);
+    return outcome;
+}
@@ -0,0 +1,40 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: referencePhysics.h
+//
+// Desc: 빠른 물리 경로(큰 step, 닫힌 해 건너뛰기, 고정 소수점 등)를 검증하기 위한 기준 stepper.
+//       게임과 같은 운동 모델(미끄러짐 -> 구름, 세로축 회전 감쇠, 쿠션 반사와 마찰,
+//       반발 계수와 RESTITUTION_SLOP)을 double로 아주 작은 고정 간격마다 진행한다.
+//       - 이동은 단계마다의 닫힌 해를 double로 계산한다.
+//       - 쿠션은 table field 대신 쿠션 다각형까지의 정확한 거리로, 포켓은 포획 원으로 판정한다.
+//       - 동시에 닿은 공들의 접촉은 solver와 같은 목표 분리 속도로 수렴할 때까지 푼다.
+//       빠르게 만들 생각이 없는 코드이므로 분기와 반복이 단순하다.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __referencePhysicsH__
+#define __referencePhysicsH__
+
+#include "billiardPhysics.h"
+
+const double REFERENCE_STEP = 1e-4;             // 기본 간격 (SIM_FIXED_STEP의 약 1/100)
+const double REFERENCE_MAX_TIME = 60.0;         // 이 시간 안에 멈추지 않으면 멈춘다
+const int    REFERENCE_SOLVER_ITERATIONS = 1000;
+const double REFERENCE_SOLVER_TOLERANCE = 1e-12;
+
+struct ReferenceBall {
+    double x, z;
+    double vx, vz;
+    double wx, wy, wz;
+    bool   active;
+};
+
+// start에서 샷을 쳐 모든 공이 멈출 때까지 진행한다 (simulateShot과 같은 결과 형식).
+// outcome.steps에는 SIM_FIXED_STEP으로 센 진행 시간을 담는다.
+ShotOutcome referenceShot(const TableState& start, float aim, float power,
+    float tipSide, float tipHeight, double step = REFERENCE_STEP);
+
+// 공 하나의 운동 에너지 (질량 1): 병진 1/2 v^2 + 회전 1/5 (R w)^2
+double ballEnergy(const BallState& ball);
+
+#endif // __referencePhysicsH__
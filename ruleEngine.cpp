@@ -0,0 +1,201 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: ruleEngine.cpp
+//
+// Desc: 사건 기반 8-ball 규칙 상태 기계 구현.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "ruleEngine.h"
+#include <cstring>
+
+CRuleEngine::CRuleEngine(void)
+{
+    reset(NULL, 0);
+}
+
+void CRuleEngine::reset(const BallState* balls, int count)
+{
+    m_phase = RULE_AIMING;
+    m_rules.turn = true;
+    m_rules.group = true;
+    m_rules.open = true;
+    m_rules.break_shot = true;
+    m_rules.free_shot = false;
+    m_rules.solid_num = m_rules.stripe_num = 0;
+    for (int i = 0; i < count; i++) {
+        if (!balls[i].active) continue;
+        if (isSolidBall(i)) m_rules.solid_num++;
+        if (isStripeBall(i)) m_rules.stripe_num++;
+    }
+    m_shotRules = m_rules;
+    m_win = 0;
+    m_lastFoul = false;
+    clearTally();
+}
+
+void CRuleEngine::clearTally(void)
+{
+    memset(&m_tally, 0, sizeof(m_tally));
+    m_tally.firstContact = -1;
+}
+
+void CRuleEngine::switchTurn(void)
+{
+    m_rules.turn = !m_rules.turn;
+    m_rules.group = !m_rules.group;
+}
+
+void CRuleEngine::onEvent(const PhysicsEvent& event)
+{
+    switch (event.type) {
+    case EVENT_SHOT_STARTED:
+        if (m_phase == RULE_AIMING) {
+            m_phase = RULE_SHOT;
+            m_shotRules = m_rules;
+        }
+        break;
+    case EVENT_CUSHION_HIT:
+        if (m_phase == RULE_SHOT)
+            m_tally.cushions++;
+        break;
+    case EVENT_FIRST_CONTACT:
+        if (m_phase == RULE_SHOT && m_tally.firstContact < 0)
+            m_tally.firstContact = event.b;
+        break;
+    case EVENT_POCKETED:
+        onPocketed(event.a);
+        break;
+    case EVENT_ALL_STOPPED:
+        if (m_phase == RULE_SHOT)
+            endShot();
+        break;
+    default:
+        break;
+    }
+}
+
+void CRuleEngine::onPocketed(int ball)
+{
+    if (ball == CUE_BALL) {
+        m_tally.whiteIn = true;
+        // free ball을 놓는 과정에서 큐볼이 구멍에 들어가면 샷이 없어도 foul이므로
+        // 턴이 넘어가고 다시 free shot이 주어진다.
+        if (m_phase != RULE_SHOT && !m_rules.free_shot) {
+            m_rules.free_shot = true;
+            switchTurn();
+        }
+    }
+    else if (isSolidBall(ball)) {
+        m_tally.solidIn = true;
+        m_rules.solid_num--;
+    }
+    else if (ball == EIGHT_BALL) {
+        m_tally.blackIn = true;
+    }
+    else if (isStripeBall(ball)) {
+        m_tally.stripeIn = true;
+        m_rules.stripe_num--;
+    }
+}
+
+// 공이 모두 멈춘 뒤 게임의 종료, 파울 여부, 턴의 전환, 공의 그룹 할당을 판단한다.
+void CRuleEngine::endShot(void)
+{
+    m_phase = RULE_AIMING;
+    m_lastFoul = foul();
+    if (m_tally.blackIn) {
+        m_win = result();
+        m_phase = RULE_GAME_OVER;
+        return;
+    }
+    nextShot();
+}
+
+// 일반적인 foul과 최초 샷의 경우에만 해당하는 foul, 그리고 첫 접촉이 자기 그룹이 아닌 경우
+bool CRuleEngine::foul(void) const
+{
+    return isFoul(m_shotRules.break_shot, m_tally.solidIn, m_tally.stripeIn, m_tally.whiteIn, m_tally.cushions) ||
+        !isLegalFirstContact(m_shotRules, m_tally.firstContact);
+}
+
+// 다음 샷에서의 turn에 관한 값을 할당.
+void CRuleEngine::nextShot(void)
+{
+    if (m_lastFoul) {
+        switchTurn();
+        m_rules.free_shot = true; // free_shot 수행 이후엔 다시 false가 되어야 함.
+    }
+    else {
+        if (m_tally.stripeIn || m_tally.solidIn) {
+            if (m_rules.open) {
+                // 플레이어가 쳐야만 하는 공의 종류가 없기에 공이 들어가기만 하면, 턴 전환이 일어나지 않음
+                // break_shot 직후에는 open 상태여야 하기 때문에 group의 할당을 하지 않음.
+                if (!m_rules.break_shot) {
+                    if (m_tally.solidIn && m_tally.stripeIn) {
+                        m_phase = RULE_SELECT_GROUP;
+                    }
+                    else {
+                        m_rules.group = m_tally.solidIn;
+                        m_rules.open = false;
+                    }
+                }
+            }
+            else {
+                // 플레이어가 쳐야하는 공과 들어간 공의 종류가 다르면 턴 전환이 발생함
+                if ((m_tally.solidIn && !m_tally.stripeIn && !m_rules.group) ||
+                    (!m_tally.solidIn && m_tally.stripeIn && m_rules.group)) {
+                    switchTurn();
+                }
+            }
+        }
+        // foul이 없는 상태에서 어떤 공도 들어가지 않으면 턴이 전환됨
+        else {
+            switchTurn();
+        }
+    }
+    // 위의 판단 이후, 다음 shot 직후의 판단을 위한 초기화
+    clearTally();
+    m_rules.break_shot = false;
+}
+
+// 게임의 승패를 판단함. 1: player 1 승리, 2: player 2 승리
+int CRuleEngine::result(void) const
+{
+    if (m_rules.open)
+        return m_rules.turn ? 2 : 1;
+
+    // 자기 그룹을 다 넣고 상대 공이나 큐볼을 넣지 않았어야 현재 플레이어의 승리
+    bool cleared = m_rules.group
+        ? m_rules.solid_num == 0 && !m_tally.stripeIn && !m_tally.whiteIn
+        : m_rules.stripe_num == 0 && !m_tally.solidIn && !m_tally.whiteIn;
+    if (m_rules.turn)
+        return cleared ? 1 : 2;
+    return cleared ? 2 : 1;
+}
+
+void CRuleEngine::selectGroup(bool solid)
+{
+    if (m_phase != RULE_SELECT_GROUP)
+        return;
+    m_rules.group = solid;
+    m_rules.open = false;
+    m_phase = RULE_AIMING;
+    clearTally();
+}
+
+void CRuleEngine::placeCueBall(void)
+{
+    m_rules.free_shot = false;
+    m_tally.whiteIn = false;
+}
+
+void CRuleEngine::restore(const RuleState& rules, RulePhase phase, int winner, bool lastFoul)
+{
+    m_phase = phase == RULE_SHOT ? RULE_AIMING : phase;
+    m_rules = rules;
+    m_shotRules = rules;
+    m_win = winner;
+    m_lastFoul = lastFoul;
+    clearTally();
+}
@@ -0,0 +1,76 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: ruleEngine.h
+//
+// Desc: 물리 사건으로 진행하는 8-ball 규칙 상태 기계.
+//       매 frame 공을 훑는 대신 event bus에서 받은 사건만으로 샷 동안의 기록
+//       (들어간 공, 쿠션 횟수, 첫 접촉)을 모으고, 모든 공이 멈추면 foul, 턴 전환,
+//       그룹 배정, 승패를 한 번에 판단한다. D3D에 의존하지 않는다.
+//
+//       상태: 조준 -> (EVENT_SHOT_STARTED) 샷 진행 -> (EVENT_ALL_STOPPED) 판단 ->
+//             조준 / 그룹 선택 / 경기 종료
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __ruleEngineH__
+#define __ruleEngineH__
+
+#include "billiardPhysics.h"
+#include "eventBus.h"
+
+enum RulePhase {
+    RULE_AIMING,        // 다음 샷을 기다림 (free shot이면 큐볼 배치 중)
+    RULE_SHOT,          // 공이 움직이는 중
+    RULE_SELECT_GROUP,  // 두 그룹이 함께 들어가 다음 샷 전에 그룹을 골라야 함
+    RULE_GAME_OVER      // 8번 공이 들어감
+};
+
+// 샷 하나 동안 모은 기록
+struct ShotTally {
+    bool solidIn, stripeIn, whiteIn, blackIn;
+    int  cushions;
+    int  firstContact;  // 큐볼이 처음 맞힌 공, 없으면 -1
+};
+
+class CRuleEngine : public CEventListener {
+public:
+    CRuleEngine(void);
+
+    // 새 게임. 남아 있는 공으로 그룹별 개수를 센다.
+    void reset(const BallState* balls, int count);
+
+    virtual void onEvent(const PhysicsEvent& event);
+
+    // 그룹 선택 (RULE_SELECT_GROUP에서만)
+    void selectGroup(bool solid);
+    // free shot으로 큐볼을 다시 놓았음
+    void placeCueBall(void);
+    // 공이 멈춘 때의 규칙 값으로 맞춘다 (네트워크 snapshot을 받았을 때).
+    void restore(const RuleState& rules, RulePhase phase, int winner, bool lastFoul);
+
+    RulePhase phase(void) const { return m_phase; }
+    bool shotInProgress(void) const { return m_phase == RULE_SHOT; }
+    bool selectingGroup(void) const { return m_phase == RULE_SELECT_GROUP; }
+    const RuleState& rules(void) const { return m_rules; }
+    int  winner(void) const { return m_win; }       // 0: 없음, 1: player 1, 2: player 2
+    bool lastShotFoul(void) const { return m_lastFoul; }
+    const ShotTally& tally(void) const { return m_tally; }
+
+private:
+    void onPocketed(int ball);
+    void endShot(void);
+    bool foul(void) const;
+    void nextShot(void);
+    int  result(void) const;
+    void clearTally(void);
+    void switchTurn(void);
+
+    RulePhase m_phase;
+    RuleState m_rules;
+    RuleState m_shotRules;  // 샷을 시작할 때의 규칙 값 (첫 접촉 판정용)
+    ShotTally m_tally;
+    int       m_win;
+    bool      m_lastFoul;
+};
+
+#endif // __ruleEngineH__
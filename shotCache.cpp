@@ -0,0 +1,187 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: shotCache.cpp
+//
+// Desc: 샷 결과 transposition cache 구현.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "shotCache.h"
+#include "zobristHash.h"
+#include <cmath>
+
+CShotCache::CShotCache(size_t capacity)
+    : m_hits(0), m_misses(0), m_evictions(0)
+{
+    m_stripeCapacity = (capacity + NUM_STRIPES - 1) / NUM_STRIPES;
+    if (m_stripeCapacity == 0)
+        m_stripeCapacity = 1;
+
+    // bucket 수는 용량 이상인 2의 거듭제곱
+    size_t numBuckets = 1;
+    while (numBuckets < m_stripeCapacity)
+        numBuckets *= 2;
+
+    for (int i = 0; i < NUM_STRIPES; i++) {
+        Stripe& stripe = m_stripes[i];
+        stripe.pool = new CObjectPool<Entry>((int)m_stripeCapacity);
+        stripe.buckets = new Entry*[numBuckets];
+        stripe.bucketMask = numBuckets - 1;
+        for (size_t b = 0; b < numBuckets; b++)
+            stripe.buckets[b] = NULL;
+        stripe.head = stripe.tail = NULL;
+        stripe.size = 0;
+    }
+}
+
+CShotCache::~CShotCache(void)
+{
+    for (int i = 0; i < NUM_STRIPES; i++) {
+        clearStripe(m_stripes[i]);
+        delete m_stripes[i].pool;
+        delete[] m_stripes[i].buckets;
+    }
+}
+
+ShotKey CShotCache::makeKey(uint64_t stateHash, float aim, float power,
+    float tipSide, float tipHeight)
+{
+    const float TWO_PI = 6.28318531f;
+    float turns = aim / TWO_PI;
+    turns -= floorf(turns); // [0, 1)
+
+    ShotKey key;
+    key.state = stateHash;
+    key.aim = CZobristHash::quantize(turns * SHOT_AIM_STEPS, 1.0f) % SHOT_AIM_STEPS;
+    key.power = CZobristHash::quantize(power, SHOT_POWER_CELL);
+    key.tipSide = (int16_t)CZobristHash::quantize(tipSide, SHOT_TIP_CELL);
+    key.tipHeight = (int16_t)CZobristHash::quantize(tipHeight, SHOT_TIP_CELL);
+    return key;
+}
+
+CShotCache::Entry* CShotCache::find(const Stripe& stripe, const ShotKey& key, size_t hash)
+{
+    for (Entry* e = bucketFor(stripe, hash); e != NULL; e = e->chain) {
+        if (e->hash == hash && e->key == key)
+            return e;
+    }
+    return NULL;
+}
+
+void CShotCache::unlinkLru(Stripe& stripe, Entry* entry)
+{
+    if (entry->prev != NULL) entry->prev->next = entry->next;
+    else stripe.head = entry->next;
+    if (entry->next != NULL) entry->next->prev = entry->prev;
+    else stripe.tail = entry->prev;
+    entry->prev = entry->next = NULL;
+}
+
+void CShotCache::pushFront(Stripe& stripe, Entry* entry)
+{
+    entry->prev = NULL;
+    entry->next = stripe.head;
+    if (stripe.head != NULL) stripe.head->prev = entry;
+    stripe.head = entry;
+    if (stripe.tail == NULL) stripe.tail = entry;
+}
+
+void CShotCache::unlinkBucket(Stripe& stripe, Entry* entry)
+{
+    Entry** link = &bucketFor(stripe, entry->hash);
+    while (*link != entry)
+        link = &(*link)->chain;
+    *link = entry->chain;
+}
+
+void CShotCache::clearStripe(Stripe& stripe)
+{
+    Entry* e = stripe.head;
+    while (e != NULL) {
+        Entry* next = e->next;
+        unlinkBucket(stripe, e);
+        stripe.pool->release(e);
+        e = next;
+    }
+    stripe.head = stripe.tail = NULL;
+    stripe.size = 0;
+}
+
+bool CShotCache::lookup(const ShotKey& key, ShotOutcome* outcome)
+{
+    size_t hash = ShotKeyHash()(key);
+    Stripe& stripe = stripeFor(hash);
+    std::lock_guard<std::mutex> guard(stripe.lock);
+
+    Entry* found = find(stripe, key, hash);
+    if (found == NULL) {
+        m_misses++;
+        return false;
+    }
+
+    // 최근 사용 위치로 이동
+    unlinkLru(stripe, found);
+    pushFront(stripe, found);
+    *outcome = found->outcome;
+    m_hits++;
+    return true;
+}
+
+void CShotCache::insert(const ShotKey& key, const ShotOutcome& outcome)
+{
+    size_t hash = ShotKeyHash()(key);
+    Stripe& stripe = stripeFor(hash);
+    std::lock_guard<std::mutex> guard(stripe.lock);
+
+    Entry* found = find(stripe, key, hash);
+    if (found != NULL) {
+        found->outcome = outcome;
+        unlinkLru(stripe, found);
+        pushFront(stripe, found);
+        return;
+    }
+
+    // 용량을 넘으면 가장 오래 사용되지 않은 항목의 칸을 다시 쓴다.
+    Entry* entry;
+    if (stripe.size >= m_stripeCapacity) {
+        entry = stripe.tail;
+        unlinkLru(stripe, entry);
+        unlinkBucket(stripe, entry);
+        m_evictions++;
+    }
+    else {
+        entry = stripe.pool->allocate();
+        stripe.size++;
+    }
+
+    entry->key = key;
+    entry->outcome = outcome;
+    entry->hash = hash;
+    pushFront(stripe, entry);
+    Entry*& bucket = bucketFor(stripe, hash);
+    entry->chain = bucket;
+    bucket = entry;
+}
+
+void CShotCache::clear(void)
+{
+    for (int i = 0; i < NUM_STRIPES; i++) {
+        std::lock_guard<std::mutex> guard(m_stripes[i].lock);
+        clearStripe(m_stripes[i]);
+    }
+}
+
+ShotCacheStats CShotCache::stats(void) const
+{
+    ShotCacheStats s;
+    s.hits = m_hits.load();
+    s.misses = m_misses.load();
+    s.evictions = m_evictions.load();
+    s.size = 0;
+    for (int i = 0; i < NUM_STRIPES; i++) {
+        const Stripe& stripe = m_stripes[i];
+        std::lock_guard<std::mutex> guard(stripe.lock);
+        s.size += stripe.size;
+    }
+    return s;
+}
@@ -0,0 +1,137 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: shotCache.h
+//
+// Desc: 샷 결과 transposition cache.
+//       (상태 hash, 양자화된 aim, power, 큐 팁 위치)를 key로 ShotOutcome을 저장한다.
+//       key는 stripe 단위로 나뉘어 각 stripe가 자신의 lock과 LRU 목록을 가지므로
+//       여러 thread에서 동시에 조회해도 서로 거의 막지 않는다.
+//       항목은 stripe마다 만들 때 잡아 둔 object pool에서 꺼내 쓰므로 조회와 저장,
+//       교체 중에는 heap 할당이 없다.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __shotCacheH__
+#define __shotCacheH__
+
+#include "billiardPhysics.h"
+#include "objectPool.h"
+#include <stdint.h>
+#include <atomic>
+#include <mutex>
+
+// aim은 한 바퀴를 AIM_STEPS 칸으로, power와 큐 팁 위치는 CELL 간격으로 양자화
+const int   SHOT_AIM_STEPS = 4096;
+const float SHOT_POWER_CELL = 0.01f;
+const float SHOT_TIP_CELL = 0.01f;
+
+struct ShotKey {
+    uint64_t state;
+    int32_t  aim;
+    int32_t  power;
+    int16_t  tipSide;
+    int16_t  tipHeight;
+
+    bool operator==(const ShotKey& other) const
+    {
+        return state == other.state && aim == other.aim && power == other.power &&
+            tipSide == other.tipSide && tipHeight == other.tipHeight;
+    }
+};
+
+struct ShotKeyHash {
+    size_t operator()(const ShotKey& key) const
+    {
+        uint64_t h = key.state ^ ((uint64_t)(uint32_t)key.aim << 32) ^ (uint32_t)key.power ^
+            ((uint64_t)(uint16_t)key.tipSide << 16) ^ ((uint64_t)(uint16_t)key.tipHeight << 48);
+        h ^= h >> 33;
+        h *= 0xFF51AFD7ED558CCDull;
+        h ^= h >> 33;
+        return (size_t)h;
+    }
+};
+
+struct ShotCacheStats {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+    uint64_t size;
+
+    double hitRate(void) const
+    {
+        uint64_t total = hits + misses;
+        return total == 0 ? 0.0 : (double)hits / (double)total;
+    }
+};
+
+class CShotCache {
+public:
+    explicit CShotCache(size_t capacity = 4096);
+    ~CShotCache(void);
+
+    static ShotKey makeKey(uint64_t stateHash, float aim, float power,
+        float tipSide = 0.0f, float tipHeight = 0.0f);
+
+    bool lookup(const ShotKey& key, ShotOutcome* outcome);
+    void insert(const ShotKey& key, const ShotOutcome& outcome);
+    void clear(void);
+    ShotCacheStats stats(void) const;
+
+    // cache에 없으면 simulate()로 계산해 저장한다.
+    // 시뮬레이션은 lock 밖에서 돌기 때문에 같은 key가 동시에 두 번 계산될 수는 있지만
+    // 결과는 같으므로 나중에 온 값이 그대로 덮어쓴다.
+    template<class Simulate>
+    ShotOutcome lookupOrSimulate(const ShotKey& key, Simulate simulate)
+    {
+        ShotOutcome outcome;
+        if (lookup(key, &outcome))
+            return outcome;
+        outcome = simulate();
+        insert(key, outcome);
+        return outcome;
+    }
+
+private:
+    // stripe는 hash의 아래 STRIPE_BITS bit로, bucket은 그 위 bit로 고른다.
+    static const int STRIPE_BITS = 4;
+    static const int NUM_STRIPES = 1 << STRIPE_BITS;
+
+    struct Entry {
+        ShotKey     key;
+        ShotOutcome outcome;
+        size_t      hash;
+        Entry*      prev;   // LRU 목록
+        Entry*      next;
+        Entry*      chain;  // 같은 bucket의 다음 항목
+    };
+
+    struct Stripe {
+        mutable std::mutex  lock;
+        CObjectPool<Entry>* pool;
+        Entry**  buckets;
+        size_t   bucketMask;
+        Entry*   head;      // 가장 최근에 사용된 항목
+        Entry*   tail;      // 가장 오래 사용되지 않은 항목
+        size_t   size;
+    };
+
+    Stripe& stripeFor(size_t hash) { return m_stripes[hash & (NUM_STRIPES - 1)]; }
+    static Entry*& bucketFor(const Stripe& stripe, size_t hash)
+    {
+        return stripe.buckets[(hash >> STRIPE_BITS) & stripe.bucketMask];
+    }
+
+    static Entry* find(const Stripe& stripe, const ShotKey& key, size_t hash);
+    static void unlinkLru(Stripe& stripe, Entry* entry);
+    static void pushFront(Stripe& stripe, Entry* entry);
+    static void unlinkBucket(Stripe& stripe, Entry* entry);
+    static void clearStripe(Stripe& stripe);
+
+    Stripe                m_stripes[NUM_STRIPES];
+    size_t                m_stripeCapacity;
+    std::atomic<uint64_t> m_hits;
+    std::atomic<uint64_t> m_misses;
+    std::atomic<uint64_t> m_evictions;
+};
+
+#endif // __shotCacheH__
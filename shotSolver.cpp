@@ -0,0 +1,153 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: shotSolver.cpp
+//
+// Desc: 기하로 구하는 직접 샷 후보 구현.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "shotSolver.h"
+#include "contactSolver.h"
+#include "tableLayout.h"
+#include <cmath>
+
+namespace
+{
+    // 큐볼을 뺀 활성 공 (SoA)
+    struct Obstacles {
+        int   count;
+        int   index[NUM_BALLS];
+        float x[NUM_BALLS];
+        float z[NUM_BALLS];
+    };
+
+    // 반지름 R인 공이 a -> b로 지나가는 capsule에 다른 공(반지름 R)이 걸리는지.
+    // 중심에서 선분까지 거리가 지름보다 작으면 막힌다. skip1, skip2는 통로의 양 끝 공이다.
+    bool corridorClear(const Obstacles& obstacles, float2 a, float2 b, int skip1, int skip2)
+    {
+        const float diameterSq = (float)(4 * M_RADIUS * M_RADIUS);
+        const float2 d = b - a;
+        const float lenSq = lengthSq(d);
+        const float invLenSq = lenSq > 0.0f ? 1.0f / lenSq : 0.0f;
+        for (int k = 0; k < obstacles.count; k++) {
+            if (obstacles.index[k] == skip1 || obstacles.index[k] == skip2) continue;
+            const float2 f = make_float2(obstacles.x[k], obstacles.z[k]) - a;
+            float s = dot(f, d) * invLenSq;
+            s = s < 0.0f ? 0.0f : s > 1.0f ? 1.0f : s;
+            if (lengthSq(f - d * s) < diameterSq)
+                return false;
+        }
+        return true;
+    }
+
+    void sortByTolerance(ShotCandidate* shots, int count)
+    {
+        // 후보가 많아야 90개이므로 삽입 정렬로 충분하다.
+        for (int i = 1; i < count; i++) {
+            ShotCandidate key = shots[i];
+            int j = i - 1;
+            while (j >= 0 && shots[j].tolerance < key.tolerance) {
+                shots[j + 1] = shots[j];
+                j--;
+            }
+            shots[j + 1] = key;
+        }
+    }
+}
+
+int findShots(const BallState* balls, int count, unsigned targetMask, float maxPower,
+    ShotCandidate* out, int maxOut)
+{
+    if (count > NUM_BALLS) count = NUM_BALLS;
+    if (count <= CUE_BALL || !balls[CUE_BALL].active || maxOut <= 0)
+        return 0;
+
+    Obstacles obstacles;
+    obstacles.count = 0;
+    for (int i = 0; i < count; i++) {
+        if (i == CUE_BALL || !balls[i].active) continue;
+        obstacles.index[obstacles.count] = i;
+        obstacles.x[obstacles.count] = balls[i].x;
+        obstacles.z[obstacles.count] = balls[i].z;
+        obstacles.count++;
+    }
+
+    const TableLayout& table = activeTable();
+    const float r = (float)M_RADIUS;
+    const float minX = table.minX + r, maxX = table.maxX - r;
+    const float minZ = table.minZ + r, maxZ = table.maxZ - r;
+    const float2 cue = ballPosition(balls[CUE_BALL]);
+    // 충돌에서 목적구가 받는 비율과 미끄러짐이 끝난 뒤 남는 비율
+    const float transfer = (1.0f + activePhysics().ballRestitution) * 0.5f * (5.0f / 7.0f);
+
+    ShotCandidate shots[SHOT_MAX_CANDIDATES];
+    int numShots = 0;
+    for (int k = 0; k < obstacles.count; k++) {
+        const int ball = obstacles.index[k];
+        if (!(targetMask & (1u << ball))) continue;
+        const float2 object = make_float2(obstacles.x[k], obstacles.z[k]);
+
+        for (int p = 0; p < table.numPockets; p++) {
+            const PocketCircle& pocket = table.pockets[p];
+            const float2 toPocket = make_float2(pocket.x, pocket.z) - object;
+            const float objectDistance = length(toPocket);
+            if (objectDistance <= 0.0f) continue;
+            const float2 dir = toPocket / objectDistance;
+
+            // ghost ball은 포켓 반대쪽으로 지름만큼 떨어진 자리이고 테이블 안에 있어야 한다.
+            const float2 ghost = object - dir * (2.0f * r);
+            if (ghost.x < minX || ghost.x > maxX || ghost.y < minZ || ghost.y > maxZ) continue;
+
+            const float2 toGhost = ghost - cue;
+            const float cueDistance = length(toGhost);
+            if (cueDistance <= 0.0f) continue;
+            const float2 aimDir = toGhost / cueDistance;
+
+            float cosCut = dot(aimDir, dir);
+            if (cosCut <= cosf(SHOT_MAX_CUT)) continue;
+            if (cosCut > 1.0f) cosCut = 1.0f;
+
+            if (!corridorClear(obstacles, cue, ghost, ball, -1)) continue;
+            if (!corridorClear(obstacles, object, make_float2(pocket.x, pocket.z), ball, -1)) continue;
+
+            // 목적구가 포켓까지 가는 속력에서 거꾸로 큐볼의 출발 속력을 구한다.
+            float objectSpeed = speedForDistance(objectDistance, SHOT_POCKET_SPEED);
+            float arriveSpeed = objectSpeed / (transfer * cosCut);
+            float power = speedForDistance(cueDistance, arriveSpeed);
+            if (power > maxPower) continue;
+
+            // 조준 오차 d가 옆으로 cueDistance * d 만큼 밀면 cut 각은 그것 / (2R cos cut) 만큼
+            // 바뀐다. 목적구 방향 오차가 포켓 반지름이 보이는 각 안이어야 한다.
+            float pocketAngle = atan2f(pocket.radius, objectDistance);
+
+            ShotCandidate& shot = shots[numShots++];
+            shot.ball = ball;
+            shot.pocket = p;
+            shot.aim = atan2f(aimDir.y, aimDir.x);
+            shot.power = power;
+            shot.cutAngle = acosf(cosCut);
+            shot.ghostX = ghost.x;
+            shot.ghostZ = ghost.y;
+            shot.cueDistance = cueDistance;
+            shot.objectDistance = objectDistance;
+            shot.tolerance = pocketAngle * 2.0f * r * cosCut / cueDistance;
+        }
+    }
+
+    sortByTolerance(shots, numShots);
+    if (numShots > maxOut) numShots = maxOut;
+    for (int i = 0; i < numShots; i++)
+        out[i] = shots[i];
+    return numShots;
+}
+
+unsigned legalTargetMask(const RuleState& rules, const BallState* balls, int count)
+{
+    unsigned mask = 0;
+    for (int i = 0; i < count && i < NUM_BALLS; i++) {
+        if (i == CUE_BALL || !balls[i].active) continue;
+        if (isLegalFirstContact(rules, i))
+            mask |= 1u << i;
+    }
+    return mask;
+}
@@ -0,0 +1,47 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: shotSolver.h
+//
+// Desc: 기하로 구하는 직접 샷 후보 (시뮬레이션 앞단의 가지치기).
+//       목적구 x 포켓마다 목적구를 포켓 중심으로 보내는 ghost ball(충돌 순간의 큐볼 중심)을
+//       구하고, 큐볼 -> ghost ball과 목적구 -> 포켓 통로가 다른 공에 막히는지
+//       capsule(반지름 R인 선분) 대 원 판정으로 걸러낸다.
+//       살아남은 후보는 cut 각과 필요한 힘을 붙여 조준 허용 오차 순으로 돌려준다.
+//
+//       힘은 큐볼이 SHOT_ROLL_TIP으로 바로 구른다고 보고 감속 모델의 닫힌 해로 구한다.
+//       목적구는 중심선 방향 속력의 (1 + e) / 2 를 받고, 미끄러지다 구르면서 5/7로 준다.
+//       쿠션, throw, 큐볼의 이후 경로(scratch)는 보지 않으므로 후보는 시뮬레이션으로 확인한다.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __shotSolverH__
+#define __shotSolverH__
+
+#include "billiardPhysics.h"
+
+const float SHOT_ROLL_TIP = 0.4f;       // 큐볼이 바로 구르는 큐 팁 높이
+const float SHOT_MAX_CUT = 1.4f;        // 이보다 얇은 cut (라디안, 약 80도)은 버린다
+const float SHOT_POCKET_SPEED = 0.05f;  // 포켓 중심에 닿을 때 남길 속력
+const int   SHOT_MAX_CANDIDATES = (NUM_BALLS - 1) * NUM_POCKETS;
+
+struct ShotCandidate {
+    int   ball;             // 목적구
+    int   pocket;           // activeTable().pockets 번호
+    float aim;              // 큐볼 출발 방향 (라디안)
+    float power;            // 큐볼 출발 속력 (tipSide 0, tipHeight SHOT_ROLL_TIP)
+    float cutAngle;         // 큐볼 진행 방향과 목적구 진행 방향 사이 (라디안)
+    float ghostX, ghostZ;   // 충돌 순간의 큐볼 중심
+    float cueDistance;      // 큐볼 -> ghost ball
+    float objectDistance;   // 목적구 -> 포켓 중심
+    float tolerance;        // 포켓 안으로 보낼 수 있는 조준 오차 (라디안, 근사)
+};
+
+// targetMask(1 << 공 번호)의 공을 노리는 직접 샷 중 통로가 열려 있고 maxPower 안에서
+// 칠 수 있는 것을 tolerance가 큰 순서로 out에 최대 maxOut개 쓰고 그 수를 돌려준다.
+int findShots(const BallState* balls, int count, unsigned targetMask, float maxPower,
+    ShotCandidate* out, int maxOut);
+
+// rules에서 큐볼이 처음 맞혀도 되는 활성 공의 mask
+unsigned legalTargetMask(const RuleState& rules, const BallState* balls, int count);
+
+#endif // __shotSolverH__
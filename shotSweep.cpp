@@ -0,0 +1,390 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: shotSweep.cpp
+//
+// Desc: (aim x power) 샷 격자 sweep 구현.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "shotSweep.h"
+#include "contactSolver.h"
+#include "detMath.h"
+#include "tableLayout.h"
+#include "threadPool.h"
+#include <atomic>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+    const float TWO_PI = 6.28318531f;
+    // 건너뛴 뒤 장애물까지 남겨 두는 거리 (다음 step의 substep이 접촉을 잡는다)
+    const float SKIP_MARGIN = (float)M_RADIUS * 0.5f;
+    // 미끄러짐 속도와 진행 방향이 이만큼 (sin) 어긋나면 곡선으로 본다
+    const float STRAIGHT_EPSILON = 1e-3f;
+    // 건너뛰지 못했을 때 다시 보기까지 기다리는 최대 step 수
+    const int   SKIP_MAX_BACKOFF = 7;
+
+    // 원점 origin에서 dir 방향 반직선이 center 중심 radius 원에 처음 닿는 거리.
+    // 이미 원 안이면 0, 닿지 않으면 FLT_MAX.
+    float rayCircle(float2 origin, float2 dir, float2 center, float radius)
+    {
+        const float2 oc = origin - center;
+        float c = dot(oc, oc) - radius * radius;
+        if (c <= 0.0f)
+            return 0.0f;
+        float b = dot(oc, dir);
+        if (b >= 0.0f)
+            return FLT_MAX;
+        float disc = b * b - c;
+        if (disc < 0.0f)
+            return FLT_MAX;
+        return -b - sqrtf(disc);
+    }
+
+    // 공 중심이 쿠션 nose 직사각형(반지름만큼 줄인) 밖으로 나가기까지의 거리
+    float rayRectExit(float2 origin, float2 dir, const TableLayout& table)
+    {
+        const float r = (float)M_RADIUS;
+        float distance = FLT_MAX;
+        if (dir.x > 0.0f) distance = fminf(distance, (table.maxX - r - origin.x) / dir.x);
+        if (dir.x < 0.0f) distance = fminf(distance, (table.minX + r - origin.x) / dir.x);
+        if (dir.y > 0.0f) distance = fminf(distance, (table.maxZ - r - origin.y) / dir.y);
+        if (dir.y < 0.0f) distance = fminf(distance, (table.minZ + r - origin.y) / dir.y);
+        return distance > 0.0f ? distance : 0.0f;
+    }
+
+    // 쿠션과 포켓까지의 거리 (공의 배치와 관계없는 부분)
+    float tableFreeDistance(float2 origin, float2 dir)
+    {
+        const TableLayout& table = activeTable();
+        float distance = rayRectExit(origin, dir, table);
+        for (int p = 0; p < table.numPockets; p++) {
+            const PocketCircle& pocket = table.pockets[p];
+            distance = fminf(distance, rayCircle(origin, dir, make_float2(pocket.x, pocket.z), pocket.radius));
+        }
+        return distance;
+    }
+
+    // 어느 방향으로든 장애물(쿠션, 포켓, 멈춘 공)에 닿기까지의 거리
+    float clearance(const BallState* balls, int self)
+    {
+        const TableLayout& table = activeTable();
+        const float r = (float)M_RADIUS;
+        const float2 p = ballPosition(balls[self]);
+        float distance = fminf(fminf(p.x - (table.minX + r), (table.maxX - r) - p.x),
+            fminf(p.y - (table.minZ + r), (table.maxZ - r) - p.y));
+        for (int k = 0; k < table.numPockets; k++) {
+            const PocketCircle& pocket = table.pockets[k];
+            distance = fminf(distance, length(p - make_float2(pocket.x, pocket.z)) - pocket.radius);
+        }
+        for (int j = 0; j < NUM_BALLS; j++) {
+            if (j == self || !balls[j].active || isBallMoving(balls[j])) continue;
+            distance = fminf(distance, length(p - ballPosition(balls[j])) - 2.0f * r);
+        }
+        return distance;
+    }
+
+    // 공이 곧게 간다면 그 방향 (진행 거리가 줄지 않는 방향)
+    bool straightDirection(const BallState& ball, float2* dir)
+    {
+        const float radius = (float)M_RADIUS;
+        const float2 v = ballVelocity(ball);
+        const float2 u = make_float2(ball.vx + radius * ball.wz, ball.vz - radius * ball.wx);
+        float speed = length(v), slip = length(u);
+
+        if (slip <= SLIP_EPSILON) {
+            if (speed <= 0.0f) return false;
+            *dir = v / speed;
+            return true;
+        }
+        // 멈춘 공이 회전으로 출발하면 미끄러짐의 반대 방향으로 곧게 간다.
+        if (speed <= 0.0f) {
+            *dir = u / (-slip);
+            return true;
+        }
+        if (fabsf(v.x * u.y - v.y * u.x) > STRAIGHT_EPSILON * speed * slip)
+            return false;
+        // 미끄러지는 동안 속력은 마찰로 2/7 * slip 만큼 줄 수 있다. 그 전에 0이 되면 되돌아온다 (draw).
+        if (dot(u, v) > 0.0f && speed < slip * (2.0f / 7.0f))
+            return false;
+        *dir = v / speed;
+        return true;
+    }
+
+    // 움직이는 공마다 이동 거리의 상한을 두고, 어느 공도 장애물(쿠션, 포켓, 멈춘 공)에 닿지 않고
+    // 움직이는 공끼리도 만날 수 없는 만큼을 고정 step 단위로 건너뛴다.
+    // 곧게 가는 공은 진행 방향의 장애물까지, 휘어 가는 (미끄러지는) 공은 모든 방향의 장애물까지
+    // 경로 길이로 잰다. 움직이는 두 공은 두 이동 거리의 합이 그 사이 틈보다 작으면 만나지 않는다.
+    // knownFree >= 0이면 큐볼 하나만 움직일 때 그 장애물까지 거리로 쓴다. 건너뛴 step 수를 돌려준다.
+    int skipFreeFlight(BallState* balls, int maxSteps, float knownFree)
+    {
+        int movers[NUM_BALLS];
+        float2 dirs[NUM_BALLS];
+        float maxSpeed[NUM_BALLS];  // 휘어 가는 공의 최대 속력 (곧게 가면 0)
+        int numMovers = 0;
+        for (int i = 0; i < NUM_BALLS; i++) {
+            if (!isBallMoving(balls[i])) continue;
+            maxSpeed[numMovers] = 0.0f;
+            if (!straightDirection(balls[i], &dirs[numMovers])) {
+                // 미끄러지는 동안 속도는 t에 선형이므로 속력은 단계의 양 끝 중 하나에서 가장 크고,
+                // 구르기 시작한 뒤에는 줄기만 한다.
+                BallState end = balls[i];
+                advanceBall(end, phaseTime(end));
+                maxSpeed[numMovers] = fmaxf(length(ballVelocity(balls[i])), length(ballVelocity(end)));
+            }
+            movers[numMovers++] = i;
+        }
+        if (numMovers == 0 || maxSteps <= 0)
+            return 0;
+
+        const float contact = 2.0f * (float)M_RADIUS;
+        float free[NUM_BALLS];
+        for (int m = 0; m < numMovers; m++) {
+            const float2 origin = ballPosition(balls[movers[m]]);
+            if (maxSpeed[m] > 0.0f) {
+                free[m] = clearance(balls, movers[m]) - SKIP_MARGIN;
+            }
+            else if (knownFree >= 0.0f && numMovers == 1 && movers[m] == CUE_BALL) {
+                free[m] = knownFree - SKIP_MARGIN;
+            }
+            else {
+                float distance = tableFreeDistance(origin, dirs[m]);
+                for (int j = 0; j < NUM_BALLS; j++) {
+                    if (j == movers[m] || !balls[j].active || isBallMoving(balls[j])) continue;
+                    distance = fminf(distance, rayCircle(origin, dirs[m], ballPosition(balls[j]), contact));
+                }
+                free[m] = distance - SKIP_MARGIN;
+            }
+            if (free[m] <= 0.0f)
+                return 0;
+        }
+        float gap[NUM_BALLS][NUM_BALLS];
+        for (int m = 0; m < numMovers; m++) {
+            for (int n = m + 1; n < numMovers; n++) {
+                gap[m][n] = length(ballPosition(balls[movers[m]]) - ballPosition(balls[movers[n]])) - contact - SKIP_MARGIN;
+                if (gap[m][n] <= 0.0f)
+                    return 0;
+            }
+        }
+
+        // 진행 거리는 step 수에 대해 줄지 않으므로 모든 조건을 지키는 가장 큰 step 수를 이분 탐색한다.
+        int lo = 0, hi = maxSteps;
+        while (lo < hi) {
+            int mid = lo + (hi - lo + 1) / 2;
+            float travel[NUM_BALLS];
+            bool fits = true;
+            for (int m = 0; fits && m < numMovers; m++) {
+                if (maxSpeed[m] > 0.0f) {
+                    travel[m] = maxSpeed[m] * activePhysics().timeScale * (mid * SIM_FIXED_STEP);
+                }
+                else {
+                    BallState probe = balls[movers[m]];
+                    advanceBall(probe, mid * SIM_FIXED_STEP);
+                    travel[m] = dot(ballPosition(probe) - ballPosition(balls[movers[m]]), dirs[m]);
+                }
+                fits = travel[m] <= free[m];
+            }
+            for (int m = 0; fits && m < numMovers; m++) {
+                for (int n = m + 1; fits && n < numMovers; n++)
+                    fits = travel[m] + travel[n] <= gap[m][n];
+            }
+            if (fits) lo = mid;
+            else hi = mid - 1;
+        }
+        if (lo == 0)
+            return 0;
+        // 제자리에서 도는 공도 같은 시간만큼 회전이 줄어든다.
+        for (int i = 0; i < NUM_BALLS; i++) {
+            if (balls[i].active) advanceBall(balls[i], lo * SIM_FIXED_STEP);
+        }
+        return lo;
+    }
+
+    uint8_t classify(const RuleState& rules, unsigned pocketed, int firstContact, int cushions)
+    {
+        bool solidIn = false, stripeIn = false;
+        for (int i = 0; i < NUM_BALLS; i++) {
+            if (!(pocketed & (1u << i))) continue;
+            solidIn = solidIn || isSolidBall(i);
+            stripeIn = stripeIn || isStripeBall(i);
+        }
+        bool scratch = (pocketed & (1u << CUE_BALL)) != 0;
+        if (scratch)
+            return SWEEP_SCRATCH;
+        // 아직 8번을 칠 수 없을 때 넣으면 진다 (파울로 센다).
+        bool earlyEight = (pocketed & (1u << EIGHT_BALL)) && !isLegalFirstContact(rules, EIGHT_BALL);
+        if (isFoul(rules.break_shot, solidIn, stripeIn, scratch, cushions) ||
+            !isLegalFirstContact(rules, firstContact) || earlyEight)
+            return SWEEP_FOUL;
+        return (pocketed & ~(1u << CUE_BALL)) != 0 ? SWEEP_POT : SWEEP_MISS;
+    }
+
+    struct SweepBody {
+        const TableState* start;
+        const SweepGrid*  grid;
+        SweepCell*        cells;
+        std::atomic<long long>* stepped;
+        std::atomic<long long>* skipped;
+
+        void operator()(int begin, int end) const
+        {
+            CContactSolver solver;
+            long long steppedSteps = 0, skippedSteps = 0;
+            for (int block = begin; block < end; block++) {
+                int aim0 = block * SWEEP_AIM_BLOCK;
+                int aim1 = aim0 + SWEEP_AIM_BLOCK < grid->aimSteps ? aim0 + SWEEP_AIM_BLOCK : grid->aimSteps;
+                runBlock(aim0, aim1, solver, steppedSteps, skippedSteps);
+            }
+            stepped->fetch_add(steppedSteps);
+            skipped->fetch_add(skippedSteps);
+        }
+
+        void runBlock(int aim0, int aim1, CContactSolver& solver, long long& steppedSteps, long long& skippedSteps) const
+        {
+            const BallState* balls = start->balls;
+            const float2 cue = ballPosition(balls[CUE_BALL]);
+            const float contact = 2.0f * (float)M_RADIUS;
+
+            // 묶음의 aim 부채꼴에 걸치는 공만 첫 충돌 후보로 둔다.
+            float blockMin = grid->aim(aim0), blockMax = grid->aim(aim1 - 1);
+            float blockMid = (blockMin + blockMax) * 0.5f, blockHalf = (blockMax - blockMin) * 0.5f;
+            int candidates[NUM_BALLS];
+            int numCandidates = 0;
+            for (int j = 0; j < NUM_BALLS; j++) {
+                if (j == CUE_BALL || !balls[j].active) continue;
+                float2 d = ballPosition(balls[j]) - cue;
+                float distance = length(d);
+                float half = distance > contact ? asinf(contact / distance) : 3.14159265f;
+                float offset = fabsf(remainderf(atan2f(d.y, d.x) - blockMid, TWO_PI));
+                if (offset <= half + blockHalf)
+                    candidates[numCandidates++] = j;
+            }
+
+            // aim마다 큐볼의 첫 장애물까지 거리는 power와 관계없다.
+            float freeDistance[SWEEP_AIM_BLOCK];
+            for (int a = aim0; a < aim1; a++) {
+                float2 dir;
+                physSinCos(grid->aim(a), &dir.y, &dir.x);
+                float free = tableFreeDistance(cue, dir);
+                for (int k = 0; k < numCandidates; k++)
+                    free = fminf(free, rayCircle(cue, dir, ballPosition(balls[candidates[k]]), contact));
+                freeDistance[a - aim0] = free;
+            }
+
+            // 출발 배치는 묶음에서 한 번 복사해 두고 샷마다 그것에서 시작한다.
+            BallState initial[NUM_BALLS];
+            memcpy(initial, balls, sizeof(initial));
+
+            for (int p = 0; p < grid->powerSteps; p++) {
+                const float power = grid->power(p);
+                for (int a = aim0; a < aim1; a++) {
+                    BallState shot[NUM_BALLS];
+                    memcpy(shot, initial, sizeof(shot));
+                    strikeCueBall(shot[CUE_BALL], grid->aim(a), power, grid->tipSide, grid->tipHeight);
+                    solver.reset();
+
+                    unsigned pocketed = 0;
+                    int cushions = 0, firstContact = -1, steps = 0;
+                    // 건너뛰지 못하면 (공이 붙어 있음) 다시 보기까지 step을 늘려 가며 기다린다.
+                    int wait = 0, backoff = 0;
+                    bool first = true, moving = true;
+                    while (moving && steps < SWEEP_MAX_STEPS) {
+                        if (wait > 0) {
+                            wait--;
+                        }
+                        else {
+                            int skip = skipFreeFlight(shot, SWEEP_MAX_STEPS - steps, first ? freeDistance[a - aim0] : -1.0f);
+                            first = false;
+                            steps += skip;
+                            skippedSteps += skip;
+                            backoff = skip > 0 ? 0 : backoff < SKIP_MAX_BACKOFF ? backoff * 2 + 1 : SKIP_MAX_BACKOFF;
+                            wait = backoff;
+                        }
+
+                        StepEvents events;
+                        stepTable(shot, NUM_BALLS, SIM_FIXED_STEP, &events, &solver);
+                        steps++;
+                        steppedSteps++;
+                        pocketed |= events.pocketed;
+                        cushions += events.cushionHits;
+                        if (firstContact < 0)
+                            firstContact = events.firstContact;
+                        moving = !fastForwardToRest(shot, NUM_BALLS);
+                    }
+
+                    SweepCell& cell = cells[p * grid->aimSteps + a];
+                    cell.pocketed = (uint16_t)pocketed;
+                    cell.firstContact = (int8_t)firstContact;
+                    cell.result = classify(start->rules, pocketed, firstContact, cushions);
+                }
+            }
+        }
+    };
+}
+
+bool SweepGrid::fullCircle(void) const
+{
+    return aimMax - aimMin >= TWO_PI - 1e-4f;
+}
+
+float SweepGrid::aim(int index) const
+{
+    if (fullCircle())
+        return aimMin + TWO_PI * index / aimSteps;
+    return aimSteps > 1 ? aimMin + (aimMax - aimMin) * index / (aimSteps - 1) : aimMin;
+}
+
+float SweepGrid::power(int index) const
+{
+    return powerSteps > 1 ? powerMin + (powerMax - powerMin) * index / (powerSteps - 1) : powerMin;
+}
+
+void sweepShots(const TableState& start, const SweepGrid& grid, SweepCell* cells,
+    CThreadPool* pool, SweepStats* stats)
+{
+    if (grid.aimSteps <= 0 || grid.powerSteps <= 0)
+        return;
+
+    std::atomic<long long> stepped(0), skipped(0);
+    SweepBody body = { &start, &grid, cells, &stepped, &skipped };
+    int blocks = (grid.aimSteps + SWEEP_AIM_BLOCK - 1) / SWEEP_AIM_BLOCK;
+    if (pool != NULL)
+        pool->parallelFor(blocks, 1, body);
+    else
+        body(0, blocks);
+
+    if (stats != NULL) {
+        stats->shots = grid.aimSteps * grid.powerSteps;
+        stats->steppedSteps = (double)stepped.load();
+        stats->skippedSteps = (double)skipped.load();
+    }
+}
+
+void potProbability(const SweepCell* cells, const SweepGrid& grid, float aimSigma, float* out)
+{
+    const bool wrap = grid.fullCircle();
+    const float spacing = wrap ? TWO_PI / grid.aimSteps :
+        grid.aimSteps > 1 ? (grid.aimMax - grid.aimMin) / (grid.aimSteps - 1) : 0.0f;
+    // 3 sigma 밖은 버린다.
+    int reach = spacing > 0.0f && aimSigma > 0.0f ? (int)ceilf(3.0f * aimSigma / spacing) : 0;
+    if (reach > grid.aimSteps / 2) reach = grid.aimSteps / 2;
+
+    for (int p = 0; p < grid.powerSteps; p++) {
+        const SweepCell* row = cells + p * grid.aimSteps;
+        for (int a = 0; a < grid.aimSteps; a++) {
+            float sum = 0.0f, weightSum = 0.0f;
+            for (int k = -reach; k <= reach; k++) {
+                int j = a + k;
+                if (wrap) j = (j + grid.aimSteps) % grid.aimSteps;
+                else if (j < 0 || j >= grid.aimSteps) continue;
+                float x = reach > 0 ? k * spacing / aimSigma : 0.0f;
+                float weight = expf(-0.5f * x * x);
+                weightSum += weight;
+                if (row[j].result == SWEEP_POT) sum += weight;
+            }
+            out[p * grid.aimSteps + a] = sum / weightSum;
+        }
+    }
+}
@@ -0,0 +1,70 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: shotSweep.h
+//
+// Desc: 한 배치에서 (aim x power) 격자의 모든 샷을 시뮬레이션해 결과를 모은다
+//       (코칭용 조준 민감도 heatmap, 물리 조정).
+//
+//       격자는 이웃한 aim SWEEP_AIM_BLOCK개 x 모든 power를 한 묶음으로 thread pool에 나눈다.
+//       묶음 안에서는 출발 배치를 한 번만 복사하고, 묶음의 aim 부채꼴에 걸리는 공만
+//       후보로 골라 둔다. aim마다 큐볼이 처음 무엇(공, 쿠션, 포켓)에 닿을 수 있는지까지의
+//       거리는 power와 관계없으므로 한 번 구해 모든 power 행이 같이 쓴다.
+//
+//       움직이는 공이 하나뿐이고 그 공이 곧게 가는 동안은 그 거리 안쪽까지를 닫힌 해로
+//       고정 step 단위로 건너뛴다 (큐볼이 첫 공에 닿기까지, 목적구 혼자 포켓으로 가는 동안).
+//       건너뛴 뒤에는 stepTable로 그대로 진행하므로 충돌은 게임과 같은 방법으로 푼다.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __shotSweepH__
+#define __shotSweepH__
+
+#include "billiardPhysics.h"
+#include <stdint.h>
+
+class CThreadPool;
+
+const int SWEEP_AIM_BLOCK = 16;         // 한 묶음의 aim 수
+const int SWEEP_MAX_STEPS = 20000;
+
+// 샷 하나의 결과 분류
+enum SweepResult {
+    SWEEP_MISS,         // 아무 공도 넣지 못함 (파울 아님)
+    SWEEP_POT,          // 파울 없이 공을 넣음
+    SWEEP_SCRATCH,      // 큐볼이 들어감 (white_in)
+    SWEEP_FOUL          // 그 밖의 파울 (isFoul, 첫 접촉)
+};
+
+struct SweepGrid {
+    float aimMin, aimMax;       // 라디안, aimSteps개를 양 끝 포함으로 나눈다
+    int   aimSteps;             // (한 바퀴 전체면 aimMax는 제외)
+    float powerMin, powerMax;
+    int   powerSteps;
+    float tipSide, tipHeight;
+
+    bool  fullCircle(void) const;
+    float aim(int index) const;
+    float power(int index) const;
+};
+
+struct SweepCell {
+    uint16_t pocketed;          // 들어간 공의 bit mask
+    int8_t   firstContact;      // -1: 아무 공도 맞히지 못함
+    uint8_t  result;            // SweepResult
+};
+
+struct SweepStats {
+    int    shots;
+    double steppedSteps;        // stepTable로 진행한 step 수
+    double skippedSteps;        // 닫힌 해로 건너뛴 step 수
+};
+
+// cells[power * aimSteps + aim]에 격자 전체의 결과를 쓴다. pool이 NULL이면 호출한 thread에서.
+void sweepShots(const TableState& start, const SweepGrid& grid, SweepCell* cells,
+    CThreadPool* pool, SweepStats* stats = 0);
+
+// 조준 오차가 표준편차 aimSigma(라디안)인 정규 분포일 때 칸마다 파울 없이 공을 넣을 확률.
+// 같은 power 행의 이웃 aim 결과를 가중 평균한다 (한 바퀴 전체면 양 끝을 잇는다).
+void potProbability(const SweepCell* cells, const SweepGrid& grid, float aimSigma, float* out);
+
+#endif // __shotSweepH__
@@ -0,0 +1,101 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: simClock.cpp
+//
+// Desc: 고해상도 시계와 시뮬레이션 시간 조절 구현.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "simClock.h"
+#include <cmath>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <chrono>
+#endif
+
+namespace
+{
+    const float SIM_SPEEDS[SIM_SPEED_COUNT] = { 0.125f, 0.25f, 0.5f, 1.0f, 2.0f, 4.0f, 8.0f, 16.0f, 16.0f };
+    const char* SIM_SPEED_LABELS[SIM_SPEED_COUNT] = { "1/8x", "1/4x", "1/2x", "1x", "2x", "4x", "8x", "16x", "instant" };
+
+    int64_t readTicks(void)
+    {
+#ifdef _WIN32
+        LARGE_INTEGER now;
+        QueryPerformanceCounter(&now);
+        return now.QuadPart;
+#else
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+}
+
+// -----------------------------------------------------------------------------
+// CMonotonicClock
+// -----------------------------------------------------------------------------
+
+CMonotonicClock::CMonotonicClock(void)
+{
+#ifdef _WIN32
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+    m_period = 1.0 / (double)frequency.QuadPart;
+#else
+    m_period = 1e-9;
+#endif
+    m_start = readTicks();
+}
+
+double CMonotonicClock::seconds(void) const
+{
+    return (double)(readTicks() - m_start) * m_period;
+}
+
+// -----------------------------------------------------------------------------
+// CSimTimeController
+// -----------------------------------------------------------------------------
+
+void CSimTimeController::faster(void)
+{
+    if (m_speed < SIM_SPEED_COUNT - 1) m_speed++;
+    m_paused = false;
+}
+
+void CSimTimeController::slower(void)
+{
+    if (m_speed > 0) m_speed--;
+    m_paused = false;
+}
+
+float CSimTimeController::scale(void) const
+{
+    return m_paused ? 0.0f : SIM_SPEEDS[m_speed];
+}
+
+const char* CSimTimeController::label(void) const
+{
+    return m_paused ? "paused" : SIM_SPEED_LABELS[m_speed];
+}
+
+float CSimTimeController::frameBudget(float frameTime) const
+{
+    // 창을 끌거나 중단점에 멈췄던 frame이 한꺼번에 진행되지 않게 한다.
+    if (frameTime > SIM_MAX_FRAME_TIME) frameTime = SIM_MAX_FRAME_TIME;
+    if (frameTime < 0.0f) frameTime = 0.0f;
+    return frameTime * scale();
+}
+
+int splitSimTime(float budget, float* chunk)
+{
+    if (budget <= 0.0f) {
+        *chunk = 0.0f;
+        return 0;
+    }
+    int count = (int)ceilf(budget / SIM_MAX_CHUNK);
+    if (count < 1) count = 1;
+    *chunk = budget / count;
+    return count;
+}
@@ -0,0 +1,65 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: simClock.h
+//
+// Desc: 고해상도 단조 시계와 시뮬레이션 시간 조절.
+//       - CMonotonicClock: QueryPerformanceCounter (그 밖의 OS는 steady_clock)로 잰 실제 시간.
+//         timeGetTime은 1ms 단위이고 timer 해상도에 따라 15.6ms씩 뛰어 frame마다 step이 흔들린다.
+//       - CSimTimeController: 일시 정지, 느리게(1/8 ~ 1/2), 빠르게(2 ~ 16배), 즉시(instant).
+//         빠르게 돌릴 때는 한 frame에 여러 조각을 진행하고 화면은 한 번만 그린다.
+//         즉시는 샷이 끝날 때까지 frame마다 SIM_INSTANT_BUDGET의 실제 시간을 쓴다.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __simClockH__
+#define __simClockH__
+
+#include <stdint.h>
+
+const int    SIM_SPEED_COUNT = 9;
+const int    SIM_SPEED_NORMAL = 3;                  // 1배속
+const int    SIM_SPEED_INSTANT = SIM_SPEED_COUNT - 1;
+const float  SIM_MAX_FRAME_TIME = 0.07f;            // 1배속 한 frame의 상한 (멈췄다 돌아온 frame, 시뮬레이션 초)
+const float  SIM_MAX_CHUNK = 0.025f;                // 한 번에 진행하는 시뮬레이션 시간의 상한
+const double SIM_FRAME_BUDGET = 0.05;               // 빠르게 돌릴 때 한 frame에 쓰는 실제 시간의 상한 (초)
+const double SIM_INSTANT_BUDGET = 0.03;             // 즉시 모드에서 한 frame에 쓰는 실제 시간 (초)
+
+class CMonotonicClock {
+public:
+    CMonotonicClock(void);
+
+    // 만든 뒤 지난 실제 시간 (초). 뒤로 가지 않는다.
+    double seconds(void) const;
+
+private:
+    int64_t m_start;
+    double  m_period;       // tick 하나의 초
+};
+
+class CSimTimeController {
+public:
+    CSimTimeController(void) : m_speed(SIM_SPEED_NORMAL), m_paused(false) {}
+
+    void togglePause(void) { m_paused = !m_paused; }
+    void faster(void);
+    void slower(void);
+    void normal(void) { m_speed = SIM_SPEED_NORMAL; m_paused = false; }
+
+    bool paused(void) const { return m_paused; }
+    bool instant(void) const { return !m_paused && m_speed == SIM_SPEED_INSTANT; }
+    // 배속 (즉시는 마지막 빠르기와 같게 본다)
+    float scale(void) const;
+    const char* label(void) const;      // "paused", "1/4x", "16x", "instant" ...
+
+    // 1배속 기준 frame 시간(EnterMsgLoop의 timeDelta)에서 이번 frame에 진행할 시간
+    float frameBudget(float frameTime) const;
+
+private:
+    int  m_speed;           // SIM_SPEEDS의 칸
+    bool m_paused;
+};
+
+// budget을 SIM_MAX_CHUNK 이하의 같은 조각으로 나눈다. 조각 수를 돌려준다 (budget이 0이면 0).
+int splitSimTime(float budget, float* chunk);
+
+#endif // __simClockH__
@@ -0,0 +1,327 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: simdMath.h
+//
+// Desc: 시뮬레이션 코드에서 쓰는 작은 header-only 수학 library.
+//       float2 / float3 / quat / float4x4 와 그 연산을 제공한다. 4개 묶음 연산
+//       (행렬 곱, quaternion 곱, 점 변환)은 SSE 또는 NEON intrinsic으로, 그 외 환경은
+//       같은 식의 scalar 구현으로 처리한다. SIMD_MATH_FORCE_SCALAR를 정의하면
+//       항상 scalar 구현을 쓴다.
+//
+//       모든 값은 float이다. 행렬은 D3D와 같은 row-major, 행 벡터 규약(p' = p * M)이므로
+//       그리는 쪽에서 D3DXMATRIX로 그대로 복사할 수 있다. D3DX에는 의존하지 않는다.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __simdMathH__
+#define __simdMathH__
+
+#include <math.h>
+
+#if defined(SIMD_MATH_FORCE_SCALAR)
+#define SIMD_MATH_SCALAR 1
+#elif defined(__SSE__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define SIMD_MATH_SSE 1
+#include <xmmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#define SIMD_MATH_NEON 1
+#include <arm_neon.h>
+#else
+#define SIMD_MATH_SCALAR 1
+#endif
+
+// -----------------------------------------------------------------------------
+// float2 (테이블 평면의 x, z)
+// -----------------------------------------------------------------------------
+
+struct float2 {
+    float x, y;
+};
+
+inline float2 make_float2(float x, float y) { float2 r = { x, y }; return r; }
+
+inline float2 operator+(float2 a, float2 b) { return make_float2(a.x + b.x, a.y + b.y); }
+inline float2 operator-(float2 a, float2 b) { return make_float2(a.x - b.x, a.y - b.y); }
+inline float2 operator-(float2 a) { return make_float2(-a.x, -a.y); }
+inline float2 operator*(float2 a, float s) { return make_float2(a.x * s, a.y * s); }
+inline float2 operator*(float s, float2 a) { return make_float2(a.x * s, a.y * s); }
+inline float2 operator/(float2 a, float s) { return a * (1.0f / s); }
+inline float2& operator+=(float2& a, float2 b) { a.x += b.x; a.y += b.y; return a; }
+inline float2& operator-=(float2& a, float2 b) { a.x -= b.x; a.y -= b.y; return a; }
+
+inline float dot(float2 a, float2 b) { return a.x * b.x + a.y * b.y; }
+inline float lengthSq(float2 a) { return dot(a, a); }
+inline float length(float2 a) { return sqrtf(dot(a, a)); }
+// 2D 외적 (a x b 의 수직 성분)
+inline float cross(float2 a, float2 b) { return a.x * b.y - a.y * b.x; }
+// 90도 돌린 벡터 (-y, x)
+inline float2 perp(float2 a) { return make_float2(-a.y, a.x); }
+
+// 길이가 0이면 0 벡터
+inline float2 normalize(float2 a)
+{
+    float len = length(a);
+    return len > 0.0f ? a / len : make_float2(0.0f, 0.0f);
+}
+
+// -----------------------------------------------------------------------------
+// float3
+// -----------------------------------------------------------------------------
+
+struct float3 {
+    float x, y, z;
+};
+
+inline float3 make_float3(float x, float y, float z) { float3 r = { x, y, z }; return r; }
+
+inline float3 operator+(float3 a, float3 b) { return make_float3(a.x + b.x, a.y + b.y, a.z + b.z); }
+inline float3 operator-(float3 a, float3 b) { return make_float3(a.x - b.x, a.y - b.y, a.z - b.z); }
+inline float3 operator-(float3 a) { return make_float3(-a.x, -a.y, -a.z); }
+inline float3 operator*(float3 a, float s) { return make_float3(a.x * s, a.y * s, a.z * s); }
+inline float3 operator*(float s, float3 a) { return a * s; }
+inline float3 operator/(float3 a, float s) { return a * (1.0f / s); }
+inline float3& operator+=(float3& a, float3 b) { a.x += b.x; a.y += b.y; a.z += b.z; return a; }
+
+inline float dot(float3 a, float3 b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+inline float lengthSq(float3 a) { return dot(a, a); }
+inline float length(float3 a) { return sqrtf(dot(a, a)); }
+inline float3 cross(float3 a, float3 b)
+{
+    return make_float3(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+}
+
+inline float3 normalize(float3 a)
+{
+    float len = length(a);
+    return len > 0.0f ? a / len : make_float3(0.0f, 0.0f, 0.0f);
+}
+
+// -----------------------------------------------------------------------------
+// 4개 묶음 register
+// -----------------------------------------------------------------------------
+
+struct simd4 {
+#if defined(SIMD_MATH_SSE)
+    __m128 v;
+#elif defined(SIMD_MATH_NEON)
+    float32x4_t v;
+#else
+    float v[4];
+#endif
+};
+
+inline simd4 simd4_load(const float* p)
+{
+    simd4 r;
+#if defined(SIMD_MATH_SSE)
+    r.v = _mm_loadu_ps(p);
+#elif defined(SIMD_MATH_NEON)
+    r.v = vld1q_f32(p);
+#else
+    r.v[0] = p[0]; r.v[1] = p[1]; r.v[2] = p[2]; r.v[3] = p[3];
+#endif
+    return r;
+}
+
+inline void simd4_store(float* p, simd4 a)
+{
+#if defined(SIMD_MATH_SSE)
+    _mm_storeu_ps(p, a.v);
+#elif defined(SIMD_MATH_NEON)
+    vst1q_f32(p, a.v);
+#else
+    p[0] = a.v[0]; p[1] = a.v[1]; p[2] = a.v[2]; p[3] = a.v[3];
+#endif
+}
+
+inline simd4 simd4_set(float x, float y, float z, float w)
+{
+    const float p[4] = { x, y, z, w };
+    return simd4_load(p);
+}
+
+inline simd4 simd4_splat(float s)
+{
+    simd4 r;
+#if defined(SIMD_MATH_SSE)
+    r.v = _mm_set1_ps(s);
+#elif defined(SIMD_MATH_NEON)
+    r.v = vdupq_n_f32(s);
+#else
+    r.v[0] = r.v[1] = r.v[2] = r.v[3] = s;
+#endif
+    return r;
+}
+
+inline simd4 simd4_add(simd4 a, simd4 b)
+{
+    simd4 r;
+#if defined(SIMD_MATH_SSE)
+    r.v = _mm_add_ps(a.v, b.v);
+#elif defined(SIMD_MATH_NEON)
+    r.v = vaddq_f32(a.v, b.v);
+#else
+    for (int i = 0; i < 4; i++) r.v[i] = a.v[i] + b.v[i];
+#endif
+    return r;
+}
+
+inline simd4 simd4_mul(simd4 a, simd4 b)
+{
+    simd4 r;
+#if defined(SIMD_MATH_SSE)
+    r.v = _mm_mul_ps(a.v, b.v);
+#elif defined(SIMD_MATH_NEON)
+    r.v = vmulq_f32(a.v, b.v);
+#else
+    for (int i = 0; i < 4; i++) r.v[i] = a.v[i] * b.v[i];
+#endif
+    return r;
+}
+
+// a + b * c
+inline simd4 simd4_madd(simd4 a, simd4 b, simd4 c)
+{
+#if defined(SIMD_MATH_NEON)
+    simd4 r;
+    r.v = vmlaq_f32(a.v, b.v, c.v);
+    return r;
+#else
+    return simd4_add(a, simd4_mul(b, c));
+#endif
+}
+
+// -----------------------------------------------------------------------------
+// quat (x, y, z, w). 단위 quaternion q가 나타내는 회전을 R(q)라 하면
+// R(a * b) 는 R(b)를 먼저, R(a)를 나중에 적용한 회전이다.
+// -----------------------------------------------------------------------------
+
+struct quat {
+    float x, y, z, w;
+};
+
+inline quat make_quat(float x, float y, float z, float w) { quat r = { x, y, z, w }; return r; }
+inline quat quatIdentity(void) { return make_quat(0.0f, 0.0f, 0.0f, 1.0f); }
+
+// 단위 축 axis를 중심으로 angle(라디안) 회전
+inline quat quatFromAxisAngle(float3 axis, float angle)
+{
+    float s = sinf(angle * 0.5f);
+    return make_quat(axis.x * s, axis.y * s, axis.z * s, cosf(angle * 0.5f));
+}
+
+inline quat operator*(quat a, quat b)
+{
+    simd4 r = simd4_mul(simd4_splat(a.w), simd4_set(b.x, b.y, b.z, b.w));
+    r = simd4_madd(r, simd4_splat(a.x), simd4_set(b.w, -b.z, b.y, -b.x));
+    r = simd4_madd(r, simd4_splat(a.y), simd4_set(b.z, b.w, -b.x, -b.y));
+    r = simd4_madd(r, simd4_splat(a.z), simd4_set(-b.y, b.x, b.w, -b.z));
+    quat q;
+    simd4_store(&q.x, r);
+    return q;
+}
+
+inline quat normalize(quat q)
+{
+    float len = sqrtf(q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w);
+    if (len <= 0.0f)
+        return quatIdentity();
+    float inv = 1.0f / len;
+    return make_quat(q.x * inv, q.y * inv, q.z * inv, q.w * inv);
+}
+
+// v를 q로 회전
+inline float3 rotate(quat q, float3 v)
+{
+    float3 u = make_float3(q.x, q.y, q.z);
+    float3 t = cross(u, v) * 2.0f;
+    return v + t * q.w + cross(u, t);
+}
+
+// 각속도 omega(라디안/시간)로 t 동안 돈 뒤의 방향. omega는 world 축 기준이다.
+// 결과는 정규화하지 않으므로 여러 번 쌓은 뒤에는 호출하는 쪽에서 normalize한다.
+inline quat integrateRotation(quat q, float3 omega, float t)
+{
+    float rate = length(omega);
+    if (rate <= 0.0f)
+        return q;
+    return quatFromAxisAngle(omega / rate, rate * t) * q;
+}
+
+// -----------------------------------------------------------------------------
+// float4x4 (row-major, p' = p * M)
+// -----------------------------------------------------------------------------
+
+struct float4x4 {
+    float m[4][4];
+};
+
+inline float4x4 float4x4Identity(void)
+{
+    float4x4 r = { { { 1, 0, 0, 0 }, { 0, 1, 0, 0 }, { 0, 0, 1, 0 }, { 0, 0, 0, 1 } } };
+    return r;
+}
+
+inline float4x4 float4x4Translation(float3 t)
+{
+    float4x4 r = float4x4Identity();
+    r.m[3][0] = t.x;
+    r.m[3][1] = t.y;
+    r.m[3][2] = t.z;
+    return r;
+}
+
+// 행 벡터 규약의 회전 행렬: p * M = rotate(q, p)
+inline float4x4 float4x4Rotation(quat q)
+{
+    float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+    float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+    float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+
+    float4x4 r = { { {
+        1 - 2 * (yy + zz), 2 * (xy + wz), 2 * (xz - wy), 0 }, {
+        2 * (xy - wz), 1 - 2 * (xx + zz), 2 * (yz + wx), 0 }, {
+        2 * (xz + wy), 2 * (yz - wx), 1 - 2 * (xx + yy), 0 }, {
+        0, 0, 0, 1 } } };
+    return r;
+}
+
+// 회전 q 후 t만큼 이동 (D3DX의 R * T)
+inline float4x4 float4x4RotationTranslation(quat q, float3 t)
+{
+    float4x4 r = float4x4Rotation(q);
+    r.m[3][0] = t.x;
+    r.m[3][1] = t.y;
+    r.m[3][2] = t.z;
+    return r;
+}
+
+// a를 먼저, b를 나중에 적용하는 행렬 (a * b)
+inline float4x4 operator*(const float4x4& a, const float4x4& b)
+{
+    simd4 b0 = simd4_load(b.m[0]), b1 = simd4_load(b.m[1]);
+    simd4 b2 = simd4_load(b.m[2]), b3 = simd4_load(b.m[3]);
+    float4x4 r;
+    for (int i = 0; i < 4; i++) {
+        simd4 row = simd4_mul(simd4_splat(a.m[i][0]), b0);
+        row = simd4_madd(row, simd4_splat(a.m[i][1]), b1);
+        row = simd4_madd(row, simd4_splat(a.m[i][2]), b2);
+        row = simd4_madd(row, simd4_splat(a.m[i][3]), b3);
+        simd4_store(r.m[i], row);
+    }
+    return r;
+}
+
+// 점 p (w = 1)를 변환
+inline float3 transformPoint(float3 p, const float4x4& m)
+{
+    simd4 r = simd4_load(m.m[3]);
+    r = simd4_madd(r, simd4_splat(p.x), simd4_load(m.m[0]));
+    r = simd4_madd(r, simd4_splat(p.y), simd4_load(m.m[1]));
+    r = simd4_madd(r, simd4_splat(p.z), simd4_load(m.m[2]));
+    float out[4];
+    simd4_store(out, r);
+    return make_float3(out[0], out[1], out[2]);
+}
+
+#endif // __simdMathH__
@@ -0,0 +1,492 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: softRenderer.cpp
+//
+// Desc: tile 기반 software rasterizer 구현.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "softRenderer.h"
+#include "tableLayout.h"
+#include "threadPool.h"
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <new>
+
+namespace
+{
+    // Setup과 같은 값들
+    const float  NEAR_Z = 1.0f;                     // D3DXMatrixPerspectiveFovLH의 near
+    const float  LIGHT_AMBIENT = 0.9f;
+    const float  LIGHT_SPECULAR = 0.9f;
+    const float  LIGHT_ATTENUATION1 = 0.9f;
+    const float  SPECULAR_POWER = 5.0f;
+    const float  PLANE_Y = -0.0006f / 5, PLANE_HEIGHT = 0.03f;
+    const float  WALL_Y = 0.12f, WALL_HEIGHT = 0.7f;
+    const float  POCKET_Y = 0.1f;
+    const uint32_t BACKGROUND = 0xafafaf;           // Display의 Clear 색
+
+    const float3 GREEN = { 0.0f, 1.0f, 0.0f };
+    const float3 DARKRED = { 215.0f / 255.0f, 0.0f, 0.0f };
+    const float3 BLACK = { 0.0f, 0.0f, 0.0f };
+    const float3 WHITE = { 1.0f, 1.0f, 1.0f };
+
+    float3 mul(float3 a, float3 b) { return make_float3(a.x * b.x, a.y * b.y, a.z * b.z); }
+    quat conjugate(quat q) { return make_quat(-q.x, -q.y, -q.z, q.w); }
+
+    uint32_t packColor(float3 c)
+    {
+        // 정수로 바꾸기 전에 float로 자른다 (분기 없이 min/max가 된다).
+        float r = c.x * 255.0f + 0.5f, g = c.y * 255.0f + 0.5f, b = c.z * 255.0f + 0.5f;
+        r = r < 0.0f ? 0.0f : r > 255.0f ? 255.0f : r;
+        g = g < 0.0f ? 0.0f : g > 255.0f ? 255.0f : g;
+        b = b < 0.0f ? 0.0f : b > 255.0f ? 255.0f : b;
+        return ((uint32_t)r << 16) | ((uint32_t)g << 8) | (uint32_t)b;
+    }
+
+    float3 unpackColor(uint32_t c)
+    {
+        const float scale = 1.0f / 255.0f;
+        return make_float3(((c >> 16) & 0xff) * scale, ((c >> 8) & 0xff) * scale, (c & 0xff) * scale);
+    }
+
+    // 중심 각 center에서 반각 half만큼 벌어진 방향을 화면 좌표로 (한 축)
+    void projectExtent(float lateral, float depth, float radius, float focal, float* lo, float* hi)
+    {
+        float dist = sqrtf(lateral * lateral + depth * depth);
+        float angle = atan2f(lateral, depth);
+        float half = asinf(radius / dist);
+        const float limit = 1.5f;   // 거의 옆으로 벗어난 방향은 화면 끝까지로 본다
+        *lo = angle - half < -limit ? -FLT_MAX : focal * tanf(angle - half);
+        *hi = angle + half > limit ? FLT_MAX : focal * tanf(angle + half);
+    }
+
+    struct TileBody {
+        const CSoftRenderer* renderer;
+        void operator()(int begin, int end) const
+        {
+            for (int tile = begin; tile < end; tile++)
+                renderer->renderTile(tile);
+        }
+    };
+}
+
+CSoftRenderer::CSoftRenderer(CThreadPool* pool)
+    : m_pool(pool), m_width(0), m_height(0), m_tilesX(0), m_tilesY(0), m_rgb(NULL),
+    m_tileTriangles(NULL), m_tileTriangleCount(NULL), m_tileSpheres(NULL),
+    m_numTriangles(0), m_numSpheres(0)
+{
+}
+
+CSoftRenderer::~CSoftRenderer(void)
+{
+    delete[] m_rgb;
+    delete[] m_tileTriangles;
+    delete[] m_tileTriangleCount;
+    delete[] m_tileSpheres;
+}
+
+bool CSoftRenderer::resize(int width, int height)
+{
+    if (width <= 0 || height <= 0)
+        return false;
+    if (width == m_width && height == m_height)
+        return true;
+
+    delete[] m_rgb;
+    delete[] m_tileTriangles;
+    delete[] m_tileTriangleCount;
+    delete[] m_tileSpheres;
+
+    m_width = width;
+    m_height = height;
+    m_tilesX = (width + SOFT_TILE_SIZE - 1) / SOFT_TILE_SIZE;
+    m_tilesY = (height + SOFT_TILE_SIZE - 1) / SOFT_TILE_SIZE;
+    int tiles = m_tilesX * m_tilesY;
+    m_rgb = new (std::nothrow) uint8_t[(size_t)width * height * 3];
+    m_tileTriangles = new (std::nothrow) uint16_t[(size_t)tiles * SOFT_MAX_TRIANGLES];
+    m_tileTriangleCount = new (std::nothrow) int[tiles];
+    m_tileSpheres = new (std::nothrow) uint32_t[tiles];
+    if (m_rgb == NULL || m_tileTriangles == NULL || m_tileTriangleCount == NULL || m_tileSpheres == NULL) {
+        m_width = m_height = 0;
+        return false;
+    }
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+// 장면 준비
+// -----------------------------------------------------------------------------
+
+void CSoftRenderer::setupCamera(const SoftScene& scene)
+{
+    // D3DXMatrixLookAtLH와 같은 축
+    m_eye = scene.eye;
+    m_forward = normalize(scene.target - scene.eye);
+    m_right = normalize(cross(scene.up, m_forward));
+    m_upAxis = cross(m_forward, m_right);
+    // 종횡비는 화면 크기를 따르므로 화소는 정사각형이고 초점 거리는 두 축이 같다.
+    m_focalY = m_height * 0.5f / tanf(scene.fovY * 0.5f);
+    m_focalX = m_focalY;
+    m_light = scene.light;
+}
+
+float3 CSoftRenderer::toView(float3 p) const
+{
+    float3 d = p - m_eye;
+    return make_float3(dot(d, m_right), dot(d, m_upAxis), dot(d, m_forward));
+}
+
+// D3D 고정 기능 조명과 같은 식: 재질 색 * (ambient + diffuse) * 감쇠 + specular 색 * specular * 감쇠.
+// 결과의 x에 ambient + diffuse 비율, y에 specular 비율을 담는다.
+float3 CSoftRenderer::shade(float3 position, float3 normal) const
+{
+    float3 toLight = m_light - position;
+    float dist = length(toLight);
+    toLight = toLight / dist;
+    float attenuation = 1.0f / (LIGHT_ATTENUATION1 * dist);
+
+    float diffuse = dot(normal, toLight);
+    if (diffuse < 0.0f) diffuse = 0.0f;
+    float specular = 0.0f;
+    if (diffuse > 0.0f) {
+        float3 half = normalize(toLight + normalize(m_eye - position));
+        float nh = dot(normal, half);
+        if (nh > 0.0f) specular = powf(nh, SPECULAR_POWER) * LIGHT_SPECULAR;
+    }
+    return make_float3((LIGHT_AMBIENT + diffuse) * attenuation, specular * attenuation, 0.0f);
+}
+
+void CSoftRenderer::addTriangle(const float3* view, const float3* color)
+{
+    // near 평면으로 자른 다각형 (삼각형 하나가 최대 사각형이 된다)
+    float3 polyView[4], polyColor[4];
+    int count = 0;
+    for (int i = 0; i < 3; i++) {
+        int j = (i + 1) % 3;
+        bool inI = view[i].z >= NEAR_Z, inJ = view[j].z >= NEAR_Z;
+        if (inI) {
+            polyView[count] = view[i];
+            polyColor[count] = color[i];
+            count++;
+        }
+        if (inI != inJ) {
+            float t = (NEAR_Z - view[i].z) / (view[j].z - view[i].z);
+            polyView[count] = view[i] + (view[j] - view[i]) * t;
+            polyColor[count] = color[i] + (color[j] - color[i]) * t;
+            count++;
+        }
+    }
+
+    Vertex projected[4];
+    for (int i = 0; i < count; i++) {
+        float invZ = 1.0f / polyView[i].z;
+        projected[i].x = m_width * 0.5f + m_focalX * polyView[i].x * invZ;
+        projected[i].y = m_height * 0.5f - m_focalY * polyView[i].y * invZ;
+        projected[i].invZ = invZ;
+        projected[i].colorOverZ = polyColor[i] * invZ;
+    }
+    for (int i = 1; i + 1 < count && m_numTriangles < SOFT_MAX_TRIANGLES; i++) {
+        Triangle& tri = m_triangles[m_numTriangles++];
+        tri.v[0] = projected[0];
+        tri.v[1] = projected[i];
+        tri.v[2] = projected[i + 1];
+    }
+}
+
+// D3DXCreateBox처럼 면마다 법선을 가진 box. 꼭짓점마다 빛을 계산한다 (Gouraud).
+void CSoftRenderer::addBox(float3 center, float3 size, float3 color)
+{
+    static const float3 normals[6] = {
+        { 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 }
+    };
+    const float3 half = size * 0.5f;
+    for (int f = 0; f < 6; f++) {
+        const float3 n = normals[f];
+        // 면 위의 두 축
+        float3 a = fabsf(n.x) > 0.0f ? make_float3(0, 1, 0) : make_float3(1, 0, 0);
+        float3 b = cross(n, a);
+        float3 faceCenter = center + mul(n, half);
+        float3 ea = mul(a, half), eb = mul(b, half);
+
+        float3 corners[4] = { faceCenter - ea - eb, faceCenter + ea - eb, faceCenter + ea + eb, faceCenter - ea + eb };
+        float3 view[4], lit[4];
+        for (int c = 0; c < 4; c++) {
+            float3 s = shade(corners[c], n);
+            lit[c] = color * (s.x + s.y);
+            view[c] = toView(corners[c]);
+        }
+        float3 v0[3] = { view[0], view[1], view[2] }, c0[3] = { lit[0], lit[1], lit[2] };
+        float3 v1[3] = { view[0], view[2], view[3] }, c1[3] = { lit[0], lit[2], lit[3] };
+        addTriangle(v0, c0);
+        addTriangle(v1, c1);
+    }
+}
+
+void CSoftRenderer::addSphere(float3 center, float radius, float3 color, bool lit, quat orientation, const SoftTexture* texture)
+{
+    if (m_numSpheres >= SOFT_MAX_SPHERES)
+        return;
+    float3 view = toView(center);
+    if (view.z <= radius)
+        return;     // 카메라에 걸치거나 뒤에 있음
+
+    float loX, hiX, loY, hiY;
+    projectExtent(view.x, view.z, radius, m_focalX, &loX, &hiX);
+    projectExtent(view.y, view.z, radius, m_focalY, &loY, &hiY);
+    float minX = m_width * 0.5f + loX, maxX = m_width * 0.5f + hiX;
+    float minY = m_height * 0.5f - hiY, maxY = m_height * 0.5f - loY;
+    if (maxX < 0 || maxY < 0 || minX >= m_width || minY >= m_height)
+        return;
+
+    Sphere& s = m_spheres[m_numSpheres++];
+    s.center = center;
+    s.radius = radius;
+    s.color = color;
+    s.lit = lit;
+    s.inverse = conjugate(orientation);
+    s.texture = texture;
+    s.minX = minX < 0 ? 0 : (int)minX;
+    s.minY = minY < 0 ? 0 : (int)minY;
+    s.maxX = maxX >= m_width ? m_width - 1 : (int)maxX;
+    s.maxY = maxY >= m_height ? m_height - 1 : (int)maxY;
+}
+
+// 변 from -> to의 안쪽(edge function >= 0)에 tile의 어느 화소 중심도 없으면 true
+bool CSoftRenderer::tileOutsideEdge(const Vertex& from, const Vertex& to, int tx, int ty) const
+{
+    float dx = to.x - from.x, dy = to.y - from.y;
+    // edge function이 가장 큰 모서리 화소
+    float x = (float)(tx * SOFT_TILE_SIZE) + (dy < 0.0f ? SOFT_TILE_SIZE - 0.5f : 0.5f);
+    float y = (float)(ty * SOFT_TILE_SIZE) + (dx > 0.0f ? SOFT_TILE_SIZE - 0.5f : 0.5f);
+    return dx * (y - from.y) - dy * (x - from.x) < 0.0f;
+}
+
+void CSoftRenderer::binPrimitives(void)
+{
+    int tiles = m_tilesX * m_tilesY;
+    memset(m_tileTriangleCount, 0, sizeof(int) * tiles);
+    memset(m_tileSpheres, 0, sizeof(uint32_t) * tiles);
+
+    for (int t = 0; t < m_numTriangles; t++) {
+        const Triangle& tri = m_triangles[t];
+        float minX = tri.v[0].x, maxX = minX, minY = tri.v[0].y, maxY = minY;
+        for (int i = 1; i < 3; i++) {
+            if (tri.v[i].x < minX) minX = tri.v[i].x;
+            if (tri.v[i].x > maxX) maxX = tri.v[i].x;
+            if (tri.v[i].y < minY) minY = tri.v[i].y;
+            if (tri.v[i].y > maxY) maxY = tri.v[i].y;
+        }
+        if (maxX < 0 || maxY < 0 || minX >= m_width || minY >= m_height) continue;
+        // 뒷면 (화면에서 시계 반대로 도는 면)은 닫힌 box의 앞면이 가리므로 담지 않는다.
+        const Vertex& a = tri.v[0];
+        const Vertex& b = tri.v[1];
+        const Vertex& c = tri.v[2];
+        if ((b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x) <= 0.0f) continue;
+        int tx0 = minX < 0 ? 0 : (int)minX / SOFT_TILE_SIZE;
+        int ty0 = minY < 0 ? 0 : (int)minY / SOFT_TILE_SIZE;
+        int tx1 = maxX >= m_width ? m_tilesX - 1 : (int)maxX / SOFT_TILE_SIZE;
+        int ty1 = maxY >= m_height ? m_tilesY - 1 : (int)maxY / SOFT_TILE_SIZE;
+        for (int ty = ty0; ty <= ty1; ty++) {
+            for (int tx = tx0; tx <= tx1; tx++) {
+                // 어느 한 변의 바깥에 tile 전체가 있으면 건너뛴다 (긴 비스듬한 레일 면).
+                if (tileOutsideEdge(a, b, tx, ty) || tileOutsideEdge(b, c, tx, ty) || tileOutsideEdge(c, a, tx, ty))
+                    continue;
+                int tile = ty * m_tilesX + tx;
+                m_tileTriangles[tile * SOFT_MAX_TRIANGLES + m_tileTriangleCount[tile]++] = (uint16_t)t;
+            }
+        }
+    }
+
+    for (int s = 0; s < m_numSpheres; s++) {
+        const Sphere& sphere = m_spheres[s];
+        for (int ty = sphere.minY / SOFT_TILE_SIZE; ty <= sphere.maxY / SOFT_TILE_SIZE; ty++) {
+            for (int tx = sphere.minX / SOFT_TILE_SIZE; tx <= sphere.maxX / SOFT_TILE_SIZE; tx++)
+                m_tileSpheres[ty * m_tilesX + tx] |= 1u << s;
+        }
+    }
+}
+
+void CSoftRenderer::render(const SoftScene& scene)
+{
+    if (m_rgb == NULL)
+        return;
+    setupCamera(scene);
+    m_numTriangles = 0;
+    m_numSpheres = 0;
+
+    const TableLayout& table = activeTable();
+    addBox(make_float3((table.minX + table.maxX) * 0.5f, PLANE_Y, (table.minZ + table.maxZ) * 0.5f),
+        make_float3(table.maxX - table.minX, PLANE_HEIGHT, table.maxZ - table.minZ), GREEN);
+    for (int i = 0; i < NUM_WALLS; i++) {
+        const WallBox& wall = table.walls[i];
+        addBox(make_float3(wall.x, WALL_Y, wall.z), make_float3(wall.width, WALL_HEIGHT, wall.depth), DARKRED);
+    }
+    for (int p = 0; p < table.numPockets; p++) {
+        const PocketCircle& pocket = table.pockets[p];
+        addSphere(make_float3(pocket.x, POCKET_Y, pocket.z), pocket.radius, BLACK, false, quatIdentity(), NULL);
+    }
+    for (int i = 0; i < scene.numBalls; i++) {
+        const BallState& ball = scene.balls[i];
+        if (!ball.active) continue;
+        addSphere(make_float3(ball.x, ball.y, ball.z), (float)M_RADIUS, WHITE, true,
+            scene.orientations != NULL ? scene.orientations[i] : quatIdentity(),
+            scene.textures != NULL ? scene.textures[i] : NULL);
+    }
+
+    binPrimitives();
+
+    TileBody body = { this };
+    int tiles = m_tilesX * m_tilesY;
+    if (m_pool != NULL)
+        m_pool->parallelFor(tiles, 1, body);
+    else
+        body(0, tiles);
+}
+
+// -----------------------------------------------------------------------------
+// tile
+// -----------------------------------------------------------------------------
+
+void CSoftRenderer::renderTile(int tile) const
+{
+    const int x0 = (tile % m_tilesX) * SOFT_TILE_SIZE;
+    const int y0 = (tile / m_tilesX) * SOFT_TILE_SIZE;
+    const int w = m_width - x0 < SOFT_TILE_SIZE ? m_width - x0 : SOFT_TILE_SIZE;
+    const int h = m_height - y0 < SOFT_TILE_SIZE ? m_height - y0 : SOFT_TILE_SIZE;
+
+    uint32_t color[SOFT_TILE_SIZE * SOFT_TILE_SIZE];
+    float depth[SOFT_TILE_SIZE * SOFT_TILE_SIZE];     // 1 / view z (클수록 가깝다, 0: 비어 있음)
+    for (int i = 0; i < SOFT_TILE_SIZE * SOFT_TILE_SIZE; i++) {
+        color[i] = BACKGROUND;
+        depth[i] = 0.0f;
+    }
+
+    // 삼각형: 화소 중심에서 edge function, 1/z와 색/z를 보간한다 (원근 보정).
+    const uint16_t* list = m_tileTriangles + tile * SOFT_MAX_TRIANGLES;
+    for (int k = 0; k < m_tileTriangleCount[tile]; k++) {
+        const Triangle& tri = m_triangles[list[k]];
+        const Vertex& a = tri.v[0];
+        const Vertex& b = tri.v[1];
+        const Vertex& c = tri.v[2];
+        float area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+        if (area <= 0.0f) continue;
+        float invArea = 1.0f / area;
+
+        float minX = a.x < b.x ? (a.x < c.x ? a.x : c.x) : (b.x < c.x ? b.x : c.x);
+        float maxX = a.x > b.x ? (a.x > c.x ? a.x : c.x) : (b.x > c.x ? b.x : c.x);
+        float minY = a.y < b.y ? (a.y < c.y ? a.y : c.y) : (b.y < c.y ? b.y : c.y);
+        float maxY = a.y > b.y ? (a.y > c.y ? a.y : c.y) : (b.y > c.y ? b.y : c.y);
+        int px0 = (int)floorf(minX) - x0, px1 = (int)ceilf(maxX) - x0;
+        int py0 = (int)floorf(minY) - y0, py1 = (int)ceilf(maxY) - y0;
+        if (px0 < 0) px0 = 0;
+        if (py0 < 0) py0 = 0;
+        if (px1 > w - 1) px1 = w - 1;
+        if (py1 > h - 1) py1 = h - 1;
+
+        // 무게와 1/z, 색/z는 화면에서 선형이므로 한 칸 옮길 때의 변화량을 더해 간다.
+        const float dw0x = (b.y - c.y) * invArea;
+        const float dw1x = (c.y - a.y) * invArea;
+        const float dzx = (a.invZ - c.invZ) * dw0x + (b.invZ - c.invZ) * dw1x;
+        const float3 dcx = (a.colorOverZ - c.colorOverZ) * dw0x + (b.colorOverZ - c.colorOverZ) * dw1x;
+        for (int py = py0; py <= py1; py++) {
+            float sy = y0 + py + 0.5f;
+            float sx = x0 + px0 + 0.5f;
+            float w0 = ((b.x - sx) * (c.y - sy) - (b.y - sy) * (c.x - sx)) * invArea;
+            float w1 = ((c.x - sx) * (a.y - sy) - (c.y - sy) * (a.x - sx)) * invArea;
+            float invZ = c.invZ + (a.invZ - c.invZ) * w0 + (b.invZ - c.invZ) * w1;
+            float r = c.colorOverZ.x + (a.colorOverZ.x - c.colorOverZ.x) * w0 + (b.colorOverZ.x - c.colorOverZ.x) * w1;
+            float g = c.colorOverZ.y + (a.colorOverZ.y - c.colorOverZ.y) * w0 + (b.colorOverZ.y - c.colorOverZ.y) * w1;
+            float bl = c.colorOverZ.z + (a.colorOverZ.z - c.colorOverZ.z) * w0 + (b.colorOverZ.z - c.colorOverZ.z) * w1;
+            float* depthRow = depth + py * SOFT_TILE_SIZE;
+            uint32_t* colorRow = color + py * SOFT_TILE_SIZE;
+            for (int px = px0; px <= px1; px++, w0 += dw0x, w1 += dw1x, invZ += dzx, r += dcx.x, g += dcx.y, bl += dcx.z) {
+                if (w0 < 0.0f || w1 < 0.0f || w0 + w1 > 1.0f) continue;
+                if (invZ <= depthRow[px]) continue;
+                depthRow[px] = invZ;
+                float z = 1.0f / invZ;
+                colorRow[px] = packColor(make_float3(r * z, g * z, bl * z));
+            }
+        }
+    }
+
+    // 구: 화소마다 시선과 교차. 시선 방향을 forward 성분이 1이 되게 두면 t가 곧 view z이다.
+    uint32_t spheres = m_tileSpheres[tile];
+    while (spheres != 0) {
+        int s = 0;
+        while (!(spheres & (1u << s))) s++;
+        spheres &= ~(1u << s);
+        const Sphere& sphere = m_spheres[s];
+
+        int px0 = sphere.minX - x0, px1 = sphere.maxX - x0;
+        int py0 = sphere.minY - y0, py1 = sphere.maxY - y0;
+        if (px0 < 0) px0 = 0;
+        if (py0 < 0) py0 = 0;
+        if (px1 > w - 1) px1 = w - 1;
+        if (py1 > h - 1) py1 = h - 1;
+
+        const float3 oc = m_eye - sphere.center;
+        const float cc = dot(oc, oc) - sphere.radius * sphere.radius;
+        const float invRadius = 1.0f / sphere.radius;
+        for (int py = py0; py <= py1; py++) {
+            float vy = (m_height * 0.5f - (y0 + py + 0.5f)) / m_focalY;
+            for (int px = px0; px <= px1; px++) {
+                float vx = (x0 + px + 0.5f - m_width * 0.5f) / m_focalX;
+                float3 dir = m_forward + m_right * vx + m_upAxis * vy;
+                float a = dot(dir, dir);
+                float b = dot(oc, dir);
+                float disc = b * b - a * cc;
+                if (disc < 0.0f) continue;
+                float t = (-b - sqrtf(disc)) / a;
+                int index = py * SOFT_TILE_SIZE + px;
+                if (t <= 0.0f || 1.0f / t <= depth[index]) continue;
+                depth[index] = 1.0f / t;
+
+                if (!sphere.lit) {
+                    color[index] = packColor(sphere.color);
+                    continue;
+                }
+                float3 hit = m_eye + dir * t;
+                float3 normal = (hit - sphere.center) * invRadius;
+                float3 base = sphere.color;
+                if (sphere.texture != NULL) {
+                    // CSphere::create의 UV: 공 자신의 축에서 u = (atan2(z, x) + pi) / 2pi, v = acos(y) / pi
+                    float3 local = rotate(sphere.inverse, normal);
+                    float ly = local.y < -1.0f ? -1.0f : local.y > 1.0f ? 1.0f : local.y;
+                    float u = (atan2f(local.z, local.x) + 3.14159265f) * (0.5f / 3.14159265f);
+                    float v = acosf(ly) * (1.0f / 3.14159265f);
+                    const SoftTexture& tex = *sphere.texture;
+                    int tx = (int)(u * tex.width), ty = (int)(v * tex.height);
+                    if (tx >= tex.width) tx = tex.width - 1;
+                    if (ty >= tex.height) ty = tex.height - 1;
+                    base = unpackColor(tex.pixels[ty * tex.width + tx]);
+                }
+                float3 s3 = shade(hit, normal);
+                color[index] = packColor(base * s3.x + WHITE * s3.y);
+            }
+        }
+    }
+
+    for (int py = 0; py < h; py++) {
+        uint8_t* out = m_rgb + ((size_t)(y0 + py) * m_width + x0) * 3;
+        const uint32_t* row = color + py * SOFT_TILE_SIZE;
+        for (int px = 0; px < w; px++) {
+            out[px * 3] = (uint8_t)(row[px] >> 16);
+            out[px * 3 + 1] = (uint8_t)(row[px] >> 8);
+            out[px * 3 + 2] = (uint8_t)row[px];
+        }
+    }
+}
+
+bool writePPM(const char* path, const uint8_t* rgb, int width, int height)
+{
+    FILE* file = fopen(path, "wb");
+    if (file == NULL)
+        return false;
+    fprintf(file, "P6\n%d %d\n255\n", width, height);
+    size_t size = (size_t)width * height * 3;
+    bool ok = fwrite(rgb, 1, size, file) == size;
+    return fclose(file) == 0 && ok;
+}
@@ -0,0 +1,121 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: softRenderer.h
+//
+// Desc: GPU 없이 게임 화면을 그리는 tile 기반 software rasterizer (replay 영상 출력용).
+//       게임이 D3D로 그리는 것과 같은 장면을 그린다: activeTable()의 바닥(초록)과
+//       쿠션(레일 box), 포켓(검은 구), 그리고 공마다의 texture를 CSphere::create와 같은
+//       UV (u = (atan2(z, x) + pi) / 2pi, v = acos(y / r) / pi)로 붙인 공.
+//       빛은 Setup의 point light와 같은 값으로 ambient + diffuse + specular를 계산한다.
+//
+//       화면을 SOFT_TILE_SIZE 정사각형 tile로 나누고, 삼각형과 구를 덮는 tile에 나누어
+//       담은 뒤 tile마다 따로 (thread pool에서 나누어) 그린다. 삼각형은 Gouraud,
+//       구는 tile 안의 화소마다 ray로 교차점을 구해 그린다 (mesh 없이 정확한 윤곽).
+//       buffer는 resize에서만 잡으므로 render는 heap을 쓰지 않는다.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __softRendererH__
+#define __softRendererH__
+
+#include "billiardPhysics.h"
+#include <stdint.h>
+
+class CThreadPool;
+
+const int SOFT_TILE_SIZE = 64;
+const int SOFT_MAX_TRIANGLES = 256;     // 바닥 + 레일 box (near 평면에서 잘린 것 포함)
+const int SOFT_MAX_SPHERES = 32;        // 공 + 포켓
+
+// 0x00RRGGBB 화소를 행 순서로 둔 texture. 호출한 쪽이 가지고 있는다.
+struct SoftTexture {
+    int             width, height;
+    const uint32_t* pixels;
+};
+
+struct SoftScene {
+    const BallState*          balls;
+    int                       numBalls;
+    const quat*               orientations;   // 공마다의 방향 (CBallTransforms와 같은 뜻)
+    const SoftTexture* const* textures;       // 공마다, NULL이면 흰 공
+
+    // 카메라 (LH, 게임의 Setup과 같은 뜻)
+    float3 eye, target, up;
+    float  fovY;                              // 라디안
+    float3 light;                             // point light 위치
+};
+
+class CSoftRenderer {
+public:
+    // pool이 있으면 tile을 나누어 그린다.
+    explicit CSoftRenderer(CThreadPool* pool = 0);
+    ~CSoftRenderer(void);
+
+    // 화면 크기를 바꾸고 buffer를 잡는다. 실패하면 false.
+    bool resize(int width, int height);
+
+    void render(const SoftScene& scene);
+
+    int width(void) const { return m_width; }
+    int height(void) const { return m_height; }
+    // RGB 3 byte 화소, 행 순서 (width * height * 3)
+    const uint8_t* pixels(void) const { return m_rgb; }
+
+    // tile 하나를 그린다 (thread pool의 body에서 부른다).
+    void renderTile(int tile) const;
+
+private:
+    CSoftRenderer(const CSoftRenderer&);
+    CSoftRenderer& operator=(const CSoftRenderer&);
+
+    struct Vertex {
+        float  x, y;        // 화면 좌표
+        float  invZ;        // 1 / view z
+        float3 colorOverZ;  // 빛을 받은 색 / view z
+    };
+    struct Triangle {
+        Vertex v[3];
+    };
+    struct Sphere {
+        float3 center;
+        float  radius;
+        float3 color;       // texture가 없을 때의 재질 색
+        bool   lit;         // false면 재질 색 그대로 (포켓)
+        quat   inverse;     // world -> 공 자신의 축
+        const SoftTexture* texture;
+        int    minX, minY, maxX, maxY;  // 화면에서 덮는 화소 범위
+    };
+
+    void setupCamera(const SoftScene& scene);
+    float3 toView(float3 p) const;
+    float3 shade(float3 position, float3 normal) const;
+    void addBox(float3 center, float3 size, float3 color);
+    void addTriangle(const float3* view, const float3* color);
+    void addSphere(float3 center, float radius, float3 color, bool lit, quat orientation, const SoftTexture* texture);
+    bool tileOutsideEdge(const Vertex& from, const Vertex& to, int tx, int ty) const;
+    void binPrimitives(void);
+
+    CThreadPool* m_pool;
+    int          m_width, m_height;
+    int          m_tilesX, m_tilesY;
+    uint8_t*     m_rgb;
+
+    // tile마다 덮는 삼각형 번호 목록과 구 bit mask
+    uint16_t*    m_tileTriangles;   // [tile * SOFT_MAX_TRIANGLES]
+    int*         m_tileTriangleCount;
+    uint32_t*    m_tileSpheres;
+
+    // 이번 frame의 카메라와 primitive
+    float3   m_eye, m_right, m_upAxis, m_forward;
+    float    m_focalX, m_focalY;    // 화소 단위 초점 거리
+    float3   m_light;
+    Triangle m_triangles[SOFT_MAX_TRIANGLES];
+    int      m_numTriangles;
+    Sphere   m_spheres[SOFT_MAX_SPHERES];
+    int      m_numSpheres;
+};
+
+// 24-bit binary PPM (P6)으로 쓴다.
+bool writePPM(const char* path, const uint8_t* rgb, int width, int height);
+
+#endif // __softRendererH__
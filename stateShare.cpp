@@ -0,0 +1,300 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: stateShare.cpp
+//
+// Desc: 공유 메모리 테이블 상태 구현.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "stateShare.h"
+#include <cstdio>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// -----------------------------------------------------------------------------
+// 공유 메모리 구역
+// -----------------------------------------------------------------------------
+
+#ifdef _WIN32
+
+bool CSharedRegion::create(const char* name, int size)
+{
+    close();
+    char fullName[64];
+    _snprintf(fullName, sizeof(fullName), "Local\\%s", name);
+    fullName[sizeof(fullName) - 1] = '\0';
+
+    HANDLE mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, (DWORD)size, fullName);
+    if (mapping == NULL)
+        return false;
+    void* view = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+    if (view == NULL) {
+        CloseHandle(mapping);
+        return false;
+    }
+    m_view = view;
+    m_handle = (intptr_t)mapping;
+    m_size = size;
+    m_owner = true;
+    return true;
+}
+
+bool CSharedRegion::open(const char* name, int size)
+{
+    close();
+    char fullName[64];
+    _snprintf(fullName, sizeof(fullName), "Local\\%s", name);
+    fullName[sizeof(fullName) - 1] = '\0';
+
+    HANDLE mapping = OpenFileMappingA(FILE_MAP_READ, FALSE, fullName);
+    if (mapping == NULL)
+        return false;
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, size);
+    if (view == NULL) {
+        CloseHandle(mapping);
+        return false;
+    }
+    m_view = view;
+    m_handle = (intptr_t)mapping;
+    m_size = size;
+    m_owner = false;
+    return true;
+}
+
+void CSharedRegion::close(void)
+{
+    if (m_view != NULL)
+        UnmapViewOfFile(m_view);
+    if (m_handle != -1)
+        CloseHandle((HANDLE)m_handle);
+    m_view = NULL;
+    m_handle = -1;
+}
+
+#else
+
+bool CSharedRegion::create(const char* name, int size)
+{
+    close();
+    snprintf(m_name, sizeof(m_name), "/%s", name);
+
+    int fd = shm_open(m_name, O_CREAT | O_RDWR, 0644);
+    if (fd < 0)
+        return false;
+    void* view = MAP_FAILED;
+    if (ftruncate(fd, size) == 0)
+        view = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (view == MAP_FAILED) {
+        ::close(fd);
+        return false;
+    }
+    m_view = view;
+    m_handle = fd;
+    m_size = size;
+    m_owner = true;
+    return true;
+}
+
+bool CSharedRegion::open(const char* name, int size)
+{
+    close();
+    snprintf(m_name, sizeof(m_name), "/%s", name);
+
+    int fd = shm_open(m_name, O_RDONLY, 0);
+    if (fd < 0)
+        return false;
+    struct stat info;
+    void* view = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && info.st_size >= size)
+        view = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    if (view == MAP_FAILED) {
+        ::close(fd);
+        return false;
+    }
+    m_view = view;
+    m_handle = fd;
+    m_size = size;
+    m_owner = false;
+    return true;
+}
+
+void CSharedRegion::close(void)
+{
+    if (m_view != NULL)
+        munmap(m_view, m_size);
+    if (m_handle != -1)
+        ::close((int)m_handle);
+    // writer가 닫으면 이름을 지운다. 열려 있던 reader는 가진 mapping을 계속 쓴다.
+    if (m_handle != -1 && m_owner)
+        shm_unlink(m_name);
+    m_view = NULL;
+    m_handle = -1;
+}
+
+#endif
+
+// -----------------------------------------------------------------------------
+// writer
+// -----------------------------------------------------------------------------
+
+bool CStateShare::create(const char* name)
+{
+    close();
+    if (!m_region.create(name, sizeof(SharedStateHeader)))
+        return false;
+
+    // 구조를 알린다. 이전 writer가 남긴 구역이면 frame을 이어 간다.
+    m_header = (SharedStateHeader*)m_region.view();
+    bool reuse = m_header->magic == STATE_SHARE_MAGIC && m_header->version == STATE_SHARE_VERSION &&
+        m_header->slotSize == sizeof(SharedStateSlot) && m_header->slotCount == (uint32_t)STATE_SHARE_SLOTS;
+    if (!reuse) {
+        m_header->magic = 0;
+        std::atomic_thread_fence(std::memory_order_release);
+        for (int i = 0; i < STATE_SHARE_SLOTS; i++)
+            m_header->slots[i].sequence.store(0, std::memory_order_relaxed);
+        m_header->latest.store(0, std::memory_order_relaxed);
+        m_header->version = STATE_SHARE_VERSION;
+        m_header->slotSize = sizeof(SharedStateSlot);
+        m_header->slotCount = STATE_SHARE_SLOTS;
+        std::atomic_thread_fence(std::memory_order_release);
+        m_header->magic = STATE_SHARE_MAGIC;
+    }
+    m_frame = m_header->latest.load(std::memory_order_relaxed);
+    return true;
+}
+
+void CStateShare::close(void)
+{
+    m_region.close();
+    m_header = NULL;
+}
+
+void CStateShare::publish(const BallState* balls, const RuleState& rules, uint32_t step, int winner, bool shotInProgress)
+{
+    if (m_header == NULL)
+        return;
+
+    uint32_t frame = ++m_frame;
+    if (frame == 0)
+        frame = ++m_frame;
+    SharedStateSlot& slot = m_header->slots[frame % STATE_SHARE_SLOTS];
+
+    // 홀수로 올린 뒤의 쓰기가 그보다 앞서 보이지 않게 한다.
+    // (이전 writer가 쓰다 멈춘 칸도 홀수에서 시작하지 않도록 맞춘다)
+    uint32_t writing = (slot.sequence.load(std::memory_order_relaxed) + 1) | 1;
+    slot.sequence.store(writing, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    SharedTableState& state = slot.state;
+    state.frame = frame;
+    state.step = step;
+    for (int i = 0; i < NUM_BALLS; i++) {
+        state.x[i] = balls[i].x;
+        state.z[i] = balls[i].z;
+        state.vx[i] = balls[i].vx;
+        state.vz[i] = balls[i].vz;
+        state.active[i] = balls[i].active ? 1 : 0;
+    }
+    state.turn = rules.turn ? 1 : 0;
+    state.group = rules.group ? 1 : 0;
+    state.open = rules.open ? 1 : 0;
+    state.breakShot = rules.break_shot ? 1 : 0;
+    state.freeShot = rules.free_shot ? 1 : 0;
+    state.shotInProgress = shotInProgress ? 1 : 0;
+    state.winner = (int8_t)winner;
+    state.reserved = 0;
+    state.solidLeft = rules.solid_num;
+    state.stripeLeft = rules.stripe_num;
+
+    slot.sequence.store(writing + 1, std::memory_order_release);
+    m_header->latest.store(frame, std::memory_order_release);
+}
+
+// -----------------------------------------------------------------------------
+// reader
+// -----------------------------------------------------------------------------
+
+bool CStateShareReader::open(const char* name)
+{
+    close();
+    if (!m_region.open(name, sizeof(SharedStateHeader)))
+        return false;
+
+    const SharedStateHeader* header = (const SharedStateHeader*)m_region.view();
+    if (header->magic != STATE_SHARE_MAGIC || header->version != STATE_SHARE_VERSION ||
+        header->slotSize != sizeof(SharedStateSlot) || header->slotCount != (uint32_t)STATE_SHARE_SLOTS) {
+        m_region.close();
+        return false;
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    m_header = (SharedStateHeader*)header;
+    return true;
+}
+
+void CStateShareReader::close(void)
+{
+    m_region.close();
+    m_header = NULL;
+}
+
+uint32_t CStateShareReader::latestFrame(void) const
+{
+    return m_header != NULL ? m_header->latest.load(std::memory_order_acquire) : 0;
+}
+
+const SharedTableState* CStateShareReader::peek(uint32_t* ticket) const
+{
+    uint32_t frame = latestFrame();
+    if (frame == 0)
+        return NULL;
+    const SharedStateSlot& slot = m_header->slots[frame % STATE_SHARE_SLOTS];
+    uint32_t sequence = slot.sequence.load(std::memory_order_acquire);
+    if (sequence & 1)
+        return NULL;
+    *ticket = sequence;
+    return &slot.state;
+}
+
+const SharedStateSlot* CStateShareReader::slotOf(const SharedTableState* state) const
+{
+    for (int i = 0; i < STATE_SHARE_SLOTS; i++) {
+        if (&m_header->slots[i].state == state)
+            return &m_header->slots[i];
+    }
+    return NULL;
+}
+
+bool CStateShareReader::validate(const SharedTableState* state, uint32_t ticket) const
+{
+    const SharedStateSlot* slot = state != NULL ? slotOf(state) : NULL;
+    if (slot == NULL)
+        return false;
+    // 읽은 값이 sequence를 다시 읽기 전에 끝나도록 한다.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot->sequence.load(std::memory_order_relaxed) == ticket;
+}
+
+bool CStateShareReader::read(SharedTableState* out) const
+{
+    // writer가 ring을 한 바퀴 돌 만큼 오래 걸리는 경우만 다시 시도하므로 몇 번이면 된다.
+    for (int attempt = 0; attempt < 16; attempt++) {
+        uint32_t ticket;
+        const SharedTableState* state = peek(&ticket);
+        if (state == NULL) {
+            if (latestFrame() == 0) return false;
+            continue;
+        }
+        memcpy(out, state, sizeof(*out));
+        if (validate(state, ticket))
+            return true;
+    }
+    return false;
+}
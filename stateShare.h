@@ -0,0 +1,134 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: stateShare.h
+//
+// Desc: 게임의 테이블 상태를 공유 메모리로 내보낸다 (중계 overlay, 통계, 관전 도구).
+//       게임(writer)은 frame마다 상태를 STATE_SHARE_SLOTS칸 ring의 다음 칸에 쓰고,
+//       다른 process(reader)는 같은 이름의 공유 메모리를 읽기 전용으로 열어 최신 칸을 읽는다.
+//
+//       칸마다 seqlock을 둔다. writer는 sequence를 홀수로 올린 뒤 쓰고 짝수로 올려 닫은 다음
+//       header의 latest를 바꾼다. reader는 latest 칸의 sequence가 짝수일 때 읽고, 읽은 뒤에도
+//       sequence가 같으면 그 값을 쓴다. writer는 reader를 기다리거나 알지 못하므로 reader가
+//       몇이든 느려지지 않는다. ring이 한 바퀴 돌아야 읽던 칸을 덮으므로 다시 읽는 일은 드물다.
+//       읽는 데 system call은 없다 (열 때 한 번만).
+//
+//       공유하는 구조는 포인터가 없는 고정 크기이며 header의 version과 slotSize로 확인한다.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __stateShareH__
+#define __stateShareH__
+
+#include "billiardPhysics.h"
+#include <atomic>
+#include <stdint.h>
+
+#define STATE_SHARE_NAME "VirtualBilliardState"
+
+const uint32_t STATE_SHARE_MAGIC = 0x54534256;     // "VBST"
+const uint32_t STATE_SHARE_VERSION = 1;
+const int      STATE_SHARE_SLOTS = 8;
+
+// 한 frame의 테이블 상태
+struct SharedTableState {
+    uint32_t frame;             // 발행 번호 (1부터)
+    uint32_t step;              // lockstep step (없으면 0)
+    float    x[NUM_BALLS], z[NUM_BALLS];
+    float    vx[NUM_BALLS], vz[NUM_BALLS];
+    uint8_t  active[NUM_BALLS];
+    uint8_t  turn;              // 1: player 1 차례
+    uint8_t  group;             // 1: 차례인 사람의 그룹이 solid
+    uint8_t  open;              // 1: 그룹이 아직 정해지지 않음
+    uint8_t  breakShot;
+    uint8_t  freeShot;
+    uint8_t  shotInProgress;
+    int8_t   winner;            // 0: 진행 중, 1 / 2: 이긴 player
+    uint8_t  reserved;
+    int32_t  solidLeft, stripeLeft;
+};
+
+struct SharedStateSlot {
+    std::atomic<uint32_t> sequence;     // 홀수: 쓰는 중
+    uint32_t              reserved;
+    SharedTableState      state;
+};
+
+struct SharedStateHeader {
+    uint32_t              magic;
+    uint32_t              version;
+    uint32_t              slotSize;
+    uint32_t              slotCount;
+    std::atomic<uint32_t> latest;       // 마지막으로 다 쓴 frame (0: 아직 없음)
+    uint32_t              reserved[3];
+    SharedStateSlot       slots[STATE_SHARE_SLOTS];
+};
+
+// 공유 메모리 구역 하나 (Windows file mapping / POSIX shm)
+class CSharedRegion {
+public:
+    CSharedRegion(void) : m_view(0), m_handle(-1), m_size(0), m_owner(false) {}
+    ~CSharedRegion(void) { close(); }
+
+    bool create(const char* name, int size);
+    bool open(const char* name, int size);
+    void close(void);
+
+    void* view(void) const { return m_view; }
+
+private:
+    CSharedRegion(const CSharedRegion&);
+    CSharedRegion& operator=(const CSharedRegion&);
+
+    void*    m_view;
+    intptr_t m_handle;
+    int      m_size;
+    bool     m_owner;
+    char     m_name[64];
+};
+
+class CStateShare {
+public:
+    CStateShare(void) : m_header(0), m_frame(0) {}
+
+    // 같은 이름이 이미 있으면 그대로 이어 쓴다.
+    bool create(const char* name = STATE_SHARE_NAME);
+    void close(void);
+    bool isOpen(void) const { return m_header != 0; }
+
+    // 다음 칸에 상태를 쓰고 최신으로 알린다.
+    void publish(const BallState* balls, const RuleState& rules, uint32_t step, int winner, bool shotInProgress);
+
+private:
+    CSharedRegion      m_region;
+    SharedStateHeader* m_header;
+    uint32_t           m_frame;
+};
+
+class CStateShareReader {
+public:
+    CStateShareReader(void) : m_header(0) {}
+
+    // writer가 만든 구역을 연다. 없거나 구조가 다르면 false.
+    bool open(const char* name = STATE_SHARE_NAME);
+    void close(void);
+    bool isOpen(void) const { return m_header != 0; }
+
+    // 최신 frame 번호 (0: 아직 없음). 바뀌었는지만 볼 때 쓴다.
+    uint32_t latestFrame(void) const;
+
+    // 최신 상태를 out에 담는다. 아직 발행된 것이 없거나 계속 덮이면 false.
+    bool read(SharedTableState* out) const;
+
+    // 복사하지 않고 공유 메모리의 칸을 바로 본다. 다 읽은 뒤 validate가 true일 때만
+    // 읽은 값을 쓴다 (false면 읽는 동안 writer가 덮은 것이다).
+    const SharedTableState* peek(uint32_t* ticket) const;
+    bool validate(const SharedTableState* state, uint32_t ticket) const;
+
+private:
+    const SharedStateSlot* slotOf(const SharedTableState* state) const;
+
+    CSharedRegion      m_region;
+    SharedStateHeader* m_header;
+};
+
+#endif // __stateShareH__
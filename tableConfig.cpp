@@ -0,0 +1,17 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: tableConfig.cpp
+//
+// Desc: 테이블 구성 구현.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "tableConfig.h"
+#include "tableLayout.h"
+
+RuntimeTable::RuntimeTable(const TableLayout& layout, int ballCount)
+    : balls(ballCount), pockets(layout.numPockets), radius((float)M_RADIUS),
+    minX(layout.minX), maxX(layout.maxX), minZ(layout.minZ), maxZ(layout.maxZ),
+    pocketList(layout.pockets)
+{
+}
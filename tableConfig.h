@@ -0,0 +1,53 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: tableConfig.h
+//
+// Desc: 물리 코어의 테이블 구성 (공 수, 포켓, 쿠션 nose 직사각형, 반지름).
+//       활성 테이블(8-ball, 9-ball, snooker, carom ...)에서 step마다 만들어
+//       islandStepper와 fastForwardToRest가 경계와 포켓 판정에 쓴다.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __tableConfigH__
+#define __tableConfigH__
+
+#include "billiardPhysics.h"
+
+struct TableLayout;
+
+// table field는 격자 점 사이를 bilinear로 보간하므로 실제 경계까지 거리와 최대 격자 한 칸 정도
+// 차이가 난다. 그만큼 더 떨어져 있을 때만 field를 읽지 않고 "닿지 않음"으로 본다.
+const float TABLE_FIELD_SLACK = 0.05f;
+
+struct RuntimeTable {
+    RuntimeTable(const TableLayout& layout, int ballCount);
+
+    int   balls;
+    int   pockets;
+    float radius;
+    float minX, maxX;
+    float minZ, maxZ;
+    const PocketCircle* pocketList;
+
+    const PocketCircle& pocket(int p) const { return pocketList[p]; }
+};
+
+// 공 중심 (x, z)가 쿠션 nose 직사각형에서 반지름 + clearance 이상 안쪽이고
+// 모든 포켓 포획 원에서 clearance 이상 떨어져 있는지 (field의 오차만큼 여유를 둔다).
+// 쿠션 jaw와 mouth는 직사각형 바깥에 있으므로 이 안의 공은 어느 쿠션, 포켓과도 닿지 않는다.
+// 분기 없이 비교를 모두 and로 묶는다.
+inline bool isClearOfBoundary(const RuntimeTable& table, float x, float z, float clearance)
+{
+    const float inset = table.radius + clearance + TABLE_FIELD_SLACK;
+    bool clear = (x > table.minX + inset) & (x < table.maxX - inset) &
+        (z > table.minZ + inset) & (z < table.maxZ - inset);
+    for (int p = 0; p < table.pockets; p++) {
+        const PocketCircle& pocket = table.pocket(p);
+        const float dx = x - pocket.x, dz = z - pocket.z;
+        const float reach = pocket.radius + clearance + TABLE_FIELD_SLACK;
+        clear &= dx * dx + dz * dz > reach * reach;
+    }
+    return clear;
+}
+
+#endif // __tableConfigH__
@@ -0,0 +1,139 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: tableField.cpp
+//
+// Desc: 테이블 경계 signed distance field 구현.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "tableField.h"
+#include <cmath>
+#include <cfloat>
+
+namespace
+{
+    // 점 p에서 선분까지 가장 가까운 점
+    void closestOnSegment(const CushionSegment& s, float px, float pz, float* qx, float* qz)
+    {
+        float ux = s.x1 - s.x0, uz = s.z1 - s.z0;
+        float len2 = ux * ux + uz * uz;
+        float t = len2 > 0.0f ? ((px - s.x0) * ux + (pz - s.z0) * uz) / len2 : 0.0f;
+        t = t < 0 ? 0 : (t > 1 ? 1 : t);
+        *qx = s.x0 + t * ux;
+        *qz = s.z0 + t * uz;
+    }
+
+    // crossing number로 다각형 내부 판정
+    bool insideOutline(const CushionSegment* segments, int n, float px, float pz)
+    {
+        bool inside = false;
+        for (int i = 0; i < n; i++) {
+            const CushionSegment& s = segments[i];
+            if ((s.z0 > pz) != (s.z1 > pz)) {
+                float x = s.x0 + (pz - s.z0) * (s.x1 - s.x0) / (s.z1 - s.z0);
+                if (px < x) inside = !inside;
+            }
+        }
+        return inside;
+    }
+}
+
+void CTableField::bake(const CushionSegment* segments, int numSegments,
+    const PocketCircle* pockets, int numPockets,
+    float minX, float maxX, float minZ, float maxZ, float cellSize)
+{
+    m_cellSize = cellSize;
+    m_invCell = 1.0f / cellSize;
+    m_originX = minX;
+    m_originZ = minZ;
+    m_cols = (int)ceilf((maxX - minX) * m_invCell) + 1;
+    m_rows = (int)ceilf((maxZ - minZ) * m_invCell) + 1;
+    m_cells.resize((size_t)m_cols * m_rows);
+
+    for (int r = 0; r < m_rows; r++) {
+        float pz = m_originZ + r * cellSize;
+        for (int c = 0; c < m_cols; c++) {
+            float px = m_originX + c * cellSize;
+            Cell& cell = m_cells[(size_t)r * m_cols + c];
+
+            // 가장 가까운 경계 점
+            float bestSq = FLT_MAX, qx = px, qz = pz;
+            int bestSegment = 0;
+            for (int i = 0; i < numSegments; i++) {
+                float sx, sz;
+                closestOnSegment(segments[i], px, pz, &sx, &sz);
+                float dSq = (px - sx) * (px - sx) + (pz - sz) * (pz - sz);
+                if (dSq < bestSq) {
+                    bestSq = dSq;
+                    qx = sx;
+                    qz = sz;
+                    bestSegment = i;
+                }
+            }
+
+            bool inside = insideOutline(segments, numSegments, px, pz);
+            float d = sqrtf(bestSq);
+            cell.distance = inside ? d : -d;
+
+            // 법선은 경계 점에서 안쪽을 향하도록 한다. 경계 위의 점이면 선분의 수직 방향을 쓴다.
+            if (d > 1e-6f) {
+                float sign = inside ? 1.0f : -1.0f;
+                cell.nx = sign * (px - qx) / d;
+                cell.nz = sign * (pz - qz) / d;
+            }
+            else {
+                const CushionSegment& s = segments[bestSegment];
+                float ux = s.x1 - s.x0, uz = s.z1 - s.z0;
+                float len = sqrtf(ux * ux + uz * uz);
+                // 시계 방향 다각형의 안쪽은 진행 방향의 오른쪽
+                cell.nx = len > 0 ? uz / len : 0.0f;
+                cell.nz = len > 0 ? -ux / len : 0.0f;
+            }
+
+            float pocket = FLT_MAX;
+            for (int p = 0; p < numPockets; p++) {
+                float dx = px - pockets[p].x;
+                float dz = pz - pockets[p].z;
+                float dp = sqrtf(dx * dx + dz * dz) - pockets[p].radius;
+                if (dp < pocket) pocket = dp;
+            }
+            cell.pocket = pocket;
+        }
+    }
+}
+
+FieldSample CTableField::sample(float x, float z) const
+{
+    float fx = (x - m_originX) * m_invCell;
+    float fz = (z - m_originZ) * m_invCell;
+
+    int c = (int)floorf(fx);
+    int r = (int)floorf(fz);
+    if (c < 0) c = 0;
+    else if (c > m_cols - 2) c = m_cols - 2;
+    if (r < 0) r = 0;
+    else if (r > m_rows - 2) r = m_rows - 2;
+
+    float tx = fx - c;
+    float tz = fz - r;
+    tx = tx < 0 ? 0 : (tx > 1 ? 1 : tx);
+    tz = tz < 0 ? 0 : (tz > 1 ? 1 : tz);
+
+    const Cell& c00 = m_cells[(size_t)r * m_cols + c];
+    const Cell& c10 = m_cells[(size_t)r * m_cols + c + 1];
+    const Cell& c01 = m_cells[(size_t)(r + 1) * m_cols + c];
+    const Cell& c11 = m_cells[(size_t)(r + 1) * m_cols + c + 1];
+
+    float w00 = (1 - tx) * (1 - tz), w10 = tx * (1 - tz);
+    float w01 = (1 - tx) * tz, w11 = tx * tz;
+
+    FieldSample s;
+    s.distance = c00.distance * w00 + c10.distance * w10 + c01.distance * w01 + c11.distance * w11;
+    s.pocket = c00.pocket * w00 + c10.pocket * w10 + c01.pocket * w01 + c11.pocket * w11;
+    float nx = c00.nx * w00 + c10.nx * w10 + c01.nx * w01 + c11.nx * w11;
+    float nz = c00.nz * w00 + c10.nz * w10 + c01.nz * w01 + c11.nz * w11;
+    float len = sqrtf(nx * nx + nz * nz);
+    s.nx = len > 0 ? nx / len : 0.0f;
+    s.nz = len > 0 ? nz / len : 0.0f;
+    return s;
+}
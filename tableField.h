@@ -0,0 +1,53 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: tableField.h
+//
+// Desc: 테이블 경계의 signed distance field.
+//       쿠션 nose, 포켓 jaw와 mouth를 닫힌 다각형(CushionSegment 목록)으로 두고,
+//       격자 점마다 경계까지의 부호 있는 거리(플레이 영역 안쪽이 +),
+//       영역 안쪽을 향하는 법선, 가장 가까운 포켓 포획 원까지의 거리를 미리 구워 둔다.
+//       공 하나는 bilinear 조회 한 번으로 쿠션 충돌과 포켓 판정을 모두 얻는다.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __tableFieldH__
+#define __tableFieldH__
+
+#include "billiardPhysics.h"
+#include <vector>
+
+struct CushionSegment {
+    float x0, z0;
+    float x1, z1;
+};
+
+struct FieldSample {
+    float distance;     // 쿠션 경계까지 거리 (플레이 영역 안쪽이 +)
+    float nx, nz;       // 플레이 영역 안쪽을 향하는 단위 법선
+    float pocket;       // 포켓 포획 원까지 거리 (0 이하이면 포켓에 들어감)
+};
+
+class CTableField {
+public:
+    CTableField(void) : m_cols(0), m_rows(0), m_originX(0), m_originZ(0), m_cellSize(1), m_invCell(1) {}
+
+    // segments는 닫힌 다각형을 이루어야 한다. 격자는 [minX, maxX] x [minZ, maxZ]를 덮는다.
+    void bake(const CushionSegment* segments, int numSegments,
+        const PocketCircle* pockets, int numPockets,
+        float minX, float maxX, float minZ, float maxZ, float cellSize);
+
+    bool isBaked(void) const { return !m_cells.empty(); }
+    FieldSample sample(float x, float z) const;
+
+private:
+    struct Cell {
+        float distance, nx, nz, pocket;
+    };
+
+    std::vector<Cell> m_cells;
+    int   m_cols, m_rows;
+    float m_originX, m_originZ;
+    float m_cellSize, m_invCell;
+};
+
+#endif // __tableFieldH__
@@ -0,0 +1,480 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: tableLayout.cpp
+//
+// Desc: 테이블 정의 파일의 컴파일, binary cache, 현재 테이블 관리.
+//
+// 정의 파일 형식 (한 줄에 하나, '#' 뒤는 주석):
+//     name   <이름>
+//     bounds <minX> <maxX> <minZ> <maxZ>      쿠션 nose 직사각형
+//     rail   <좌우 레일 두께> <상하 레일 두께>
+//     corner <mouth> <jaw>                   코너 포켓 입구 모양 (없으면 막힌 코너)
+//     side   <mouth> <throat> <jaw depth>    사이드 포켓 입구 모양 (없으면 막힌 레일)
+//     pocket <x> <z> <radius>                포켓 포획 원 (최대 NUM_POCKETS개)
+//     cue    <x> <z>
+//     rack   <x> <z> [ball]                  rack 자리, ball을 주면 그 공을 고정
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "tableLayout.h"
+#include <cstdio>
+#include <cstring>
+#include <cassert>
+#include <string>
+#include <stdint.h>
+
+const float FIELD_MARGIN = 0.4f;      // 쿠션 다각형 밖으로 격자를 더 덮는 폭
+const float FIELD_CELL = 0.025f;
+
+namespace
+{
+    // 내장 기본 테이블 (tables/8ball.table과 같은 값)
+    const char DEFAULT_TABLE_SOURCE[] =
+        "name   8-ball\n"
+        "bounds -4.5 4.5 -3.0 3.0\n"
+        "rail   0.25 0.5\n"
+        "corner 0.45 0.3\n"
+        "side   0.3 0.25 0.35\n"
+        "pocket -4.4  2.9 0.3\n"
+        "pocket  0.0  3.0 0.3\n"
+        "pocket  4.4  2.9 0.3\n"
+        "pocket -4.4 -2.9 0.3\n"
+        "pocket  0.0 -3.0 0.3\n"
+        "pocket  4.4 -2.9 0.3\n"
+        "cue    -2.5 0.0\n"
+        "rack   1.0   0.0\n"
+        "rack   1.36 -0.21\n"
+        "rack   1.36  0.21\n"
+        "rack   1.72 -0.42\n"
+        "rack   1.72  0.0  8\n"
+        "rack   1.72  0.42\n"
+        "rack   2.08 -0.63\n"
+        "rack   2.08 -0.21\n"
+        "rack   2.08  0.21\n"
+        "rack   2.08  0.63\n"
+        "rack   2.44 -0.84\n"
+        "rack   2.44 -0.42\n"
+        "rack   2.44  0.0\n"
+        "rack   2.44  0.42\n"
+        "rack   2.44  0.84\n";
+
+    const char CACHE_MAGIC[4] = { 'T', 'B', 'L', 'C' };
+    const uint32_t CACHE_VERSION = 1;
+
+    struct CacheHeader {
+        char     magic[4];
+        uint32_t version;
+        uint32_t layoutSize;    // sizeof(TableLayout), 구조체가 바뀌면 cache를 버린다
+        uint32_t reserved;
+        uint64_t sourceHash;    // 원본 텍스트의 FNV-1a hash
+    };
+
+    // 포켓 입구 모양. 정의 파일에만 있고 컴파일 결과에는 다각형으로 들어간다.
+    struct MouthShape {
+        bool  corner;
+        float cornerMouth;      // 코너에서 쿠션 nose가 끝나는 거리
+        float cornerJaw;        // jaw가 레일 바깥으로 벌어지는 정도
+        bool  side;
+        float sideMouth;        // 사이드 포켓 입구 반폭
+        float sideThroat;       // 사이드 포켓 안쪽 반폭
+        float sideJawDepth;     // 사이드 포켓 jaw 깊이
+    };
+
+    uint64_t hashSource(const char* text, size_t length)
+    {
+        uint64_t h = 14695981039346656037ULL;
+        for (size_t i = 0; i < length; i++) {
+            h ^= (unsigned char)text[i];
+            h *= 1099511628211ULL;
+        }
+        return h;
+    }
+
+    // 닫힌 다각형의 꼭짓점 목록
+    struct Outline {
+        float x[TABLE_MAX_SEGMENTS], z[TABLE_MAX_SEGMENTS];
+        int   n;
+
+        Outline(void) : n(0) {}
+
+        void add(float px, float pz)
+        {
+            if (n >= TABLE_MAX_SEGMENTS) return;
+            x[n] = px;
+            z[n] = pz;
+            n++;
+        }
+
+        // 코너 포켓 mouth: 한 레일의 nose 끝 -> jaw -> 다른 레일의 jaw -> nose 끝
+        // (sx, sz)는 코너의 방향, fromSideRail은 좌우 레일에서 들어오는지 여부
+        void corner(const MouthShape& m, float cx, float cz, float sx, float sz, bool fromSideRail)
+        {
+            if (!m.corner) {
+                add(cx, cz);
+            }
+            else if (fromSideRail) {
+                add(cx, cz - sz * m.cornerMouth);
+                add(cx + sx * m.cornerJaw, cz - sz * m.cornerJaw);
+                add(cx - sx * m.cornerJaw, cz + sz * m.cornerJaw);
+                add(cx - sx * m.cornerMouth, cz);
+            }
+            else {
+                add(cx - sx * m.cornerMouth, cz);
+                add(cx - sx * m.cornerJaw, cz + sz * m.cornerJaw);
+                add(cx + sx * m.cornerJaw, cz - sz * m.cornerJaw);
+                add(cx, cz - sz * m.cornerMouth);
+            }
+        }
+
+        // 사이드 포켓 mouth: dir은 레일을 따라가는 방향(+1/-1), sz는 레일 바깥 방향
+        void side(const MouthShape& m, float cx, float cz, float dir, float sz)
+        {
+            if (!m.side) return;
+            add(cx - dir * m.sideMouth, cz);
+            add(cx - dir * m.sideThroat, cz + sz * m.sideJawDepth);
+            add(cx + dir * m.sideThroat, cz + sz * m.sideJawDepth);
+            add(cx + dir * m.sideMouth, cz);
+        }
+    };
+
+    // 꼭짓점을 시계 방향(왼쪽 레일 위로 -> 상단 레일 오른쪽으로 -> ...)으로 나열한다.
+    void buildOutline(const MouthShape& mouth, TableLayout& layout)
+    {
+        Outline outline;
+        const float midX = (layout.minX + layout.maxX) * 0.5f;
+
+        outline.corner(mouth, layout.minX, layout.maxZ, -1.0f, 1.0f, true);     // 상단 왼쪽
+        outline.side(mouth, midX, layout.maxZ, 1.0f, 1.0f);                     // 상단 중앙
+        outline.corner(mouth, layout.maxX, layout.maxZ, 1.0f, 1.0f, false);     // 상단 오른쪽
+        outline.corner(mouth, layout.maxX, layout.minZ, 1.0f, -1.0f, true);     // 하단 오른쪽
+        outline.side(mouth, midX, layout.minZ, -1.0f, -1.0f);                   // 하단 중앙
+        outline.corner(mouth, layout.minX, layout.minZ, -1.0f, -1.0f, false);   // 하단 왼쪽
+
+        layout.numSegments = outline.n;
+        for (int i = 0; i < outline.n; i++) {
+            int j = (i + 1) % outline.n;
+            CushionSegment segment = { outline.x[i], outline.z[i], outline.x[j], outline.z[j] };
+            layout.segments[i] = segment;
+        }
+    }
+
+    void buildWalls(float sideRail, float endRail, TableLayout& layout)
+    {
+        float width = layout.maxX - layout.minX;
+        float depth = layout.maxZ - layout.minZ;
+        float midX = (layout.minX + layout.maxX) * 0.5f;
+        float midZ = (layout.minZ + layout.maxZ) * 0.5f;
+
+        WallBox top = { midX, layout.maxZ + endRail * 0.5f, width + sideRail * 2, endRail };
+        WallBox bottom = { midX, layout.minZ - endRail * 0.5f, width + sideRail * 2, endRail };
+        WallBox right = { layout.maxX + sideRail * 0.5f, midZ, sideRail, depth };
+        WallBox left = { layout.minX - sideRail * 0.5f, midZ, sideRail, depth };
+        layout.walls[0] = top;
+        layout.walls[1] = bottom;
+        layout.walls[2] = right;
+        layout.walls[3] = left;
+    }
+
+    bool insideBounds(const TableLayout& layout, float x, float z)
+    {
+        const float r = (float)M_RADIUS;
+        return layout.minX + r <= x && x <= layout.maxX - r &&
+            layout.minZ + r <= z && z <= layout.maxZ - r;
+    }
+
+    bool readFile(const char* path, std::string* text)
+    {
+        FILE* fp = fopen(path, "rb");
+        if (fp == NULL) return false;
+        char buffer[4096];
+        size_t n;
+        while ((n = fread(buffer, 1, sizeof(buffer), fp)) > 0)
+            text->append(buffer, n);
+        fclose(fp);
+        return true;
+    }
+
+    bool readCache(const char* path, uint64_t sourceHash, TableLayout* out)
+    {
+        FILE* fp = fopen(path, "rb");
+        if (fp == NULL) return false;
+
+        CacheHeader header;
+        TableLayout layout;
+        bool ok = fread(&header, sizeof(header), 1, fp) == 1 &&
+            memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) == 0 &&
+            header.version == CACHE_VERSION &&
+            header.layoutSize == sizeof(TableLayout) &&
+            header.sourceHash == sourceHash &&
+            fread(&layout, sizeof(layout), 1, fp) == 1;
+        fclose(fp);
+
+        // 손상된 파일로 배열 밖을 읽지 않도록 개수만 확인한다.
+        ok = ok && 0 <= layout.numPockets && layout.numPockets <= NUM_POCKETS &&
+            3 <= layout.numSegments && layout.numSegments <= TABLE_MAX_SEGMENTS &&
+            0 <= layout.rackCount && layout.rackCount <= TABLE_MAX_RACK;
+        if (ok) {
+            layout.name[TABLE_NAME_LENGTH - 1] = '\0';
+            *out = layout;
+        }
+        return ok;
+    }
+
+    void writeCache(const char* path, uint64_t sourceHash, const TableLayout& layout)
+    {
+        FILE* fp = fopen(path, "wb");
+        if (fp == NULL) return;
+
+        CacheHeader header;
+        memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+        header.version = CACHE_VERSION;
+        header.layoutSize = sizeof(TableLayout);
+        header.reserved = 0;
+        header.sourceHash = sourceHash;
+        bool ok = fwrite(&header, sizeof(header), 1, fp) == 1 &&
+            fwrite(&layout, sizeof(layout), 1, fp) == 1;
+        fclose(fp);
+
+        // 반쯤 쓴 파일은 다음 실행에서 읽지 않도록 지운다.
+        if (!ok) remove(path);
+    }
+}
+
+bool compileTableLayout(const char* source, TableLayout* out, char* error, int errorSize)
+{
+    TableLayout layout;
+    memset(&layout, 0, sizeof(layout));
+    strcpy(layout.name, "table");
+
+    MouthShape mouth;
+    memset(&mouth, 0, sizeof(mouth));
+    float sideRail = 0.25f, endRail = 0.5f;
+    bool hasBounds = false, hasCue = false;
+
+    int lineNumber = 0;
+    const char* p = source;
+    while (*p != '\0') {
+        // 한 줄 복사 (주석과 개행 제거)
+        char line[256];
+        int length = 0;
+        while (*p != '\0' && *p != '\n') {
+            if (length < (int)sizeof(line) - 1) line[length++] = *p;
+            p++;
+        }
+        if (*p == '\n') p++;
+        line[length] = '\0';
+        lineNumber++;
+
+        char* comment = strchr(line, '#');
+        if (comment != NULL) *comment = '\0';
+
+        char key[32];
+        int consumed = 0;
+        if (sscanf(line, "%31s%n", key, &consumed) != 1)
+            continue;
+        const char* args = line + consumed;
+
+        float a, b, c, d;
+        int ball;
+        bool ok = true;
+        const char* reason = "wrong number of values";
+
+        if (strcmp(key, "name") == 0) {
+            while (*args == ' ' || *args == '\t') args++;
+            int n = (int)strlen(args);
+            while (n > 0 && (args[n - 1] == ' ' || args[n - 1] == '\t' || args[n - 1] == '\r')) n--;
+            if (n >= TABLE_NAME_LENGTH) n = TABLE_NAME_LENGTH - 1;
+            memcpy(layout.name, args, n);
+            layout.name[n] = '\0';
+        }
+        else if (strcmp(key, "bounds") == 0) {
+            ok = sscanf(args, "%f %f %f %f", &a, &b, &c, &d) == 4;
+            if (ok && (a >= b || c >= d)) {
+                ok = false;
+                reason = "bounds must be min < max";
+            }
+            if (ok) {
+                layout.minX = a; layout.maxX = b;
+                layout.minZ = c; layout.maxZ = d;
+                hasBounds = true;
+            }
+        }
+        else if (strcmp(key, "rail") == 0) {
+            ok = sscanf(args, "%f %f", &sideRail, &endRail) == 2;
+        }
+        else if (strcmp(key, "corner") == 0) {
+            ok = sscanf(args, "%f %f", &mouth.cornerMouth, &mouth.cornerJaw) == 2;
+            mouth.corner = true;
+        }
+        else if (strcmp(key, "side") == 0) {
+            ok = sscanf(args, "%f %f %f", &mouth.sideMouth, &mouth.sideThroat, &mouth.sideJawDepth) == 3;
+            mouth.side = true;
+        }
+        else if (strcmp(key, "pocket") == 0) {
+            ok = sscanf(args, "%f %f %f", &a, &b, &c) == 3;
+            if (ok && layout.numPockets >= NUM_POCKETS) {
+                ok = false;
+                reason = "too many pockets";
+            }
+            if (ok) {
+                PocketCircle pocket = { a, b, c };
+                layout.pockets[layout.numPockets++] = pocket;
+            }
+        }
+        else if (strcmp(key, "cue") == 0) {
+            ok = sscanf(args, "%f %f", &layout.cueX, &layout.cueZ) == 2;
+            hasCue = true;
+        }
+        else if (strcmp(key, "rack") == 0) {
+            int n = sscanf(args, "%f %f %d", &a, &b, &ball);
+            ok = n == 2 || n == 3;
+            if (ok && layout.rackCount >= TABLE_MAX_RACK) {
+                ok = false;
+                reason = "too many rack spots";
+            }
+            if (ok) {
+                layout.rackX[layout.rackCount] = a;
+                layout.rackZ[layout.rackCount] = b;
+                layout.rackBall[layout.rackCount] = n == 3 ? ball : 0;
+                layout.rackCount++;
+            }
+        }
+        else {
+            ok = false;
+            reason = "unknown keyword";
+        }
+
+        if (!ok) {
+            snprintf(error, errorSize, "line %d: %s (%s)", lineNumber, reason, key);
+            return false;
+        }
+    }
+
+    if (!hasBounds || !hasCue) {
+        snprintf(error, errorSize, "missing %s", hasBounds ? "cue" : "bounds");
+        return false;
+    }
+    if (!insideBounds(layout, layout.cueX, layout.cueZ)) {
+        snprintf(error, errorSize, "cue spot is outside the cushions");
+        return false;
+    }
+
+    // 고정된 공은 사용하는 공이어야 하고 한 번만 나와야 한다.
+    for (int i = 0; i < layout.rackCount; i++) {
+        if (!insideBounds(layout, layout.rackX[i], layout.rackZ[i])) {
+            snprintf(error, errorSize, "rack spot %d is outside the cushions", i + 1);
+            return false;
+        }
+        int fixed = layout.rackBall[i];
+        if (fixed == 0) continue;
+        bool valid = 0 < fixed && fixed <= layout.rackCount;
+        for (int j = 0; j < i && valid; j++) {
+            if (layout.rackBall[j] == fixed) valid = false;
+        }
+        if (!valid) {
+            snprintf(error, errorSize, "rack spot %d: ball %d cannot be fixed here", i + 1, fixed);
+            return false;
+        }
+    }
+
+    buildOutline(mouth, layout);
+    buildWalls(sideRail, endRail, layout);
+    *out = layout;
+    return true;
+}
+
+bool loadTableLayout(const char* path, TableLayout* out, char* error, int errorSize)
+{
+    std::string source;
+    if (!readFile(path, &source)) {
+        snprintf(error, errorSize, "%s: cannot open", path);
+        return false;
+    }
+
+    uint64_t sourceHash = hashSource(source.data(), source.size());
+    std::string cachePath = std::string(path) + ".bin";
+    if (readCache(cachePath.c_str(), sourceHash, out))
+        return true;
+
+    char reason[200];
+    if (!compileTableLayout(source.c_str(), out, reason, sizeof(reason))) {
+        snprintf(error, errorSize, "%s: %s", path, reason);
+        return false;
+    }
+    writeCache(cachePath.c_str(), sourceHash, *out);
+    return true;
+}
+
+const TableLayout& defaultTableLayout(void)
+{
+    struct Default {
+        TableLayout layout;
+        Default(void)
+        {
+            char error[128];
+            bool ok = compileTableLayout(DEFAULT_TABLE_SOURCE, &layout, error, sizeof(error));
+            assert(ok);
+            (void)ok;
+        }
+    };
+    static const Default table;
+    return table.layout;
+}
+
+namespace
+{
+    struct ActiveTable {
+        TableLayout layout;
+        CTableField field;
+    };
+
+    void bakeActive(ActiveTable& table)
+    {
+        const TableLayout& layout = table.layout;
+
+        // 포켓 jaw까지 덮도록 쿠션 다각형 전체를 감싼다.
+        float minX = layout.minX, maxX = layout.maxX;
+        float minZ = layout.minZ, maxZ = layout.maxZ;
+        for (int i = 0; i < layout.numSegments; i++) {
+            const CushionSegment& s = layout.segments[i];
+            if (s.x0 < minX) minX = s.x0;
+            if (s.x0 > maxX) maxX = s.x0;
+            if (s.z0 < minZ) minZ = s.z0;
+            if (s.z0 > maxZ) maxZ = s.z0;
+        }
+        table.field.bake(layout.segments, layout.numSegments, layout.pockets, layout.numPockets,
+            minX - FIELD_MARGIN, maxX + FIELD_MARGIN, minZ - FIELD_MARGIN, maxZ + FIELD_MARGIN, FIELD_CELL);
+    }
+
+    ActiveTable& active(void)
+    {
+        // 여러 thread에서 처음 불려도 한 번만 굽는다.
+        struct Holder {
+            ActiveTable table;
+            Holder(void)
+            {
+                table.layout = defaultTableLayout();
+                bakeActive(table);
+            }
+        };
+        static Holder holder;
+        return holder.table;
+    }
+}
+
+void setActiveTable(const TableLayout& layout)
+{
+    ActiveTable& table = active();
+    table.layout = layout;
+    bakeActive(table);
+}
+
+const TableLayout& activeTable(void)
+{
+    return active().layout;
+}
+
+const CTableField& activeTableField(void)
+{
+    return active().field;
+}
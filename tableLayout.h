@@ -0,0 +1,59 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: tableLayout.h
+//
+// Desc: 파일에서 읽는 테이블 정의 (8-ball, 9-ball, snooker, carom ...).
+//       tables/*.table 텍스트를 읽을 때 한 번 쿠션 다각형, 포켓 포획 원, 레일,
+//       rack 배치를 담은 고정 크기 TableLayout으로 컴파일하고, 같은 이름 + ".bin"
+//       파일에 그대로 저장해 둔다. 원본이 바뀌지 않았으면 다음 실행부터는 파싱 없이
+//       binary를 읽는다. 물리 코어는 activeTable()의 값만 사용한다.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __tableLayoutH__
+#define __tableLayoutH__
+
+#include "tableField.h"
+
+const int TABLE_NAME_LENGTH = 32;
+const int TABLE_MAX_SEGMENTS = 64;
+const int TABLE_MAX_RACK = NUM_BALLS - 1;   // 큐볼을 제외한 공 수
+
+// 컴파일된 테이블. 포인터가 없는 POD이므로 파일에 그대로 쓰고 읽는다.
+struct TableLayout {
+    char  name[TABLE_NAME_LENGTH];
+
+    // 쿠션 nose가 만드는 직사각형 (포켓 mouth는 이 바깥으로 벌어진다)
+    float minX, maxX, minZ, maxZ;
+
+    WallBox walls[NUM_WALLS];           // 상단, 하단, 오른쪽, 왼쪽 레일 (그리기용)
+
+    int          numPockets;
+    PocketCircle pockets[NUM_POCKETS];
+
+    int            numSegments;         // 시계 방향으로 닫힌 쿠션 다각형
+    CushionSegment segments[TABLE_MAX_SEGMENTS];
+
+    float cueX, cueZ;                   // 큐볼 시작 위치
+    int   rackCount;                    // 1 ~ rackCount 번 공을 사용한다
+    float rackX[TABLE_MAX_RACK], rackZ[TABLE_MAX_RACK];
+    int   rackBall[TABLE_MAX_RACK];     // 자리에 고정된 공 번호, 섞는 자리는 0
+};
+
+// 텍스트 정의를 컴파일한다. 실패하면 error에 "줄: 이유"를 남기고 false.
+bool compileTableLayout(const char* source, TableLayout* out, char* error, int errorSize);
+
+// path의 정의를 읽는다. path + ".bin"이 같은 원본으로 만든 것이면 그것을 그대로 쓰고,
+// 아니면 컴파일한 뒤 다시 저장한다 (저장 실패는 무시).
+bool loadTableLayout(const char* path, TableLayout* out, char* error, int errorSize);
+
+// 파일이 없을 때 쓰는 기본 8-ball 테이블
+const TableLayout& defaultTableLayout(void);
+
+// 물리 코어가 사용하는 테이블. setActiveTable은 field를 다시 굽기 때문에
+// 시뮬레이션이 진행 중이지 않을 때(게임 시작, 테이블 변경) 호출해야 한다.
+void setActiveTable(const TableLayout& layout);
+const TableLayout& activeTable(void);
+const CTableField& activeTableField(void);
+
+#endif // __tableLayoutH__
@@ -0,0 +1,164 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: threadPool.cpp
+//
+// Desc: 물리 코어에서 쓰는 작은 work-stealing thread pool 구현.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "threadPool.h"
+
+namespace
+{
+    unsigned long long packRange(int begin, int end)
+    {
+        return ((unsigned long long)(unsigned)begin << 32) | (unsigned)end;
+    }
+
+    void unpackRange(unsigned long long range, int& begin, int& end)
+    {
+        begin = (int)(unsigned)(range >> 32);
+        end = (int)(unsigned)(range & 0xffffffffu);
+    }
+}
+
+CThreadPool::CThreadPool(int numThreads)
+    : m_stop(false), m_generation(0), m_function(NULL), m_body(NULL), m_grain(1),
+    m_slots(NULL), m_finishedWorkers(0)
+{
+    if (numThreads <= 0) {
+        int hardware = (int)std::thread::hardware_concurrency();
+        numThreads = hardware > 1 ? hardware - 1 : 0;
+    }
+    m_slots = new WorkSlot[numThreads + 1];
+    for (int i = 0; i <= numThreads; i++)
+        m_slots[i].range.store(0);
+    for (int i = 0; i < numThreads; i++)
+        m_workers.push_back(std::thread(&CThreadPool::workerLoop, this, i + 1));
+}
+
+CThreadPool::~CThreadPool(void)
+{
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    for (size_t i = 0; i < m_workers.size(); i++)
+        m_workers[i].join();
+    delete[] m_slots;
+}
+
+// 자기 구간의 앞에서 grain 만큼 꺼낸다.
+bool CThreadPool::takeOwn(int slot, int& begin, int& end)
+{
+    std::atomic<unsigned long long>& range = m_slots[slot].range;
+    unsigned long long current = range.load();
+    for (;;) {
+        int b, e;
+        unpackRange(current, b, e);
+        if (b >= e)
+            return false;
+        int next = e - b > m_grain ? b + m_grain : e;
+        if (range.compare_exchange_weak(current, packRange(next, e))) {
+            begin = b;
+            end = next;
+            return true;
+        }
+    }
+}
+
+// 다른 thread 구간의 뒤쪽 절반(grain 이하면 전부)을 자기 구간으로 가져온다.
+bool CThreadPool::steal(int slot)
+{
+    int numSlots = (int)m_workers.size() + 1;
+    for (int k = 1; k < numSlots; k++) {
+        std::atomic<unsigned long long>& victim = m_slots[(slot + k) % numSlots].range;
+        unsigned long long current = victim.load();
+        for (;;) {
+            int b, e;
+            unpackRange(current, b, e);
+            if (b >= e)
+                break;
+            int mid = e - b > m_grain ? b + (e - b) / 2 : b;
+            if (victim.compare_exchange_weak(current, packRange(b, mid))) {
+                m_slots[slot].range.store(packRange(mid, e));
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void CThreadPool::runChunks(int slot)
+{
+    for (;;) {
+        int begin, end;
+        if (takeOwn(slot, begin, end)) {
+            m_function(m_body, begin, end);
+            continue;
+        }
+        // 훔쳐 간 구간은 훔친 thread가 끝내므로 모든 구간이 비었으면 그만둔다.
+        if (!steal(slot))
+            return;
+    }
+}
+
+void CThreadPool::workerLoop(int slot)
+{
+    unsigned seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> guard(m_lock);
+            m_wake.wait(guard, [&]() { return m_stop || m_generation != seen; });
+            if (m_stop)
+                return;
+            seen = m_generation;
+        }
+
+        runChunks(slot);
+
+        // 모든 worker가 이번 호출을 마쳐야 호출자가 돌아간다. 늦게 깨어난 worker가
+        // 다음 호출의 값을 읽는 일이 없도록 일이 없어도 한 번씩은 들른다.
+        std::lock_guard<std::mutex> guard(m_lock);
+        if (++m_finishedWorkers == (int)m_workers.size())
+            m_done.notify_all();
+    }
+}
+
+void CThreadPool::run(int count, int grain, BodyFunction function, const void* body)
+{
+    if (count <= 0)
+        return;
+    if (grain < 1)
+        grain = 1;
+
+    // 조각이 하나뿐이거나 worker가 없으면 그냥 여기서 처리한다.
+    if (m_workers.empty() || count <= grain) {
+        function(body, 0, count);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        m_function = function;
+        m_body = body;
+        m_grain = grain;
+
+        // 처음에는 고르게 나누어 주고, 늦게 끝나는 구간은 훔쳐 가며 맞춘다.
+        int numSlots = (int)m_workers.size() + 1;
+        for (int i = 0; i < numSlots; i++)
+            m_slots[i].range.store(packRange(count * i / numSlots, count * (i + 1) / numSlots));
+
+        m_finishedWorkers = 0;
+        m_generation++;
+    }
+    m_wake.notify_all();
+
+    runChunks(0);
+
+    // 모든 worker가 구간을 다 끝낼 때까지 기다린다.
+    std::unique_lock<std::mutex> guard(m_lock);
+    m_done.wait(guard, [&]() { return m_finishedWorkers == (int)m_workers.size(); });
+    m_body = NULL;
+}
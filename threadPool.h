@@ -0,0 +1,78 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: threadPool.h
+//
+// Desc: 물리 코어에서 쓰는 작은 work-stealing thread pool.
+//       parallelFor는 [0, count) 구간을 thread 수만큼 나누어 각자의 구간에서 grain 크기씩
+//       앞에서 꺼내 처리한다. 자기 구간이 비면 다른 thread 구간의 뒤쪽 절반을 훔쳐 온다.
+//       호출한 thread도 함께 처리하고, 모든 구간이 끝날 때까지 기다린다.
+//       body는 호출이 끝날 때까지만 쓰므로 복사하지 않고 주소만 넘긴다 (heap 할당 없음).
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __threadPoolH__
+#define __threadPoolH__
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class CThreadPool {
+public:
+    // numThreads: worker 수 (0이면 hardware thread 수 - 1)
+    explicit CThreadPool(int numThreads = 0);
+    ~CThreadPool(void);
+
+    // 호출한 thread를 포함해 일을 나누어 받는 thread 수
+    int size(void) const { return (int)m_workers.size() + 1; }
+
+    // body(begin, end)를 여러 thread에서 부른다.
+    template<class Body>
+    void parallelFor(int count, int grain, const Body& body)
+    {
+        run(count, grain, &invokeBody<Body>, &body);
+    }
+
+private:
+    typedef void (*BodyFunction)(const void* body, int begin, int end);
+
+    template<class Body>
+    static void invokeBody(const void* body, int begin, int end)
+    {
+        (*static_cast<const Body*>(body))(begin, end);
+    }
+
+    void run(int count, int grain, BodyFunction function, const void* body);
+
+    CThreadPool(const CThreadPool&);
+    CThreadPool& operator=(const CThreadPool&);
+
+    // 한 thread가 가진 남은 구간 [begin, end). (begin << 32) | end 로 묶어 CAS 한 번에 바꾼다.
+    struct WorkSlot {
+        std::atomic<unsigned long long> range;
+        char pad[64 - sizeof(std::atomic<unsigned long long>)];  // cache line 공유 방지
+    };
+
+    void workerLoop(int slot);
+    void runChunks(int slot);
+    bool takeOwn(int slot, int& begin, int& end);
+    bool steal(int slot);
+
+    std::vector<std::thread> m_workers;
+    std::mutex               m_lock;
+    std::condition_variable  m_wake;        // 새 일이 들어옴
+    std::condition_variable  m_done;        // 일이 모두 끝남
+    bool                     m_stop;
+    unsigned                 m_generation;  // parallelFor 호출마다 증가
+
+    // 진행 중인 parallelFor
+    BodyFunction     m_function;
+    const void*      m_body;
+    int              m_grain;
+    WorkSlot*        m_slots;               // 0은 호출한 thread, 1..은 worker
+    int              m_finishedWorkers;     // 이번 호출을 마친 worker 수
+};
+
+#endif // __threadPoolH__
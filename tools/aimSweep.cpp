@@ -0,0 +1,266 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: aimSweep.cpp
+//
+// Desc: 한 테이블 배치에서 (aim x power) 격자 전체를 시뮬레이션해 파울 없이 공을 넣을
+//       확률 heatmap(PPM)과 칸마다의 결과(CSV)를 쓴다 (코칭, 물리 조정용).
+//
+//       heatmap은 가로가 aim, 세로가 power (위쪽이 강함)이다. 색은 조준 오차(-sigma)를
+//       감안한 넣을 확률로 검정 -> 파랑 -> 초록 -> 노랑으로 밝아지고, 그 칸의 샷 자체가
+//       scratch면 빨강, 그 밖의 파울이면 보라를 섞는다.
+//       CSV 열: aim, power, result (miss / pot / scratch / foul), pocketed (bit mask),
+//       first_contact, pot_probability
+//
+//       배치 파일 (없으면 rack 배치에서 break):
+//         ball <번호> <x> <z>      적은 공만 테이블에 있다 (0번은 꼭 있어야 한다)
+//         break                    break 샷으로 판정한다
+//         group solid|stripe       친 사람의 그룹 (없으면 open)
+//       '#' 뒤는 주석이다.
+//
+//       빌드 예)
+//         g++ -O2 -I.. -o aimSweep aimSweep.cpp ../shotSweep.cpp ../billiardPhysics.cpp
+//             ../contactSolver.cpp ../detMath.cpp ../eventBus.cpp ../islandStepper.cpp
+//             ../physicsParams.cpp ../tableConfig.cpp ../tableField.cpp ../tableLayout.cpp ../threadPool.cpp
+//             -lpthread
+//       사용 예)
+//         aimSweep -aims 1000 -powers 200 -out sweep position.txt
+//       그 밖의 옵션: -aim min max (라디안, 기본 한 바퀴), -power min max, -tip side height,
+//                     -sigma 조준 오차 (라디안), -threads n (0: 모든 core), -table 파일
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "billiardPhysics.h"
+#include "shotSweep.h"
+#include "tableLayout.h"
+#include "threadPool.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+    const char* RESULT_NAMES[] = { "miss", "pot", "scratch", "foul" };
+
+    // Setup과 같은 배치 (섞는 자리는 번호 순서로 채운다), break 샷
+    void rackTable(TableState& state)
+    {
+        const TableLayout& table = activeTable();
+        memset(&state, 0, sizeof(state));
+        int next = 0;
+        for (int i = 0; i < NUM_BALLS; i++) {
+            BallState& ball = state.balls[i];
+            ball.y = (float)M_RADIUS;
+            if (i > table.rackCount) {
+                pocketBall(ball);
+                continue;
+            }
+            ball.active = true;
+            if (i == CUE_BALL) {
+                ball.x = table.cueX;
+                ball.z = table.cueZ;
+                continue;
+            }
+            int pos = -1;
+            for (int p = 0; p < table.rackCount; p++) {
+                if (table.rackBall[p] == i) pos = p;
+            }
+            while (pos < 0 && next < table.rackCount) {
+                if (table.rackBall[next] == 0) pos = next;
+                next++;
+            }
+            if (pos < 0) {
+                pocketBall(ball);
+                continue;
+            }
+            ball.x = table.rackX[pos];
+            ball.z = table.rackZ[pos];
+        }
+        state.rules.turn = true;
+        state.rules.open = true;
+        state.rules.break_shot = true;
+    }
+
+    bool loadPosition(const char* path, TableState& state)
+    {
+        FILE* file = fopen(path, "r");
+        if (file == NULL)
+            return false;
+        memset(&state, 0, sizeof(state));
+        for (int i = 0; i < NUM_BALLS; i++) {
+            state.balls[i].y = (float)M_RADIUS;
+            pocketBall(state.balls[i]);
+        }
+        state.rules.turn = true;
+        state.rules.open = true;
+
+        char line[256];
+        while (fgets(line, sizeof(line), file) != NULL) {
+            char* comment = strchr(line, '#');
+            if (comment != NULL) *comment = '\0';
+            int index;
+            float x, z;
+            char word[32];
+            if (sscanf(line, " ball %d %f %f", &index, &x, &z) == 3 && index >= 0 && index < NUM_BALLS) {
+                BallState& ball = state.balls[index];
+                memset(&ball, 0, sizeof(ball));
+                ball.x = x;
+                ball.y = (float)M_RADIUS;
+                ball.z = z;
+                ball.active = true;
+            }
+            else if (sscanf(line, " group %31s", word) == 1) {
+                state.rules.open = false;
+                state.rules.group = strcmp(word, "solid") == 0;
+            }
+            else if (sscanf(line, " %31s", word) == 1 && strcmp(word, "break") == 0) {
+                state.rules.break_shot = true;
+            }
+        }
+        fclose(file);
+
+        for (int i = 1; i < NUM_BALLS; i++) {
+            if (!state.balls[i].active) continue;
+            if (isSolidBall(i)) state.rules.solid_num++;
+            if (isStripeBall(i)) state.rules.stripe_num++;
+        }
+        return state.balls[CUE_BALL].active;
+    }
+
+    // 넣을 확률을 색으로: 검정 -> 파랑 -> 초록 -> 노랑
+    void rampColor(float p, float* rgb)
+    {
+        static const float stops[4][3] = { { 0.05f, 0.05f, 0.08f }, { 0.1f, 0.2f, 0.8f }, { 0.1f, 0.75f, 0.2f }, { 1.0f, 0.9f, 0.1f } };
+        float t = (p < 0.0f ? 0.0f : p > 1.0f ? 1.0f : p) * 3.0f;
+        int k = t >= 3.0f ? 2 : (int)t;
+        float f = t - k;
+        for (int c = 0; c < 3; c++)
+            rgb[c] = stops[k][c] + (stops[k + 1][c] - stops[k][c]) * f;
+    }
+
+    bool writeHeatmap(const char* path, const SweepGrid& grid, const SweepCell* cells, const float* probability)
+    {
+        FILE* file = fopen(path, "wb");
+        if (file == NULL)
+            return false;
+        fprintf(file, "P6\n%d %d\n255\n", grid.aimSteps, grid.powerSteps);
+        std::vector<unsigned char> row(grid.aimSteps * 3);
+        for (int y = 0; y < grid.powerSteps; y++) {
+            int p = grid.powerSteps - 1 - y;     // 위쪽이 강한 샷
+            for (int a = 0; a < grid.aimSteps; a++) {
+                int index = p * grid.aimSteps + a;
+                float rgb[3];
+                rampColor(probability[index], rgb);
+                static const float scratch[3] = { 0.85f, 0.1f, 0.1f }, foul[3] = { 0.5f, 0.1f, 0.5f };
+                const float* tint = cells[index].result == SWEEP_SCRATCH ? scratch :
+                    cells[index].result == SWEEP_FOUL ? foul : NULL;
+                for (int c = 0; c < 3; c++) {
+                    float v = tint != NULL ? rgb[c] * 0.4f + tint[c] * 0.6f : rgb[c];
+                    row[a * 3 + c] = (unsigned char)(v * 255.0f + 0.5f);
+                }
+            }
+            fwrite(&row[0], 1, row.size(), file);
+        }
+        return fclose(file) == 0;
+    }
+
+    bool writeCsv(const char* path, const SweepGrid& grid, const SweepCell* cells, const float* probability)
+    {
+        FILE* file = fopen(path, "w");
+        if (file == NULL)
+            return false;
+        fprintf(file, "aim,power,result,pocketed,first_contact,pot_probability\n");
+        for (int p = 0; p < grid.powerSteps; p++) {
+            for (int a = 0; a < grid.aimSteps; a++) {
+                const SweepCell& cell = cells[p * grid.aimSteps + a];
+                fprintf(file, "%.5f,%.4f,%s,%u,%d,%.4f\n", grid.aim(a), grid.power(p), RESULT_NAMES[cell.result],
+                    (unsigned)cell.pocketed, cell.firstContact, probability[p * grid.aimSteps + a]);
+            }
+        }
+        return fclose(file) == 0;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    SweepGrid grid;
+    grid.aimMin = 0.0f;
+    grid.aimMax = 6.28318531f;
+    grid.aimSteps = 1000;
+    grid.powerMin = 0.5f;
+    grid.powerMax = 8.0f;
+    grid.powerSteps = 200;
+    grid.tipSide = 0.0f;
+    grid.tipHeight = 0.4f;      // 바로 구르는 높이
+    float sigma = 0.005f;
+    int threads = 0;
+    const char* out = "sweep";
+    const char* tablePath = NULL;
+    const char* positionPath = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-aim") == 0 && i + 2 < argc) { grid.aimMin = (float)atof(argv[++i]); grid.aimMax = (float)atof(argv[++i]); }
+        else if (strcmp(argv[i], "-power") == 0 && i + 2 < argc) { grid.powerMin = (float)atof(argv[++i]); grid.powerMax = (float)atof(argv[++i]); }
+        else if (strcmp(argv[i], "-tip") == 0 && i + 2 < argc) { grid.tipSide = (float)atof(argv[++i]); grid.tipHeight = (float)atof(argv[++i]); }
+        else if (strcmp(argv[i], "-aims") == 0 && i + 1 < argc) grid.aimSteps = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-powers") == 0 && i + 1 < argc) grid.powerSteps = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-sigma") == 0 && i + 1 < argc) sigma = (float)atof(argv[++i]);
+        else if (strcmp(argv[i], "-threads") == 0 && i + 1 < argc) threads = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-out") == 0 && i + 1 < argc) out = argv[++i];
+        else if (strcmp(argv[i], "-table") == 0 && i + 1 < argc) tablePath = argv[++i];
+        else positionPath = argv[i];
+    }
+    if (grid.aimSteps <= 0 || grid.powerSteps <= 0) {
+        fprintf(stderr, "grid size must be positive\n");
+        return 1;
+    }
+
+    if (tablePath != NULL) {
+        TableLayout layout;
+        char error[256];
+        if (!loadTableLayout(tablePath, &layout, error, sizeof(error))) {
+            fprintf(stderr, "%s: %s\n", tablePath, error);
+            return 1;
+        }
+        setActiveTable(layout);
+    }
+
+    TableState start;
+    if (positionPath == NULL)
+        rackTable(start);
+    else if (!loadPosition(positionPath, start)) {
+        fprintf(stderr, "cannot read %s (or no cue ball)\n", positionPath);
+        return 1;
+    }
+
+    const int count = grid.aimSteps * grid.powerSteps;
+    std::vector<SweepCell> cells(count);
+    std::vector<float> probability(count);
+    CThreadPool pool(threads > 0 ? threads - 1 : 0);
+
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    SweepStats stats;
+    sweepShots(start, grid, &cells[0], threads == 1 ? NULL : &pool, &stats);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    potProbability(&cells[0], grid, sigma, &probability[0]);
+
+    int counts[4] = { 0, 0, 0, 0 };
+    for (int i = 0; i < count; i++)
+        counts[cells[i].result]++;
+
+    char path[512];
+    snprintf(path, sizeof(path), "%s.ppm", out);
+    bool ok = writeHeatmap(path, grid, &cells[0], &probability[0]);
+    snprintf(path, sizeof(path), "%s.csv", out);
+    ok = writeCsv(path, grid, &cells[0], &probability[0]) && ok;
+    if (!ok)
+        fprintf(stderr, "cannot write %s.ppm / %s.csv\n", out, out);
+
+    fprintf(stderr, "%d x %d shots in %.2f s on %d thread(s) (%.0f shots/s)\n", grid.aimSteps, grid.powerSteps,
+        seconds, threads == 1 ? 1 : pool.size(), count / seconds);
+    fprintf(stderr, "  pot %d, miss %d, scratch %d, foul %d; %.0f steps simulated, %.0f skipped in closed form\n",
+        counts[SWEEP_POT], counts[SWEEP_MISS], counts[SWEEP_SCRATCH], counts[SWEEP_FOUL],
+        stats.steppedSteps, stats.skippedSteps);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,249 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: allocCheck.cpp
+//
+// Desc: 안정 상태의 게임 진행이 heap을 쓰지 않는지 검사하는 창 없는 harness.
+//       게임과 같은 부품(island stepper와 worker pool, event bus와 규칙, what-if cache,
+//       조준 경로 예측, 상태 hash)으로 무작위 샷을 frame 단위로 치며 게임을 이어 간다.
+//       처음 -warmup 샷이 지난 뒤에는 frame마다, 샷마다 CAllocWatch::expectNone()을
+//       검사하고, 하나라도 할당이 있으면 내용을 출력하고 1을 돌려준다.
+//
+//       ALLOC_TRACKING을 정의해 allocTracker.cpp와 함께 빌드해야 한다 (없으면 실패).
+//       빌드 예)
+//         g++ -O2 -DALLOC_TRACKING -I.. -o allocCheck allocCheck.cpp ../allocTracker.cpp
+//             ../aimGuide.cpp ../billiardPhysics.cpp ../contactSolver.cpp ../detMath.cpp
+//             ../eventBus.cpp ../islandStepper.cpp ../physicsParams.cpp
+//             ../ruleEngine.cpp ../shotCache.cpp ../tableConfig.cpp ../tableField.cpp
+//             ../tableLayout.cpp ../threadPool.cpp ../zobristHash.cpp -lpthread
+//       사용 예)
+//         allocCheck -shots 500
+//       그 밖의 옵션: -warmup n, -seed n, -threads n (0: 모든 core)
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "aimGuide.h"
+#include "allocTracker.h"
+#include "billiardPhysics.h"
+#include "eventBus.h"
+#include "islandStepper.h"
+#include "ruleEngine.h"
+#include "shotCache.h"
+#include "tableConfig.h"
+#include "tableLayout.h"
+#include "threadPool.h"
+#include "zobristHash.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdint.h>
+
+namespace
+{
+    const float FRAME_TIME = 1.0f / 60.0f;
+    const int   MAX_SHOT_FRAMES = 60 * 60;  // 한 샷이 이보다 길면 멈춘 것으로 본다
+    const int   MAX_GAME_SHOTS = 200;
+
+    int g_failures = 0;
+
+    void reportAlloc(const char* where, const AllocStats& delta)
+    {
+        printf("steady-state allocation in %s: %llu allocation(s), %llu byte(s)\n",
+            where, delta.count, delta.bytes);
+        g_failures++;
+    }
+
+    uint64_t splitmix64(uint64_t& state)
+    {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    float uniform(uint64_t& state, float lo, float hi)
+    {
+        return lo + (hi - lo) * (float)((splitmix64(state) >> 40) / 16777216.0);
+    }
+
+    // Setup과 같은 rack 배치 (섞는 자리는 번호 순서로 채운다)
+    void rackTable(TableState& state)
+    {
+        const TableLayout& table = activeTable();
+        memset(&state, 0, sizeof(state));
+        int next = 0;
+        for (int i = 0; i < NUM_BALLS; i++) {
+            BallState& ball = state.balls[i];
+            ball.y = (float)M_RADIUS;
+            if (i > table.rackCount) {
+                pocketBall(ball);
+                continue;
+            }
+            ball.active = true;
+            if (i == CUE_BALL) {
+                ball.x = table.cueX;
+                ball.z = table.cueZ;
+                continue;
+            }
+            int pos = -1;
+            for (int p = 0; p < table.rackCount; p++) {
+                if (table.rackBall[p] == i) pos = p;
+            }
+            while (pos < 0 && next < table.rackCount) {
+                if (table.rackBall[next] == 0) pos = next;
+                next++;
+            }
+            if (pos < 0) {
+                pocketBall(ball);
+                continue;
+            }
+            ball.x = table.rackX[pos];
+            ball.z = table.rackZ[pos];
+        }
+    }
+
+    // free shot: 다른 공, 쿠션, 포켓과 떨어진 무작위 위치에 큐볼을 놓는다.
+    void placeCue(TableState& state, uint64_t& seed)
+    {
+        const TableLayout& table = activeTable();
+        const RuntimeTable config(table, NUM_BALLS);
+        const float diameter = (float)(M_RADIUS * 2);
+        BallState& cue = state.balls[CUE_BALL];
+        memset(&cue, 0, sizeof(cue));
+        cue.y = (float)M_RADIUS;
+        cue.active = true;
+        for (int attempt = 0; attempt < 1000; attempt++) {
+            cue.x = uniform(seed, table.minX, table.maxX);
+            cue.z = uniform(seed, table.minZ, table.maxZ);
+            bool free = isClearOfBoundary(config, cue.x, cue.z, 0.0f);
+            for (int j = 1; j < NUM_BALLS && free; j++) {
+                const BallState& other = state.balls[j];
+                free = !other.active || lengthSq(ballPosition(cue) - ballPosition(other)) > diameter * diameter;
+            }
+            if (free)
+                return;
+        }
+        cue.x = table.cueX;
+        cue.z = table.cueZ;
+    }
+
+    // 게임의 전역 부품들
+    struct Game {
+        TableState     table;
+        CIslandStepper stepper;
+        CEventBus      bus;
+        CRuleEngine    rules;
+        CZobristHash   hash;
+        CShotCache     cache;
+        CAimGuide      guide;
+        int            shots;
+
+        void newGame(void)
+        {
+            rackTable(table);
+            rules.reset(table.balls, NUM_BALLS);
+            table.rules = rules.rules();
+            hash.reset(table);
+            stepper.reset();
+            shots = 0;
+        }
+
+        void syncHash(void)
+        {
+            table.rules = rules.rules();
+            hash.reset(table);
+        }
+    };
+
+    // 조준, what-if 조회, 치기, 멈출 때까지의 frame. frame마다 할당을 검사한다 (check일 때).
+    void playShot(Game& game, uint64_t& seed, bool check)
+    {
+        CAllocWatch shotWatch;
+
+        if (game.rules.selectingGroup())
+            game.rules.selectGroup((splitmix64(seed) & 1) != 0);
+        if (game.rules.rules().free_shot) {
+            placeCue(game.table, seed);
+            game.rules.placeCueBall();
+        }
+        game.syncHash();
+
+        float aim = uniform(seed, -3.14159265f, 3.14159265f);
+        float power = uniform(seed, 1.0f, 6.0f);
+        float tipSide = uniform(seed, -0.3f, 0.3f);
+        float tipHeight = uniform(seed, -0.3f, 0.4f);
+
+        // 조준 중: 경로 예측과 샷 미리보기
+        game.guide.setTable(game.table.balls, NUM_BALLS, game.hash.value());
+        game.guide.predict(aim, power, tipSide, tipHeight);
+        const TableState& table = game.table;
+        ShotKey key = CShotCache::makeKey(game.hash.value(), aim, power, tipSide, tipHeight);
+        game.cache.lookupOrSimulate(key, [&table, aim, power, tipSide, tipHeight]() {
+            return simulateShot(table, aim, power, tipSide, tipHeight);
+        });
+
+        strikeCueBall(game.table.balls[CUE_BALL], aim, power, tipSide, tipHeight);
+        for (int frame = 0; frame < MAX_SHOT_FRAMES; frame++) {
+            CAllocWatch frameWatch;
+            game.stepper.step(game.table.balls, NUM_BALLS, FRAME_TIME, NULL);
+            game.bus.dispatch();
+            game.syncHash();
+            if (check)
+                frameWatch.expectNone("frame");
+            if (!game.rules.shotInProgress())
+                break;
+        }
+        if (check)
+            shotWatch.expectNone("shot");
+
+        game.shots++;
+        if (game.rules.winner() != 0 || game.rules.shotInProgress() || game.shots >= MAX_GAME_SHOTS)
+            game.newGame();
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    int count = 300;
+    int warmup = 20;
+    int threads = 0;
+    uint64_t seed = 1;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-shots") == 0 && i + 1 < argc) count = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-warmup") == 0 && i + 1 < argc) warmup = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-threads") == 0 && i + 1 < argc) threads = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-seed") == 0 && i + 1 < argc) seed = strtoull(argv[++i], NULL, 10);
+        else {
+            fprintf(stderr, "unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+    if (!allocTrackingEnabled()) {
+        fprintf(stderr, "built without ALLOC_TRACKING; allocations cannot be counted\n");
+        return 1;
+    }
+    setAllocFailureHandler(reportAlloc);
+
+    // 부품은 게임처럼 시작할 때 모두 만든다.
+    CThreadPool pool(threads > 0 ? threads - 1 : 0);
+    Game* game = new Game;
+    game->stepper.setPool(&pool);
+    game->stepper.setEventBus(&game->bus);
+    game->bus.subscribe(&game->rules);
+    game->newGame();
+
+    for (int i = 0; i < warmup; i++)
+        playShot(*game, seed, false);
+
+    AllocStats before = allocTotals();
+    for (int i = 0; i < count; i++)
+        playShot(*game, seed, true);
+    AllocStats after = allocTotals();
+
+    printf("%d shots after %d warm-up shots on %d thread(s): %llu allocation(s), %llu byte(s), %d failure(s)\n",
+        count, warmup, pool.size(), after.count - before.count, after.bytes - before.bytes, g_failures);
+    ShotCacheStats stats = game->cache.stats();
+    printf("what-if cache: %llu hits, %llu misses\n", (unsigned long long)stats.hits,
+        (unsigned long long)stats.misses);
+    delete game;
+    return g_failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,200 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: envCheck.cpp
+//
+// Desc: 학습용 C ABI 환경(billiardEnv.h)을 검사하는 창 없는 smoke test.
+//       같은 seed와 같은 행동 순서로 benv_create, benv_reset, benv_step, benv_observe를
+//       thread 수를 바꾸어(1, 2, 모든 core, -threads) 돌리고, 보상, done과 관측이
+//       thread 1개일 때와 bit 단위로 같은지 본다. 환경은 서로 독립이므로 나누는 방법과
+//       관계없이 같아야 한다.
+//       create 뒤의 reset, step, observe는 CAllocWatch::expectNone()으로 할당이 없는지 검사한다.
+//       하나라도 틀리면 내용을 출력하고 1을 돌려준다.
+//
+//       ALLOC_TRACKING을 정의해 allocTracker.cpp와 함께 빌드해야 한다 (없으면 실패).
+//       빌드 예)
+//         g++ -O2 -DALLOC_TRACKING -I.. -o envCheck envCheck.cpp ../allocTracker.cpp
+//             ../billiardEnv.cpp ../billiardPhysics.cpp ../contactSolver.cpp ../detMath.cpp
+//             ../eventBus.cpp ../islandStepper.cpp ../physicsParams.cpp ../ruleEngine.cpp
+//             ../tableConfig.cpp ../tableField.cpp ../tableLayout.cpp ../threadPool.cpp -lpthread
+//       사용 예)
+//         envCheck -envs 64 -steps 200
+//       그 밖의 옵션: -seed n, -threads n (함께 비교할 thread 수)
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "allocTracker.h"
+#include "billiardEnv.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdint.h>
+
+namespace
+{
+    const int MAX_RUNS = 4;
+
+    int g_failures = 0;
+
+    void reportAlloc(const char* where, const AllocStats& delta)
+    {
+        printf("allocation in %s: %llu allocation(s), %llu byte(s)\n", where, delta.count, delta.bytes);
+        g_failures++;
+    }
+
+    uint64_t splitmix64(uint64_t& state)
+    {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    float uniform(uint64_t& state, float lo, float hi)
+    {
+        return lo + (hi - lo) * (float)((splitmix64(state) >> 40) / 16777216.0);
+    }
+
+    // 한 번의 실행에서 모은 결과 (step마다 보상과 done, 마지막 관측)
+    struct RunResult {
+        int      threads;
+        float*   rewards;
+        uint8_t* dones;
+        float*   positions;
+        uint8_t* active;
+        int32_t* rules;
+    };
+
+    // 같은 seed면 thread 수와 관계없이 같은 행동 순서가 된다.
+    bool run(int threads, int numEnvs, int steps, uint64_t seed, RunResult& result)
+    {
+        BilliardEnv* env = benv_create(numEnvs, threads);
+        if (env == NULL || benv_num_envs(env) != numEnvs) {
+            printf("benv_create(%d, %d) failed\n", numEnvs, threads);
+            benv_destroy(env);
+            return false;
+        }
+        BilliardEnvAction* actions = new BilliardEnvAction[numEnvs];
+        uint64_t random = seed;
+
+        CAllocWatch watch;
+        benv_reset(env, seed);
+        watch.expectNone("benv_reset");
+        for (int s = 0; s < steps; s++) {
+            for (int i = 0; i < numEnvs; i++) {
+                BilliardEnvAction& action = actions[i];
+                action.aim = uniform(random, -3.14159265f, 3.14159265f);
+                action.power = uniform(random, 1.0f, 8.0f);
+                action.tipSide = uniform(random, -0.3f, 0.3f);
+                action.tipHeight = uniform(random, -0.3f, 0.4f);
+                action.placeX = uniform(random, -4.5f, 4.5f);
+                action.placeZ = uniform(random, -3.0f, 3.0f);
+                action.group = (int32_t)(splitmix64(random) & 1);
+            }
+            watch.begin();
+            benv_step(env, actions, result.rewards + s * numEnvs, result.dones + s * numEnvs);
+            watch.expectNone("benv_step");
+        }
+        watch.begin();
+        benv_observe(env, result.positions, result.active, result.rules);
+        watch.expectNone("benv_observe");
+
+        delete[] actions;
+        benv_destroy(env);
+        return true;
+    }
+
+    // 첫 실행(thread 1개)과 bit 단위로 비교한다.
+    int compare(const RunResult& base, const RunResult& other, int numEnvs, int steps)
+    {
+        int mismatches = 0;
+        for (int s = 0; s < steps; s++) {
+            for (int i = 0; i < numEnvs; i++) {
+                int k = s * numEnvs + i;
+                if (memcmp(&base.rewards[k], &other.rewards[k], sizeof(float)) != 0 ||
+                    base.dones[k] != other.dones[k]) {
+                    if (mismatches < 8) {
+                        printf("step %d env %d: reward %g done %d with 1 thread, %g %d with %d\n", s, i,
+                            base.rewards[k], base.dones[k], other.rewards[k], other.dones[k], other.threads);
+                    }
+                    mismatches++;
+                }
+            }
+        }
+        if (memcmp(base.positions, other.positions, sizeof(float) * numEnvs * BENV_NUM_BALLS * 2) != 0 ||
+            memcmp(base.active, other.active, numEnvs * BENV_NUM_BALLS) != 0 ||
+            memcmp(base.rules, other.rules, sizeof(int32_t) * numEnvs * BENV_RULE_FIELDS) != 0) {
+            printf("final observation differs with %d thread(s)\n", other.threads);
+            mismatches++;
+        }
+        return mismatches;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    int numEnvs = 64;
+    int steps = 200;
+    int extraThreads = -1;
+    uint64_t seed = 1;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-envs") == 0 && i + 1 < argc) numEnvs = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-steps") == 0 && i + 1 < argc) steps = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-threads") == 0 && i + 1 < argc) extraThreads = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-seed") == 0 && i + 1 < argc) seed = strtoull(argv[++i], NULL, 10);
+        else {
+            fprintf(stderr, "unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+    if (numEnvs <= 0 || steps <= 0) {
+        fprintf(stderr, "-envs and -steps must be positive\n");
+        return 1;
+    }
+    if (!allocTrackingEnabled()) {
+        fprintf(stderr, "built without ALLOC_TRACKING; allocations cannot be counted\n");
+        return 1;
+    }
+    setAllocFailureHandler(reportAlloc);
+
+    // thread 1개가 기준이다. 0은 모든 core.
+    int threadCounts[MAX_RUNS] = { 1, 2, 0, extraThreads };
+    int numRuns = extraThreads >= 0 ? MAX_RUNS : MAX_RUNS - 1;
+
+    RunResult results[MAX_RUNS];
+    int mismatches = 0;
+    for (int r = 0; r < numRuns; r++) {
+        RunResult& result = results[r];
+        result.threads = threadCounts[r];
+        result.rewards = new float[numEnvs * steps];
+        result.dones = new uint8_t[numEnvs * steps];
+        result.positions = new float[numEnvs * BENV_NUM_BALLS * 2];
+        result.active = new uint8_t[numEnvs * BENV_NUM_BALLS];
+        result.rules = new int32_t[numEnvs * BENV_RULE_FIELDS];
+        if (!run(result.threads, numEnvs, steps, seed, result)) {
+            g_failures++;
+            numRuns = r;
+            break;
+        }
+        if (r > 0)
+            mismatches += compare(results[0], result, numEnvs, steps);
+
+        double total = 0.0;
+        int games = 0;
+        for (int k = 0; k < numEnvs * steps; k++) {
+            total += result.rewards[k];
+            games += result.dones[k];
+        }
+        printf("%d thread(s): %d env(s) x %d step(s), %d game(s) finished, reward sum %.1f\n",
+            result.threads, numEnvs, steps, games, total);
+    }
+
+    printf("%d mismatch(es), %d failure(s)\n", mismatches, g_failures);
+    for (int r = 0; r < numRuns; r++) {
+        delete[] results[r].rewards;
+        delete[] results[r].dones;
+        delete[] results[r].positions;
+        delete[] results[r].active;
+        delete[] results[r].rules;
+    }
+    return mismatches > 0 || g_failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,262 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: netCheck.cpp
+//
+// Desc: 네트워크 대전 동기화(netSession)를 한 process 안에서 검사하는 창 없는 harness.
+//       host, player, 관전자 세 session을 CLoopbackHub로 잇고 지연과 손실을 준 채
+//       두 사람이 무작위로 샷, 큐볼 배치, 그룹 선택을 낸다. player의 clock은 조금씩 흔들려
+//       host보다 앞서거나 뒤처지므로 예측과 rollback이 일어난다.
+//       도중에 player의 공 하나를 몰래 옮겨 checksum 불일치와 snapshot 재전송(resync)을 일으킨다.
+//
+//       입력을 멈추고 -settle frame 동안 더 진행한 뒤 다음을 검사하고, 틀리면 1을 돌려준다.
+//         - 세 session 모두 synced이고 확정 입력 수(confirmedTurns)가 같다.
+//         - 모두 기록한 가장 늦은 step의 stateChecksum이 같다.
+//         - 지연이 있으면 rollback이 한 번 이상 있었다.
+//         - 공을 옮긴 player가 resync 했다.
+//
+//       빌드 예)
+//         g++ -O2 -I.. -o netCheck netCheck.cpp ../netSession.cpp ../netTransport.cpp
+//             ../lockstep.cpp ../ruleEngine.cpp ../billiardPhysics.cpp ../contactSolver.cpp
+//             ../detMath.cpp ../eventBus.cpp ../islandStepper.cpp ../physicsParams.cpp
+//             ../tableConfig.cpp ../tableField.cpp ../tableLayout.cpp ../threadPool.cpp -lpthread
+//       사용 예)
+//         netCheck -delay 5 -drop 7
+//       그 밖의 옵션: -frames n (입력을 내는 frame 수), -settle n, -seed n
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "billiardPhysics.h"
+#include "eventBus.h"
+#include "islandStepper.h"
+#include "lockstep.h"
+#include "netSession.h"
+#include "netTransport.h"
+#include "ruleEngine.h"
+#include "tableLayout.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdint.h>
+
+namespace
+{
+    const int NUM_SIDES = 3;            // 0: host, 1: player, 2: 관전자
+    const int SUBMIT_CHANCE = 40;       // frame마다 1/SUBMIT_CHANCE 확률로 입력을 낸다
+    const float CORRUPT_OFFSET = 0.01f; // 몰래 옮기는 거리
+
+    const char* SIDE_NAMES[NUM_SIDES] = { "host", "player", "spectator" };
+
+    uint64_t splitmix64(uint64_t& state)
+    {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    float uniform(uint64_t& state, float lo, float hi)
+    {
+        return lo + (hi - lo) * (float)((splitmix64(state) >> 40) / 16777216.0);
+    }
+
+    // 게임 하나의 물리와 규칙 (virtualLego.cpp의 g_table, g_stepper, g_eventBus, g_rules, g_net)
+    struct Side {
+        BallState      balls[NUM_BALLS];
+        CIslandStepper stepper;
+        CEventBus      bus;
+        CRuleEngine    rules;
+        CNetSession    session;
+    };
+
+    // Setup과 같은 rack 배치 (섞는 자리는 번호 순서로 채운다)
+    void rackTable(BallState* balls)
+    {
+        const TableLayout& table = activeTable();
+        memset(balls, 0, sizeof(BallState) * NUM_BALLS);
+        int next = 0;
+        for (int i = 0; i < NUM_BALLS; i++) {
+            BallState& ball = balls[i];
+            ball.y = (float)M_RADIUS;
+            if (i > table.rackCount) {
+                pocketBall(ball);
+                continue;
+            }
+            ball.active = true;
+            if (i == CUE_BALL) {
+                ball.x = table.cueX;
+                ball.z = table.cueZ;
+                continue;
+            }
+            int pos = -1;
+            for (int p = 0; p < table.rackCount; p++) {
+                if (table.rackBall[p] == i) pos = p;
+            }
+            while (pos < 0 && next < table.rackCount) {
+                if (table.rackBall[next] == 0) pos = next;
+                next++;
+            }
+            if (pos < 0) {
+                pocketBall(ball);
+                continue;
+            }
+            ball.x = table.rackX[pos];
+            ball.z = table.rackZ[pos];
+        }
+    }
+
+    // 낼 수 있는 입력 하나를 낸다. 배치는 자리가 맞지 않으면 거절되므로 다음 기회에 다시 고른다.
+    bool submitRandom(CNetSession& session, uint64_t& seed)
+    {
+        const TableLayout& table = activeTable();
+        if (session.canSubmit(NET_INPUT_GROUP))
+            return session.submitGroup((splitmix64(seed) & 1) != 0);
+        if (session.canSubmit(NET_INPUT_PLACE)) {
+            return session.submitPlacement(uniform(seed, table.minX, table.maxX),
+                uniform(seed, table.minZ, table.maxZ));
+        }
+        if (session.canSubmit(NET_INPUT_SHOT)) {
+            return session.submitShot(uniform(seed, -3.14159265f, 3.14159265f), uniform(seed, 1.0f, 8.0f),
+                uniform(seed, -0.3f, 0.3f), uniform(seed, -0.3f, 0.4f));
+        }
+        return false;
+    }
+
+    // 모든 공이 멈춰 있으면 큐볼이 아닌 공 하나를 옮긴다. 옮기지 못하면 false.
+    bool corruptBall(BallState* balls)
+    {
+        for (int i = 0; i < NUM_BALLS; i++) {
+            if (balls[i].active && isBallMoving(balls[i])) return false;
+        }
+        for (int i = 1; i < NUM_BALLS; i++) {
+            if (!balls[i].active) continue;
+            balls[i].x += CORRUPT_OFFSET;
+            return true;
+        }
+        return false;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    int frames = 40000;
+    int settle = 3000;
+    int delay = 5;
+    int dropEvery = 7;
+    uint64_t seed = 1;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-frames") == 0 && i + 1 < argc) frames = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-settle") == 0 && i + 1 < argc) settle = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-delay") == 0 && i + 1 < argc) delay = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-drop") == 0 && i + 1 < argc) dropEvery = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-seed") == 0 && i + 1 < argc) seed = strtoull(argv[++i], NULL, 10);
+        else {
+            fprintf(stderr, "unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    CLoopbackHub* hub = new CLoopbackHub;
+    hub->setConditions(delay, dropEvery);
+    Side* sides = new Side[NUM_SIDES];
+    CLoopbackTransport* transports[NUM_SIDES];
+    for (int k = 0; k < NUM_SIDES; k++) {
+        Side& side = sides[k];
+        // 붙는 쪽은 host의 snapshot을 받을 때까지 빈 테이블이다.
+        rackTable(side.balls);
+        if (k != 0) {
+            for (int i = 0; i < NUM_BALLS; i++)
+                pocketBall(side.balls[i]);
+        }
+        side.rules.reset(side.balls, NUM_BALLS);
+        side.bus.subscribe(&side.rules);
+        side.stepper.setEventBus(&side.bus);
+        side.session.attach(side.balls, &side.stepper, &side.bus, &side.rules);
+        transports[k] = new CLoopbackTransport(*hub, k);
+    }
+    if (!sides[0].session.host(transports[0]) || !sides[1].session.join(transports[1], 0, true) ||
+        !sides[2].session.join(transports[2], 0, false)) {
+        fprintf(stderr, "cannot start the sessions\n");
+        return 1;
+    }
+
+    // 도중에 player의 공을 옮긴다 (공이 모두 멈춘 때).
+    const int corruptFrom = frames / 3;
+    bool corrupted = false;
+    int submitted = 0;
+    for (int f = 0; f < frames + settle; f++) {
+        hub->deliver();
+        for (int k = 0; k < NUM_SIDES; k++) {
+            Side& side = sides[k];
+            side.session.poll();
+            // player의 clock은 frame마다 0~2 step으로 흔들린다.
+            int steps = k == 1 ? (f % 7 == 0 ? 2 : f % 7 == 3 ? 0 : 1) : 1;
+            side.session.advance(steps);
+            side.bus.dispatch();
+
+            if (f < frames && splitmix64(seed) % SUBMIT_CHANCE == 0 && submitRandom(side.session, seed))
+                submitted++;
+        }
+        if (!corrupted && f >= corruptFrom && f < frames && sides[1].session.synced())
+            corrupted = corruptBall(sides[1].balls);
+    }
+
+    // 모두 기록한 가장 늦은 step에서 비교한다.
+    uint32_t common = sides[0].session.step();
+    for (int k = 1; k < NUM_SIDES; k++) {
+        if (sides[k].session.step() < common) common = sides[k].session.step();
+    }
+    common = common > 0 ? common - 1 : 0;
+
+    int failures = 0;
+    unsigned rollbacks = 0;
+    uint64_t checksums[NUM_SIDES];
+    for (int k = 0; k < NUM_SIDES; k++) {
+        const CNetSession& session = sides[k].session;
+        const NetStats& stats = session.stats();
+        bool found = session.checksums().lookup(common, &checksums[k]);
+        printf("%-9s step %6u turns %4u%s checksum %016llx | sent %u B in %u packets, "
+            "%u predictions, %u rollbacks (%u steps), %u resyncs\n",
+            SIDE_NAMES[k], session.step(), session.confirmedTurns(), session.synced() ? "" : " (not synced)",
+            found ? (unsigned long long)checksums[k] : 0ull, stats.bytesSent, stats.packetsSent,
+            stats.predictions, stats.rollbacks, stats.resimulatedSteps, stats.resyncs);
+        rollbacks += stats.rollbacks;
+
+        if (!session.synced() || !found) {
+            printf("FAIL: %s has no state at step %u\n", SIDE_NAMES[k], common);
+            failures++;
+            continue;
+        }
+        if (k == 0) continue;
+        if (checksums[k] != checksums[0]) {
+            printf("FAIL: %s differs from the host at step %u\n", SIDE_NAMES[k], common);
+            failures++;
+        }
+        if (session.confirmedTurns() != sides[0].session.confirmedTurns()) {
+            printf("FAIL: %s confirmed %u turns, the host %u\n", SIDE_NAMES[k], session.confirmedTurns(),
+                sides[0].session.confirmedTurns());
+            failures++;
+        }
+    }
+    if (delay > 0 && rollbacks == 0) {
+        printf("FAIL: no rollbacks with a delay of %d\n", delay);
+        failures++;
+    }
+    if (!corrupted) {
+        printf("FAIL: the player's state was never corrupted (the table never came to rest)\n");
+        failures++;
+    }
+    else if (sides[1].session.stats().resyncs == 0) {
+        printf("FAIL: the player did not resync after its state was corrupted\n");
+        failures++;
+    }
+    printf("%d inputs submitted, delay %d, drop every %d: %s\n", submitted, delay, dropEvery,
+        failures == 0 ? "converged" : "FAILED");
+
+    for (int k = 0; k < NUM_SIDES; k++) {
+        sides[k].session.close();
+        delete transports[k];
+    }
+    delete[] sides;
+    delete hub;
+    return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,696 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: physicsDiff.cpp
+//
+// Desc: 빠른 물리 경로가 기준 stepper(referencePhysics)와 같은 결과를 내는지 보는 차분 검사.
+//
+//       1. seed로 무작위 배치(겹치지 않는 공, 규칙 값)와 샷(aim, power, 큐 팁)을 만든다.
+//       2. 같은 case를 기준 stepper와 후보 엔진마다 진행한다.
+//       3. 엔진마다 step이 끝날 때마다 NaN, 에너지 증가, 풀고 난 뒤의 겹침을 보고,
+//          끝난 뒤 들어간 공, 파울 (scratch 포함), 첫 접촉, 멈춘 위치(-tol 이내)를 기준과 비교한다.
+//       어긋난 case는 공을 빼고, 큐 팁과 좌표를 단순하게 하며 같은 종류로 계속 어긋나는
+//       가장 작은 case로 줄여 파일로 남긴다. -replay로 그 파일을 다시 돌려 공마다의 차이를 본다.
+//
+//       후보 엔진
+//         game      simulateShot과 같은 진행 (SIM_FIXED_STEP, 멈출 때 닫힌 해)
+//         no-rest   fastForwardToRest 없이 끝까지 step
+//         step-x2   두 배 간격의 step
+//         sweep     shotSweep의 건너뛰기 경로 (위치는 비교하지 않는다)
+//
+//       여러 공이 한꺼번에 부딪히는 배치는 작은 차이가 커지므로 (혼돈) 위치와 들어간 공의
+//       차이는 엔진의 잘못이 아닐 수 있다. 불변식 위반(NaN, 에너지, 겹침)은 언제나 잘못이다.
+//
+//       빌드 예)
+//         g++ -O2 -I.. -o physicsDiff physicsDiff.cpp ../referencePhysics.cpp ../shotSweep.cpp
+//             ../billiardPhysics.cpp ../contactSolver.cpp ../detMath.cpp ../eventBus.cpp
+//             ../islandStepper.cpp ../physicsParams.cpp ../tableField.cpp ../tableLayout.cpp
+//             ../tableConfig.cpp ../threadPool.cpp -lpthread
+//       사용 예)
+//         physicsDiff -cases 1000000 -balls 4 -out fail
+//         physicsDiff -replay fail-game-position.txt
+//       그 밖의 옵션: -seed n, -threads n (0: 모든 core), -tol 위치 허용 오차, -refstep 기준 간격,
+//                     -engines game,step-x2 (쉼표로), -table 파일
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "billiardPhysics.h"
+#include "contactSolver.h"
+#include "referencePhysics.h"
+#include "shotSweep.h"
+#include "tableLayout.h"
+#include "threadPool.h"
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+namespace
+{
+    const int   MAX_ENGINES = 8;
+    const int   CASE_GRAIN = 16;
+    const int   MAX_SHOT_STEPS = 20000;
+    // step 사이 에너지가 이 비율보다 늘면 위반 (float 반올림 여유)
+    const double ENERGY_TOLERANCE = 1e-4;
+    // 풀고 난 뒤 남아도 되는 겹침 (위치 보정 반복의 잔차)
+    const float OVERLAP_TOLERANCE = (float)M_RADIUS * 0.01f;
+    // 공 사이에 두는 최소 틈 (출발 배치)
+    const float SPAWN_GAP = 0.02f;
+
+    enum DiffFailure {
+        DIFF_OK,
+        DIFF_NAN,
+        DIFF_ENERGY,
+        DIFF_OVERLAP,
+        DIFF_POCKETED,
+        DIFF_FOUL,
+        DIFF_FIRST_CONTACT,
+        DIFF_POSITION,
+        DIFF_KINDS
+    };
+    const char* FAILURE_NAMES[DIFF_KINDS] = {
+        "ok", "nan", "energy", "overlap", "pocketed", "foul", "first-contact", "position"
+    };
+
+    struct DiffCase {
+        TableState start;
+        float aim, power, tipSide, tipHeight;
+    };
+
+    struct DiffOptions {
+        float  tolerance;
+        double referenceStep;
+    };
+
+    // -------------------------------------------------------------------------
+    // step마다의 불변식
+    // -------------------------------------------------------------------------
+
+    struct StepMonitor {
+        double energy;
+        bool   nan, energyGain, overlap;
+
+        void start(const BallState* balls)
+        {
+            energy = totalEnergy(balls);
+            nan = energyGain = overlap = false;
+        }
+
+        void observe(const BallState* balls)
+        {
+            for (int i = 0; i < NUM_BALLS; i++) {
+                const BallState& b = balls[i];
+                if (!b.active) continue;
+                if (std::isnan(b.x) || std::isnan(b.z) || std::isnan(b.vx) || std::isnan(b.vz) ||
+                    std::isnan(b.wx) || std::isnan(b.wy) || std::isnan(b.wz))
+                    nan = true;
+            }
+            double now = totalEnergy(balls);
+            if (now > energy * (1.0 + ENERGY_TOLERANCE) + 1e-9)
+                energyGain = true;
+            energy = now;
+
+            const float limit = (float)(2 * M_RADIUS) - OVERLAP_TOLERANCE;
+            for (int i = 0; i < NUM_BALLS; i++) {
+                if (!balls[i].active) continue;
+                for (int j = i + 1; j < NUM_BALLS; j++) {
+                    if (!balls[j].active) continue;
+                    if (lengthSq(ballPosition(balls[i]) - ballPosition(balls[j])) < limit * limit)
+                        overlap = true;
+                }
+            }
+        }
+
+        static double totalEnergy(const BallState* balls)
+        {
+            double sum = 0.0;
+            for (int i = 0; i < NUM_BALLS; i++)
+                sum += ballEnergy(balls[i]);
+            return sum;
+        }
+    };
+
+    // -------------------------------------------------------------------------
+    // 후보 엔진
+    // -------------------------------------------------------------------------
+
+    typedef void (*EngineRun)(const DiffCase& c, ShotOutcome& out, StepMonitor& monitor);
+
+    struct DiffEngine {
+        const char* name;
+        bool        positions;      // 멈춘 위치를 비교할 수 있음
+        bool        earlyEight;     // 8번을 일찍 넣는 것도 파울로 센다 (shotSweep의 분류)
+        EngineRun   run;
+    };
+
+    void finishOutcome(const DiffCase& c, ShotOutcome& out)
+    {
+        bool solidIn = false, stripeIn = false;
+        for (int i = 0; i < NUM_BALLS; i++) {
+            if (!(out.pocketed & (1u << i))) continue;
+            solidIn = solidIn || isSolidBall(i);
+            stripeIn = stripeIn || isStripeBall(i);
+        }
+        out.scratch = (out.pocketed & (1u << CUE_BALL)) != 0;
+        out.foul = isFoul(c.start.rules.break_shot, solidIn, stripeIn, out.scratch, out.cushionHits) ||
+            !isLegalFirstContact(c.start.rules, out.firstContact);
+    }
+
+    bool anyMoving(const BallState* balls)
+    {
+        for (int i = 0; i < NUM_BALLS; i++) {
+            if (isBallMoving(balls[i])) return true;
+        }
+        return false;
+    }
+
+    void runStepped(const DiffCase& c, ShotOutcome& out, StepMonitor& monitor, float step, bool restShortcut)
+    {
+        memset(&out, 0, sizeof(out));
+        out.firstContact = -1;
+        BallState* balls = out.finalBalls;
+        memcpy(balls, c.start.balls, sizeof(c.start.balls));
+        strikeCueBall(balls[CUE_BALL], c.aim, c.power, c.tipSide, c.tipHeight);
+        monitor.start(balls);
+
+        CContactSolver solver;
+        bool moving = true;
+        while (moving && out.steps < MAX_SHOT_STEPS) {
+            StepEvents events;
+            stepTable(balls, NUM_BALLS, step, &events, &solver);
+            out.steps++;
+            out.pocketed |= events.pocketed;
+            out.cushionHits += events.cushionHits;
+            if (out.firstContact < 0)
+                out.firstContact = events.firstContact;
+            moving = restShortcut ? !fastForwardToRest(balls, NUM_BALLS) : anyMoving(balls);
+            monitor.observe(balls);
+        }
+        finishOutcome(c, out);
+    }
+
+    void runGame(const DiffCase& c, ShotOutcome& out, StepMonitor& monitor)
+    {
+        runStepped(c, out, monitor, SIM_FIXED_STEP, true);
+    }
+
+    void runNoRest(const DiffCase& c, ShotOutcome& out, StepMonitor& monitor)
+    {
+        runStepped(c, out, monitor, SIM_FIXED_STEP, false);
+    }
+
+    void runDoubleStep(const DiffCase& c, ShotOutcome& out, StepMonitor& monitor)
+    {
+        runStepped(c, out, monitor, SIM_FIXED_STEP * 2.0f, true);
+    }
+
+    void runSweep(const DiffCase& c, ShotOutcome& out, StepMonitor& monitor)
+    {
+        memset(&out, 0, sizeof(out));
+        monitor.start(c.start.balls);
+        SweepGrid grid = { c.aim, c.aim, 1, c.power, c.power, 1, c.tipSide, c.tipHeight };
+        SweepCell cell;
+        sweepShots(c.start, grid, &cell, NULL);
+        out.pocketed = cell.pocketed;
+        out.firstContact = cell.firstContact;
+        out.scratch = cell.result == SWEEP_SCRATCH;
+        out.foul = cell.result == SWEEP_SCRATCH || cell.result == SWEEP_FOUL;
+    }
+
+    const DiffEngine ENGINES[] = {
+        { "game",    true,  false, runGame },
+        { "no-rest", true,  false, runNoRest },
+        { "step-x2", true,  false, runDoubleStep },
+        { "sweep",   false, true,  runSweep },
+    };
+    const int NUM_ENGINES = (int)(sizeof(ENGINES) / sizeof(ENGINES[0]));
+
+    // -------------------------------------------------------------------------
+    // 비교
+    // -------------------------------------------------------------------------
+
+    DiffFailure compare(const DiffCase& c, const DiffEngine& engine, const ShotOutcome& reference,
+        const ShotOutcome& out, const StepMonitor& monitor, float tolerance, float* worst)
+    {
+        *worst = 0.0f;
+        if (monitor.nan) return DIFF_NAN;
+        if (monitor.energyGain) return DIFF_ENERGY;
+        if (monitor.overlap) return DIFF_OVERLAP;
+        if (reference.pocketed != out.pocketed) return DIFF_POCKETED;
+        bool foul = reference.foul;
+        if (engine.earlyEight)
+            foul = foul || ((reference.pocketed & (1u << EIGHT_BALL)) && !isLegalFirstContact(c.start.rules, EIGHT_BALL));
+        if (foul != out.foul || reference.scratch != out.scratch) return DIFF_FOUL;
+        if (reference.firstContact != out.firstContact) return DIFF_FIRST_CONTACT;
+        if (!engine.positions) return DIFF_OK;
+        for (int i = 0; i < NUM_BALLS; i++) {
+            if (!reference.finalBalls[i].active) continue;
+            float error = length(ballPosition(reference.finalBalls[i]) - ballPosition(out.finalBalls[i]));
+            if (error > *worst) *worst = error;
+        }
+        return *worst > tolerance ? DIFF_POSITION : DIFF_OK;
+    }
+
+    DiffFailure check(const DiffCase& c, const DiffEngine& engine, const DiffOptions& options,
+        ShotOutcome* reference = 0, ShotOutcome* result = 0)
+    {
+        ShotOutcome ref = referenceShot(c.start, c.aim, c.power, c.tipSide, c.tipHeight, options.referenceStep);
+        ShotOutcome out;
+        StepMonitor monitor;
+        engine.run(c, out, monitor);
+        float worst;
+        DiffFailure failure = compare(c, engine, ref, out, monitor, options.tolerance, &worst);
+        if (reference != NULL) *reference = ref;
+        if (result != NULL) *result = out;
+        return failure;
+    }
+
+    // -------------------------------------------------------------------------
+    // case 생성
+    // -------------------------------------------------------------------------
+
+    uint64_t nextRandom(uint64_t& state)
+    {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    float uniform(uint64_t& state, float lo, float hi)
+    {
+        return lo + (hi - lo) * (float)((nextRandom(state) >> 40) * (1.0 / 16777216.0));
+    }
+
+    bool placeable(const TableState& state, float x, float z)
+    {
+        const TableLayout& table = activeTable();
+        for (int p = 0; p < table.numPockets; p++) {
+            const PocketCircle& pocket = table.pockets[p];
+            if (length(make_float2(x - pocket.x, z - pocket.z)) < pocket.radius + (float)M_RADIUS)
+                return false;
+        }
+        const float limit = (float)(2 * M_RADIUS) + SPAWN_GAP;
+        for (int i = 0; i < NUM_BALLS; i++) {
+            if (!state.balls[i].active) continue;
+            if (lengthSq(ballPosition(state.balls[i]) - make_float2(x, z)) < limit * limit)
+                return false;
+        }
+        return true;
+    }
+
+    void countGroups(TableState& state)
+    {
+        state.rules.solid_num = state.rules.stripe_num = 0;
+        for (int i = 1; i < NUM_BALLS; i++) {
+            if (!state.balls[i].active) continue;
+            if (isSolidBall(i)) state.rules.solid_num++;
+            if (isStripeBall(i)) state.rules.stripe_num++;
+        }
+    }
+
+    void generateCase(uint64_t seed, int maxBalls, DiffCase& c)
+    {
+        uint64_t random = seed;
+        const TableLayout& table = activeTable();
+        const float r = (float)M_RADIUS;
+
+        memset(&c, 0, sizeof(c));
+        for (int i = 0; i < NUM_BALLS; i++) {
+            c.start.balls[i].y = r;
+            pocketBall(c.start.balls[i]);
+        }
+
+        // 큐볼과 무작위로 고른 목적구를 겹치지 않게 놓는다.
+        int numBalls = 1 + (int)(nextRandom(random) % (uint64_t)maxBalls);
+        for (int n = 0; n < numBalls; n++) {
+            int index = n == 0 ? CUE_BALL : 1 + (int)(nextRandom(random) % (NUM_BALLS - 1));
+            if (c.start.balls[index].active) continue;
+            for (int attempt = 0; attempt < 32; attempt++) {
+                float x = uniform(random, table.minX + r, table.maxX - r);
+                float z = uniform(random, table.minZ + r, table.maxZ - r);
+                if (!placeable(c.start, x, z)) continue;
+                BallState& ball = c.start.balls[index];
+                memset(&ball, 0, sizeof(ball));
+                ball.x = x;
+                ball.y = r;
+                ball.z = z;
+                ball.active = true;
+                break;
+            }
+        }
+        if (!c.start.balls[CUE_BALL].active) {
+            BallState& cue = c.start.balls[CUE_BALL];
+            memset(&cue, 0, sizeof(cue));
+            cue.x = table.cueX;
+            cue.y = r;
+            cue.z = table.cueZ;
+            cue.active = true;
+        }
+
+        RuleState& rules = c.start.rules;
+        rules.turn = true;
+        rules.break_shot = nextRandom(random) % 10 == 0;
+        rules.open = nextRandom(random) % 2 == 0;
+        rules.group = nextRandom(random) % 2 == 0;
+        countGroups(c.start);
+
+        c.aim = uniform(random, -3.14159265f, 3.14159265f);
+        c.power = uniform(random, 0.2f, 8.0f);
+        float tipAngle = uniform(random, -3.14159265f, 3.14159265f);
+        float tipRadius = MAX_TIP_OFFSET * sqrtf(uniform(random, 0.0f, 1.0f));
+        c.tipSide = tipRadius * cosf(tipAngle);
+        c.tipHeight = tipRadius * sinf(tipAngle);
+    }
+
+    // -------------------------------------------------------------------------
+    // 줄이기
+    // -------------------------------------------------------------------------
+
+    bool stillFails(const DiffCase& c, const DiffEngine& engine, DiffFailure kind, const DiffOptions& options)
+    {
+        return check(c, engine, options) == kind;
+    }
+
+    float roundTo(float value, float cell)
+    {
+        return floorf(value / cell + 0.5f) * cell;
+    }
+
+    // 같은 종류로 계속 어긋나는 동안 case를 단순하게 만든다.
+    DiffCase shrinkCase(DiffCase c, const DiffEngine& engine, DiffFailure kind, const DiffOptions& options)
+    {
+        bool progress = true;
+        while (progress) {
+            progress = false;
+
+            // 공을 하나씩 뺀다.
+            for (int i = 1; i < NUM_BALLS; i++) {
+                if (!c.start.balls[i].active) continue;
+                DiffCase trial = c;
+                pocketBall(trial.start.balls[i]);
+                countGroups(trial.start);
+                if (stillFails(trial, engine, kind, options)) {
+                    c = trial;
+                    progress = true;
+                }
+            }
+
+            // 큐 팁, 규칙, 힘과 방향을 단순한 값으로
+            DiffCase trials[6];
+            int numTrials = 0;
+            if (c.tipSide != 0.0f) { trials[numTrials] = c; trials[numTrials++].tipSide = 0.0f; }
+            if (c.tipHeight != 0.0f) { trials[numTrials] = c; trials[numTrials++].tipHeight = 0.0f; }
+            if (c.start.rules.break_shot) { trials[numTrials] = c; trials[numTrials++].start.rules.break_shot = false; }
+            if (!c.start.rules.open) { trials[numTrials] = c; trials[numTrials++].start.rules.open = true; }
+            if (roundTo(c.power, 0.1f) != c.power) { trials[numTrials] = c; trials[numTrials].power = roundTo(c.power, 0.1f); numTrials++; }
+            if (roundTo(c.aim, 0.001f) != c.aim) { trials[numTrials] = c; trials[numTrials].aim = roundTo(c.aim, 0.001f); numTrials++; }
+            for (int t = 0; t < numTrials; t++) {
+                if (stillFails(trials[t], engine, kind, options)) {
+                    c = trials[t];
+                    progress = true;
+                }
+            }
+
+            // 좌표를 0.01 격자로
+            for (int i = 0; i < NUM_BALLS; i++) {
+                BallState& ball = c.start.balls[i];
+                if (!ball.active) continue;
+                float x = roundTo(ball.x, 0.01f), z = roundTo(ball.z, 0.01f);
+                if (x == ball.x && z == ball.z) continue;
+                DiffCase trial = c;
+                trial.start.balls[i].active = false;
+                if (!placeable(trial.start, x, z)) continue;
+                trial.start.balls[i].active = true;
+                trial.start.balls[i].x = x;
+                trial.start.balls[i].z = z;
+                if (stillFails(trial, engine, kind, options)) {
+                    c = trial;
+                    progress = true;
+                }
+            }
+        }
+        return c;
+    }
+
+    // -------------------------------------------------------------------------
+    // case 파일 (aimSweep의 배치 파일에 shot 줄을 더한 형식)
+    // -------------------------------------------------------------------------
+
+    bool writeCase(const char* path, const DiffCase& c, const char* engine, DiffFailure kind)
+    {
+        FILE* file = fopen(path, "w");
+        if (file == NULL)
+            return false;
+        fprintf(file, "# %s: %s\n", engine, FAILURE_NAMES[kind]);
+        for (int i = 0; i < NUM_BALLS; i++) {
+            const BallState& ball = c.start.balls[i];
+            if (ball.active) fprintf(file, "ball %d %.9g %.9g\n", i, ball.x, ball.z);
+        }
+        if (c.start.rules.break_shot) fprintf(file, "break\n");
+        if (!c.start.rules.open) fprintf(file, "group %s\n", c.start.rules.group ? "solid" : "stripe");
+        fprintf(file, "shot %.9g %.9g %.9g %.9g\n", c.aim, c.power, c.tipSide, c.tipHeight);
+        return fclose(file) == 0;
+    }
+
+    bool readCase(const char* path, DiffCase& c)
+    {
+        FILE* file = fopen(path, "r");
+        if (file == NULL)
+            return false;
+        memset(&c, 0, sizeof(c));
+        for (int i = 0; i < NUM_BALLS; i++) {
+            c.start.balls[i].y = (float)M_RADIUS;
+            pocketBall(c.start.balls[i]);
+        }
+        c.start.rules.turn = true;
+        c.start.rules.open = true;
+        bool shot = false;
+
+        char line[256];
+        while (fgets(line, sizeof(line), file) != NULL) {
+            char* comment = strchr(line, '#');
+            if (comment != NULL) *comment = '\0';
+            int index;
+            float x, z;
+            char word[32];
+            if (sscanf(line, " ball %d %f %f", &index, &x, &z) == 3 && index >= 0 && index < NUM_BALLS) {
+                BallState& ball = c.start.balls[index];
+                memset(&ball, 0, sizeof(ball));
+                ball.x = x;
+                ball.y = (float)M_RADIUS;
+                ball.z = z;
+                ball.active = true;
+            }
+            else if (sscanf(line, " shot %f %f %f %f", &c.aim, &c.power, &c.tipSide, &c.tipHeight) == 4) {
+                shot = true;
+            }
+            else if (sscanf(line, " group %31s", word) == 1) {
+                c.start.rules.open = false;
+                c.start.rules.group = strcmp(word, "solid") == 0;
+            }
+            else if (sscanf(line, " %31s", word) == 1 && strcmp(word, "break") == 0) {
+                c.start.rules.break_shot = true;
+            }
+        }
+        fclose(file);
+        countGroups(c.start);
+        return shot && c.start.balls[CUE_BALL].active;
+    }
+
+    int replay(const DiffCase& c, const DiffOptions& options, const bool* enabled)
+    {
+        ShotOutcome reference = referenceShot(c.start, c.aim, c.power, c.tipSide, c.tipHeight, options.referenceStep);
+        printf("reference: pocketed 0x%04x, first contact %d, cushions %d, foul %d, scratch %d\n",
+            reference.pocketed, reference.firstContact, reference.cushionHits, reference.foul, reference.scratch);
+
+        int failures = 0;
+        for (int e = 0; e < NUM_ENGINES; e++) {
+            if (!enabled[e]) continue;
+            const DiffEngine& engine = ENGINES[e];
+            ShotOutcome out;
+            StepMonitor monitor;
+            engine.run(c, out, monitor);
+            float worst;
+            DiffFailure failure = compare(c, engine, reference, out, monitor, options.tolerance, &worst);
+            printf("%-8s %-13s pocketed 0x%04x, first contact %d, cushions %d, foul %d, scratch %d, worst %.4f\n",
+                engine.name, FAILURE_NAMES[failure], out.pocketed, out.firstContact, out.cushionHits,
+                out.foul, out.scratch, worst);
+            if (engine.positions) {
+                for (int i = 0; i < NUM_BALLS; i++) {
+                    const BallState& a = reference.finalBalls[i];
+                    const BallState& b = out.finalBalls[i];
+                    if (!a.active && !b.active) continue;
+                    printf("    ball %2d  ref (%8.4f, %8.4f)%s  out (%8.4f, %8.4f)%s\n", i,
+                        a.x, a.z, a.active ? "" : " in", b.x, b.z, b.active ? "" : " in");
+                }
+            }
+            if (failure != DIFF_OK) failures++;
+        }
+        return failures;
+    }
+
+    struct CaseBody {
+        uint64_t           seed;
+        int                maxBalls;
+        const DiffOptions* options;
+        const bool*        enabled;
+        std::atomic<long long> (*counts)[DIFF_KINDS];
+        std::mutex*        lock;
+        DiffCase         (*samples)[DIFF_KINDS];
+        bool             (*sampled)[DIFF_KINDS];
+
+        void operator()(int begin, int end) const
+        {
+            long long local[MAX_ENGINES][DIFF_KINDS];
+            memset(local, 0, sizeof(local));
+            for (int index = begin; index < end; index++) {
+                DiffCase c;
+                uint64_t caseSeed = seed ^ ((uint64_t)index * 0xD1B54A32D192ED03ull);
+                generateCase(caseSeed, maxBalls, c);
+
+                ShotOutcome reference = referenceShot(c.start, c.aim, c.power, c.tipSide, c.tipHeight,
+                    options->referenceStep);
+                for (int e = 0; e < NUM_ENGINES; e++) {
+                    if (!enabled[e]) continue;
+                    ShotOutcome out;
+                    StepMonitor monitor;
+                    ENGINES[e].run(c, out, monitor);
+                    float worst;
+                    DiffFailure failure = compare(c, ENGINES[e], reference, out, monitor,
+                        options->tolerance, &worst);
+                    local[e][failure]++;
+                    if (failure == DIFF_OK) continue;
+
+                    // 엔진과 종류마다 처음 본 case 하나를 줄이기용으로 남긴다.
+                    std::lock_guard<std::mutex> guard(*lock);
+                    if (!sampled[e][failure]) {
+                        sampled[e][failure] = true;
+                        samples[e][failure] = c;
+                    }
+                }
+            }
+            for (int e = 0; e < NUM_ENGINES; e++) {
+                for (int k = 0; k < DIFF_KINDS; k++) {
+                    if (local[e][k] != 0) counts[e][k].fetch_add(local[e][k]);
+                }
+            }
+        }
+    };
+}
+
+int main(int argc, char* argv[])
+{
+    int cases = 10000, threads = 0, maxBalls = NUM_BALLS - 1;
+    uint64_t seed = 1;
+    DiffOptions options = { 0.05f, REFERENCE_STEP };
+    const char* out = "diff";
+    const char* replayPath = NULL;
+    const char* tablePath = NULL;
+    const char* engineList = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-cases") == 0 && i + 1 < argc) cases = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-seed") == 0 && i + 1 < argc) seed = strtoull(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "-threads") == 0 && i + 1 < argc) threads = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-balls") == 0 && i + 1 < argc) maxBalls = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-tol") == 0 && i + 1 < argc) options.tolerance = (float)atof(argv[++i]);
+        else if (strcmp(argv[i], "-refstep") == 0 && i + 1 < argc) options.referenceStep = atof(argv[++i]);
+        else if (strcmp(argv[i], "-engines") == 0 && i + 1 < argc) engineList = argv[++i];
+        else if (strcmp(argv[i], "-out") == 0 && i + 1 < argc) out = argv[++i];
+        else if (strcmp(argv[i], "-replay") == 0 && i + 1 < argc) replayPath = argv[++i];
+        else if (strcmp(argv[i], "-table") == 0 && i + 1 < argc) tablePath = argv[++i];
+    }
+    if (maxBalls < 1) maxBalls = 1;
+    if (maxBalls > NUM_BALLS - 1) maxBalls = NUM_BALLS - 1;
+    if (options.referenceStep <= 0.0) options.referenceStep = REFERENCE_STEP;
+
+    bool enabled[MAX_ENGINES];
+    for (int e = 0; e < NUM_ENGINES; e++)
+        enabled[e] = engineList == NULL || strstr(engineList, ENGINES[e].name) != NULL;
+
+    if (tablePath != NULL) {
+        TableLayout layout;
+        char error[256];
+        if (!loadTableLayout(tablePath, &layout, error, sizeof(error))) {
+            fprintf(stderr, "%s: %s\n", tablePath, error);
+            return 1;
+        }
+        setActiveTable(layout);
+    }
+
+    if (replayPath != NULL) {
+        DiffCase c;
+        if (!readCase(replayPath, c)) {
+            fprintf(stderr, "cannot read %s\n", replayPath);
+            return 1;
+        }
+        return replay(c, options, enabled) == 0 ? 0 : 1;
+    }
+
+    std::atomic<long long> counts[MAX_ENGINES][DIFF_KINDS];
+    for (int e = 0; e < MAX_ENGINES; e++) {
+        for (int k = 0; k < DIFF_KINDS; k++) counts[e][k].store(0);
+    }
+    static DiffCase samples[MAX_ENGINES][DIFF_KINDS];
+    bool sampled[MAX_ENGINES][DIFF_KINDS];
+    memset(sampled, 0, sizeof(sampled));
+    std::mutex lock;
+
+    CThreadPool pool(threads > 0 ? threads - 1 : 0);
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    CaseBody body = { seed, maxBalls, &options, enabled, counts, &lock, samples, sampled };
+    if (threads == 1)
+        body(0, cases);
+    else
+        pool.parallelFor(cases, CASE_GRAIN, body);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    printf("%d cases in %.1f s on %d thread(s) (%.0f cases/s), up to %d object balls\n",
+        cases, seconds, threads == 1 ? 1 : pool.size(), cases / seconds, maxBalls);
+    printf("%-8s", "engine");
+    for (int k = 0; k < DIFF_KINDS; k++) printf(" %13s", FAILURE_NAMES[k]);
+    printf("\n");
+    int failures = 0;
+    for (int e = 0; e < NUM_ENGINES; e++) {
+        if (!enabled[e]) continue;
+        printf("%-8s", ENGINES[e].name);
+        for (int k = 0; k < DIFF_KINDS; k++) printf(" %13lld", counts[e][k].load());
+        printf("\n");
+        for (int k = 1; k < DIFF_KINDS; k++) {
+            if (counts[e][k].load() != 0) failures++;
+        }
+    }
+
+    // 어긋난 종류마다 줄인 case를 남긴다 (줄이기도 여러 thread에서).
+    struct Shrink { int engine, kind; };
+    std::vector<Shrink> work;
+    for (int e = 0; e < NUM_ENGINES; e++) {
+        for (int k = 1; k < DIFF_KINDS; k++) {
+            if (sampled[e][k]) { Shrink s = { e, k }; work.push_back(s); }
+        }
+    }
+    if (!work.empty()) {
+        std::vector<DiffCase> shrunk(work.size());
+        auto shrinkBody = [&](int from, int to) {
+            for (int w = from; w < to; w++)
+                shrunk[w] = shrinkCase(samples[work[w].engine][work[w].kind], ENGINES[work[w].engine],
+                    (DiffFailure)work[w].kind, options);
+        };
+        if (threads == 1)
+            shrinkBody(0, (int)work.size());
+        else
+            pool.parallelFor((int)work.size(), 1, shrinkBody);
+        for (size_t w = 0; w < work.size(); w++) {
+            char path[512];
+            snprintf(path, sizeof(path), "%s-%s-%s.txt", out, ENGINES[work[w].engine].name, FAILURE_NAMES[work[w].kind]);
+            int balls = 0;
+            for (int i = 0; i < NUM_BALLS; i++) balls += shrunk[w].start.balls[i].active ? 1 : 0;
+            if (writeCase(path, shrunk[w], ENGINES[work[w].engine].name, (DiffFailure)work[w].kind))
+                printf("  %s: %d ball(s)\n", path, balls);
+        }
+    }
+    return failures == 0 ? 0 : 1;
+}
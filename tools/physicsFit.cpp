@@ -0,0 +1,713 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: physicsFit.cpp
+//
+// Desc: 실제 테이블에서 기록한 샷의 공 궤적에 맞춰 물리 계수(physicsParams.h)를 조정하고
+//       게임이 시작할 때 읽는 계수 파일(physics.params)을 쓴다.
+//
+//       계수 한 벌의 오차는 기록한 모든 샷을 그 계수로 다시 시뮬레이션해 기록 시각마다의
+//       공 위치 차이를 모은 RMS다. 시뮬레이션에서 이미 들어간 공의 기록, 들어간 공 집합이
+//       다른 공은 POCKET_PENALTY의 오차로 센다. 샷들은 core마다 나누어 시뮬레이션하고,
+//       계수는 Nelder-Mead (log 좌표, 시작 값이 0인 계수는 선형 좌표, 수렴하면 가장 좋은
+//       점에서 다시 시작)로 찾는다.
+//
+//       기록 파일 (여러 개를 줄 수 있고 한 파일에 샷이 여러 개 있어도 된다, '#' 뒤는 주석):
+//         shot                           새 샷 시작
+//         ball <번호> <x> <z>            친 순간의 공 위치 (테이블 좌표)
+//         strike <aim> <power> <side> <height>   게임의 샷 입력과 같은 값
+//         sample <t> <번호> <x> <z>      t초(실제 시간) 뒤의 공 위치
+//         pocket <t> <번호>              t초에 그 공이 들어감
+//         break / group solid|stripe     규칙 값 (오차에는 쓰지 않는다)
+//
+//       clock_rate와 time_scale, 마찰 계수는 서로 보상할 수 있으므로 clock_rate는 기본적으로
+//       고정한다 (-fit으로 바꿀 수 있다). 검증용으로 -synth는 주어진 계수로 만든 가짜 기록을 쓴다.
+//
+//       빌드 예)
+//         g++ -O2 -I.. -o physicsFit physicsFit.cpp ../physicsParams.cpp ../billiardPhysics.cpp
+//             ../contactSolver.cpp ../detMath.cpp ../eventBus.cpp ../islandStepper.cpp
+//             ../tableConfig.cpp ../tableField.cpp ../tableLayout.cpp ../threadPool.cpp -lpthread
+//       사용 예)
+//         physicsFit -out physics.params shots1.txt shots2.txt
+//         physicsFit -synth 200 -truth true.params -noise 0.005 synthetic.txt
+//       그 밖의 옵션: -start 계수 파일 (시작점, 기본은 지금 값), -fit key,key,... (조정할 계수),
+//                     -evals 최대 평가 수, -restarts n, -threads n (0: 모든 core), -table 파일
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "billiardPhysics.h"
+#include "contactSolver.h"
+#include "physicsParams.h"
+#include "tableLayout.h"
+#include "threadPool.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+    const float  POCKET_PENALTY = 1.0f;         // 들어간 것이 어긋난 기록 하나의 오차 (테이블 단위)
+    const int    MAX_SHOT_STEPS = 20000;
+    const double SIMPLEX_STEP = 0.2;            // 처음 simplex의 크기 (log 좌표는 약 20%, 선형 좌표는 범위의 20%)
+    const double SIMPLEX_TOLERANCE = 1e-4;      // 꼭짓점 사이 오차 차이가 이보다 작으면 수렴
+    const float  SYNTH_RATE = 30.0f;            // 가짜 기록의 초당 sample 수
+    const float  SYNTH_DURATION = 15.0f;        // 가짜 기록의 최대 길이 (실제 초)
+    // 앞부분만 맞춘 뒤 점점 길게 맞춘다 (실제 초). 긴 궤적은 충돌을 거치며 계수에 대해
+    // 울퉁불퉁해지므로 처음부터 전체를 맞추면 엉뚱한 극소에 머문다.
+    const float  HORIZONS[] = { 0.5f, 1.0f, 2.0f, 4.0f, 8.0f };
+    const float  FULL_HORIZON = 1e30f;
+
+    struct TrackSample {
+        float time;
+        int   ball;
+        float x, z;
+    };
+
+    struct RecordedShot {
+        TableState   start;
+        float        aim, power, tipSide, tipHeight;
+        int          firstSample, numSamples;
+        unsigned int pocketed;
+    };
+
+    struct Recording {
+        std::vector<RecordedShot> shots;
+        std::vector<TrackSample>  samples;
+    };
+
+    bool sampleEarlier(const TrackSample& a, const TrackSample& b)
+    {
+        return a.time < b.time;
+    }
+
+    void beginShot(Recording& recording)
+    {
+        RecordedShot shot;
+        memset(&shot, 0, sizeof(shot));
+        for (int i = 0; i < NUM_BALLS; i++) {
+            shot.start.balls[i].y = (float)M_RADIUS;
+            pocketBall(shot.start.balls[i]);
+        }
+        shot.start.rules.turn = true;
+        shot.start.rules.open = true;
+        shot.firstSample = (int)recording.samples.size();
+        recording.shots.push_back(shot);
+    }
+
+    // 마지막 샷을 닫는다. 큐볼이나 strike가 없으면 버린다.
+    bool endShot(Recording& recording, bool struck)
+    {
+        if (recording.shots.empty())
+            return true;
+        RecordedShot& shot = recording.shots.back();
+        shot.numSamples = (int)recording.samples.size() - shot.firstSample;
+        if (!struck || !shot.start.balls[CUE_BALL].active || shot.numSamples == 0) {
+            recording.samples.resize(shot.firstSample);
+            recording.shots.pop_back();
+            return false;
+        }
+        std::stable_sort(recording.samples.begin() + shot.firstSample, recording.samples.end(), sampleEarlier);
+        for (int i = 1; i < NUM_BALLS; i++) {
+            if (!shot.start.balls[i].active) continue;
+            if (isSolidBall(i)) shot.start.rules.solid_num++;
+            if (isStripeBall(i)) shot.start.rules.stripe_num++;
+        }
+        return true;
+    }
+
+    bool loadRecording(const char* path, Recording& recording, int* dropped)
+    {
+        FILE* file = fopen(path, "r");
+        if (file == NULL)
+            return false;
+
+        bool open = false, struck = false;
+        char line[256];
+        while (fgets(line, sizeof(line), file) != NULL) {
+            char* comment = strchr(line, '#');
+            if (comment != NULL) *comment = '\0';
+            char word[32];
+            if (sscanf(line, " %31s", word) != 1)
+                continue;
+
+            if (strcmp(word, "shot") == 0) {
+                if (open && !endShot(recording, struck)) (*dropped)++;
+                beginShot(recording);
+                open = true;
+                struck = false;
+                continue;
+            }
+            if (!open)
+                continue;
+
+            RecordedShot& shot = recording.shots.back();
+            int index;
+            float t, x, z;
+            if (sscanf(line, " ball %d %f %f", &index, &x, &z) == 3 && index >= 0 && index < NUM_BALLS) {
+                BallState& ball = shot.start.balls[index];
+                memset(&ball, 0, sizeof(ball));
+                ball.x = x;
+                ball.y = (float)M_RADIUS;
+                ball.z = z;
+                ball.active = true;
+            }
+            else if (sscanf(line, " strike %f %f %f %f", &shot.aim, &shot.power, &shot.tipSide, &shot.tipHeight) == 4) {
+                struck = true;
+            }
+            else if (sscanf(line, " sample %f %d %f %f", &t, &index, &x, &z) == 4 && index >= 0 && index < NUM_BALLS) {
+                TrackSample sample = { t, index, x, z };
+                recording.samples.push_back(sample);
+            }
+            else if (sscanf(line, " pocket %f %d", &t, &index) == 2 && index >= 0 && index < NUM_BALLS) {
+                shot.pocketed |= 1u << index;
+            }
+            else if (sscanf(line, " group %31s", word) == 1) {
+                shot.start.rules.open = false;
+                shot.start.rules.group = strcmp(word, "solid") == 0;
+            }
+            else if (strcmp(word, "break") == 0) {
+                shot.start.rules.break_shot = true;
+            }
+        }
+        fclose(file);
+        if (open && !endShot(recording, struck)) (*dropped)++;
+        return true;
+    }
+
+    // -------------------------------------------------------------------------
+    // 지금 계수로 샷을 다시 진행한다
+    // -------------------------------------------------------------------------
+
+    bool anyMoving(const BallState* balls)
+    {
+        for (int i = 0; i < NUM_BALLS; i++) {
+            if (isBallMoving(balls[i])) return true;
+        }
+        return false;
+    }
+
+    // times[] (실제 초, 오름차순)마다 공의 위치를 positions[k * NUM_BALLS + i]에,
+    // 그때 테이블에 있는지를 onTable에 채우고, 그 동안 들어간 공을 돌려준다.
+    // toRest면 마지막 시각 뒤에도 멈출 때까지 진행한다.
+    unsigned int playShot(const RecordedShot& shot, const float* times, int numTimes,
+        float2* positions, uint8_t* onTable, bool toRest)
+    {
+        const float clockRate = activePhysics().clockRate;
+        BallState balls[NUM_BALLS], before[NUM_BALLS];
+        memcpy(balls, shot.start.balls, sizeof(balls));
+        strikeCueBall(balls[CUE_BALL], shot.aim, shot.power, shot.tipSide, shot.tipHeight);
+        memcpy(before, balls, sizeof(balls));
+
+        CContactSolver solver;
+        unsigned int pocketed = 0;
+        double simTime = 0.0;
+        bool moving = true;
+        int steps = 0;
+        for (int k = 0; k <= numTimes; k++) {
+            // 마지막 바퀴는 멈출 때까지 진행해 들어간 공을 모두 센다.
+            if (k == numTimes && !toRest)
+                break;
+            double target = k < numTimes ? (double)times[k] * clockRate : 1e30;
+            while (moving && simTime < target && steps < MAX_SHOT_STEPS) {
+                memcpy(before, balls, sizeof(balls));
+                StepEvents events;
+                stepTable(balls, NUM_BALLS, SIM_FIXED_STEP, &events, &solver);
+                pocketed |= events.pocketed;
+                simTime += SIM_FIXED_STEP;
+                steps++;
+                moving = anyMoving(balls);
+            }
+            if (k == numTimes)
+                break;
+
+            // 프레임 안에서는 직선으로 보간한다 (멈춘 뒤에는 마지막 위치).
+            float f = moving ? (float)(1.0 - (simTime - target) / SIM_FIXED_STEP) : 1.0f;
+            if (f < 0.0f) f = 0.0f;
+            for (int i = 0; i < NUM_BALLS; i++) {
+                bool active = balls[i].active;
+                onTable[k * NUM_BALLS + i] = active ? 1 : 0;
+                positions[k * NUM_BALLS + i] = active ?
+                    ballPosition(before[i]) + (ballPosition(balls[i]) - ballPosition(before[i])) * f :
+                    make_float2(0.0f, 0.0f);
+            }
+        }
+        return pocketed;
+    }
+
+    struct ShotError {
+        double sumSq;
+        int    count;
+    };
+
+    // horizon(실제 초)까지의 기록만 센다. 들어간 공 집합은 전체를 볼 때만 비교한다.
+    ShotError shotError(const RecordedShot& shot, const TrackSample* samples, float horizon)
+    {
+        ShotError error = { 0.0, 0 };
+        int numSamples = 0;
+        while (numSamples < shot.numSamples && samples[numSamples].time <= horizon)
+            numSamples++;
+        if (numSamples == 0)
+            return error;
+
+        std::vector<float> times(numSamples);
+        std::vector<float2> positions(numSamples * NUM_BALLS);
+        std::vector<uint8_t> onTable(numSamples * NUM_BALLS);
+        for (int s = 0; s < numSamples; s++)
+            times[s] = samples[s].time;
+        const bool full = horizon >= FULL_HORIZON;
+        unsigned int pocketed = playShot(shot, &times[0], numSamples, &positions[0], &onTable[0], full);
+
+        for (int s = 0; s < numSamples; s++) {
+            const TrackSample& sample = samples[s];
+            int slot = s * NUM_BALLS + sample.ball;
+            float e = onTable[slot] ?
+                length(positions[slot] - make_float2(sample.x, sample.z)) : POCKET_PENALTY;
+            error.sumSq += (double)e * e;
+            error.count++;
+        }
+        for (unsigned int diff = full ? pocketed ^ shot.pocketed : 0; diff != 0; diff &= diff - 1) {
+            error.sumSq += (double)POCKET_PENALTY * POCKET_PENALTY;
+            error.count++;
+        }
+        return error;
+    }
+
+    struct ErrorBody {
+        const Recording* recording;
+        float            horizon;
+        ShotError*       errors;
+
+        void operator()(int begin, int end) const
+        {
+            for (int i = begin; i < end; i++) {
+                const RecordedShot& shot = recording->shots[i];
+                errors[i] = shotError(shot, &recording->samples[shot.firstSample], horizon);
+            }
+        }
+    };
+
+    // 지금 계수의 RMS 오차. 샷 단위로 나누어 돌리고 샷 순서로 더한다.
+    double fitError(const Recording& recording, float horizon, CThreadPool* pool, std::vector<ShotError>& errors)
+    {
+        const int count = (int)recording.shots.size();
+        errors.resize(count);
+        ErrorBody body = { &recording, horizon, &errors[0] };
+        if (pool != NULL)
+            pool->parallelFor(count, 1, body);
+        else
+            body(0, count);
+
+        double sumSq = 0.0;
+        long long samples = 0;
+        for (int i = 0; i < count; i++) {
+            sumSq += errors[i].sumSq;
+            samples += errors[i].count;
+        }
+        return samples > 0 ? sqrt(sumSq / samples) : 0.0;
+    }
+
+    // -------------------------------------------------------------------------
+    // Nelder-Mead
+    // -------------------------------------------------------------------------
+
+    struct FitSpace {
+        PhysicsParams start;
+        int           index[PHYSICS_PARAM_COUNT];   // 조정하는 계수
+        bool          linear[PHYSICS_PARAM_COUNT];  // 시작 값이 0이라 선형 좌표로 찾음
+        int           dims;
+    };
+
+    // x_k = ln(value / start) 이다. 시작 값이 0인 계수는 어떤 x_k에서도 0이 되므로
+    // x_k = (value - start) / (max - min) 으로 찾는다. 범위를 넘으면 경계에 붙인다.
+    PhysicsParams paramsAt(const FitSpace& space, const double* x)
+    {
+        PhysicsParams params = space.start;
+        for (int k = 0; k < space.dims; k++) {
+            const PhysicsParamInfo& info = physicsParamInfo(space.index[k]);
+            float start = space.start.*info.member;
+            float value = space.linear[k] ? (float)(start + x[k] * (info.maxValue - info.minValue))
+                : (float)(start * exp(x[k]));
+            if (value < info.minValue) value = info.minValue;
+            if (value > info.maxValue) value = info.maxValue;
+            params.*info.member = value;
+        }
+        return params;
+    }
+
+    struct Evaluator {
+        const FitSpace*  space;
+        const Recording* recording;
+        CThreadPool*     pool;
+        float            horizon;
+        std::vector<ShotError> errors;
+        int              evaluations;
+
+        double operator()(const double* x)
+        {
+            setActivePhysics(paramsAt(*space, x));
+            evaluations++;
+            return fitError(*recording, horizon, pool, errors);
+        }
+    };
+
+    // best에서 시작한 simplex가 줄어들 때까지 반복한다. best를 고쳐 쓰고 그 오차를 돌려준다.
+    double nelderMead(Evaluator& evaluate, double* best, double bestValue, int maxEvaluations)
+    {
+        const int n = evaluate.space->dims;
+        double points[PHYSICS_PARAM_COUNT + 1][PHYSICS_PARAM_COUNT];
+        double values[PHYSICS_PARAM_COUNT + 1];
+        for (int p = 0; p <= n; p++) {
+            memcpy(points[p], best, sizeof(double) * n);
+            if (p > 0) points[p][p - 1] += SIMPLEX_STEP;
+            values[p] = p == 0 ? bestValue : evaluate(points[p]);
+        }
+
+        while (evaluate.evaluations < maxEvaluations) {
+            // 오차 순으로 정렬 (꼭짓점이 적으므로 삽입 정렬)
+            for (int i = 1; i <= n; i++) {
+                for (int j = i; j > 0 && values[j] < values[j - 1]; j--) {
+                    std::swap(values[j], values[j - 1]);
+                    for (int k = 0; k < n; k++) std::swap(points[j][k], points[j - 1][k]);
+                }
+            }
+            if (values[n] - values[0] < SIMPLEX_TOLERANCE * (values[0] + 1e-9))
+                break;
+
+            double centroid[PHYSICS_PARAM_COUNT];
+            for (int k = 0; k < n; k++) {
+                centroid[k] = 0.0;
+                for (int p = 0; p < n; p++) centroid[k] += points[p][k];
+                centroid[k] /= n;
+            }
+            double reflect[PHYSICS_PARAM_COUNT], trial[PHYSICS_PARAM_COUNT];
+            for (int k = 0; k < n; k++)
+                reflect[k] = centroid[k] + (centroid[k] - points[n][k]);
+            double reflectValue = evaluate(reflect);
+
+            if (reflectValue < values[0]) {
+                for (int k = 0; k < n; k++)
+                    trial[k] = centroid[k] + 2.0 * (centroid[k] - points[n][k]);
+                double expandValue = evaluate(trial);
+                bool expand = expandValue < reflectValue;
+                memcpy(points[n], expand ? trial : reflect, sizeof(double) * n);
+                values[n] = expand ? expandValue : reflectValue;
+                continue;
+            }
+            if (reflectValue < values[n - 1]) {
+                memcpy(points[n], reflect, sizeof(double) * n);
+                values[n] = reflectValue;
+                continue;
+            }
+
+            // 바깥(반사 쪽) 또는 안쪽 수축
+            bool outside = reflectValue < values[n];
+            for (int k = 0; k < n; k++)
+                trial[k] = outside ? centroid[k] + 0.5 * (reflect[k] - centroid[k]) :
+                    centroid[k] + 0.5 * (points[n][k] - centroid[k]);
+            double contractValue = evaluate(trial);
+            if (contractValue < (outside ? reflectValue : values[n])) {
+                memcpy(points[n], trial, sizeof(double) * n);
+                values[n] = contractValue;
+                continue;
+            }
+
+            // 가장 좋은 점으로 전체를 줄인다.
+            for (int p = 1; p <= n; p++) {
+                for (int k = 0; k < n; k++)
+                    points[p][k] = points[0][k] + 0.5 * (points[p][k] - points[0][k]);
+                values[p] = evaluate(points[p]);
+            }
+        }
+
+        int bestIndex = 0;
+        for (int p = 1; p <= n; p++) {
+            if (values[p] < values[bestIndex]) bestIndex = p;
+        }
+        memcpy(best, points[bestIndex], sizeof(double) * n);
+        return values[bestIndex];
+    }
+
+    // -------------------------------------------------------------------------
+    // 검증용 가짜 기록
+    // -------------------------------------------------------------------------
+
+    uint64_t nextRandom(uint64_t& state)
+    {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    float uniform(uint64_t& state, float lo, float hi)
+    {
+        return lo + (hi - lo) * (float)((nextRandom(state) >> 40) * (1.0 / 16777216.0));
+    }
+
+    float gaussian(uint64_t& state)
+    {
+        float u = uniform(state, 1e-7f, 1.0f), v = uniform(state, 0.0f, 6.28318531f);
+        return sqrtf(-2.0f * logf(u)) * cosf(v);
+    }
+
+    bool placeable(const TableState& state, float x, float z)
+    {
+        const TableLayout& table = activeTable();
+        for (int p = 0; p < table.numPockets; p++) {
+            const PocketCircle& pocket = table.pockets[p];
+            if (length(make_float2(x - pocket.x, z - pocket.z)) < pocket.radius + (float)M_RADIUS)
+                return false;
+        }
+        const float limit = (float)(2 * M_RADIUS) + 0.02f;
+        for (int i = 0; i < NUM_BALLS; i++) {
+            if (!state.balls[i].active) continue;
+            if (lengthSq(ballPosition(state.balls[i]) - make_float2(x, z)) < limit * limit)
+                return false;
+        }
+        return true;
+    }
+
+    // 큐볼과 목적구 1~3개를 놓고 지금 계수로 친 궤적을 noise를 더해 기록한다.
+    bool writeSynthetic(const char* path, int count, float noise, uint64_t seed)
+    {
+        FILE* file = fopen(path, "w");
+        if (file == NULL)
+            return false;
+        const TableLayout& table = activeTable();
+        const float r = (float)M_RADIUS;
+        uint64_t random = seed;
+
+        const int numTimes = (int)(SYNTH_DURATION * SYNTH_RATE);
+        std::vector<float> times(numTimes);
+        for (int k = 0; k < numTimes; k++)
+            times[k] = (k + 1) / SYNTH_RATE;
+        std::vector<float2> positions(numTimes * NUM_BALLS);
+        std::vector<uint8_t> onTable(numTimes * NUM_BALLS);
+
+        for (int n = 0; n < count; n++) {
+            RecordedShot shot;
+            memset(&shot, 0, sizeof(shot));
+            for (int i = 0; i < NUM_BALLS; i++) {
+                shot.start.balls[i].y = r;
+                pocketBall(shot.start.balls[i]);
+            }
+            int numBalls = 2 + (int)(nextRandom(random) % 3);
+            for (int b = 0; b < numBalls; b++) {
+                int index = b == 0 ? CUE_BALL : 1 + (int)(nextRandom(random) % (NUM_BALLS - 1));
+                for (int attempt = 0; attempt < 32 && !shot.start.balls[index].active; attempt++) {
+                    float x = uniform(random, table.minX + r, table.maxX - r);
+                    float z = uniform(random, table.minZ + r, table.maxZ - r);
+                    if (!placeable(shot.start, x, z)) continue;
+                    BallState& ball = shot.start.balls[index];
+                    memset(&ball, 0, sizeof(ball));
+                    ball.x = x;
+                    ball.y = r;
+                    ball.z = z;
+                    ball.active = true;
+                }
+            }
+            if (!shot.start.balls[CUE_BALL].active)
+                continue;
+
+            // 절반은 첫 번째 목적구를 겨냥한다 (공끼리의 충돌도 기록되도록).
+            int target = -1;
+            for (int i = 1; i < NUM_BALLS && target < 0; i++) {
+                if (shot.start.balls[i].active) target = i;
+            }
+            const BallState& cue = shot.start.balls[CUE_BALL];
+            shot.aim = target >= 0 && nextRandom(random) % 2 == 0 ?
+                atan2f(shot.start.balls[target].z - cue.z, shot.start.balls[target].x - cue.x) + uniform(random, -0.1f, 0.1f) :
+                uniform(random, -3.14159265f, 3.14159265f);
+            shot.power = uniform(random, 0.5f, 6.0f);
+            shot.tipSide = uniform(random, -0.3f, 0.3f);
+            shot.tipHeight = uniform(random, -0.3f, 0.4f);
+
+            playShot(shot, &times[0], numTimes, &positions[0], &onTable[0], false);
+
+            fprintf(file, "shot\n");
+            for (int i = 0; i < NUM_BALLS; i++) {
+                if (shot.start.balls[i].active) fprintf(file, "ball %d %.5f %.5f\n", i, shot.start.balls[i].x, shot.start.balls[i].z);
+            }
+            fprintf(file, "strike %.6f %.5f %.4f %.4f\n", shot.aim, shot.power, shot.tipSide, shot.tipHeight);
+            // 움직이는 동안만 기록한다 (추적기가 멈춘 공은 다시 보내지 않는다고 본다).
+            for (int i = 0; i < NUM_BALLS; i++) {
+                if (!shot.start.balls[i].active) continue;
+                float2 last = ballPosition(shot.start.balls[i]);
+                for (int k = 0; k < numTimes; k++) {
+                    int slot = k * NUM_BALLS + i;
+                    if (!onTable[slot]) {
+                        fprintf(file, "pocket %.4f %d\n", times[k], i);
+                        break;
+                    }
+                    if (positions[slot].x == last.x && positions[slot].y == last.y) continue;
+                    last = positions[slot];
+                    fprintf(file, "sample %.4f %d %.5f %.5f\n", times[k], i,
+                        last.x + noise * gaussian(random), last.y + noise * gaussian(random));
+                }
+            }
+        }
+        return fclose(file) == 0;
+    }
+
+    void printParams(const char* title, const PhysicsParams& params, const PhysicsParams* before)
+    {
+        printf("%s\n", title);
+        for (int i = 0; i < PHYSICS_PARAM_COUNT; i++) {
+            const PhysicsParamInfo& info = physicsParamInfo(i);
+            if (before != NULL)
+                printf("  %-20s %10.5g -> %10.5g\n", info.key, before->*info.member, params.*info.member);
+            else
+                printf("  %-20s %10.5g\n", info.key, params.*info.member);
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    int threads = 0, maxEvaluations = 3000, restarts = 2, synthCount = 0;
+    float noise = 0.005f;
+    uint64_t seed = 1;
+    const char* out = PHYSICS_PARAMS_FILE;
+    const char* startPath = NULL;
+    const char* truthPath = NULL;
+    const char* tablePath = NULL;
+    const char* fitList = NULL;
+    std::vector<const char*> inputs;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-out") == 0 && i + 1 < argc) out = argv[++i];
+        else if (strcmp(argv[i], "-start") == 0 && i + 1 < argc) startPath = argv[++i];
+        else if (strcmp(argv[i], "-fit") == 0 && i + 1 < argc) fitList = argv[++i];
+        else if (strcmp(argv[i], "-evals") == 0 && i + 1 < argc) maxEvaluations = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-restarts") == 0 && i + 1 < argc) restarts = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-threads") == 0 && i + 1 < argc) threads = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-table") == 0 && i + 1 < argc) tablePath = argv[++i];
+        else if (strcmp(argv[i], "-synth") == 0 && i + 1 < argc) synthCount = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-truth") == 0 && i + 1 < argc) truthPath = argv[++i];
+        else if (strcmp(argv[i], "-noise") == 0 && i + 1 < argc) noise = (float)atof(argv[++i]);
+        else if (strcmp(argv[i], "-seed") == 0 && i + 1 < argc) seed = strtoull(argv[++i], NULL, 10);
+        else inputs.push_back(argv[i]);
+    }
+
+    char error[256];
+    if (tablePath != NULL) {
+        TableLayout layout;
+        if (!loadTableLayout(tablePath, &layout, error, sizeof(error))) {
+            fprintf(stderr, "%s\n", error);
+            return 1;
+        }
+        setActiveTable(layout);
+    }
+
+    if (synthCount > 0) {
+        PhysicsParams truth = defaultPhysicsParams();
+        if (truthPath != NULL && !loadPhysicsParams(truthPath, &truth, error, sizeof(error))) {
+            fprintf(stderr, "%s\n", error);
+            return 1;
+        }
+        if (inputs.empty()) {
+            fprintf(stderr, "no output file for -synth\n");
+            return 1;
+        }
+        setActivePhysics(truth);
+        if (!writeSynthetic(inputs[0], synthCount, noise, seed)) {
+            fprintf(stderr, "cannot write %s\n", inputs[0]);
+            return 1;
+        }
+        printf("%d synthetic shots written to %s\n", synthCount, inputs[0]);
+        return 0;
+    }
+
+    Recording recording;
+    int dropped = 0;
+    for (size_t i = 0; i < inputs.size(); i++) {
+        if (!loadRecording(inputs[i], recording, &dropped)) {
+            fprintf(stderr, "cannot read %s\n", inputs[i]);
+            return 1;
+        }
+    }
+    if (recording.shots.empty()) {
+        fprintf(stderr, "no recorded shots (need shot / ball 0 / strike / sample lines)\n");
+        return 1;
+    }
+
+    FitSpace space;
+    space.start = defaultPhysicsParams();
+    if (startPath != NULL && !loadPhysicsParams(startPath, &space.start, error, sizeof(error))) {
+        fprintf(stderr, "%s\n", error);
+        return 1;
+    }
+    space.dims = 0;
+    for (int i = 0; i < PHYSICS_PARAM_COUNT; i++) {
+        const PhysicsParamInfo& info = physicsParamInfo(i);
+        bool fit = fitList != NULL ? strstr(fitList, info.key) != NULL : info.member != &PhysicsParams::clockRate;
+        if (!fit) continue;
+        space.linear[space.dims] = !(space.start.*info.member > 0.0f);
+        if (space.linear[space.dims])
+            printf("%s starts at %g; searching it linearly in [%g, %g]\n", info.key, space.start.*info.member,
+                info.minValue, info.maxValue);
+        space.index[space.dims++] = i;
+    }
+    if (space.dims == 0) {
+        fprintf(stderr, "nothing to fit\n");
+        return 1;
+    }
+
+    CThreadPool pool(threads > 0 ? threads - 1 : 0);
+    Evaluator evaluate = { &space, &recording, threads == 1 ? NULL : &pool, FULL_HORIZON, std::vector<ShotError>(), 0 };
+
+    printf("%d shots, %d samples (%d shots without cue ball / strike / samples dropped), %d thread(s)\n",
+        (int)recording.shots.size(), (int)recording.samples.size(), dropped, threads == 1 ? 1 : pool.size());
+
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    double x[PHYSICS_PARAM_COUNT] = { 0.0 };
+    double startError = evaluate(x);
+
+    // 짧은 horizon부터 차례로 맞추고, 전체 기록에서는 수렴한 점에서 몇 번 다시 시작한다.
+    const int numHorizons = (int)(sizeof(HORIZONS) / sizeof(HORIZONS[0]));
+    for (int h = 0; h <= numHorizons + restarts && evaluate.evaluations < maxEvaluations; h++) {
+        evaluate.horizon = h < numHorizons ? HORIZONS[h] : FULL_HORIZON;
+        double before = evaluate(x);
+        double value = nelderMead(evaluate, x, before, maxEvaluations);
+        if (h < numHorizons)
+            printf("  first %4.1f s: rms %.5f -> %.5f (%d evaluations)\n", HORIZONS[h], before, value, evaluate.evaluations);
+        else
+            printf("  whole shots: rms %.5f -> %.5f (%d evaluations)\n", before, value, evaluate.evaluations);
+        if (h > numHorizons && before - value < SIMPLEX_TOLERANCE * before)
+            break;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    PhysicsParams fitted = paramsAt(space, x);
+    setActivePhysics(fitted);
+    double fittedError = fitError(recording, FULL_HORIZON, evaluate.pool, evaluate.errors);
+
+    printf("fit error (rms position, table units): %.5f -> %.5f in %.1f s, %d evaluations (%.0f shots/s)\n",
+        startError, fittedError, seconds, evaluate.evaluations,
+        evaluate.evaluations * (double)recording.shots.size() / seconds);
+    printParams("parameters:", fitted, &space.start);
+
+    // 가장 안 맞는 샷 몇 개 (기록이 잘못되었을 수 있다)
+    std::vector<std::pair<double, int> > worst;
+    for (size_t i = 0; i < evaluate.errors.size(); i++) {
+        const ShotError& e = evaluate.errors[i];
+        worst.push_back(std::make_pair(e.count > 0 ? sqrt(e.sumSq / e.count) : 0.0, (int)i));
+    }
+    std::sort(worst.begin(), worst.end());
+    printf("worst shots:");
+    for (int i = (int)worst.size() - 1; i >= 0 && i >= (int)worst.size() - 5; i--)
+        printf(" #%d %.4f", worst[i].second, worst[i].first);
+    printf("\n");
+
+    char comment[128];
+    snprintf(comment, sizeof(comment), "physicsFit: rms %.5f over %d samples from %d shots",
+        fittedError, (int)recording.samples.size(), (int)recording.shots.size());
+    if (!savePhysicsParams(out, fitted, comment)) {
+        fprintf(stderr, "cannot write %s\n", out);
+        return 1;
+    }
+    printf("wrote %s\n", out);
+    return 0;
+}
@@ -0,0 +1,327 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: renderReplay.cpp
+//
+// Desc: 샷 목록을 물리 코어로 다시 진행하면서 software rasterizer로 frame을 그려
+//       PPM 파일이나 raw RGB 영상 stream으로 내보낸다 (GPU 없는 서버에서 highlight 영상 생성).
+//
+//       샷 목록은 한 줄에 "aim power [tipSide tipHeight]" (라디안, 큐볼 속력, 반지름 비율).
+//       '#' 뒤는 주석이다. 공이 모두 멈추면 다음 샷을 친다. 큐볼이 들어갔으면 cue 자리에 다시 놓는다.
+//       목록이 없으면 rack 쪽으로 break 한 번을 친다.
+//
+//       texture는 -textures 폴더의 Ball<n>.ppm (P6)을 읽는다. 게임의 image\Ball<n>.jpg는
+//       미리 바꿔 둔다 (예: ffmpeg -i Ball1.jpg Ball1.ppm). 없는 공은 번호 색으로 만든다.
+//
+//       빌드 예)
+//         g++ -O2 -I.. -o renderReplay renderReplay.cpp ../softRenderer.cpp ../ballTransforms.cpp
+//             ../billiardPhysics.cpp ../contactSolver.cpp ../detMath.cpp ../eventBus.cpp
+//             ../islandStepper.cpp ../physicsParams.cpp ../tableField.cpp ../tableLayout.cpp
+//             ../tableConfig.cpp ../threadPool.cpp -lpthread
+//       사용 예)
+//         renderReplay -size 1920x1080 -fps 60 -out frames/f shots.txt
+//         renderReplay -raw shots.txt | ffmpeg -f rawvideo -pix_fmt rgb24 -s 1920x1080 -r 60 -i - clip.mp4
+//       그 밖의 옵션: -threads n (0: 모든 core), -table 파일, -textures 폴더
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "billiardPhysics.h"
+#include "ballTransforms.h"
+#include "contactSolver.h"
+#include "softRenderer.h"
+#include "tableLayout.h"
+#include "threadPool.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+namespace
+{
+    // d3d::EnterMsgLoop가 ms 단위 시간에 곱하는 값: 실제 1초가 시뮬레이션 0.7
+    const float SIM_PER_SECOND = 0.7f;
+    // 마지막 샷이 멈춘 뒤 더 그리는 시간 (초)
+    const float TAIL_SECONDS = 1.0f;
+    const int   MAX_SHOTS = 256;
+    const int   TEXTURE_WIDTH = 256, TEXTURE_HEIGHT = 128;
+
+    struct Shot {
+        float aim, power, tipSide, tipHeight;
+    };
+
+    // 8-ball 공 색 (1 ~ 7, 9 ~ 15는 같은 색의 줄무늬)
+    const uint32_t BALL_COLORS[8] = {
+        0xf0f0e8, 0xf2c200, 0x1c3fa8, 0xc8201e, 0x5a2a8c, 0xf07818, 0x187a3a, 0x7a1a1a
+    };
+
+    // 파일이 없는 공의 texture: 번호 색 (줄무늬 공은 가운데 띠), 양 끝에 흰 원
+    void makeBallTexture(int ball, std::vector<uint32_t>& pixels, SoftTexture& texture)
+    {
+        pixels.resize(TEXTURE_WIDTH * TEXTURE_HEIGHT);
+        uint32_t color = ball == 8 ? 0x101010 : BALL_COLORS[ball % 8];
+        bool stripe = ball > 8;
+        for (int y = 0; y < TEXTURE_HEIGHT; y++) {
+            float v = (y + 0.5f) / TEXTURE_HEIGHT;
+            for (int x = 0; x < TEXTURE_WIDTH; x++) {
+                float u = (x + 0.5f) / TEXTURE_WIDTH;
+                uint32_t c = color;
+                if (stripe && (v < 0.3f || v > 0.7f)) c = 0xf0f0e8;
+                // 번호 원 자리 (u = 0.25, 0.75의 적도)
+                float du = fabsf(fmodf(u, 0.5f) - 0.25f) * 2.0f, dv = v - 0.5f;
+                if (ball != 0 && du * du + dv * dv < 0.012f) c = 0xf0f0e8;
+                pixels[y * TEXTURE_WIDTH + x] = c;
+            }
+        }
+        texture.width = TEXTURE_WIDTH;
+        texture.height = TEXTURE_HEIGHT;
+        texture.pixels = &pixels[0];
+    }
+
+    // 주석이 없는 단순한 P6 PPM
+    bool loadPPM(const char* path, std::vector<uint32_t>& pixels, SoftTexture& texture)
+    {
+        FILE* file = fopen(path, "rb");
+        if (file == NULL)
+            return false;
+        int width, height, maxValue;
+        bool ok = fscanf(file, "P6 %d %d %d", &width, &height, &maxValue) == 3 && maxValue == 255 &&
+            width > 0 && height > 0 && fgetc(file) != EOF;
+        if (ok) {
+            std::vector<uint8_t> rgb((size_t)width * height * 3);
+            ok = fread(&rgb[0], 1, rgb.size(), file) == rgb.size();
+            if (ok) {
+                pixels.resize((size_t)width * height);
+                for (size_t i = 0; i < pixels.size(); i++)
+                    pixels[i] = ((uint32_t)rgb[i * 3] << 16) | ((uint32_t)rgb[i * 3 + 1] << 8) | rgb[i * 3 + 2];
+                texture.width = width;
+                texture.height = height;
+                texture.pixels = &pixels[0];
+            }
+        }
+        fclose(file);
+        return ok;
+    }
+
+    int loadShots(const char* path, Shot* shots, int capacity)
+    {
+        FILE* file = fopen(path, "r");
+        if (file == NULL)
+            return -1;
+        int count = 0;
+        char line[256];
+        while (count < capacity && fgets(line, sizeof(line), file) != NULL) {
+            char* comment = strchr(line, '#');
+            if (comment != NULL) *comment = '\0';
+            Shot shot = { 0, 0, 0, 0 };
+            if (sscanf(line, "%f %f %f %f", &shot.aim, &shot.power, &shot.tipSide, &shot.tipHeight) >= 2)
+                shots[count++] = shot;
+        }
+        fclose(file);
+        return count;
+    }
+
+    // Setup과 같은 배치 (섞는 자리는 번호 순서로 채운다)
+    void rackBalls(BallState* balls, CBallTransforms& transforms)
+    {
+        const TableLayout& table = activeTable();
+        int next = 0;
+        for (int i = 0; i < NUM_BALLS; i++) {
+            BallState& ball = balls[i];
+            memset(&ball, 0, sizeof(ball));
+            ball.y = (float)M_RADIUS;
+            transforms.resetOrientation(i);
+            transforms.rotateLocal(i, quatFromAxisAngle(make_float3(0, 0, 1), 3.14159265f * 0.5f));
+            if (i > table.rackCount) {
+                pocketBall(ball);
+                continue;
+            }
+            ball.active = true;
+            if (i == CUE_BALL) {
+                ball.x = table.cueX;
+                ball.z = table.cueZ;
+                continue;
+            }
+            int pos = -1;
+            for (int p = 0; p < table.rackCount; p++) {
+                if (table.rackBall[p] == i) pos = p;
+            }
+            while (pos < 0 && next < table.rackCount) {
+                if (table.rackBall[next] == 0) pos = next;
+                next++;
+            }
+            if (pos < 0) {
+                pocketBall(ball);
+                continue;
+            }
+            ball.x = table.rackX[pos];
+            ball.z = table.rackZ[pos];
+        }
+    }
+
+    bool anyMoving(const BallState* balls)
+    {
+        for (int i = 0; i < NUM_BALLS; i++) {
+            if (isBallMoving(balls[i])) return true;
+        }
+        return false;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    int width = 1920, height = 1080, fps = 60, threads = 0;
+    const char* out = "frame";
+    const char* textureDir = NULL;
+    const char* tablePath = NULL;
+    const char* shotPath = NULL;
+    bool raw = false;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-size") == 0 && i + 1 < argc) sscanf(argv[++i], "%dx%d", &width, &height);
+        else if (strcmp(argv[i], "-fps") == 0 && i + 1 < argc) fps = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-threads") == 0 && i + 1 < argc) threads = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-out") == 0 && i + 1 < argc) out = argv[++i];
+        else if (strcmp(argv[i], "-textures") == 0 && i + 1 < argc) textureDir = argv[++i];
+        else if (strcmp(argv[i], "-table") == 0 && i + 1 < argc) tablePath = argv[++i];
+        else if (strcmp(argv[i], "-raw") == 0) raw = true;
+        else shotPath = argv[i];
+    }
+    if (fps <= 0) fps = 60;
+
+    if (tablePath != NULL) {
+        TableLayout layout;
+        char error[256];
+        if (!loadTableLayout(tablePath, &layout, error, sizeof(error))) {
+            fprintf(stderr, "%s: %s\n", tablePath, error);
+            return 1;
+        }
+        setActiveTable(layout);
+    }
+
+    BallState balls[NUM_BALLS];
+    CBallTransforms transforms;
+    rackBalls(balls, transforms);
+
+    Shot shots[MAX_SHOTS];
+    int numShots = 0;
+    if (shotPath != NULL) {
+        numShots = loadShots(shotPath, shots, MAX_SHOTS);
+        if (numShots < 0) {
+            fprintf(stderr, "cannot read %s\n", shotPath);
+            return 1;
+        }
+    }
+    if (numShots == 0) {
+        const TableLayout& table = activeTable();
+        float dx = table.rackCount > 0 ? table.rackX[0] - table.cueX : 1.0f;
+        float dz = table.rackCount > 0 ? table.rackZ[0] - table.cueZ : 0.0f;
+        Shot breakShot = { atan2f(dz, dx), 8.0f, 0.0f, 0.0f };
+        shots[numShots++] = breakShot;
+    }
+
+    std::vector<uint32_t> texturePixels[NUM_BALLS];
+    SoftTexture textures[NUM_BALLS];
+    const SoftTexture* texturePointers[NUM_BALLS];
+    for (int i = 0; i < NUM_BALLS; i++) {
+        char path[512];
+        bool loaded = false;
+        if (textureDir != NULL) {
+            snprintf(path, sizeof(path), "%s/Ball%d.ppm", textureDir, i);
+            loaded = loadPPM(path, texturePixels[i], textures[i]);
+        }
+        if (!loaded)
+            makeBallTexture(i, texturePixels[i], textures[i]);
+        texturePointers[i] = &textures[i];
+    }
+
+    CThreadPool pool(threads > 0 ? threads - 1 : 0);
+    CSoftRenderer renderer(&pool);
+    if (!renderer.resize(width, height)) {
+        fprintf(stderr, "cannot allocate %dx%d frame\n", width, height);
+        return 1;
+    }
+#ifdef _WIN32
+    if (raw) _setmode(_fileno(stdout), _O_BINARY);
+#endif
+
+    // Setup의 카메라와 빛
+    SoftScene scene;
+    scene.balls = balls;
+    scene.numBalls = NUM_BALLS;
+    scene.textures = texturePointers;
+    scene.eye = make_float3(0.0f, 5.0f, -8.0f);
+    scene.target = make_float3(0.0f, 0.0f, 0.0f);
+    scene.up = make_float3(0.0f, 2.0f, 0.0f);
+    scene.fovY = 3.14159265f / 4;
+    scene.light = make_float3(0.0f, 3.0f, 0.0f);
+    quat orientations[NUM_BALLS];
+    scene.orientations = orientations;
+
+    CContactSolver solver;
+    const float frameSim = SIM_PER_SECOND / fps;
+    const int tailFrames = (int)(TAIL_SECONDS * fps);
+    int nextShot = 0, idle = 0, frame = 0;
+    double renderSeconds = 0.0;
+    const TableLayout& table = activeTable();
+
+    while (idle <= tailFrames) {
+        if (!anyMoving(balls)) {
+            if (nextShot < numShots) {
+                if (!balls[CUE_BALL].active) {
+                    memset(&balls[CUE_BALL], 0, sizeof(BallState));
+                    balls[CUE_BALL].x = table.cueX;
+                    balls[CUE_BALL].y = (float)M_RADIUS;
+                    balls[CUE_BALL].z = table.cueZ;
+                    balls[CUE_BALL].active = true;
+                }
+                const Shot& shot = shots[nextShot++];
+                strikeCueBall(balls[CUE_BALL], shot.aim, shot.power, shot.tipSide, shot.tipHeight);
+                solver.reset();
+                idle = 0;
+            }
+            else {
+                idle++;
+            }
+        }
+
+        // 게임 frame처럼 진행하고 평균 각속도로 굴린다 (CSphere::roll).
+        BallState before[NUM_BALLS];
+        memcpy(before, balls, sizeof(before));
+        for (float left = frameSim; left > 0.0f; left -= SIM_FIXED_STEP)
+            stepTable(balls, NUM_BALLS, left < SIM_FIXED_STEP ? left : SIM_FIXED_STEP, NULL, &solver);
+        for (int i = 0; i < NUM_BALLS; i++) {
+            if (!balls[i].active) continue;
+            float3 omega = (ballSpin(before[i]) + ballSpin(balls[i])) * 0.5f;
+            transforms.roll(i, omega, frameSim * activePhysics().timeScale);
+            orientations[i] = transforms.orientation(i);
+        }
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        renderer.render(scene);
+        renderSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        if (raw) {
+            if (fwrite(renderer.pixels(), (size_t)width * height * 3, 1, stdout) != 1)
+                return 1;
+        }
+        else {
+            char path[512];
+            snprintf(path, sizeof(path), "%s%05d.ppm", out, frame);
+            if (!writePPM(path, renderer.pixels(), width, height)) {
+                fprintf(stderr, "cannot write %s\n", path);
+                return 1;
+            }
+        }
+        frame++;
+    }
+
+    double perFrame = renderSeconds / frame;
+    fprintf(stderr, "%d frames (%.1f s of play) at %dx%d: %.2f ms per frame on %d thread(s), %.1fx real time\n",
+        frame, (double)frame / fps, width, height, perFrame * 1000.0, pool.size(), 1.0 / (perFrame * fps));
+    return 0;
+}
@@ -0,0 +1,67 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: stateReader.cpp
+//
+// Desc: 게임이 공유 메모리로 내보내는 테이블 상태를 읽어 출력하는 창 없는 예제.
+//       게임을 띄운 뒤 실행하면 0.1초마다 최신 frame의 차례, 그룹, 남은 공,
+//       움직이는 공 수를 한 줄씩 쓴다. 읽기는 공유 메모리를 바로 보므로
+//       게임 쪽에서는 reader가 있는지도 알지 못한다.
+//
+//       빌드 예)
+//         cl /EHsc /I.. stateReader.cpp ..\stateShare.cpp
+//         g++ -O2 -I.. -o stateReader stateReader.cpp ../stateShare.cpp -lrt
+//       사용: stateReader [공유 메모리 이름]
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "stateShare.h"
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+int main(int argc, char* argv[])
+{
+    const char* name = argc > 1 ? argv[1] : STATE_SHARE_NAME;
+
+    CStateShareReader reader;
+    while (!reader.open(name)) {
+        printf("waiting for %s ...\n", name);
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+    }
+
+    uint32_t shown = 0;
+    for (;;) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        if (reader.latestFrame() == shown)
+            continue;
+
+        // 필요한 값만 칸에서 바로 읽고, 그동안 덮이지 않았을 때만 출력한다.
+        uint32_t ticket;
+        const SharedTableState* state = reader.peek(&ticket);
+        if (state == NULL)
+            continue;
+        uint32_t frame = state->frame;
+        int onTable = 0, moving = 0;
+        for (int i = 1; i < NUM_BALLS; i++) {
+            if (state->active[i]) onTable++;
+        }
+        for (int i = 0; i < NUM_BALLS; i++) {
+            if (state->active[i] && (state->vx[i] != 0.0f || state->vz[i] != 0.0f)) moving++;
+        }
+        int turn = state->turn ? 1 : 2;
+        const char* group = state->open ? "open" : state->group ? "solid" : "stripe";
+        int winner = state->winner;
+        bool freeShot = state->freeShot != 0;
+        int solidLeft = state->solidLeft, stripeLeft = state->stripeLeft;
+        if (!reader.validate(state, ticket))
+            continue;
+
+        shown = frame;
+        printf("frame %u : player %d (%s)%s, %d ball(s) on table (solid %d, stripe %d), %d moving",
+            frame, turn, group, freeShot ? " free shot" : "", onTable, solidLeft, stripeLeft, moving);
+        if (winner != 0)
+            printf(", player %d wins", winner);
+        printf("\n");
+        fflush(stdout);
+    }
+}
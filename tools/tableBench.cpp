@@ -0,0 +1,273 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: tableBench.cpp
+//
+// Desc: 경계 판정(isClearOfBoundary, tableConfig.h) 검사와 샷 시뮬레이션 속도 측정.
+//
+//       1. 쿠션 nose 직사각형과 포켓 원으로 "닿지 않음"을 판정하는 영역이 table field와
+//          맞는지 격자로 훑는다 (그 영역에서 field가 쿠션이나 포켓을 보고하면 위반).
+//          이 영역의 공은 물리 코어가 field를 읽지 않으므로 위반이 있으면 충돌을 놓친다.
+//       2. 같은 샷 목록(rack break와 무작위 배치, seed 고정)을 한 thread로 -repeat 번
+//          simulateShot 하고 가장 빠른 시간을 남긴다. 매번 결과(멈춘 위치, 들어간 공,
+//          step 수)가 같아야 한다.
+//
+//       빌드 예)
+//         g++ -O2 -I.. -o tableBench tableBench.cpp ../billiardPhysics.cpp ../contactSolver.cpp
+//             ../detMath.cpp ../eventBus.cpp ../islandStepper.cpp ../physicsParams.cpp
+//             ../tableConfig.cpp ../tableField.cpp ../tableLayout.cpp ../threadPool.cpp -lpthread
+//       사용 예)
+//         tableBench -shots 2000
+//         tableBench -table ../tables/snooker.table
+//       그 밖의 옵션: -seed n, -repeat n
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "billiardPhysics.h"
+#include "islandStepper.h"
+#include "tableConfig.h"
+#include "tableLayout.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdint.h>
+#include <vector>
+
+namespace
+{
+    const float CHECK_STEP = 0.005f;    // 경계 검사 격자 간격
+
+    struct BenchShot {
+        TableState start;
+        float aim, power, tipSide, tipHeight;
+    };
+
+    struct BenchResult {
+        double seconds;
+        long long steps;
+        std::vector<ShotOutcome> outcomes;
+    };
+
+    uint64_t splitmix64(uint64_t& state)
+    {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    float uniform(uint64_t& state, float lo, float hi)
+    {
+        return lo + (hi - lo) * (float)((splitmix64(state) >> 40) / 16777216.0);
+    }
+
+    // Setup과 같은 rack 배치 (섞는 자리는 번호 순서로 채운다), break 샷
+    void rackTable(TableState& state)
+    {
+        const TableLayout& table = activeTable();
+        memset(&state, 0, sizeof(state));
+        int next = 0;
+        for (int i = 0; i < NUM_BALLS; i++) {
+            BallState& ball = state.balls[i];
+            ball.y = (float)M_RADIUS;
+            if (i > table.rackCount) {
+                pocketBall(ball);
+                continue;
+            }
+            ball.active = true;
+            if (i == CUE_BALL) {
+                ball.x = table.cueX;
+                ball.z = table.cueZ;
+                continue;
+            }
+            int pos = -1;
+            for (int p = 0; p < table.rackCount; p++) {
+                if (table.rackBall[p] == i) pos = p;
+            }
+            while (pos < 0 && next < table.rackCount) {
+                if (table.rackBall[next] == 0) pos = next;
+                next++;
+            }
+            if (pos < 0) {
+                pocketBall(ball);
+                continue;
+            }
+            ball.x = table.rackX[pos];
+            ball.z = table.rackZ[pos];
+        }
+        state.rules.turn = true;
+        state.rules.open = true;
+        state.rules.break_shot = true;
+    }
+
+    // 서로 겹치지 않고 포켓에서 떨어진 무작위 배치
+    void scatterTable(TableState& state, uint64_t& seed)
+    {
+        const TableLayout& table = activeTable();
+        const RuntimeTable config(table, NUM_BALLS);
+        const float diameter = (float)(M_RADIUS * 2);
+        memset(&state, 0, sizeof(state));
+        for (int i = 0; i < NUM_BALLS; i++) {
+            BallState& ball = state.balls[i];
+            ball.y = (float)M_RADIUS;
+            if (i > table.rackCount) {
+                pocketBall(ball);
+                continue;
+            }
+            for (int attempt = 0; attempt < 1000; attempt++) {
+                ball.x = uniform(seed, table.minX, table.maxX);
+                ball.z = uniform(seed, table.minZ, table.maxZ);
+                bool free = isClearOfBoundary(config, ball.x, ball.z, 0.0f);
+                for (int j = 0; j < i && free; j++) {
+                    const BallState& other = state.balls[j];
+                    free = !other.active || lengthSq(ballPosition(ball) - ballPosition(other)) > diameter * diameter;
+                }
+                if (free) {
+                    ball.active = true;
+                    break;
+                }
+            }
+            if (!ball.active)
+                pocketBall(ball);
+        }
+        state.rules.turn = true;
+        state.rules.open = true;
+    }
+
+    std::vector<BenchShot> makeShots(int count, uint64_t seed)
+    {
+        std::vector<BenchShot> shots(count);
+        for (int i = 0; i < count; i++) {
+            BenchShot& shot = shots[i];
+            if (i % 2 == 0)
+                rackTable(shot.start);
+            else
+                scatterTable(shot.start, seed);
+            shot.aim = uniform(seed, -3.14159265f, 3.14159265f);
+            shot.power = uniform(seed, 1.0f, 8.0f);
+            shot.tipSide = uniform(seed, -0.3f, 0.3f);
+            shot.tipHeight = uniform(seed, -0.3f, 0.4f);
+        }
+        return shots;
+    }
+
+    // 샷 목록을 한 번 돌리고 가장 빠른 시간을 남긴다.
+    void runShots(const std::vector<BenchShot>& shots, BenchResult& result)
+    {
+        result.outcomes.resize(shots.size());
+        long long steps = 0;
+        std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < shots.size(); i++) {
+            const BenchShot& shot = shots[i];
+            result.outcomes[i] = simulateShot(shot.start, shot.aim, shot.power, shot.tipSide, shot.tipHeight);
+            steps += result.outcomes[i].steps;
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        if (result.steps == 0 || seconds < result.seconds)
+            result.seconds = seconds;
+        result.steps = steps;
+    }
+
+    bool sameOutcome(const ShotOutcome& a, const ShotOutcome& b)
+    {
+        if (a.pocketed != b.pocketed || a.cushionHits != b.cushionHits || a.firstContact != b.firstContact ||
+            a.steps != b.steps || a.foul != b.foul)
+            return false;
+        for (int i = 0; i < NUM_BALLS; i++) {
+            const BallState& p = a.finalBalls[i];
+            const BallState& q = b.finalBalls[i];
+            if (p.active != q.active || p.x != q.x || p.z != q.z || p.vx != q.vx || p.vz != q.vz)
+                return false;
+        }
+        return true;
+    }
+
+    // 판정 영역 안의 격자 점에서 field가 쿠션(반지름 + clearance 안쪽)이나 포켓(clearance 안쪽)을
+    // 보고하는 점의 수. margin에는 field 값이 요구보다 얼마나 남는지의 최솟값을 남긴다.
+    int checkBoundary(float clearance, int* points, float* margin)
+    {
+        const TableLayout& table = activeTable();
+        const RuntimeTable config(table, NUM_BALLS);
+        const CTableField& field = activeTableField();
+        int violations = 0;
+        *points = 0;
+        *margin = 1e9f;
+        for (float z = table.minZ; z <= table.maxZ; z += CHECK_STEP) {
+            for (float x = table.minX; x <= table.maxX; x += CHECK_STEP) {
+                if (!isClearOfBoundary(config, x, z, clearance)) continue;
+                (*points)++;
+                FieldSample sample = field.sample(x, z);
+                float cushion = sample.distance - (float)M_RADIUS - clearance;
+                float pocket = sample.pocket - clearance;
+                float least = cushion < pocket ? cushion : pocket;
+                if (least < *margin) *margin = least;
+                if (cushion < 0.0f || pocket < 0.0f || (clearance == 0.0f && sample.pocket <= 0.0f))
+                    violations++;
+            }
+        }
+        return violations;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    int count = 1000;
+    int repeat = 5;
+    uint64_t seed = 1;
+    const char* tablePath = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-shots") == 0 && i + 1 < argc) count = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-repeat") == 0 && i + 1 < argc) repeat = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-seed") == 0 && i + 1 < argc) seed = strtoull(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "-table") == 0 && i + 1 < argc) tablePath = argv[++i];
+        else {
+            fprintf(stderr, "unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+    if (count <= 0 || repeat <= 0) {
+        fprintf(stderr, "-shots and -repeat must be positive\n");
+        return 1;
+    }
+
+    if (tablePath != NULL) {
+        TableLayout layout;
+        char error[256];
+        if (!loadTableLayout(tablePath, &layout, error, sizeof(error))) {
+            fprintf(stderr, "%s: %s\n", tablePath, error);
+            return 1;
+        }
+        setActiveTable(layout);
+    }
+    printf("table %s\n", activeTable().name);
+
+    // 1. 판정 영역 검사 (moveBall은 clearance 0, substep 간격은 SUBSTEP_TRAVEL)
+    const float CLEARANCES[] = { 0.0f, SUBSTEP_TRAVEL };
+    int failures = 0;
+    for (int c = 0; c < 2; c++) {
+        int points;
+        float margin;
+        int violations = checkBoundary(CLEARANCES[c], &points, &margin);
+        printf("boundary clearance %.3f: %d points, %d violations, least field margin %.4f\n",
+            CLEARANCES[c], points, violations, margin);
+        failures += violations;
+    }
+
+    // 2. 속도 측정. 한 번 먼저 돌려 cache와 clock을 데우고, 그 결과와 매번 비교한다.
+    std::vector<BenchShot> shots = makeShots(count, seed);
+    BenchResult timed, warmup;
+    timed.seconds = warmup.seconds = 0;
+    timed.steps = warmup.steps = 0;
+    runShots(shots, warmup);
+    int mismatches = 0;
+    for (int r = 0; r < repeat; r++) {
+        runShots(shots, timed);
+        for (int i = 0; i < count; i++) {
+            if (!sameOutcome(warmup.outcomes[i], timed.outcomes[i]))
+                mismatches++;
+        }
+    }
+    printf("%d shots, %lld steps in %.3f s (%.0f shots/s, %.2f us/step), %d outcome(s) differ between runs\n",
+        count, timed.steps, timed.seconds, count / timed.seconds, timed.seconds * 1e6 / timed.steps, mismatches);
+    return failures > 0 || mismatches > 0 ? 1 : 0;
+}
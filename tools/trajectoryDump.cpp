@@ -0,0 +1,344 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: trajectoryDump.cpp
+//
+// Desc: 무작위 샷들의 궤적을 여러 thread에서 시뮬레이션해 trajectoryStore 파일로 쓰고,
+//       그 파일을 읽어 보여 주거나 읽는 속도를 잰다 (학습 pipeline용 dataset).
+//
+//       쓰기: 샷 i는 seed와 i로만 정해지므로 thread 수와 관계없이 같은 dataset이 된다.
+//             짝수 번째는 rack break, 홀수 번째는 공이 흩어진 무작위 배치에서 친다.
+//       읽기: -read는 한 샷의 header와 공마다의 궤적 요약, 사건을 출력한다.
+//             -bench는 모든 샷을 차례로, 그리고 무작위 순서로 고른 열만 풀어 속도를 잰다.
+//
+//       빌드 예)
+//         g++ -O2 -I.. -o trajectoryDump trajectoryDump.cpp ../trajectoryStore.cpp
+//             ../billiardPhysics.cpp ../contactSolver.cpp ../detMath.cpp ../eventBus.cpp
+//             ../islandStepper.cpp ../physicsParams.cpp ../tableConfig.cpp ../tableField.cpp
+//             ../tableLayout.cpp ../threadPool.cpp -lpthread
+//       사용 예)
+//         trajectoryDump -shots 1000000 -out shots.traj
+//         trajectoryDump -read shots.traj -shot 42 -columns x,z,events
+//         trajectoryDump -bench shots.traj -columns x
+//       그 밖의 옵션: -seed n, -threads n (0: 모든 core), -table 파일
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "billiardPhysics.h"
+#include "tableConfig.h"
+#include "tableLayout.h"
+#include "threadPool.h"
+#include "trajectoryStore.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <stdint.h>
+#include <vector>
+
+namespace
+{
+    const char* EVENT_NAMES[] = { "start", "ball", "cushion", "pocket", "first", "stop" };
+
+    uint64_t splitmix64(uint64_t& state)
+    {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    float uniform(uint64_t& state, float lo, float hi)
+    {
+        return lo + (hi - lo) * (float)((splitmix64(state) >> 40) / 16777216.0);
+    }
+
+    // Setup과 같은 rack 배치 (섞는 자리는 번호 순서로 채운다), break 샷
+    void rackTable(TableState& state)
+    {
+        const TableLayout& table = activeTable();
+        memset(&state, 0, sizeof(state));
+        int next = 0;
+        for (int i = 0; i < NUM_BALLS; i++) {
+            BallState& ball = state.balls[i];
+            ball.y = (float)M_RADIUS;
+            if (i > table.rackCount) {
+                pocketBall(ball);
+                continue;
+            }
+            ball.active = true;
+            if (i == CUE_BALL) {
+                ball.x = table.cueX;
+                ball.z = table.cueZ;
+                continue;
+            }
+            int pos = -1;
+            for (int p = 0; p < table.rackCount; p++) {
+                if (table.rackBall[p] == i) pos = p;
+            }
+            while (pos < 0 && next < table.rackCount) {
+                if (table.rackBall[next] == 0) pos = next;
+                next++;
+            }
+            if (pos < 0) {
+                pocketBall(ball);
+                continue;
+            }
+            ball.x = table.rackX[pos];
+            ball.z = table.rackZ[pos];
+        }
+        state.rules.turn = true;
+        state.rules.open = true;
+        state.rules.break_shot = true;
+    }
+
+    // 서로 겹치지 않고 쿠션, 포켓에서 떨어진 무작위 배치
+    void scatterTable(TableState& state, uint64_t& seed)
+    {
+        const TableLayout& table = activeTable();
+        const RuntimeTable config(table, NUM_BALLS);
+        const float diameter = (float)(M_RADIUS * 2);
+        memset(&state, 0, sizeof(state));
+        for (int i = 0; i < NUM_BALLS; i++) {
+            BallState& ball = state.balls[i];
+            ball.y = (float)M_RADIUS;
+            if (i > table.rackCount) {
+                pocketBall(ball);
+                continue;
+            }
+            for (int attempt = 0; attempt < 1000; attempt++) {
+                ball.x = uniform(seed, table.minX, table.maxX);
+                ball.z = uniform(seed, table.minZ, table.maxZ);
+                bool free = isClearOfBoundary(config, ball.x, ball.z, 0.0f);
+                for (int j = 0; j < i && free; j++) {
+                    const BallState& other = state.balls[j];
+                    free = !other.active || lengthSq(ballPosition(ball) - ballPosition(other)) > diameter * diameter;
+                }
+                if (free) {
+                    ball.active = true;
+                    break;
+                }
+            }
+            if (!ball.active)
+                pocketBall(ball);
+        }
+        state.rules.turn = true;
+        state.rules.open = true;
+    }
+
+    // 샷 i의 배치와 큐
+    void makeShot(uint64_t seed, int index, TableState& start, float* aim, float* power, float* tipSide,
+        float* tipHeight)
+    {
+        uint64_t state = seed * 0x9E3779B97F4A7C15ull + (uint64_t)index;
+        splitmix64(state);
+        if (index % 2 == 0)
+            rackTable(start);
+        else
+            scatterTable(start, state);
+        *aim = uniform(state, -3.14159265f, 3.14159265f);
+        *power = uniform(state, 1.0f, 8.0f);
+        *tipSide = uniform(state, -0.3f, 0.3f);
+        *tipHeight = uniform(state, -0.3f, 0.4f);
+    }
+
+    unsigned parseColumns(const char* text)
+    {
+        unsigned columns = 0;
+        if (strstr(text, "x") != NULL) columns |= TRAJ_COLUMN_X;
+        if (strstr(text, "z") != NULL) columns |= TRAJ_COLUMN_Z;
+        if (strstr(text, "events") != NULL) columns |= TRAJ_COLUMN_EVENTS;
+        return columns;
+    }
+
+    int writeDataset(const char* path, int count, uint64_t seed, int threads)
+    {
+        CTrajectoryWriter writer;
+        if (!writer.create(path)) {
+            fprintf(stderr, "cannot create %s\n", path);
+            return 1;
+        }
+
+        CThreadPool pool(threads > 0 ? threads - 1 : 0);
+        std::atomic<long long> samples(0), steps(0);
+        std::atomic<bool> failed(false);
+        std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+
+        // recorder는 stepper 작업 공간이 커서 묶음마다 하나 만든다.
+        pool.parallelFor(count, 64, [&](int from, int to) {
+            std::unique_ptr<CTrajectoryRecorder> recorder(new CTrajectoryRecorder);
+            TrajectoryShot shot;
+            for (int i = from; i < to && !failed; i++) {
+                TableState start;
+                float aim, power, tipSide, tipHeight;
+                makeShot(seed, i, start, &aim, &power, &tipSide, &tipHeight);
+                recorder->record(start, aim, power, tipSide, tipHeight, &shot);
+                shot.header.id = (uint64_t)i;
+                if (!writer.append(shot))
+                    failed = true;
+
+                long long recorded = 0;
+                for (int b = 0; b < NUM_BALLS; b++)
+                    recorded += (long long)shot.x[b].size();
+                samples += recorded;
+                steps += shot.header.steps;
+            }
+        });
+
+        uint64_t blockBytes = writer.bytesWritten() - sizeof(TrajectoryFileHeader);
+        if (!writer.close() || failed) {
+            fprintf(stderr, "cannot write %s\n", path);
+            return 1;
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+        // 비교: 공마다 매 step float x, z (8 byte)를 그대로 쓴 크기
+        double rawBytes = (double)samples.load() * 8.0;
+        double indexBytes = (double)count * sizeof(TrajectoryIndexEntry);
+        printf("%d shots, %lld steps in %.2f s on %d thread(s) (%.0f shots/s)\n", count, steps.load(), seconds,
+            pool.size(), count / seconds);
+        printf("columns %.1f MB (%.1f bytes/shot), index %.1f MB; raw float positions %.1f MB (%.1fx smaller)\n",
+            blockBytes / 1048576.0, (double)blockBytes / count, indexBytes / 1048576.0, rawBytes / 1048576.0,
+            rawBytes / (double)blockBytes);
+        return 0;
+    }
+
+    int readDataset(const char* path, int shot, unsigned columns)
+    {
+        CTrajectoryReader reader;
+        if (!reader.open(path)) {
+            fprintf(stderr, "cannot open %s (missing, not closed, or another version)\n", path);
+            return 1;
+        }
+        printf("%s: %d shots, step %.4f s, position quantum %g\n", path, reader.shotCount(),
+            reader.fileHeader().stepTime, reader.fileHeader().positionQuantum);
+        if (shot < 0)
+            return 0;
+
+        TrajectoryShot out;
+        if (!reader.readShot(shot, columns, &out)) {
+            fprintf(stderr, "cannot read shot %d\n", shot);
+            return 1;
+        }
+        const TrajectoryShotHeader& header = out.header;
+        printf("shot %d (id %llu): aim %.4f power %.3f tip %.2f %.2f, %u steps, pocketed 0x%04x, "
+            "first contact %d, cushions %u%s%s\n", shot, (unsigned long long)header.id, header.aim, header.power,
+            header.tipSide, header.tipHeight, header.steps, header.pocketed, header.firstContact,
+            header.cushionHits, header.foul ? ", foul" : "", header.scratch ? ", scratch" : "");
+
+        for (int b = 0; b < NUM_BALLS; b++) {
+            uint32_t samples = header.samples[b];
+            if (samples == 0) continue;
+            printf("  ball %2d: %u samples", b, samples);
+            if (!out.x[b].empty() && !out.z[b].empty()) {
+                printf(", (%.3f, %.3f) -> (%.3f, %.3f)", out.x[b][0], out.z[b][0], out.x[b][samples - 1],
+                    out.z[b][samples - 1]);
+            }
+            printf("\n");
+            for (size_t e = 0; e < out.events[b].size(); e++) {
+                const TrajectoryEvent& event = out.events[b][e];
+                printf("    step %5u %-7s", event.step, event.type < 6 ? EVENT_NAMES[event.type] : "?");
+                if (event.other >= 0) printf(" ball %2d", event.other);
+                printf(" speed %.3f\n", event.speed);
+            }
+        }
+        return 0;
+    }
+
+    int benchDataset(const char* path, unsigned columns, uint64_t seed)
+    {
+        CTrajectoryReader reader;
+        if (!reader.open(path)) {
+            fprintf(stderr, "cannot open %s (missing, not closed, or another version)\n", path);
+            return 1;
+        }
+        const int count = reader.shotCount();
+        if (count == 0)
+            return 0;
+
+        // 고른 열의 압축된 크기
+        double bytes = 0;
+        for (int i = 0; i < count; i++) {
+            for (int c = 0; c < TRAJ_COLUMN_COUNT; c++) {
+                if (columns & (1u << c)) bytes += reader.entry(i).columnSize[c];
+            }
+        }
+
+        TrajectoryShot shot;
+        long long samples = 0;
+        std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+        for (int i = 0; i < count; i++) {
+            if (!reader.readShot(i, columns, &shot)) {
+                fprintf(stderr, "shot %d is damaged\n", i);
+                return 1;
+            }
+            for (int b = 0; b < NUM_BALLS; b++)
+                samples += (long long)(shot.x[b].size() + shot.z[b].size());
+        }
+        double sequential = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+        uint64_t state = seed;
+        begin = std::chrono::steady_clock::now();
+        for (int i = 0; i < count; i++) {
+            if (!reader.readShot((int)(splitmix64(state) % (uint64_t)count), columns, &shot)) {
+                fprintf(stderr, "shot %d is damaged\n", i);
+                return 1;
+            }
+        }
+        double random = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+        printf("sequential: %d shots in %.3f s (%.0f shots/s, %.0f MB/s compressed, %.1f M positions/s)\n",
+            count, sequential, count / sequential, bytes / 1048576.0 / sequential, samples / sequential / 1e6);
+        printf("random:     %d shots in %.3f s (%.0f shots/s)\n", count, random, count / random);
+        return 0;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    int count = 10000;
+    int threads = 0;
+    int shot = -1;
+    uint64_t seed = 1;
+    unsigned columns = TRAJ_COLUMN_ALL;
+    const char* out = "shots.traj";
+    const char* readPath = NULL;
+    const char* benchPath = NULL;
+    const char* tablePath = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-shots") == 0 && i + 1 < argc) count = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-threads") == 0 && i + 1 < argc) threads = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-seed") == 0 && i + 1 < argc) seed = strtoull(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "-out") == 0 && i + 1 < argc) out = argv[++i];
+        else if (strcmp(argv[i], "-read") == 0 && i + 1 < argc) readPath = argv[++i];
+        else if (strcmp(argv[i], "-bench") == 0 && i + 1 < argc) benchPath = argv[++i];
+        else if (strcmp(argv[i], "-shot") == 0 && i + 1 < argc) shot = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-columns") == 0 && i + 1 < argc) columns = parseColumns(argv[++i]);
+        else if (strcmp(argv[i], "-table") == 0 && i + 1 < argc) tablePath = argv[++i];
+        else {
+            fprintf(stderr, "unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    if (readPath != NULL)
+        return readDataset(readPath, shot, columns);
+    if (benchPath != NULL)
+        return benchDataset(benchPath, columns, seed);
+
+    if (count <= 0) {
+        fprintf(stderr, "-shots must be positive\n");
+        return 1;
+    }
+    if (tablePath != NULL) {
+        TableLayout layout;
+        char error[256];
+        if (!loadTableLayout(tablePath, &layout, error, sizeof(error))) {
+            fprintf(stderr, "%s: %s\n", tablePath, error);
+            return 1;
+        }
+        setActiveTable(layout);
+    }
+    return writeDataset(out, count, seed, threads);
+}
@@ -0,0 +1,518 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: trajectoryStore.cpp
+//
+// Desc: 샷 궤적 기록, 열 단위 인코딩, 파일 writer / memory map reader 구현.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "trajectoryStore.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// -----------------------------------------------------------------------------
+// varint (LEB128), zigzag
+// -----------------------------------------------------------------------------
+
+namespace
+{
+    void putVarint(std::vector<uint8_t>& out, uint64_t value)
+    {
+        while (value >= 0x80) {
+            out.push_back((uint8_t)(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back((uint8_t)value);
+    }
+
+    void putSigned(std::vector<uint8_t>& out, int64_t value)
+    {
+        putVarint(out, ((uint64_t)value << 1) ^ (uint64_t)(value >> 63));
+    }
+
+    // 열 하나를 읽는 커서. 끝을 넘으면 failed가 되고 그 뒤로는 0을 돌려준다.
+    struct ColumnCursor {
+        const uint8_t* at;
+        const uint8_t* end;
+        bool failed;
+
+        uint64_t varint(void)
+        {
+            uint64_t value = 0;
+            for (int shift = 0; shift < 64; shift += 7) {
+                if (at >= end) {
+                    failed = true;
+                    return 0;
+                }
+                uint8_t byte = *at++;
+                value |= (uint64_t)(byte & 0x7F) << shift;
+                if (byte < 0x80)
+                    return value;
+            }
+            failed = true;
+            return 0;
+        }
+
+        int64_t signedVarint(void)
+        {
+            uint64_t value = varint();
+            return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+        }
+    };
+
+    int32_t quantize(float value, float quantum)
+    {
+        return (int32_t)lrintf(value / quantum);
+    }
+
+    // 공마다 양자화한 위치를 처음 값, 첫 차분, 차분의 차분으로 쓴다.
+    void encodePositions(std::vector<uint8_t>& out, const std::vector<float>& values, uint32_t samples)
+    {
+        int32_t previous = 0, delta = 0;
+        for (uint32_t s = 0; s < samples; s++) {
+            int32_t q = quantize(values[s], TRAJ_POSITION_QUANTUM);
+            if (s == 0) {
+                putSigned(out, q);
+            }
+            else {
+                int32_t d = q - previous;
+                putSigned(out, s == 1 ? d : d - delta);
+                delta = d;
+            }
+            previous = q;
+        }
+    }
+
+    bool decodePositions(ColumnCursor& cursor, uint32_t samples, std::vector<float>& values)
+    {
+        values.resize(samples);
+        int64_t previous = 0, delta = 0;
+        for (uint32_t s = 0; s < samples; s++) {
+            int64_t v = cursor.signedVarint();
+            if (s == 0) {
+                previous = v;
+            }
+            else {
+                delta = s == 1 ? v : delta + v;
+                previous += delta;
+            }
+            values[s] = (float)previous * TRAJ_POSITION_QUANTUM;
+        }
+        return !cursor.failed;
+    }
+
+    // 사건 하나: step 차이, 종류 * 32 + (상대 공 + 1), 양자화한 속력
+    void encodeEvents(std::vector<uint8_t>& out, const std::vector<TrajectoryEvent>& events)
+    {
+        putVarint(out, events.size());
+        uint32_t step = 0;
+        for (size_t e = 0; e < events.size(); e++) {
+            const TrajectoryEvent& event = events[e];
+            putVarint(out, event.step - step);
+            putVarint(out, (uint64_t)event.type * 32 + (uint64_t)(event.other + 1));
+            float speed = event.speed > 0.0f ? event.speed : 0.0f;
+            putVarint(out, (uint64_t)quantize(speed, TRAJ_SPEED_QUANTUM));
+            step = event.step;
+        }
+    }
+
+    bool decodeEvents(ColumnCursor& cursor, std::vector<TrajectoryEvent>& events)
+    {
+        uint64_t count = cursor.varint();
+        // 사건 하나는 적어도 3 byte이다.
+        if (cursor.failed || count > (uint64_t)(cursor.end - cursor.at) / 3)
+            return false;
+        events.resize((size_t)count);
+        uint32_t step = 0;
+        for (size_t e = 0; e < events.size(); e++) {
+            TrajectoryEvent& event = events[e];
+            step += (uint32_t)cursor.varint();
+            uint64_t kind = cursor.varint();
+            event.step = step;
+            event.type = (uint8_t)(kind / 32);
+            event.other = (int8_t)((int)(kind % 32) - 1);
+            event.speed = (float)cursor.varint() * TRAJ_SPEED_QUANTUM;
+        }
+        return !cursor.failed;
+    }
+
+    // 마지막으로 (양자화한 값이) 바뀐 위치까지의 수
+    uint32_t movingSamples(const std::vector<float>& x, const std::vector<float>& z)
+    {
+        uint32_t samples = (uint32_t)std::min(x.size(), z.size());
+        while (samples > 1 &&
+            quantize(x[samples - 1], TRAJ_POSITION_QUANTUM) == quantize(x[samples - 2], TRAJ_POSITION_QUANTUM) &&
+            quantize(z[samples - 1], TRAJ_POSITION_QUANTUM) == quantize(z[samples - 2], TRAJ_POSITION_QUANTUM))
+            samples--;
+        return samples;
+    }
+}
+
+void TrajectoryShot::clear(void)
+{
+    memset(&header, 0, sizeof(header));
+    header.firstContact = -1;
+    for (int b = 0; b < NUM_BALLS; b++) {
+        x[b].clear();
+        z[b].clear();
+        events[b].clear();
+    }
+}
+
+// -----------------------------------------------------------------------------
+// 기록
+// -----------------------------------------------------------------------------
+
+CTrajectoryRecorder::CTrajectoryRecorder(void) : m_shot(NULL), m_step(0)
+{
+    m_stepper.setEventBus(&m_bus);
+    m_bus.subscribe(this);
+}
+
+void CTrajectoryRecorder::onEvent(const PhysicsEvent& event)
+{
+    TrajectoryEvent record;
+    record.step = m_step;
+    record.type = (uint8_t)event.type;
+    record.other = -1;
+    record.speed = event.speed;
+
+    switch (event.type) {
+    case EVENT_BALL_CONTACT:
+        record.other = (int8_t)event.b;
+        m_shot->events[event.a].push_back(record);
+        record.other = (int8_t)event.a;
+        m_shot->events[event.b].push_back(record);
+        break;
+    case EVENT_CUSHION_HIT:
+    case EVENT_POCKETED:
+        m_shot->events[event.a].push_back(record);
+        break;
+    default:
+        break;
+    }
+}
+
+void CTrajectoryRecorder::record(const TableState& start, float aim, float power, float tipSide, float tipHeight,
+    TrajectoryShot* out, int maxSteps)
+{
+    out->clear();
+    TrajectoryShotHeader& header = out->header;
+    header.aim = aim;
+    header.power = power;
+    header.tipSide = tipSide;
+    header.tipHeight = tipHeight;
+
+    BallState balls[NUM_BALLS];
+    memcpy(balls, start.balls, sizeof(balls));
+    for (int b = 0; b < NUM_BALLS; b++) {
+        if (!balls[b].active) continue;
+        out->x[b].push_back(balls[b].x);
+        out->z[b].push_back(balls[b].z);
+    }
+
+    m_stepper.reset();
+    m_bus.clear();
+    m_shot = out;
+    strikeCueBall(balls[CUE_BALL], aim, power, tipSide, tipHeight);
+
+    int cushionHits = 0;
+    for (m_step = 1; (int)m_step <= maxSteps; m_step++) {
+        StepEvents events;
+        m_stepper.step(balls, NUM_BALLS, SIM_FIXED_STEP, &events);
+        m_bus.dispatch();
+        header.steps = m_step;
+        header.pocketed |= events.pocketed;
+        cushionHits += events.cushionHits;
+        if (header.firstContact < 0)
+            header.firstContact = events.firstContact;
+
+        for (int b = 0; b < NUM_BALLS; b++) {
+            if (!balls[b].active) continue;
+            out->x[b].push_back(balls[b].x);
+            out->z[b].push_back(balls[b].z);
+        }
+        if (events.movingBalls == 0)
+            break;
+    }
+    m_bus.clear();
+    m_shot = NULL;
+
+    bool solidIn = false, stripeIn = false;
+    for (int b = 0; b < NUM_BALLS; b++) {
+        if (!(header.pocketed & (1u << b))) continue;
+        solidIn = solidIn || isSolidBall(b);
+        stripeIn = stripeIn || isStripeBall(b);
+    }
+    header.cushionHits = (uint16_t)std::min(cushionHits, 0xFFFF);
+    header.scratch = (header.pocketed & (1u << CUE_BALL)) != 0;
+    header.foul = isFoul(start.rules.break_shot, solidIn, stripeIn, header.scratch != 0, cushionHits) ||
+        !isLegalFirstContact(start.rules, header.firstContact);
+}
+
+// -----------------------------------------------------------------------------
+// writer
+// -----------------------------------------------------------------------------
+
+bool CTrajectoryWriter::create(const char* path)
+{
+    close();
+    m_file = fopen(path, "wb");
+    if (m_file == NULL)
+        return false;
+
+    // 닫을 때 채운다. indexOffset이 0인 파일은 reader가 열지 않는다.
+    TrajectoryFileHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = TRAJ_MAGIC;
+    header.version = TRAJ_VERSION;
+    header.headerSize = sizeof(TrajectoryFileHeader);
+    header.entrySize = sizeof(TrajectoryIndexEntry);
+    header.positionQuantum = TRAJ_POSITION_QUANTUM;
+    header.speedQuantum = TRAJ_SPEED_QUANTUM;
+    header.stepTime = SIM_FIXED_STEP;
+    m_failed = fwrite(&header, sizeof(header), 1, m_file) != 1;
+    m_offset = sizeof(header);
+    m_index.clear();
+    return !m_failed;
+}
+
+bool CTrajectoryWriter::append(const TrajectoryShot& shot)
+{
+    // 인코딩은 부른 thread에서 한다.
+    TrajectoryIndexEntry entry;
+    memset(&entry, 0, sizeof(entry));
+    entry.header = shot.header;
+
+    std::vector<uint8_t> block;
+    block.reserve(4096);
+    for (int b = 0; b < NUM_BALLS; b++)
+        entry.header.samples[b] = movingSamples(shot.x[b], shot.z[b]);
+
+    uint32_t columnStart[TRAJ_COLUMN_COUNT];
+    columnStart[TRAJ_X] = 0;
+    for (int b = 0; b < NUM_BALLS; b++)
+        encodePositions(block, shot.x[b], entry.header.samples[b]);
+    columnStart[TRAJ_Z] = (uint32_t)block.size();
+    for (int b = 0; b < NUM_BALLS; b++)
+        encodePositions(block, shot.z[b], entry.header.samples[b]);
+    columnStart[TRAJ_EVENTS] = (uint32_t)block.size();
+    for (int b = 0; b < NUM_BALLS; b++)
+        encodeEvents(block, shot.events[b]);
+
+    for (int c = 0; c < TRAJ_COLUMN_COUNT; c++) {
+        uint32_t end = c + 1 < TRAJ_COLUMN_COUNT ? columnStart[c + 1] : (uint32_t)block.size();
+        entry.columnSize[c] = end - columnStart[c];
+    }
+
+    std::lock_guard<std::mutex> guard(m_lock);
+    if (m_file == NULL || m_failed)
+        return false;
+    if (!block.empty() && fwrite(&block[0], block.size(), 1, m_file) != 1) {
+        m_failed = true;
+        return false;
+    }
+    for (int c = 0; c < TRAJ_COLUMN_COUNT; c++)
+        entry.columnOffset[c] = m_offset + columnStart[c];
+    m_offset += block.size();
+    m_index.push_back(entry);
+    return true;
+}
+
+bool CTrajectoryWriter::close(void)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    if (m_file == NULL)
+        return false;
+
+    // 여러 thread가 쓴 block의 순서는 매번 다르지만 index는 id 순서로 둔다.
+    std::stable_sort(m_index.begin(), m_index.end(),
+        [](const TrajectoryIndexEntry& a, const TrajectoryIndexEntry& b) { return a.header.id < b.header.id; });
+
+    // index는 8 byte 경계에 둔다 (reader가 map한 그대로 읽는다).
+    bool ok = !m_failed;
+    static const uint8_t PADDING[8] = { 0 };
+    size_t padding = (size_t)((8 - m_offset % 8) % 8);
+    if (ok && padding > 0)
+        ok = fwrite(PADDING, padding, 1, m_file) == 1;
+    m_offset += padding;
+    if (ok && !m_index.empty())
+        ok = fwrite(&m_index[0], sizeof(TrajectoryIndexEntry), m_index.size(), m_file) == m_index.size();
+
+    TrajectoryFileHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = TRAJ_MAGIC;
+    header.version = TRAJ_VERSION;
+    header.headerSize = sizeof(TrajectoryFileHeader);
+    header.entrySize = sizeof(TrajectoryIndexEntry);
+    header.positionQuantum = TRAJ_POSITION_QUANTUM;
+    header.speedQuantum = TRAJ_SPEED_QUANTUM;
+    header.stepTime = SIM_FIXED_STEP;
+    header.shotCount = (uint32_t)m_index.size();
+    header.indexOffset = m_offset;
+    ok = ok && fseek(m_file, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, m_file) == 1;
+    ok = fclose(m_file) == 0 && ok;
+    m_file = NULL;
+    m_index.clear();
+    return ok;
+}
+
+int CTrajectoryWriter::shotCount(void) const
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    return (int)m_index.size();
+}
+
+uint64_t CTrajectoryWriter::bytesWritten(void) const
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    return m_offset;
+}
+
+// -----------------------------------------------------------------------------
+// reader
+// -----------------------------------------------------------------------------
+
+#ifdef _WIN32
+
+bool CTrajectoryReader::open(const char* path)
+{
+    close();
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+    LARGE_INTEGER size;
+    HANDLE mapping = NULL;
+    const void* view = NULL;
+    if (GetFileSizeEx(file, &size) && size.QuadPart > 0)
+        mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mapping != NULL)
+        view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (view == NULL) {
+        if (mapping != NULL) CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    m_data = (const uint8_t*)view;
+    m_size = (uint64_t)size.QuadPart;
+    m_file = (intptr_t)file;
+    m_mapping = (intptr_t)mapping;
+    return validate();
+}
+
+void CTrajectoryReader::close(void)
+{
+    if (m_data != NULL)
+        UnmapViewOfFile(m_data);
+    if (m_mapping != -1)
+        CloseHandle((HANDLE)m_mapping);
+    if (m_file != -1)
+        CloseHandle((HANDLE)m_file);
+    m_data = NULL;
+    m_size = 0;
+    m_file = m_mapping = -1;
+    m_header = NULL;
+    m_index = NULL;
+}
+
+#else
+
+bool CTrajectoryReader::open(const char* path)
+{
+    close();
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat info;
+    void* view = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && info.st_size > 0)
+        view = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (view == MAP_FAILED) {
+        ::close(fd);
+        return false;
+    }
+    m_data = (const uint8_t*)view;
+    m_size = (uint64_t)info.st_size;
+    m_file = fd;
+    return validate();
+}
+
+void CTrajectoryReader::close(void)
+{
+    if (m_data != NULL)
+        munmap((void*)m_data, (size_t)m_size);
+    if (m_file != -1)
+        ::close((int)m_file);
+    m_data = NULL;
+    m_size = 0;
+    m_file = m_mapping = -1;
+    m_header = NULL;
+    m_index = NULL;
+}
+
+#endif
+
+bool CTrajectoryReader::validate(void)
+{
+    const TrajectoryFileHeader* header = (const TrajectoryFileHeader*)m_data;
+    bool ok = m_size >= sizeof(TrajectoryFileHeader) &&
+        header->magic == TRAJ_MAGIC && header->version == TRAJ_VERSION &&
+        header->headerSize == sizeof(TrajectoryFileHeader) && header->entrySize == sizeof(TrajectoryIndexEntry) &&
+        header->indexOffset >= sizeof(TrajectoryFileHeader) && header->indexOffset <= m_size &&
+        (m_size - header->indexOffset) / sizeof(TrajectoryIndexEntry) >= header->shotCount &&
+        header->indexOffset % 8 == 0;
+    if (!ok) {
+        close();
+        return false;
+    }
+    m_header = header;
+    m_index = (const TrajectoryIndexEntry*)(m_data + header->indexOffset);
+    return true;
+}
+
+bool CTrajectoryReader::readShot(int shot, unsigned columns, TrajectoryShot* out) const
+{
+    if (m_header == NULL || shot < 0 || shot >= (int)m_header->shotCount)
+        return false;
+    const TrajectoryIndexEntry& entry = m_index[shot];
+    out->header = entry.header;
+
+    for (int c = 0; c < TRAJ_COLUMN_COUNT; c++) {
+        bool wanted = (columns & (1u << c)) != 0;
+        for (int b = 0; b < NUM_BALLS; b++) {
+            if (c == TRAJ_X) out->x[b].clear();
+            else if (c == TRAJ_Z) out->z[b].clear();
+            else out->events[b].clear();
+        }
+        if (!wanted) continue;
+        if (entry.columnOffset[c] > m_size || entry.columnSize[c] > m_size - entry.columnOffset[c])
+            return false;
+
+        ColumnCursor cursor;
+        cursor.at = m_data + entry.columnOffset[c];
+        cursor.end = cursor.at + entry.columnSize[c];
+        cursor.failed = false;
+        for (int b = 0; b < NUM_BALLS; b++) {
+            uint32_t samples = entry.header.samples[b];
+            // 위치 하나는 적어도 1 byte이다.
+            if (c != TRAJ_EVENTS && samples > (uint64_t)(cursor.end - cursor.at))
+                return false;
+            bool ok = c == TRAJ_X ? decodePositions(cursor, samples, out->x[b])
+                : c == TRAJ_Z ? decodePositions(cursor, samples, out->z[b])
+                : decodeEvents(cursor, out->events[b]);
+            if (!ok)
+                return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,184 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: trajectoryStore.h
+//
+// Desc: 샷 궤적 전체(step마다 공의 위치와 공마다의 사건)를 담는 열 단위 binary 파일.
+//       학습 pipeline이 수백만 샷의 궤적을 읽을 수 있도록 작게 쓰고, 필요한 샷과 열만 푼다.
+//
+//       파일 구성
+//         TrajectoryFileHeader
+//         샷 block들 (열 X, Z, EVENTS가 차례로 붙는다, 쓴 순서)
+//         index: 샷마다 TrajectoryIndexEntry (샷 header와 열의 위치), id 순서
+//       모든 구조는 포인터가 없는 POD이며 little-endian 그대로 쓴다.
+//
+//       위치 열: 공마다 TRAJ_POSITION_QUANTUM 단위로 양자화한 값을 처음 값, 첫 차분,
+//       그 뒤로는 차분의 차분으로 zigzag varint에 담는다. 공은 거의 등속으로 움직이므로
+//       대부분 1 byte가 된다. 공의 기록은 마지막으로 움직인 step (들어간 공은 들어가기 직전)
+//       에서 끝나고 (header의 samples), 그 뒤의 위치는 마지막 값과 같다.
+//       사건 열: 공마다 사건 수와 (앞 사건과의 step 차이, 종류와 상대 공, 속력)을 varint로 담는다.
+//       공끼리 충돌은 두 공의 열에 모두 들어간다.
+//
+//       writer는 여러 simulation thread에서 동시에 append할 수 있다. 부른 thread에서 인코딩하고
+//       파일 끝에 붙일 때만 잠근다. reader는 파일을 memory map하고 index로 아무 샷이나 바로 찾는다.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __trajectoryStoreH__
+#define __trajectoryStoreH__
+
+#include "billiardPhysics.h"
+#include "eventBus.h"
+#include "islandStepper.h"
+#include <mutex>
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+
+const uint32_t TRAJ_MAGIC = 0x4A544256;         // "VBTJ"
+const uint32_t TRAJ_VERSION = 1;
+const float    TRAJ_POSITION_QUANTUM = 1.0f / 2048.0f;  // 위치 단위 (반지름의 약 1/430)
+const float    TRAJ_SPEED_QUANTUM = 1.0f / 256.0f;
+const int      TRAJ_MAX_STEPS = 20000;
+
+enum TrajectoryColumn {
+    TRAJ_X,
+    TRAJ_Z,
+    TRAJ_EVENTS,
+    TRAJ_COLUMN_COUNT
+};
+
+// readShot에 넘기는 열 선택
+const unsigned TRAJ_COLUMN_X = 1u << TRAJ_X;
+const unsigned TRAJ_COLUMN_Z = 1u << TRAJ_Z;
+const unsigned TRAJ_COLUMN_EVENTS = 1u << TRAJ_EVENTS;
+const unsigned TRAJ_COLUMN_ALL = (1u << TRAJ_COLUMN_COUNT) - 1;
+
+struct TrajectoryFileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t headerSize;        // sizeof(TrajectoryFileHeader)
+    uint32_t entrySize;         // sizeof(TrajectoryIndexEntry)
+    float    positionQuantum;
+    float    speedQuantum;
+    float    stepTime;          // 기록 간격 (시뮬레이션 초)
+    uint32_t shotCount;
+    uint64_t indexOffset;       // 0: writer가 닫지 않은 파일
+};
+
+struct TrajectoryShotHeader {
+    uint64_t id;                // 쓰는 쪽이 붙인 번호 (index 순서)
+    float    aim, power;
+    float    tipSide, tipHeight;
+    uint32_t steps;             // 모든 공이 멈출 때까지의 step 수
+    uint32_t pocketed;          // 들어간 공의 bit mask
+    int32_t  firstContact;      // 큐볼이 처음 맞힌 공, 없으면 -1
+    uint16_t cushionHits;
+    uint8_t  foul;
+    uint8_t  scratch;
+    uint32_t samples[NUM_BALLS];    // 공마다 기록한 위치 수 (처음 위치 포함, 0: 처음부터 없는 공)
+};
+
+struct TrajectoryIndexEntry {
+    TrajectoryShotHeader header;
+    uint64_t columnOffset[TRAJ_COLUMN_COUNT];  // 파일 처음부터
+    uint32_t columnSize[TRAJ_COLUMN_COUNT];
+    uint32_t reserved;
+};
+
+struct TrajectoryEvent {
+    uint32_t step;              // 사건이 일어난 step (1부터)
+    uint8_t  type;              // EVENT_BALL_CONTACT, EVENT_CUSHION_HIT, EVENT_POCKETED
+    int8_t   other;             // 충돌한 상대 공, 없으면 -1
+    float    speed;
+};
+
+// 샷 하나의 궤적. x[b], z[b]는 step 0(치기 전)부터의 위치이다.
+// writer는 마지막으로 움직인 뒤의 값을 버리고, reader는 samples[b]개를 돌려준다.
+struct TrajectoryShot {
+    TrajectoryShotHeader header;
+    std::vector<float> x[NUM_BALLS], z[NUM_BALLS];
+    std::vector<TrajectoryEvent> events[NUM_BALLS];
+
+    void clear(void);
+};
+
+// start 배치에서 샷을 치고 모든 공이 멈출 때까지 SIM_FIXED_STEP마다 기록한다.
+// stepper와 event bus를 가지고 있으므로 thread마다 하나씩 쓴다.
+class CTrajectoryRecorder : private CEventListener {
+public:
+    CTrajectoryRecorder(void);
+
+    void record(const TableState& start, float aim, float power, float tipSide, float tipHeight,
+        TrajectoryShot* out, int maxSteps = TRAJ_MAX_STEPS);
+
+private:
+    virtual void onEvent(const PhysicsEvent& event);
+
+    CIslandStepper  m_stepper;
+    CEventBus       m_bus;
+    TrajectoryShot* m_shot;
+    uint32_t        m_step;
+};
+
+class CTrajectoryWriter {
+public:
+    CTrajectoryWriter(void) : m_file(NULL), m_offset(0), m_failed(false) {}
+    ~CTrajectoryWriter(void) { close(); }
+
+    bool create(const char* path);
+
+    // 여러 thread에서 동시에 불러도 된다. 쓰기에 실패하면 false (그 뒤로도 계속 false).
+    bool append(const TrajectoryShot& shot);
+
+    // index를 id 순서로 쓰고 header를 채운다. 쓰는 중 실패가 있었으면 false.
+    bool close(void);
+
+    int shotCount(void) const;
+    uint64_t bytesWritten(void) const;
+
+private:
+    CTrajectoryWriter(const CTrajectoryWriter&);
+    CTrajectoryWriter& operator=(const CTrajectoryWriter&);
+
+    FILE*                             m_file;
+    uint64_t                          m_offset;     // 다음 block을 쓸 위치
+    bool                              m_failed;
+    std::vector<TrajectoryIndexEntry> m_index;
+    mutable std::mutex                m_lock;
+};
+
+class CTrajectoryReader {
+public:
+    CTrajectoryReader(void) : m_data(0), m_size(0), m_file(-1), m_mapping(-1), m_header(0), m_index(0) {}
+    ~CTrajectoryReader(void) { close(); }
+
+    // 파일을 읽기 전용으로 map한다. 없거나, 닫히지 않았거나, 구조가 다르면 false.
+    bool open(const char* path);
+    void close(void);
+    bool isOpen(void) const { return m_data != 0; }
+
+    int shotCount(void) const { return m_header != 0 ? (int)m_header->shotCount : 0; }
+    const TrajectoryFileHeader& fileHeader(void) const { return *m_header; }
+    const TrajectoryShotHeader& header(int shot) const { return m_index[shot].header; }
+    const TrajectoryIndexEntry& entry(int shot) const { return m_index[shot]; }
+
+    // shot의 header와 columns(TRAJ_COLUMN_*)로 고른 열만 out에 푼다.
+    // 고르지 않은 열은 비워 둔다. 열이 손상되었으면 false.
+    bool readShot(int shot, unsigned columns, TrajectoryShot* out) const;
+
+private:
+    CTrajectoryReader(const CTrajectoryReader&);
+    CTrajectoryReader& operator=(const CTrajectoryReader&);
+
+    // map한 파일의 header와 index를 확인한다. 틀리면 닫고 false.
+    bool validate(void);
+
+    const uint8_t*              m_data;
+    uint64_t                    m_size;
+    intptr_t                    m_file;
+    intptr_t                    m_mapping;
+    const TrajectoryFileHeader* m_header;
+    const TrajectoryIndexEntry* m_index;
+};
+
+#endif // __trajectoryStoreH__
@@ -11,10 +11,28 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "d3dUtility.h"
-#include <vector>
+#include "billiardPhysics.h"
+#include "tableLayout.h"
+#include "zobristHash.h"
+#include "shotCache.h"
+#include "aimGuide.h"
+#include "islandStepper.h"
+#include "threadPool.h"
+#include "eventBus.h"
+#include "ruleEngine.h"
+#include "simdMath.h"
+#include "ballTransforms.h"
+#include "allocTracker.h"
+#include "lockstep.h"
+#include "netSession.h"
+#include "shotSolver.h"
+#include "stateShare.h"
+#include "simClock.h"
+#include <cfloat>
 #include <ctime>
 #include <cstdlib>
 #include <cstdio>
+#include <cstring>
 #include <cassert>
 #include <algorithm>
 
@@ -24,26 +42,14 @@ IDirect3DDevice9* Device = NULL;
 const int Width = 1024;
 const int Height = 768;
 
-// 테이블 경계값 정의
-const float TABLE_MIN_X = -4.5f;
-const float TABLE_MAX_X = 4.5f;
-const float TABLE_MIN_Z = -3.0f;
-const float TABLE_MAX_Z = 3.0f;
-
-// There are four balls
-// initialize the position (coordinate) of each ball (ball0 ~ ball3)
-const float spherePos[16][2] = {
-    {-2.5f, 0.0f},  // 큐볼 위치 
-    {1.0f, 0.0f},   // 삼각형 첫 번째 줄 (꼭대기)
-    {1.36f, -0.21f}, {1.36f, 0.21f},  // 삼각형 두 번째 줄
-    {1.72f, -0.42f}, {1.72f, 0.0f}, {1.72f, 0.42f},  // 삼각형 세 번째 줄
-    {2.08f, -0.63f}, {2.08f, -0.21f}, {2.08f, 0.21f}, {2.08f, 0.63f},  // 삼각형 네 번째 줄
-    {2.44f, -0.84f}, {2.44f, -0.42f}, {2.44f, 0.0f}, {2.44f, 0.42f}, {2.44f, 0.84f}  // 삼각형 다섯 번째 줄
+// 테이블 정의 파일 (F5 ~ F8로 바꿀 수 있다). 공 배치도 이 파일의 rack을 따른다.
+const char* const TABLE_FILES[] = {
+    "tables\\8ball.table",
+    "tables\\9ball.table",
+    "tables\\snooker.table",
+    "tables\\carom.table"
 };
 
-// 벽에 공이 맞은 횟수 카운트
-int cusion_count;
-
 // -----------------------------------------------------------------------------
 // Transform matrices
 // -----------------------------------------------------------------------------
@@ -51,10 +57,23 @@ D3DXMATRIX g_mWorld;
 D3DXMATRIX g_mView;
 D3DXMATRIX g_mProj;
 
-#define M_RADIUS 0.21   // ball radius
 #define PI 3.14159265
 #define M_HEIGHT 0.01
-#define DECREASE_RATE 0.9982
+
+// simdMath의 행렬은 D3DXMATRIX와 같은 배치이므로 그대로 복사한다.
+static D3DXMATRIX toD3DMatrix(const float4x4& m)
+{
+    D3DXMATRIX r;
+    memcpy(&r, &m, sizeof(r));
+    return r;
+}
+
+static float4x4 fromD3DMatrix(const D3DXMATRIX& m)
+{
+    float4x4 r;
+    memcpy(&r, &m, sizeof(r));
+    return r;
+}
 
 // -----------------------------------------------------------------------------
 // CSphere class definition
@@ -62,35 +81,48 @@ D3DXMATRIX g_mProj;
 
 class CSphere {
 private:
-    float					center_x, center_y, center_z;
+    BallState* m_state;     // 물리 상태 (g_table.balls의 한 칸 또는 m_ownState)
+    BallState  m_ownState;
     float                   m_radius;
-    float					m_velocity_x;
-    float					m_velocity_z;
-    D3DXVECTOR3 m_prevPos; // 이전 프레임에서의 위치
-    D3DXMATRIX m_rotation; // 누적 회전 각도
+    CBallTransforms* m_transforms;  // 방향과 world 행렬을 두는 곳
+    int        m_slot;
 
 public:
-    CSphere(void) : isActive(true)
+    CSphere(void)
     {
-        D3DXMatrixIdentity(&m_mLocal);
-        D3DXMatrixIdentity(&m_rotation);
+        ZeroMemory(&m_ownState, sizeof(m_ownState));
+        m_ownState.active = true;
+        m_state = &m_ownState;
+        m_transforms = NULL;
+        m_slot = 0;
         ZeroMemory(&m_mtrl, sizeof(m_mtrl));
         m_radius = 0;
-        m_velocity_x = 0;
-        m_velocity_z = 0;
         m_pSphereMesh = NULL;
         m_pTexture = NULL;
     }
     ~CSphere(void) {}
 
-    void deactivate() { isActive = false; }
+    // 물리 코어가 진행하는 상태에 연결한다. 현재 상태는 그대로 옮겨진다.
+    void bindState(BallState* state)
+    {
+        *state = *m_state;
+        m_state = state;
+    }
 
-    void activate() { isActive = true; }
+    // 방향과 world 행렬을 transforms의 slot 칸에 둔다.
+    void bindTransform(CBallTransforms* transforms, int slot)
+    {
+        m_transforms = transforms;
+        m_slot = slot;
+        m_transforms->resetOrientation(m_slot);
+        syncPosition();
+    }
 
-    bool isActiveBall() const { return isActive; }
-    //활성 상태 관리 추가
-private:
-    bool isActive; // 활성 상태 플래그
+    void deactivate() { m_state->active = false; }
+
+    void activate() { m_state->active = true; }
+
+    bool isActiveBall() const { return m_state->active; }
 
 
 
@@ -174,9 +206,8 @@ public:
 
     void rotate(float angleDegrees, const D3DXVECTOR3& axis)
     {
-        D3DXMATRIX rot;
-        D3DXMatrixRotationAxis(&rot, &axis, D3DXToRadian(angleDegrees));
-        m_rotation = rot * m_rotation;
+        m_transforms->rotateLocal(m_slot,
+            quatFromAxisAngle(normalize(make_float3(axis.x, axis.y, axis.z)), D3DXToRadian(angleDegrees)));
     }
 	
     void destroy(void)
@@ -191,19 +222,12 @@ public:
         }
     }
 
-    void draw(IDirect3DDevice9* pDevice, const D3DXMATRIX& mWorld)
+    // world 행렬은 g_ballTransforms.update()가 frame마다 미리 만들어 둔다.
+    void draw(IDirect3DDevice9* pDevice)
     {
         if (NULL == pDevice)
             return;
-        // 현재 위치를 기반으로 한 이동 행렬 생성
-        D3DXMATRIX mTranslation;
-        D3DXMatrixTranslation(&mTranslation, center_x, center_y, center_z);
-
-        // 회전과 이동을 결합
-        D3DXMATRIX mWorldLocal = m_rotation * mTranslation;
-
-        // 최종 월드 행렬 계산 (로컬 변환 후 월드 변환)
-        D3DXMATRIX finalWorld = mWorldLocal * mWorld;
+        D3DXMATRIX finalWorld = toD3DMatrix(m_transforms->matrix(m_slot));
         pDevice->SetTransform(D3DTS_WORLD, &finalWorld);
 
         // 머티리얼과 텍스처 설정
@@ -219,157 +243,43 @@ public:
 
     // 공 두 개 사이의 거리 계산 함수
     float distanceTo(const CSphere& other) const {
-        float dx = this->center_x - other.center_x;
-        float dy = this->center_y - other.center_y;
-        float dz = this->center_z - other.center_z;
-
-        float distanceSquared = dx * dx + dy * dy + dz * dz;
-        return sqrt(distanceSquared);
-    }
-
-    bool CSphere::hasIntersected(CSphere& ball) {
-        float radiusSum = M_RADIUS * 2;
-        return this->distanceTo(ball) <= radiusSum;
+        return length(make_float3(m_state->x, m_state->y, m_state->z) -
+            make_float3(other.m_state->x, other.m_state->y, other.m_state->z));
     }
 
-    void hitBy(CSphere& ball)
+    // 물리 코어가 공을 timeDelta 만큼 진행한 뒤, 그 동안의 각속도만큼 회전시킨다.
+    // 미끄러지는 공(draw, follow, english)은 이동 거리와 다르게 돈다.
+    void roll(const BallState& before, float timeDelta)
     {
-        if (this->hasIntersected(ball))
-        {
-            // Get positions and velocities of the two balls
-            D3DXVECTOR3 pos1 = this->getCenter();
-            D3DXVECTOR3 pos2 = ball.getCenter();
-
-            float vx1 = this->getVelocity_X();
-            float vz1 = this->getVelocity_Z();
-            float vx2 = ball.getVelocity_X();
-            float vz2 = ball.getVelocity_Z();
-
-            // Calculate normal and tangent vectors
-            float dx = pos1.x - pos2.x;
-            float dz = pos1.z - pos2.z;
-            float distance = this->distanceTo(ball);
-
-            // Normalize the normal vector
-            float nx = dx / distance;
-            float nz = dz / distance;
-
-            // Tangent vector is perpendicular to the normal vector
-            float tx = -nz;
-            float tz = nx;
-
-            // Project velocities onto the normal and tangent vectors
-            float v1n = nx * vx1 + nz * vz1;
-            float v1t = tx * vx1 + tz * vz1;
-            float v2n = nx * vx2 + nz * vz2;
-            float v2t = tx * vx2 + tz * vz2;
-
-            // Swap normal velocities (elastic collision)
-            float temp = v1n;
-            v1n = v2n;
-            v2n = temp;
-
-            // Convert scalar normal and tangential velocities back to vectors
-            vx1 = v1n * nx + v1t * tx;
-            vz1 = v1n * nz + v1t * tz;
-            vx2 = v2n * nx + v2t * tx;
-            vz2 = v2n * nz + v2t * tz;
-
-            // Set new velocities for the balls
-            this->setPower(vx1, vz1);
-            ball.setPower(vx2, vz2);
-
-            // Separate the balls to prevent sticking
-            float overlap = M_RADIUS * 2 - distance;
-            float correctionX = overlap / 2 * nx;
-            float correctionZ = overlap / 2 * nz;
-
-            this->setCenter(pos1.x + correctionX, pos1.y, pos1.z + correctionZ);
-            ball.setCenter(pos2.x - correctionX, pos2.y, pos2.z - correctionZ);
-        }
-	}
+        if (!m_state->active) return;
 
-	void ballUpdate(float timeDiff) 
-	{
-        if (!this->isActive) return;
-
-		const float TIME_SCALE = 3.3;
-		D3DXVECTOR3 cord = this->getCenter();
-		double vx = abs(this->getVelocity_X());
-		double vz = abs(this->getVelocity_Z());
-
-
-		if(vx > 0.01 || vz > 0.01)
-		{
-			float tX = cord.x + TIME_SCALE*timeDiff*m_velocity_x;
-			float tZ = cord.z + TIME_SCALE*timeDiff*m_velocity_z;
-
-			//correction of position of ball
-			// Please uncomment this part because this correction of ball position is necessary when a ball collides with a wall
-			if(tX >= (4.5 - M_RADIUS))
-				tX = 4.5 - M_RADIUS;
-			else if(tX <=(-4.5 + M_RADIUS))
-				tX = -4.5 + M_RADIUS;
-			else if(tZ <= (-3 + M_RADIUS))
-				tZ = -3 + M_RADIUS;
-			else if(tZ >= (3 - M_RADIUS))
-				tZ = 3 - M_RADIUS;
-			
-			this->setCenter(tX, cord.y, tZ);
-
-		}
-		else { this->setPower(0,0);}
-		//this->setPower(this->getVelocity_X() * DECREASE_RATE, this->getVelocity_Z() * DECREASE_RATE);
-		double rate = 1 -  (1 - DECREASE_RATE)*timeDiff * 400;
-		if(rate < 0 )
-			rate = 0;
-		this->setPower(getVelocity_X() * rate, getVelocity_Z() * rate);
-        float distance = sqrt(m_velocity_x * m_velocity_x + m_velocity_z * m_velocity_z) * TIME_SCALE * timeDiff;
-
-        // 이동 거리와 구의 반지름을 기반으로 회전 각도 계산
-        float angle = distance / M_RADIUS;
-
-        // 속도 벡터에 수직인 회전 축 계산 (x-z 평면에서)
-        D3DXVECTOR3 velocity(m_velocity_x, 0.0f, m_velocity_z);
-        D3DXVECTOR3 up(0.0f, 1.0f, 0.0f); // 월드의 업 벡터
-        D3DXVECTOR3 axis;
-
-        if (D3DXVec3Length(&velocity) == 0.0f)
-        {
-            // 속도가 없으면 회전 없음
-            axis = D3DXVECTOR3(0.0f, 1.0f, 0.0f); // 기본 축
-        }
-        else
-        {
-            // 속도 벡터에 수직인 축 계산
-            D3DXVec3Cross(&axis,&up,&velocity);
-            D3DXVec3Normalize(&axis, &axis);
-        }
+        // 각속도는 프레임 동안 거의 선형으로 변하므로 평균값을 쓴다.
+        float3 omega = (ballSpin(before) + ballSpin(*m_state)) * 0.5f;
 
-        // 회전 행렬 생성
-        D3DXMATRIX rot;
-        D3DXMatrixRotationAxis(&rot, &axis, angle);
+        // R * w가 속도 단위이므로 이동과 같은 timeScale을 곱한다.
+        m_transforms->roll(m_slot, omega, timeDelta * activePhysics().timeScale);
+        syncPosition();
+    }
 
-        // 누적 회전 행렬 업데이트
-        m_rotation = m_rotation * rot;
+	float2 getVelocity() const { return ballVelocity(*m_state); }
 
+	// 중심을 친 것처럼 속도만 주고 회전은 없앤다.
+	void setPower(float vx, float vz)
+	{
+		setBallVelocity(*m_state, make_float2(vx, vz));
+		m_state->wx = m_state->wy = m_state->wz = 0;
 	}
 
-	double getVelocity_X() { return this->m_velocity_x;	}
-	double getVelocity_Z() { return this->m_velocity_z; }
-
-	void setPower(double vx, double vz)
+	// 양자화된 샷 입력(큐 팁 위치 포함)으로 친다. lockstep 상대도 같은 입력을 적용한다.
+	void strike(const ShotInput& input)
 	{
-		this->m_velocity_x = vx;
-		this->m_velocity_z = vz;
+		applyShot(*m_state, input);
 	}
 
     void setCenter(float x, float y, float z)
     {
-        D3DXMATRIX m;
-        center_x = x;	center_y = y;	center_z = z;
-        D3DXMatrixTranslation(&m, x, y, z);
-        setLocalTransform(m);
+        m_state->x = x;	m_state->y = y;	m_state->z = z;
+        syncPosition();
     }
 
     void setColor(D3DXCOLOR color) {
@@ -379,16 +289,19 @@ public:
     }
 
     float getRadius(void)  const { return (float)(M_RADIUS); }
-    const D3DXMATRIX& getLocalTransform(void) const { return m_mLocal; }
-    void setLocalTransform(const D3DXMATRIX& mLocal) { m_mLocal = mLocal; }
     D3DXVECTOR3 getCenter(void) const
     {
-        D3DXVECTOR3 org(center_x, center_y, center_z);
+        D3DXVECTOR3 org(m_state->x, m_state->y, m_state->z);
         return org;
     }
 
 private:
-    D3DXMATRIX              m_mLocal;
+    void syncPosition(void)
+    {
+        if (m_transforms != NULL)
+            m_transforms->setPosition(m_slot, make_float3(m_state->x, m_state->y, m_state->z));
+    }
+
     D3DMATERIAL9            m_mtrl;
     ID3DXMesh* m_pSphereMesh;
     LPDIRECT3DTEXTURE9 m_pTexture;
@@ -457,49 +370,6 @@ public:
     }
 
 
-    bool hasIntersected(CSphere& ball)
-    {
-        float ballX = ball.getCenter().x;
-        float ballZ = ball.getCenter().z;
-
-        // 벽의 경계 
-        float leftBoundary = m_x - (m_width / 2);
-        float rightBoundary = m_x + (m_width / 2);
-        float frontBoundary = m_z - (m_depth / 2);
-        float backBoundary = m_z + (m_depth / 2);
-
-        // 공과 벽의 충돌 여부 확인
-        bool intersectsX = (ballX + ball.getRadius() >= leftBoundary) && (ballX - ball.getRadius() <= rightBoundary);
-        bool intersectsZ = (ballZ + ball.getRadius() >= frontBoundary) && (ballZ - ball.getRadius() <= backBoundary);
-
-        return intersectsX && intersectsZ;
-    }
-
-    void hitBy(CSphere& ball)
-    {
-        if (hasIntersected(ball)) {
-            D3DXVECTOR3 ballVelocity(ball.getVelocity_X(), 0.0f, ball.getVelocity_Z());
-            D3DXVECTOR3 wallNormal;
-
-            if (m_width > m_depth) {
-                // 수평 
-                wallNormal = D3DXVECTOR3(0.0f, 0.0f, (ball.getCenter().z > m_z) ? -1.0f : 1.0f);
-            }
-            else {
-                // 수직 
-                wallNormal = D3DXVECTOR3((ball.getCenter().x > m_x) ? -1.0f : 1.0f, 0.0f, 0.0f);
-            }
-
-            // 반사 벡터 계산
-            D3DXVECTOR3 reflectedVelocity = ballVelocity - 2 * D3DXVec3Dot(&ballVelocity, &wallNormal) * wallNormal;
-
-            ball.setPower(reflectedVelocity.x, reflectedVelocity.z);
-
-            // 벽에 공이 맞은 횟수 카운트
-            cusion_count++;
-        }
-    }
-
     void setPosition(float x, float y, float z)
     {
         D3DXMATRIX m;
@@ -530,13 +400,30 @@ class CPocket {
 private:
     D3DXVECTOR3 m_position; // 구멍의 중심 좌표
     float m_radius;         // 구멍의 반지름
+    ID3DXMesh* m_pMesh;     // create()에서 한 번 만든다
 
 public:
 
-    CPocket() : m_position(D3DXVECTOR3(0.0f, 0.0f, 0.0f)), m_radius(0.0f) {}
+    CPocket() : m_position(D3DXVECTOR3(0.0f, 0.0f, 0.0f)), m_radius(0.0f), m_pMesh(NULL) {}
 
     CPocket(D3DXVECTOR3 position, float radius)
-        : m_position(position), m_radius(radius) {}
+        : m_position(position), m_radius(radius), m_pMesh(NULL) {}
+
+    bool create(IDirect3DDevice9* pDevice)
+    {
+        if (NULL == pDevice)
+            return false;
+        destroy();
+        return SUCCEEDED(D3DXCreateSphere(pDevice, m_radius, 20, 20, &m_pMesh, NULL));
+    }
+
+    void destroy(void)
+    {
+        if (m_pMesh != NULL) {
+            m_pMesh->Release();
+            m_pMesh = NULL;
+        }
+    }
 
     D3DXVECTOR3 getPosition() const {
         return m_position;
@@ -546,16 +433,8 @@ public:
         return m_radius;
     }
 
-    bool isBallInPocket(const CSphere& ball) const {
-        D3DXVECTOR3 ballPos = ball.getCenter();
-        float distanceSquared =
-            (ballPos.x - m_position.x) * (ballPos.x - m_position.x) +
-            (ballPos.z - m_position.z) * (ballPos.z - m_position.z);
-        return distanceSquared <= (m_radius * m_radius);
-    }
-
     void draw(IDirect3DDevice9* pDevice, const D3DXMATRIX& mWorld) const {
-        if (!pDevice) return;
+        if (!pDevice || !m_pMesh) return;
 
         D3DXVECTOR3 worldPos = getTransformedPosition(mWorld);
         D3DXMATRIX pocketTransform;
@@ -571,11 +450,7 @@ public:
         mtrl.Ambient = D3DXCOLOR(0, 0, 0, 1);
         pDevice->SetMaterial(&mtrl);
 
-        ID3DXMesh* pocketMesh = NULL;
-        if (SUCCEEDED(D3DXCreateSphere(pDevice, m_radius, 20, 20, &pocketMesh, NULL))) {
-            pocketMesh->DrawSubset(0);
-            pocketMesh->Release();
-        }
+        m_pMesh->DrawSubset(0);
     }
     // 포켓의 월드 좌표를 계산
     D3DXVECTOR3 getTransformedPosition(const D3DXMATRIX& worldMatrix) const {
@@ -597,16 +472,8 @@ public:
 };
 
 
-// 전역 변수에 pockets 추가
-const int NUM_POCKETS = 6;
-CPocket pockets[NUM_POCKETS] = {
-    CPocket(D3DXVECTOR3(-4.4f, 0.1f, 2.9f), 0.3f),  // 상단 왼쪽
-    CPocket(D3DXVECTOR3(0.0f, 0.1f, 3.0f), 0.3f),   // 상단 중앙
-    CPocket(D3DXVECTOR3(4.4f, 0.1f, 2.9f), 0.3f),   // 상단 오른쪽
-    CPocket(D3DXVECTOR3(-4.4f, 0.1f, -2.9f), 0.3f), // 하단 왼쪽
-    CPocket(D3DXVECTOR3(0.0f, 0.1f, -3.0f), 0.3f),  // 하단 중앙
-    CPocket(D3DXVECTOR3(4.4f, 0.1f, -2.9f), 0.3f)   // 하단 오른쪽
-};
+// 전역 변수에 pockets 추가 (위치는 Setup에서 activeTable()의 포켓으로 설정)
+CPocket pockets[NUM_POCKETS];
 
 
 // -----------------------------------------------------------------------------
@@ -713,6 +580,127 @@ private:
 //    }
 //};
 
+// -----------------------------------------------------------------------------
+// 물리 사건 listener들
+// -----------------------------------------------------------------------------
+
+// 샷 하나 동안의 충돌, 쿠션, 포켓 수를 모아 샷이 끝나면 한 줄로 정리한다.
+class CShotTelemetry : public CEventListener {
+public:
+    CShotTelemetry(void) { reset(); }
+
+    void reset(void)
+    {
+        m_contacts = m_cushions = m_pocketed = 0;
+        m_hardest = 0.0f;
+        m_text[0] = '\0';
+    }
+
+    virtual void onEvent(const PhysicsEvent& event)
+    {
+        switch (event.type) {
+        case EVENT_SHOT_STARTED:
+            m_contacts = m_cushions = m_pocketed = 0;
+            m_hardest = 0.0f;
+            break;
+        case EVENT_BALL_CONTACT:
+            m_contacts++;
+            if (event.speed > m_hardest) m_hardest = event.speed;
+            break;
+        case EVENT_CUSHION_HIT:
+            m_cushions++;
+            break;
+        case EVENT_POCKETED:
+            m_pocketed++;
+            break;
+        case EVENT_ALL_STOPPED:
+            sprintf(m_text, "last shot : %d contact(s) (hardest %.2f), %d cushion(s), %d ball(s) in",
+                m_contacts, m_hardest, m_cushions, m_pocketed);
+            break;
+        default:
+            break;
+        }
+    }
+
+    const char* text(void) const { return m_text; }
+
+private:
+    int   m_contacts, m_cushions, m_pocketed;
+    float m_hardest;
+    char  m_text[128];
+};
+
+// 공이 포켓에 들어가면 시스템 소리를 낸다.
+class CAudioCues : public CEventListener {
+public:
+    virtual void onEvent(const PhysicsEvent& event)
+    {
+        if (event.type == EVENT_POCKETED) {
+            ::PlaySound(TEXT("SystemAsterisk"), NULL, SND_ALIAS | SND_ASYNC | SND_NODEFAULT);
+        }
+    }
+};
+
+// frame, 샷, what-if 시뮬레이션마다의 heap 할당을 센다 (ALLOC_TRACKING 빌드에서만 값이 있다).
+// 처음 몇 frame이 지난 뒤에는 frame 안에서 할당이 없어야 한다.
+const int ALLOC_WARMUP_FRAMES = 60;
+
+class CAllocAccounting : public CEventListener {
+public:
+    CAllocAccounting(void) : m_frames(0)
+    {
+        m_frame.count = m_frame.bytes = 0;
+        m_shot = m_simulation = m_frame;
+        m_text[0] = '\0';
+    }
+
+    void beginFrame(void) { m_frameWatch.begin(); }
+
+    void endFrame(void)
+    {
+        m_frame = m_frameWatch.delta();
+        if (++m_frames > ALLOC_WARMUP_FRAMES)
+            m_frameWatch.expectNone("frame");
+        format();
+    }
+
+    void recordSimulation(const AllocStats& delta) { m_simulation = delta; }
+
+    virtual void onEvent(const PhysicsEvent& event)
+    {
+        if (event.type == EVENT_SHOT_STARTED)
+            m_shotWatch.begin();
+        else if (event.type == EVENT_ALL_STOPPED)
+            m_shot = m_shotWatch.delta();
+    }
+
+    const char* text(void) const { return m_text; }
+
+private:
+    void format(void)
+    {
+        sprintf(m_text, "alloc : frame %llu (%llu B), last shot %llu (%llu B), what-if %llu (%llu B)",
+            m_frame.count, m_frame.bytes, m_shot.count, m_shot.bytes,
+            m_simulation.count, m_simulation.bytes);
+    }
+
+    CAllocWatch m_frameWatch;
+    CAllocWatch m_shotWatch;
+    AllocStats  m_frame;
+    AllocStats  m_shot;
+    AllocStats  m_simulation;
+    int         m_frames;
+    char        m_text[160];
+};
+
+// 안정 상태에서 할당이 생기면 debugger 출력으로 알린다.
+void reportSteadyStateAlloc(const char* where, const AllocStats& delta)
+{
+    char message[128];
+    sprintf(message, "steady-state allocation in %s: %llu allocation(s), %llu byte(s)\n",
+        where, delta.count, delta.bytes);
+    ::OutputDebugStringA(message);
+}
 
 // -----------------------------------------------------------------------------
 // Global variables
@@ -722,21 +710,53 @@ CWall	g_legowall[4];
 CSphere	g_sphere[16];
 CSphere	g_target_blueball;
 CLight	g_light;
+CBallTransforms g_ballTransforms;   // 공마다의 방향과 world 행렬 (조준 공은 마지막 slot)
+
+TableState   g_table;       // 물리 코어가 진행하는 공 상태 (g_sphere가 연결됨)
+CZobristHash g_zobrist;     // g_table의 hash, 매 frame 바뀐 공만 갱신
+BallState    g_hashedBalls[NUM_BALLS]; // g_zobrist에 반영된 공 상태
+RuleState    g_hashedRules; // g_zobrist에 반영된 규칙 값
+CShotCache   g_shotCache;   // what-if 조회 결과
+CAimGuide    g_aimGuide;    // 조준 경로 예측
+CThreadPool  g_physicsPool; // island를 나누어 진행할 worker
+CIslandStepper g_stepper;   // 접촉 island 단위 진행 (step 사이 warm start 유지)
+
+// 조준 경로 overlay (마우스가 움직일 때만 다시 만든다)
+struct GuideVertex {
+    float x, y, z;
+    D3DCOLOR color;
+};
+#define GUIDE_FVF (D3DFVF_XYZ | D3DFVF_DIFFUSE)
+const int MAX_GUIDE_VERTICES = 3 * 2 * (AIM_PATH_MAX_POINTS - 1) + 32; // 세 경로 + 첫 충돌 위치의 원
+GuideVertex g_guideVertices[MAX_GUIDE_VERTICES];
+int g_numGuideVertices = 0;
 
 double g_camera_pos[3] = { 0.0, 5.0, -8.0 };
 
-// 게임 진행을 위한 변수들
-bool shot_last; // true: 직전 frame에서 shot이 진행 중이었음, false: 직전 frame에서 샷이 진행 중이지 않았음.
-bool shot_now; // true: 현재 frame에서 shot이 진행 중, false: 현재 frame에서 샷이 진행 중이지 않음.
-bool turn; // true: player 1, false: player 2
-bool break_shot; // 최초의 shot인지 여부
-bool free_shot; // 다음 샷 전에 free shot을 수행할지 여부
-bool open; // true: 플레이어별로 공이 배정되지 않음, false: 공이 배정됨.
-bool solid_in, stripe_in, white_in, black_in; // 하나의 샷 동안 pocket에 들어간 공의 종류
-int solid_num, stripe_num;
-bool group; // 현재 쳐야 하는 공의 그룹, ture: solid, false: stripe
-int win; // 승자 저장 0: 무승부, 1: player 1 승, 2: player 2 승
-bool select_group; // 다음 샷을 시작하기 전 select를 해야함을 알려줌.
+// 게임 진행: 물리 사건을 event bus로 받아 규칙, telemetry, 소리가 각자 처리한다.
+CEventBus      g_eventBus;
+CRuleEngine    g_rules;
+CShotTelemetry g_telemetry;
+CAudioCues     g_audio;
+CAllocAccounting g_allocs;
+
+// lockstep step 번호와 step마다의 상태 checksum (DETERMINISTIC_PHYSICS 빌드에서 진행)
+CFixedStepClock g_lockstepClock;
+CDesyncDetector g_desync;
+
+// 네트워크 대전 / 관전 (명령줄로 켠다). 켜져 있으면 공 진행과 입력은 g_net이 맡는다.
+CUdpTransport g_udp;
+CNetSession   g_net;
+NetRole       g_netRole = NET_OFFLINE;
+char          g_netHost[256] = "";
+uint16_t      g_netPort = 0;
+
+// 중계 overlay / 관전 도구가 읽는 공유 메모리 상태 (frame마다 발행)
+CStateShare   g_stateShare;
+
+// 일시 정지 / 느리게 / 빠르게 (P, PgUp, PgDn, Home). g_clock은 frame마다 쓴 실제 시간을 잰다.
+CSimTimeController g_timeControl;
+CMonotonicClock    g_clock;
 
 // 텍스트 박스들
 RECT turn_rect = { 10, 10, 300, 50 };     // 첫 번째 박스 (위치 변경 없음)
@@ -744,120 +764,194 @@ RECT group_rect = { 10, 50, 300, 90 };    // 두 번째 박스 (아래로 이동
 RECT win_rect = { 10, 90, 300, 130 };     // 세 번째 박스 (아래로 이동)
 RECT select_rect = { 10, 130, 1000, 170 }; // 네 번째 박스 (아래로 이동)
 RECT free_shot_rect = { 10, 170, 300, 210 }; // 네 번째 박스 (아래로 이동)
+RECT preview_rect = { 10, 210, 1000, 250 }; // 샷 미리보기 결과
+
+RECT tip_rect = { 10, 250, 1000, 290 }; // 큐 팁 위치
+RECT telemetry_rect = { 10, 290, 1000, 330 }; // 마지막 샷 기록
+RECT alloc_rect = { 10, 330, 1000, 370 }; // heap 할당 계수
+RECT lockstep_rect = { 10, 370, 1000, 410 }; // lockstep step과 checksum
+RECT net_rect = { 10, 410, 1000, 450 }; // 네트워크 상태
+RECT time_rect = { 10, 450, 1000, 490 }; // 시뮬레이션 속도
+
+char preview_text[256] = ""; // 마지막 what-if 조회 결과
+
+// 큐 팁 위치 (반지름 비율, 방향키로 조절). side: 오른쪽 +, height: 위쪽 +
+const float TIP_STEP = 0.1f;
+float g_tipSide = 0.0f;
+float g_tipHeight = 0.0f;
 
 // -----------------------------------------------------------------------------
 // Functions
 // -----------------------------------------------------------------------------
 
-// 파울 여부 판단
-// 일반적인 foul과 최초 샷의 경우에만 해당하는 foul 구현
-// 게임의 승패를 판단함. 1: player 1 승리, 2: player 2 승리
-int result() {
-    if (open) {
-        if (turn) {
-            return 2;
-        }
-        else {
-            return 1;
+// 마지막 동기화 이후 바뀐 공과 규칙 값만 hash에 반영한다.
+void syncTableHash() {
+    for (int i = 0; i < NUM_BALLS; i++) {
+        const BallState& ball = g_table.balls[i];
+        const BallState& hashed = g_hashedBalls[i];
+        if (ball.x != hashed.x || ball.z != hashed.z || ball.active != hashed.active) {
+            g_zobrist.updateBall(i, hashed, ball);
+            g_hashedBalls[i] = ball;
         }
     }
-    else {
-        if (turn) {
-            if (group) {
-                if (solid_num == 0 && !stripe_in && !white_in) {
-                    return 1;
-                }
-                else {
-                    return 2;
-                }
-            }
-            else {
-                if (stripe_num == 0 && !solid_in && !white_in) {
-                    return 1;
-                }
-                else {
-                    return 2;
-                }
-            }
-        }
-        else {
-            if (group) {
-                if (solid_num == 0 && !stripe_in && !white_in) {
-                    return 2;
-                }
-                else {
-                    return 1;
-                }
-            }
-            else {
-                if (stripe_num == 0 && !solid_in && !white_in) {
-                    return 2;
-                }
-                else {
-                    return 1;
-                }
-            }
-        }
+    const RuleState& rules = g_rules.rules();
+    g_zobrist.updateRules(g_hashedRules, rules);
+    g_hashedRules = rules;
+}
+
+// 흰 공에서 파란 공 방향/거리로, 현재 큐 팁 위치로 샷을 쳤을 때의 결과를 조회한다.
+// 같은 배치에서 같은 샷을 다시 물으면 시뮬레이션 없이 cache에서 답한다.
+ShotOutcome previewShot(float aim, float power) {
+    syncTableHash();
+
+    // 실제 샷과 같은 양자화를 거친 값으로 시뮬레이션한다.
+    float side, height;
+    decodeShot(encodeShot(0, aim, power, g_tipSide, g_tipHeight), &aim, &power, &side, &height);
+    ShotKey key = CShotCache::makeKey(g_zobrist.value(), aim, power, side, height);
+    return g_shotCache.lookupOrSimulate(key, [aim, power, side, height]() {
+        CAllocWatch watch;
+        TableState state = g_table;
+        state.rules = g_rules.rules();
+        ShotOutcome outcome = simulateShot(state, aim, power, side, height);
+        g_allocs.recordSimulation(watch.delta());
+        return outcome;
+    });
+}
+
+void addGuideLine(float x0, float z0, float x1, float z1, D3DCOLOR color) {
+    if (g_numGuideVertices + 2 > MAX_GUIDE_VERTICES) return;
+    const float y = 0.02f; // 바닥 바로 위
+    GuideVertex v0 = { x0, y, z0, color };
+    GuideVertex v1 = { x1, y, z1, color };
+    g_guideVertices[g_numGuideVertices++] = v0;
+    g_guideVertices[g_numGuideVertices++] = v1;
+}
+
+void addGuidePath(const AimPath& path, D3DCOLOR color) {
+    for (int i = 1; i < path.count; i++) {
+        addGuideLine(path.x[i - 1], path.z[i - 1], path.x[i], path.z[i], color);
     }
 }
 
-// shot의 foul 여부를 판단함. break_shot와 cusion count를 사용함.
-bool foul() {
-    if (break_shot) {
-        if (!solid_in && !stripe_in) {
-            if (cusion_count < 4) {
-                return true;
-            }
+// 흰 공에서 파란 공 방향/거리로 쳤을 때의 경로를 다시 예측해 overlay를 만든다.
+void updateAimGuide() {
+    g_numGuideVertices = 0;
+    if (g_rules.shotInProgress() || g_rules.rules().free_shot || !g_sphere[0].isActiveBall()) return;
+
+    syncTableHash();
+    g_aimGuide.setTable(g_table.balls, NUM_BALLS, g_zobrist.value());
+
+    D3DXVECTOR3 targetpos = g_target_blueball.getCenter();
+    D3DXVECTOR3 whitepos = g_sphere[0].getCenter();
+    float dx = targetpos.x - whitepos.x;
+    float dz = targetpos.z - whitepos.z;
+    const AimPrediction& pred = g_aimGuide.predict(atan2f(dz, dx), sqrtf(dx * dx + dz * dz), g_tipSide, g_tipHeight);
+
+    addGuidePath(pred.cue, D3DCOLOR_XRGB(255, 255, 255));
+    if (pred.hitBall >= 0) {
+        // 첫 충돌 위치의 큐볼 윤곽
+        const int SEGMENTS = 16;
+        for (int i = 0; i < SEGMENTS; i++) {
+            float a0 = (float)(2 * PI * i / SEGMENTS);
+            float a1 = (float)(2 * PI * (i + 1) / SEGMENTS);
+            addGuideLine(pred.ghostX + (float)M_RADIUS * cosf(a0), pred.ghostZ + (float)M_RADIUS * sinf(a0),
+                pred.ghostX + (float)M_RADIUS * cosf(a1), pred.ghostZ + (float)M_RADIUS * sinf(a1),
+                D3DCOLOR_XRGB(255, 255, 255));
         }
+        addGuidePath(pred.cueAfter, D3DCOLOR_XRGB(160, 160, 160));
+        addGuidePath(pred.object, D3DCOLOR_XRGB(255, 255, 0));
     }
-    if (white_in) {
-        return true;
+}
+
+void drawAimGuide() {
+    if (g_numGuideVertices == 0) return;
+
+    Device->SetTransform(D3DTS_WORLD, &g_mWorld);
+    Device->SetRenderState(D3DRS_LIGHTING, FALSE);
+    Device->SetTexture(0, NULL);
+    Device->SetFVF(GUIDE_FVF);
+    Device->DrawPrimitiveUP(D3DPT_LINELIST, g_numGuideVertices / 2, g_guideVertices, sizeof(GuideVertex));
+    Device->SetRenderState(D3DRS_LIGHTING, TRUE);
+}
+
+// 테이블 정의 파일을 읽어 물리 코어의 현재 테이블로 만든다. 공 배치는 다음 Setup에서 바뀐다.
+bool selectTable(const char* path) {
+    TableLayout layout;
+    char error[256];
+    if (!loadTableLayout(path, &layout, error, sizeof(error))) {
+        ::MessageBox(0, error, "Table", MB_OK);
+        return false;
+    }
+    setActiveTable(layout);
+    return true;
+}
+
+// 조정한 물리 계수 파일이 있으면 읽는다. 없으면 기본 계수를 그대로 쓴다.
+bool selectPhysics(const char* path) {
+    FILE* file = fopen(path, "r");
+    if (file == NULL)
+        return false;
+    fclose(file);
+
+    PhysicsParams params;
+    char error[256];
+    if (!loadPhysicsParams(path, &params, error, sizeof(error))) {
+        ::MessageBox(0, error, "Physics", MB_OK);
+        return false;
     }
-    return false;
+    setActivePhysics(params);
+    return true;
 }
 
-// 다음 샷에서의 turn에 관한 값을 할당.
-void next_shot() { 
-    if (foul()) {
-        turn = !turn;
-        group = !group;
-        free_shot = true; // free_shot 수행 이후엔 다시 false가 되어야 함.
+// 명령줄 앞의 네트워크 옵션을 읽어 g_netRole, g_netHost, g_netPort에 둔다.
+// 나머지(테이블 정의 파일)의 시작을 돌려준다.
+const char* parseNetOptions(const char* cmdLine) {
+    if (cmdLine == NULL)
+        return NULL;
+
+    static char rest[256];
+    char option[16] = "";
+    char host[256] = "";
+    unsigned port = 0;
+    int optionEnd = 0;
+    int argsEnd = 0;
+    if (sscanf(cmdLine, " %15s%n", option, &optionEnd) != 1)
+        return cmdLine;
+
+    const char* args = cmdLine + optionEnd;
+    if (strcmp(option, "-host") == 0 && sscanf(args, " %u%n", &port, &argsEnd) == 1) {
+        g_netRole = NET_HOST;
+        strcpy(g_netHost, "localhost");
+    }
+    else if ((strcmp(option, "-join") == 0 || strcmp(option, "-watch") == 0) &&
+        sscanf(args, " %255s %u%n", host, &port, &argsEnd) == 2) {
+        g_netRole = strcmp(option, "-join") == 0 ? NET_PLAYER : NET_SPECTATOR;
+        strcpy(g_netHost, host);
     }
     else {
-        if (stripe_in || solid_in) {
-            if (open) {
-                // 플레이어가 쳐야만 하는 공의 종류가 없기에 공이 들어가기만 하면, 턴 전환이 일어나지 않음
-                // break_shot 직후에는 open 상태여야 하기 때문에 group의 할당을 하지 않음.
-                if (!break_shot) {
-                    if (solid_in && stripe_in) {
-                        select_group = true;
-                    }
-                    else {
-                        group = solid_in ? true : false;
-                        open = false;
-                    }
-                }
-            }
-            else {
-                // 플레이어가 쳐야하는 공과 들어간 공의 종류가 다르면 턴 전환이 발생함
-                if ((solid_in && !stripe_in) && !group ||
-                    (!solid_in && stripe_in) && group) {
-                    turn = !turn;
-                    group = !group;
-                }
-            }
-        }
-        // foul이 없는 상태에서 어떤 공도 들어가지 않으면 턴이 전환됨
-        else {
-            turn = !turn;
-            group = !group;
-        }
+        return cmdLine;
     }
-    // 위의 판단 이후, 다음 shot 직후의 판단을 위한 초기화
-    cusion_count = 0;
-    solid_in = stripe_in = white_in = black_in = false;
-    break_shot = false;
-}; 
+    g_netPort = (uint16_t)port;
+
+    // 남은 부분의 앞 공백을 건너뛴다.
+    const char* p = args + argsEnd;
+    while (*p == ' ' || *p == '\t') p++;
+    strncpy(rest, p, sizeof(rest) - 1);
+    rest[sizeof(rest) - 1] = '\0';
+    return rest;
+}
+
+// Setup으로 공을 놓은 뒤 부른다. host는 이 배치로 시작하고, 붙는 쪽은 host의 배치를 받는다.
+bool startNetwork(void) {
+    g_net.attach(g_table.balls, &g_stepper, &g_eventBus, &g_rules);
+    if (g_netRole == NET_HOST)
+        return g_udp.open(g_netPort) && g_net.host(&g_udp);
+
+    if (!g_udp.open(0))
+        return false;
+    int hostPeer = g_udp.addPeer(g_netHost, g_netPort);
+    return hostPeer >= 0 && g_net.join(&g_udp, hostPeer, g_netRole == NET_PLAYER);
+}
 
 void destroyAllLegoBlock(void)
 {
@@ -872,86 +966,104 @@ bool Setup()
     D3DXMatrixIdentity(&g_mView);
     D3DXMatrixIdentity(&g_mProj);
 
-    // 게임 진행을 위한 값 초기화
-    shot_last = false;
-    shot_now = false;
-    turn = true;
-    break_shot = true;
-    free_shot = false;
-    cusion_count = 0;
-    open = true;
-    solid_in = stripe_in = white_in = black_in = false;
-    solid_num = stripe_num = 7;
-    win = 0;
-    select_group = false;
+    const TableLayout& table = activeTable();
 
     // create plane and set the position
-    if (false == g_legoPlane.create(Device, -1, -1, 9, 0.03f, 6, d3d::GREEN)) return false;
-    g_legoPlane.setPosition(0.0f, -0.0006f / 5, 0.0f);
+    if (false == g_legoPlane.create(Device, -1, -1, table.maxX - table.minX, 0.03f, table.maxZ - table.minZ, d3d::GREEN)) return false;
+    g_legoPlane.setPosition((table.minX + table.maxX) / 2, -0.0006f / 5, (table.minZ + table.maxZ) / 2);
 	// create walls and set the position. note that there are four walls
-    // 상단 벽
-    if (false == g_legowall[0].create(Device, -1, -1, 9.5f, 0.7f, 0.5f, d3d::DARKRED)) return false;
-    g_legowall[0].setPosition(0.0f, 0.12f, 3.25f);
-
-    // 하단 벽
-    if (false == g_legowall[1].create(Device, -1, -1, 9.5f, 0.7f, 0.5f, d3d::DARKRED)) return false;
-    g_legowall[1].setPosition(0.0f, 0.12f, -3.25f);
-
-    // 오른쪽 벽
-    if (false == g_legowall[2].create(Device, -1, -1, 0.25f, 0.7f, 6.0f, d3d::DARKRED)) return false;
-    g_legowall[2].setPosition(4.625f, 0.12f, 0.0f);
-
-    // 왼쪽 벽
-    if (false == g_legowall[3].create(Device, -1, -1, 0.25f, 0.7f, 6.0f, d3d::DARKRED)) return false;
-    g_legowall[3].setPosition(-4.625f, 0.12f, 0.0f);
-
-    std::vector<int> availableIndices;
-    for (int pos = 1; pos < 16; pos++) {
-        if (pos != 5) { // 8번 공은 spherePos[5]에 고정
-            availableIndices.push_back(pos);
+    // 상단, 하단, 오른쪽, 왼쪽 벽
+    for (i = 0; i < NUM_WALLS; i++) {
+        const WallBox& wall = table.walls[i];
+        if (false == g_legowall[i].create(Device, -1, -1, wall.width, 0.7f, wall.depth, d3d::DARKRED)) return false;
+        g_legowall[i].setPosition(wall.x, 0.12f, wall.z);
+    }
+
+    for (i = 0; i < table.numPockets; i++) {
+        pockets[i] = CPocket(D3DXVECTOR3(table.pockets[i].x, 0.1f, table.pockets[i].z), table.pockets[i].radius);
+        if (false == pockets[i].create(Device)) return false;
+    }
+
+    // 고정된 공이 없는 rack 자리만 섞는다.
+    int availableIndices[TABLE_MAX_RACK];
+    int numAvailable = 0;
+    for (int pos = 0; pos < table.rackCount; pos++) {
+        if (table.rackBall[pos] == 0) {
+            availableIndices[numAvailable++] = pos;
         }
     }
 
     // 인덱스 섞기
-    std::random_shuffle(availableIndices.begin(), availableIndices.end());
+    std::random_shuffle(availableIndices, availableIndices + numAvailable);
 
 	// create four balls and set the position
 	for (i=0;i<16;i++) {
         char textureFileName[256];
         sprintf(textureFileName, "image\\Ball%d.jpg", i);
         if (false == g_sphere[i].create(Device, textureFileName)) return false;
+        g_sphere[i].bindState(&g_table.balls[i]);
+        g_sphere[i].bindTransform(&g_ballTransforms, i);
+
+        // 0번 공(큐볼)은 cue 자리, rack에 고정된 공은 그 자리에 놓는다.
+        int posIndex = -1;
+        for (int pos = 0; pos < table.rackCount; pos++) {
+            if (table.rackBall[pos] == i) posIndex = pos;
+        }
 
         float x, z;
         if (i == 0) {
-            // 0번 공(큐볼)은 spherePos[0]에 고정
-            x = spherePos[0][0];
-            z = spherePos[0][1];
+            x = table.cueX;
+            z = table.cueZ;
         }
-        else if (i == 8) {
-            // 8번 공은 spherePos[5]에 고정
-            x = spherePos[5][0];
-            z = spherePos[5][1];
+        else if (i > table.rackCount) {
+            // 이 테이블에서 쓰지 않는 공
+            g_sphere[i].setPower(0, 0);
+            pocketBall(g_table.balls[i]);
+            continue;
+        }
+        else if (posIndex >= 0) {
+            x = table.rackX[posIndex];
+            z = table.rackZ[posIndex];
         }
         else {
             // 나머지 공들은 랜덤하게 섞인 인덱스에서 위치 선택
-            if (availableIndices.empty()) {
+            if (numAvailable == 0) {
                 MessageBox(NULL, "Not enough positions to assign all balls.", "Error", MB_OK);
                 return false;
             }
-            int posIndex = availableIndices.back();
-            availableIndices.pop_back();
-            x = spherePos[posIndex][0];
-            z = spherePos[posIndex][1];
+            posIndex = availableIndices[--numAvailable];
+            x = table.rackX[posIndex];
+            z = table.rackZ[posIndex];
         }
 
         // 공의 위치 설정
+        g_sphere[i].activate();
         g_sphere[i].setCenter(x, (float)M_RADIUS, z);
         g_sphere[i].setPower(0, 0);
         g_sphere[i].rotate(90.0f, D3DXVECTOR3(0.0f, 0.0f, 1.0f));
 	}
+
+    // 게임 진행을 위한 값 초기화 (테이블에 올라간 공의 수를 센다)
+    g_eventBus.clear();
+    g_rules.reset(g_table.balls, NUM_BALLS);
+    g_telemetry.reset();
+
+    g_table.rules = g_rules.rules();
+    g_hashedRules = g_table.rules;
+    memcpy(g_hashedBalls, g_table.balls, sizeof(g_hashedBalls));
+    g_zobrist.reset(g_table);
+    g_shotCache.clear();
+    g_stepper.setPool(&g_physicsPool);
+    g_stepper.reset();
+    g_lockstepClock.reset();
+    g_desync.reset();
+    g_aimGuide.invalidate();
+    g_numGuideVertices = 0;
+    preview_text[0] = '\0';
 	
 	// create blue ball for set direction
     if (false == g_target_blueball.create(Device, NULL, d3d::BLUE)) return false;
+    g_target_blueball.bindTransform(&g_ballTransforms, NUM_BALLS);
     g_target_blueball.setCenter(.0f, (float)M_RADIUS, .0f);
 
     // light setting 
@@ -1008,115 +1120,122 @@ void Cleanup(void)
     for (int i = 0; i < 4; i++) {
         g_legowall[i].destroy();
     }
+    for (int i = 0; i < 16; i++) {
+        g_sphere[i].destroy();
+    }
+    g_target_blueball.destroy();
+    for (int i = 0; i < NUM_POCKETS; i++) {
+        pockets[i].destroy();
+    }
     destroyAllLegoBlock();
     g_light.destroy();
     d3d::CleanupFont();     //폰트 정리
 }
 
+// 공을 timeDelta 만큼 진행하고 그 동안 쌓인 사건을 규칙 등에 넘긴다. 진행한 시간을 돌려준다.
+// before는 NUM_BALLS칸의 작업 공간이다.
+float stepSimulation(float timeDelta, BallState* before) {
+    // 물리 사건은 step 동안 event bus에 쌓인다.
+    memcpy(before, g_table.balls, sizeof(BallState) * NUM_BALLS);
+    bool shot_was_running = g_rules.shotInProgress();
+
+    float simulated;
+    if (g_net.active()) {
+        // 네트워크: 받은 입력을 적용하고(필요하면 되돌려 다시 진행) LOCKSTEP_DT로 진행한다.
+        // 사건은 session이 step마다 넘긴다.
+        g_net.poll();
+        int steps = g_lockstepClock.advance(timeDelta);
+        g_net.advance(steps);
+        simulated = steps * LOCKSTEP_DT;
+    }
+    else {
+#ifdef DETERMINISTIC_PHYSICS
+        // lockstep: LOCKSTEP_DT 간격으로만 진행하고 step마다 checksum을 남긴다.
+        int steps = g_lockstepClock.advance(timeDelta);
+        for (int s = 0; s < steps; s++) {
+            g_stepper.step(g_table.balls, NUM_BALLS, LOCKSTEP_DT, NULL);
+            g_desync.record(g_lockstepClock.step(), stateChecksum(g_table.balls, NUM_BALLS));
+            g_lockstepClock.finishStep();
+        }
+        simulated = steps * LOCKSTEP_DT;
+#else
+        g_stepper.step(g_table.balls, NUM_BALLS, timeDelta, NULL);
+        simulated = timeDelta;
+#endif
+    }
+    for (int i = 0; i < 16; i++) {
+        g_sphere[i].roll(before[i], simulated);
+    }
+
+    // 쌓인 사건을 규칙, telemetry, 소리에 넘긴다. 모든 공이 멈춘 사건에서
+    // 게임의 종료, 파울 여부, 턴의 전환, 공의 그룹 할당이 판단된다.
+    g_eventBus.dispatch();
+    if (shot_was_running && !g_rules.shotInProgress()) {
+        updateAimGuide();
+    }
+    return simulated;
+}
+
 // timeDelta represents the time between the current image frame and the last image frame.
 // the distance of moving balls should be "velocity * timeDelta"
 bool Display(float timeDelta) {
     if (Device) {
+        g_allocs.beginFrame();
         Device->Clear(0, 0, D3DCLEAR_TARGET | D3DCLEAR_ZBUFFER, 0x00afafaf, 1.0f, 0);
         Device->BeginScene();
 
-        // 각 샷이 종료될 때마다 게임의 종료, 파울 여부, 턴의 전환, 공의 그룹 할당을 판단한다.
-        // 현재 프레임의 shot 진행 여부 판단.
-
-        shot_now = false;
-        for (int i = 0; i < 16; i++) {
-            if (g_sphere[i].isActiveBall() && g_sphere[i].getVelocity_X() != 0 && g_sphere[i].getVelocity_Z() != 0) {
-                shot_now = true;
-                break;
-            }
-        }
-
-        // free ball을 놓는 과정에서 공이 구멍에 들어가게 되면 free_shot이 다시 주어짐
-        // shot 자체는 진행중이지 않은 상황(shot_last와 shot_now 모두 false로 유지되는 상황) 임에도 foul이기 떄문에 턴이 넘어가고 다시 free_shot이 주어짐.
-        if (!shot_last && !shot_now && white_in && !free_shot) {
-            free_shot = true;
-            turn = !turn;
-            group = !group;
+        // Ball updates, pocket / wall / ball-to-ball collisions
+        // 빠르게 돌릴 때는 여러 조각을 진행하고 화면은 이 frame에 한 번만 그린다.
+        // 네트워크 대전 중에는 상대와 같은 속도로만 진행하므로 시간 조절을 쓰지 않는다.
+        BallState before[NUM_BALLS];
+        if (g_net.active()) {
+            stepSimulation(timeDelta, before);
         }
-
-        // 공이 멈춘 직후 의 frame에서 직전의 shot의 값을 통해 게임의 진행 판단.
-        if (shot_last && !shot_now) { 
-            // 게임의 종료 여부를 판단
-            if (black_in) { 
-                win = result();
-            }
-            else { // 종료되지 않았다면
-                next_shot();
-            }
+        else if (g_timeControl.instant() && g_rules.shotInProgress()) {
+            // 즉시: 샷이 끝나거나 이 frame에 쓸 실제 시간이 다할 때까지 진행한다.
+            double deadline = g_clock.seconds() + SIM_INSTANT_BUDGET;
+            do {
+                stepSimulation(SIM_MAX_CHUNK, before);
+            } while (g_rules.shotInProgress() && g_clock.seconds() < deadline);
         }
-
-        // 다음 frame의 샷 진행 여부를 update한다.
-        shot_last = shot_now;
-
-        // Ball updates and pocket collision
-        for (int i = 0; i < 16; i++) {
-            if (!g_sphere[i].isActiveBall()) continue; // 비활성화된 공 건너뛰기
-
-            for (const auto& pocket : pockets) {
-                if (pocket.isBallInPocket(g_sphere[i])) {
-                    g_sphere[i].deactivate(); // 공 비활성화
-                    g_sphere[i].setCenter(-999.0f, -999.0f, -999.0f); // 물리적으로 접근 불가능한 위치
-                    g_sphere[i].setPower(0, 0); // 속도 제거
-
-                    // i 값에 따라서 white_in, black_in, solid_in, stripe_in에 값을 할당한다.
-                    if (i == 0) {
-                        white_in = true;
-                    }
-                    else if (0 < i && i < 8) {
-                        solid_in = true;
-                        solid_num--;
-                    }
-                    else if (i == 8) {
-                        black_in = true;
-                    }
-                    else {
-                        stripe_in = true;
-                        stripe_num--;
-                    }
-
-                    break; // 더 이상 처리할 필요 없음
-                }
-            }
-
-            g_sphere[i].ballUpdate(timeDelta);
-
-            for (int j = 0; j < 4; j++) {
-                g_legowall[j].hitBy(g_sphere[i]);
-            }
+        else {
+            // 한 frame이 SIM_FRAME_BUDGET을 넘기면 남은 조각은 버린다 (그만큼 느리게 보인다).
+            float chunk;
+            int chunks = splitSimTime(g_timeControl.frameBudget(timeDelta), &chunk);
+            double deadline = g_clock.seconds() + SIM_FRAME_BUDGET;
+            for (int c = 0; c < chunks && (c == 0 || g_clock.seconds() < deadline); c++)
+                stepSimulation(chunk, before);
         }
+        syncTableHash();
 
-        // Ball-to-ball collisions
-        for (int i = 0; i < 16; i++) {
-            for (int j = i + 1; j < 16; j++) {
-                g_sphere[i].hitBy(g_sphere[j]);
-            }
-        }
+        const RuleState& rules = g_rules.rules();
+        g_stateShare.publish(g_table.balls, rules, g_net.active() ? g_net.step() : g_lockstepClock.step(),
+            g_rules.winner(), g_rules.shotInProgress());
 
         // Draw plane, walls, pockets, and active balls
         g_legoPlane.draw(Device, g_mWorld);
         for (int i = 0; i < 4; i++) {
             g_legowall[i].draw(Device, g_mWorld);
         }
-        for (const auto& pocket : pockets) {
-            pocket.draw(Device, g_mWorld);
+        for (int i = 0; i < activeTable().numPockets; i++) {
+            pockets[i].draw(Device, g_mWorld);
         }
+        g_ballTransforms.update(fromD3DMatrix(g_mWorld));
         for (int i = 0; i < 16; i++) {
             if (g_sphere[i].isActiveBall()) {
-                g_sphere[i].draw(Device, g_mWorld);
+                g_sphere[i].draw(Device);
             }
         }
-        g_target_blueball.draw(Device, g_mWorld);
+        g_target_blueball.draw(Device);
+        if (!g_rules.shotInProgress()) {
+            drawAimGuide();
+        }
         g_light.draw(Device);
 
         // 화면에 문자열 표현
         // turn
         char* turn_text;
-        if (turn) {
+        if (rules.turn) {
             turn_text = "Turn : Player 1's turn";
         }
         else {
@@ -1125,11 +1244,11 @@ bool Display(float timeDelta) {
         d3d::RenderText(Device, turn_text, turn_rect);
         // 할당된 공 그룹
         char* group_text;
-        if (open) {
+        if (rules.open) {
             group_text = "group : any";
         }
         else {
-            if (group) {
+            if (rules.group) {
                 group_text = "target group: solid ball";
             }
             else {
@@ -1140,10 +1259,10 @@ bool Display(float timeDelta) {
 
         // 경기 결과
         char* win_text;
-        if (win == 0) {
+        if (g_rules.winner() == 0) {
             win_text = "result : draw";
         }
-        else if(win == 1){
+        else if(g_rules.winner() == 1){
             win_text = "result : player 1 win";
         }
         else {
@@ -1151,9 +1270,61 @@ bool Display(float timeDelta) {
         }
         d3d::RenderText(Device, win_text, win_rect);
 
+        // 마지막 샷 미리보기 결과
+        if (preview_text[0] != '\0') {
+            d3d::RenderText(Device, preview_text, preview_rect);
+        }
+
+        // 큐 팁 위치
+        char tip_text[128];
+        sprintf(tip_text, "cue tip : side %+.1f, height %+.1f (arrow keys)", g_tipSide, g_tipHeight);
+        d3d::RenderText(Device, tip_text, tip_rect);
+
+        // 마지막 샷 기록
+        if (g_telemetry.text()[0] != '\0') {
+            d3d::RenderText(Device, g_telemetry.text(), telemetry_rect);
+        }
+
+        // heap 할당 계수 (ALLOC_TRACKING 빌드)
+        if (allocTrackingEnabled()) {
+            d3d::RenderText(Device, g_allocs.text(), alloc_rect);
+        }
+
+        // 네트워크 상태
+        if (g_net.active()) {
+            static const char* ROLE_NAMES[] = { "offline", "host", "player 2", "spectator" };
+            const NetStats& stats = g_net.stats();
+            char net_text[192];
+            if (g_net.synced()) {
+                sprintf(net_text, "net : %s, step %u, turn %u, rollback %u (%u steps), sent %.1f KB, received %.1f KB",
+                    ROLE_NAMES[g_net.role()], g_net.step(), g_net.confirmedTurns(), stats.rollbacks,
+                    stats.resimulatedSteps, stats.bytesSent / 1024.0f, stats.bytesReceived / 1024.0f);
+            }
+            else {
+                sprintf(net_text, "net : %s, connecting to %s:%u", ROLE_NAMES[g_net.role()], g_netHost, g_netPort);
+            }
+            d3d::RenderText(Device, net_text, net_rect);
+        }
+        else {
+            // 시뮬레이션 속도 (네트워크 대전 중에는 바꿀 수 없다)
+            char time_text[128];
+            sprintf(time_text, "time : %s (P: pause, PgUp / PgDn: speed, Home: 1x)", g_timeControl.label());
+            d3d::RenderText(Device, time_text, time_rect);
+        }
+
+#ifdef DETERMINISTIC_PHYSICS
+        // lockstep 상태
+        uint64_t checksum = 0;
+        char lockstep_text[128];
+        g_desync.lookup(g_lockstepClock.step() - 1, &checksum);
+        sprintf(lockstep_text, "lockstep : step %u, checksum %016llx%s", g_lockstepClock.step(),
+            (unsigned long long)checksum, g_desync.desynced() ? ", DESYNC" : "");
+        d3d::RenderText(Device, lockstep_text, lockstep_rect);
+#endif
+
         // 어떤 공을 칠지 선택해야 한다면 뜨는 창
         char* select_text;
-        if (select_group) {
+        if (g_rules.selectingGroup()) {
             select_text = "select target group using keyboard ( solid : A, stripe: B )";
             d3d::RenderText(Device, select_text, select_rect);
         }
@@ -1164,7 +1335,7 @@ bool Display(float timeDelta) {
 
         // free shot 진행 중임을 알려주는 창
         char* free_shot_text;
-        if (free_shot) {
+        if (rules.free_shot) {
             free_shot_text = "free shot";
             d3d::RenderText(Device, free_shot_text, free_shot_rect);
         }
@@ -1172,6 +1343,7 @@ bool Display(float timeDelta) {
         Device->EndScene();
         Device->Present(0, 0, 0, 0);
         Device->SetTexture(0, NULL);
+        g_allocs.endFrame();
     }
 
     return true;
@@ -1206,28 +1378,110 @@ LRESULT CALLBACK d3d::WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
             }
             break;
         case 'A':
-            if (select_group) {
-                group = true;
-                select_group = false;
-                open = false;
-
-                cusion_count = 0;
-                solid_in = stripe_in = white_in = black_in = false;
+        case 'B':
+            if (g_net.active()) {
+                g_net.submitGroup(wParam == 'A');
+            }
+            else {
+                g_rules.selectGroup(wParam == 'A');
             }
             break;
-        case 'B':
-            if (select_group) {
-                group = false;
-                select_group = false;
-                open = false;
+        case 'Q': // 현재 조준으로 샷을 쳤을 때의 결과 미리보기
+        {
+            if (!g_rules.shotInProgress() && !g_rules.rules().free_shot) {
+                D3DXVECTOR3 targetpos = g_target_blueball.getCenter();
+                D3DXVECTOR3 whitepos = g_sphere[0].getCenter();
+                float dx = targetpos.x - whitepos.x;
+                float dz = targetpos.z - whitepos.z;
+                ShotOutcome outcome = previewShot(atan2f(dz, dx), sqrtf(dx * dx + dz * dz));
+
+                int potted = 0;
+                for (int i = 1; i < 16; i++) {
+                    if (outcome.pocketed & (1u << i)) potted++;
+                }
+                ShotCacheStats cacheStats = g_shotCache.stats();
+                sprintf(preview_text, "preview : %d ball(s) in%s%s (cache hit %.0f%%)",
+                    potted, outcome.scratch ? ", scratch" : "", outcome.foul ? ", foul" : "",
+                    cacheStats.hitRate() * 100.0);
+            }
+            break;
+        }
+        case 'H': // 넣을 수 있는 직접 샷 중 가장 쉬운 것으로 조준
+        {
+            if (g_rules.shotInProgress() || g_rules.rules().free_shot || !g_sphere[0].isActiveBall()) break;
+
+            ShotCandidate shots[SHOT_MAX_CANDIDATES];
+            unsigned targets = legalTargetMask(g_rules.rules(), g_table.balls, NUM_BALLS);
+            int numShots = findShots(g_table.balls, NUM_BALLS, targets, FLT_MAX, shots, SHOT_MAX_CANDIDATES);
+
+            // 힘은 흰 공에서 파란 공까지의 거리이므로 파란 공이 테이블 안에 놓이는 샷만 쓴다.
+            const TableLayout& table = activeTable();
+            D3DXVECTOR3 whitepos = g_sphere[0].getCenter();
+            int chosen = -1;
+            float markX = 0.0f, markZ = 0.0f;
+            for (int i = 0; i < numShots && chosen < 0; i++) {
+                markX = whitepos.x + cosf(shots[i].aim) * shots[i].power;
+                markZ = whitepos.z + sinf(shots[i].aim) * shots[i].power;
+                if (markX >= table.minX + M_RADIUS && markX <= table.maxX - M_RADIUS &&
+                    markZ >= table.minZ + M_RADIUS && markZ <= table.maxZ - M_RADIUS)
+                    chosen = i;
+            }
+            if (chosen < 0) {
+                sprintf(preview_text, "hint : no open shot (%d candidate(s))", numShots);
+                break;
+            }
 
-                cusion_count = 0;
-                solid_in = stripe_in = white_in = black_in = false;
+            const ShotCandidate& shot = shots[chosen];
+            g_target_blueball.setCenter(markX, (float)M_RADIUS, markZ);
+            g_tipSide = 0.0f;
+            g_tipHeight = SHOT_ROLL_TIP;
+            updateAimGuide();
+            sprintf(preview_text, "hint : ball %d -> pocket %d, cut %.0f deg, power %.2f (%d open shot(s))",
+                shot.ball, shot.pocket, shot.cutAngle * 180.0f / PI, shot.power, numShots);
+            break;
+        }
+        case VK_LEFT: // 큐 팁 위치 조절 (miscue 범위 밖으로는 나가지 않음)
+        case VK_RIGHT:
+        case VK_UP:
+        case VK_DOWN:
+        {
+            float side = g_tipSide + (wParam == VK_RIGHT ? TIP_STEP : wParam == VK_LEFT ? -TIP_STEP : 0.0f);
+            float height = g_tipHeight + (wParam == VK_UP ? TIP_STEP : wParam == VK_DOWN ? -TIP_STEP : 0.0f);
+            if (sqrtf(side * side + height * height) <= MAX_TIP_OFFSET + 1e-3f) {
+                g_tipSide = side;
+                g_tipHeight = height;
+                updateAimGuide();
+            }
+            break;
+        }
+        case VK_F5: // 테이블 변경 (새 게임)
+        case VK_F6:
+        case VK_F7:
+        case VK_F8:
+            // 네트워크 대전 중에는 상대와 테이블이 달라지므로 바꾸지 않는다.
+            if (!g_net.active() && !g_rules.shotInProgress() && selectTable(TABLE_FILES[wParam - VK_F5])) {
+                Cleanup();
+                if (!Setup()) {
+                    ::MessageBox(0, "Setup() - FAILED", 0, 0);
+                    ::DestroyWindow(hwnd);
+                }
+            }
+            break;
+        case 'P': // 일시 정지
+        case VK_PRIOR: // 빠르게
+        case VK_NEXT: // 느리게
+        case VK_HOME: // 1배속
+            // 네트워크 대전 중에는 상대와 같은 속도로 진행해야 하므로 바꾸지 않는다.
+            if (!g_net.active()) {
+                if (wParam == 'P') g_timeControl.togglePause();
+                else if (wParam == VK_PRIOR) g_timeControl.faster();
+                else if (wParam == VK_NEXT) g_timeControl.slower();
+                else g_timeControl.normal();
             }
             break;
         case VK_SPACE: // 스페이스바를 누르는 경우
-            if (!select_group) {
-                if (!shot_last) { // 직전의 shot이 종료되어야 다음 shot을 할 수 있다.
+            if (!g_rules.selectingGroup()) {
+                if (!g_rules.shotInProgress()) { // 직전의 shot이 종료되어야 다음 shot을 할 수 있다.
                     D3DXVECTOR3 targetpos = g_target_blueball.getCenter();
                     D3DXVECTOR3 whitepos = g_sphere[0].getCenter();
 
@@ -1236,25 +1490,31 @@ LRESULT CALLBACK d3d::WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
                     const float MIN_DISTANCE = M_RADIUS / 2.0f; // 최소 거리 설정
 
                     if (distance < MIN_DISTANCE)  break; // 발사하지 않음
-                    if (free_shot) { // free_shot의 경우 blue_ball의 위치로 흰 공을 이동시키고 activate를 한다.
+                    preview_text[0] = '\0';
+                    if (g_rules.rules().free_shot && g_net.active()) {
+                        if (g_net.submitPlacement(targetpos.x, targetpos.z))
+                            updateAimGuide();
+                    }
+                    else if (g_rules.rules().free_shot) { // free_shot의 경우 blue_ball의 위치로 흰 공을 이동시키고 activate를 한다.
                         g_sphere[0].setCenter(g_target_blueball.getCenter().x, g_target_blueball.getCenter().y, g_target_blueball.getCenter().z);
                         g_sphere[0].activate();
                         g_sphere[0].setPower(0, 0);
-                        free_shot = false;
-                        white_in = false;
+                        g_rules.placeCueBall();
+                        updateAimGuide();
                     }
                     else {
                         D3DXVECTOR3 targetpos = g_target_blueball.getCenter();
                         D3DXVECTOR3	whitepos = g_sphere[0].getCenter();
-                        double theta = acos(sqrt(pow(targetpos.x - whitepos.x, 2)) / sqrt(pow(targetpos.x - whitepos.x, 2) +
-
-                            pow(targetpos.z - whitepos.z, 2)));
-                        if (targetpos.z - whitepos.z <= 0 && targetpos.x - whitepos.x >= 0) { theta = -theta; }
-                        if (targetpos.z - whitepos.z >= 0 && targetpos.x - whitepos.x <= 0) { theta = PI - theta; }
-                        if (targetpos.z - whitepos.z <= 0 && targetpos.x - whitepos.x <= 0) { theta = PI + theta; }
-
-                        double distance = sqrt(pow(targetpos.x - whitepos.x, 2) + pow(targetpos.z - whitepos.z, 2));
-                        g_sphere[0].setPower(distance * cos(theta), distance * sin(theta));
+                        float2 toTarget = make_float2(targetpos.x - whitepos.x, targetpos.z - whitepos.z);
+                        float theta = atan2f(toTarget.y, toTarget.x);
+                        if (g_net.active()) {
+                            // 자기 차례가 아니면 무시된다. 치는 쪽은 확정을 기다리지 않고 바로 움직인다.
+                            g_net.submitShot(theta, length(toTarget), g_tipSide, g_tipHeight);
+                        }
+                        else {
+                            g_sphere[0].strike(encodeShot(g_lockstepClock.step(), theta, length(toTarget),
+                                g_tipSide, g_tipHeight));
+                        }
                     }
                 }
             }
@@ -1313,18 +1573,20 @@ LRESULT CALLBACK d3d::WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
                 float new_x_pos = coord3d.x + dx;
                 float new_z_pos = coord3d.z + dy;
 
-                // 테이블 크기에 맞춘 경계 제한
-                const float TABLE_MIN_X = -4.5f + M_RADIUS; // 반지름만큼 여유를 둠
-                const float TABLE_MAX_X = 4.5f - M_RADIUS;
-                const float TABLE_MIN_Z = -3.0f + M_RADIUS;
-                const float TABLE_MAX_Z = 3.0f - M_RADIUS;
+                // 테이블 크기에 맞춘 경계 제한 (반지름만큼 여유를 둠)
+                const TableLayout& table = activeTable();
+                const float minX = (float)(table.minX + M_RADIUS);
+                const float maxX = (float)(table.maxX - M_RADIUS);
+                const float minZ = (float)(table.minZ + M_RADIUS);
+                const float maxZ = (float)(table.maxZ - M_RADIUS);
 
                 // 위치 제한
-                new_x_pos = max(TABLE_MIN_X, min(TABLE_MAX_X, new_x_pos));
-                new_z_pos = max(TABLE_MIN_Z, min(TABLE_MAX_Z, new_z_pos));
+                new_x_pos = max(minX, min(maxX, new_x_pos));
+                new_z_pos = max(minZ, min(maxZ, new_z_pos));
 
                 // 제한된 위치로 파란 공 이동
                 g_target_blueball.setCenter(new_x_pos, coord3d.y, new_z_pos);
+                updateAimGuide();
             }
             old_x = new_x;
             old_y = new_y;
@@ -1345,6 +1607,21 @@ int WINAPI WinMain(HINSTANCE hinstance,
 {
     srand(static_cast<unsigned int>(time(NULL)));
 
+    // 명령줄: [-host port | -join host port | -watch host port] [테이블 정의 파일]
+    // 테이블 파일을 읽지 못하면 내장 8-ball 테이블을 쓴다.
+    // 작업 폴더에 physics.params (tools/physicsFit의 결과)가 있으면 그 계수를 쓴다.
+    const char* tablePath = parseNetOptions(cmdLine);
+    selectPhysics(PHYSICS_PARAMS_FILE);
+    selectTable(tablePath != NULL && tablePath[0] != '\0' ? tablePath : TABLE_FILES[0]);
+
+    // 물리 사건을 받을 곳들
+    g_eventBus.subscribe(&g_rules);
+    g_eventBus.subscribe(&g_telemetry);
+    g_eventBus.subscribe(&g_audio);
+    g_eventBus.subscribe(&g_allocs);
+    setAllocFailureHandler(reportSteadyStateAlloc);
+    g_stepper.setEventBus(&g_eventBus);
+
     if (!d3d::InitD3D(hinstance,
         Width, Height, true, D3DDEVTYPE_HAL, &Device))
     {
@@ -1358,7 +1635,20 @@ int WINAPI WinMain(HINSTANCE hinstance,
         return 0;
     }
 
-    d3d::EnterMsgLoop(Display);
+    if (g_netRole != NET_OFFLINE && !startNetwork())
+    {
+        ::MessageBox(0, "startNetwork() - FAILED", 0, 0);
+        return 0;
+    }
+
+    // 공유 메모리를 만들지 못해도 게임은 그대로 진행한다 (읽는 도구만 붙지 못한다).
+    g_stateShare.create();
+
+    d3d::EnterMsgLoop(Display, activePhysics().clockRate);
+
+    g_net.close();
+    g_udp.close();
+    g_stateShare.close();
 
     Cleanup();
 
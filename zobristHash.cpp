@@ -0,0 +1,64 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: zobristHash.cpp
+//
+// Desc: 테이블 상태의 64-bit Zobrist hash 구현.
+//       격자 칸마다 key 표를 두는 대신 (공, 칸) 쌍을 splitmix64로 섞어
+//       key를 만든다. 표와 같은 성질을 가지면서 메모리를 쓰지 않는다.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "zobristHash.h"
+#include <cmath>
+
+namespace
+{
+    const uint64_t ZOBRIST_SEED = 0x9E3779B97F4A7C15ull;
+
+    uint64_t splitmix64(uint64_t x)
+    {
+        x += 0x9E3779B97F4A7C15ull;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+        return x ^ (x >> 31);
+    }
+
+    // 규칙 항목별 key
+    const uint64_t TURN_KEY = splitmix64(ZOBRIST_SEED ^ 0x01);
+    const uint64_t GROUP_KEY = splitmix64(ZOBRIST_SEED ^ 0x02);
+    const uint64_t OPEN_KEY = splitmix64(ZOBRIST_SEED ^ 0x03);
+}
+
+int32_t CZobristHash::quantize(float value, float cell)
+{
+    return (int32_t)floorf(value / cell + 0.5f);
+}
+
+uint64_t CZobristHash::ballKey(int index, const BallState& ball)
+{
+    // 포켓에 들어간 공은 위치와 무관하게 기여하지 않는다.
+    if (!ball.active)
+        return 0;
+
+    uint64_t qx = (uint32_t)quantize(ball.x, ZOBRIST_CELL) & 0xFFFFF;
+    uint64_t qz = (uint32_t)quantize(ball.z, ZOBRIST_CELL) & 0xFFFFF;
+    uint64_t cell = ((uint64_t)index << 40) | (qx << 20) | qz;
+    return splitmix64(ZOBRIST_SEED ^ splitmix64(cell));
+}
+
+uint64_t CZobristHash::rulesKey(const RuleState& rules)
+{
+    uint64_t key = 0;
+    if (rules.turn) key ^= TURN_KEY;
+    if (rules.group) key ^= GROUP_KEY;
+    if (rules.open) key ^= OPEN_KEY;
+    return key;
+}
+
+uint64_t CZobristHash::compute(const TableState& state)
+{
+    uint64_t h = rulesKey(state.rules);
+    for (int i = 0; i < NUM_BALLS; i++)
+        h ^= ballKey(i, state.balls[i]);
+    return h;
+}
@@ -0,0 +1,48 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: zobristHash.h
+//
+// Desc: 테이블 상태의 64-bit Zobrist hash.
+//       공의 위치는 ZOBRIST_CELL 크기의 격자로 양자화되며, 공 하나가 움직이거나
+//       규칙 값이 바뀔 때 해당 항목만 XOR로 갱신할 수 있다.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __zobristHashH__
+#define __zobristHashH__
+
+#include "billiardPhysics.h"
+#include <stdint.h>
+
+// 위치 양자화 간격. 이보다 가까운 두 배치는 같은 상태로 취급된다.
+const float ZOBRIST_CELL = 0.01f;
+
+class CZobristHash {
+public:
+    CZobristHash(void) : m_value(0) {}
+
+    // 상태 전체로부터 다시 계산
+    void reset(const TableState& state) { m_value = compute(state); }
+    uint64_t value(void) const { return m_value; }
+
+    // 공 하나의 before -> after 변화만 반영
+    void updateBall(int index, const BallState& before, const BallState& after)
+    {
+        m_value ^= ballKey(index, before) ^ ballKey(index, after);
+    }
+
+    void updateRules(const RuleState& before, const RuleState& after)
+    {
+        m_value ^= rulesKey(before) ^ rulesKey(after);
+    }
+
+    static uint64_t compute(const TableState& state);
+    static uint64_t ballKey(int index, const BallState& ball);
+    static uint64_t rulesKey(const RuleState& rules);
+    static int32_t quantize(float value, float cell);
+
+private:
+    uint64_t m_value;
+};
+
+#endif // __zobristHashH__